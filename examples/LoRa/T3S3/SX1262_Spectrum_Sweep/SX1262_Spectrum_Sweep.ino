@@ -0,0 +1,180 @@
+/*
+  Spectrum sweep of the EU868 ISM band using SX1262 spectral scan.
+  Max-hold and average are drawn on the OLED together with a waterfall,
+  each completed sweep is also streamed over serial as a single line:
+  SWEEP <start MHz> <step MHz> <level of each step as two hex digits>
+  Level 0 is -160 dBm, step is 1 dB.
+
+  WARNING: Spectral scan requires a binary patch to be uploaded
+  to the SX1262, there may be some undocumented side effects!
+
+  For full API reference, see the GitHub Pages
+  https://jgromes.github.io/RadioLib/
+*/
+
+#include <RadioLib.h>
+#include <U8g2lib.h>
+#include <Wire.h>
+
+// this file contains binary patch for the SX1262
+#include <modules/SX126x/patches/SX126x_patch_scan.h>
+
+// Board pin definitions
+#define I2C_SDA                     18
+#define I2C_SCL                     17
+#define RADIO_SCLK_PIN              5
+#define RADIO_MISO_PIN              3
+#define RADIO_MOSI_PIN              6
+#define RADIO_CS_PIN                7
+#define RADIO_RST_PIN               8
+#define RADIO_DIO1_PIN              33
+#define RADIO_BUSY_PIN              34
+
+// sweep range, 64 steps of 125 kHz cover 863 - 871 MHz
+#define SWEEP_FREQ_START            863.0
+#define SWEEP_FREQ_STEP             0.125
+#define SWEEP_STEPS                 64
+#define SWEEP_SAMPLES               512
+
+// waterfall occupies the bottom half of the display, one row per sweep
+#define WATERFALL_ROWS              32
+
+// levels this far above the average noise floor are shown in the waterfall
+#define WATERFALL_THRESHOLD_DB      10
+
+SX1262 radio = new Module(RADIO_CS_PIN, RADIO_DIO1_PIN, RADIO_RST_PIN, RADIO_BUSY_PIN);
+
+U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
+
+uint8_t maxHold[SWEEP_STEPS];
+uint16_t average[SWEEP_STEPS];
+uint8_t waterfall[WATERFALL_ROWS * SWEEP_STEPS];
+
+SX126xSweep_t sweep = {
+    SWEEP_FREQ_START,
+    SWEEP_FREQ_STEP,
+    SWEEP_STEPS,
+    SWEEP_SAMPLES,
+    RADIOLIB_SX126X_SPECTRAL_SCAN_WINDOW_DEFAULT,
+    RADIOLIB_SX126X_SCAN_INTERVAL_8_20_US,
+    maxHold,
+    average,
+    3,
+    waterfall,
+    WATERFALL_ROWS,
+};
+
+void halt(const __FlashStringHelper *msg, int state)
+{
+    Serial.print(msg);
+    Serial.println(state);
+    while (true) {
+        delay(10);
+    }
+}
+
+// map level to the top half of the display, -140 dBm at the bottom, -40 dBm at the top
+uint8_t levelToY(uint8_t level)
+{
+    int dbm = SX126x::spectralSweepPower(level);
+    dbm = constrain(dbm, -140, -40);
+    return 31 - ((dbm + 140) * 31) / 100;
+}
+
+void draw()
+{
+    // noise floor is the lowest average level
+    uint16_t floor = 0xFFFF;
+    for (int i = 0; i < SWEEP_STEPS; i++) {
+        floor = min(floor, average[i]);
+    }
+    uint8_t threshold = (floor >> 8) + WATERFALL_THRESHOLD_DB;
+
+    u8g2.clearBuffer();
+    for (int i = 0; i < SWEEP_STEPS; i++) {
+        // average as bars, max-hold as dots above them
+        uint8_t x = 2 * i;
+        uint8_t y = levelToY(average[i] >> 8);
+        u8g2.drawVLine(x, y, 32 - y);
+        u8g2.drawPixel(x + 1, levelToY(maxHold[i]));
+
+        // newest row of the waterfall at the top
+        for (int r = 0; r < WATERFALL_ROWS; r++) {
+            uint16_t row = (sweep.row + WATERFALL_ROWS - 1 - r) % WATERFALL_ROWS;
+            if (waterfall[row * SWEEP_STEPS + i] > threshold) {
+                u8g2.drawBox(x, 32 + r, 2, 1);
+            }
+        }
+    }
+    u8g2.sendBuffer();
+}
+
+void stream()
+{
+    uint16_t row = (sweep.row + WATERFALL_ROWS - 1) % WATERFALL_ROWS;
+    Serial.print("SWEEP ");
+    Serial.print(SWEEP_FREQ_START, 3);
+    Serial.print(' ');
+    Serial.print(SWEEP_FREQ_STEP, 3);
+    Serial.print(' ');
+    for (int i = 0; i < SWEEP_STEPS; i++) {
+        uint8_t level = waterfall[row * SWEEP_STEPS + i];
+        Serial.print(level >> 4, HEX);
+        Serial.print(level & 0x0F, HEX);
+    }
+    Serial.println();
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    Wire.begin(I2C_SDA, I2C_SCL);
+    u8g2.begin();
+
+    SPI.begin(RADIO_SCLK_PIN, RADIO_MISO_PIN, RADIO_MOSI_PIN);
+
+    // spectral scan is done in FSK mode
+    Serial.print(F("[SX1262] Initializing ... "));
+    int state = radio.beginFSK(SWEEP_FREQ_START);
+    if (state != RADIOLIB_ERR_NONE) {
+        halt(F("failed, code "), state);
+    }
+    Serial.println(F("success!"));
+
+    // NOTE: this patch is uploaded into volatile memory,
+    //       and must be re-uploaded on every power up
+    Serial.print(F("[SX1262] Uploading patch ... "));
+    state = radio.uploadPatch(sx126x_patch_scan, sizeof(sx126x_patch_scan));
+    if (state != RADIOLIB_ERR_NONE) {
+        halt(F("failed, code "), state);
+    }
+    Serial.println(F("success!"));
+
+    // the receiver bandwidth should be about the same as the sweep step
+    state = radio.setRxBandwidth(117.3);
+    state |= radio.setDataShaping(RADIOLIB_SHAPING_NONE);
+    if (state != RADIOLIB_ERR_NONE) {
+        halt(F("[SX1262] Failed to set scan parameters, code "), state);
+    }
+
+    state = radio.spectralSweepStart(&sweep);
+    if (state != RADIOLIB_ERR_NONE) {
+        halt(F("[SX1262] Failed to start sweep, code "), state);
+    }
+}
+
+void loop()
+{
+    // the next step is already running while the previous one is processed,
+    // so the display and serial output only slow down the sweep when they take longer than a single scan
+    int state = radio.spectralSweepUpdate();
+    if (state == RADIOLIB_ERR_NONE) {
+        stream();
+        draw();
+    } else if (state != RADIOLIB_ERR_RANGING_TIMEOUT) {
+        Serial.print(F("[SX1262] Sweep failed, code "));
+        Serial.println(state);
+        radio.spectralSweepStart(&sweep);
+    }
+}
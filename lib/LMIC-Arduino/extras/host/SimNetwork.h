@@ -0,0 +1,288 @@
+/*******************************************************************************
+ * Scripted LoRaWAN 1.0.x network for the host port: a gateway and network
+ * server in one, attached to the simulated channel like any other radio.
+ *
+ * It accepts OTAA joins for a single device, answers confirmed uplinks with
+ * an ACK and can queue application downlinks. Downlinks are sent exactly at
+ * the start of RX1 (or RX2) after the uplink ends, so the device only hears
+ * them if it opened its receive window in time.
+ *******************************************************************************/
+#ifndef _sim_network_h_
+#define _sim_network_h_
+
+#include <hal/Sim/SimHal.h>
+
+class SimNetwork : public SimRadio {
+  public:
+    SimNetwork(SimChannel* channel, const uint8_t* appKey) : SimRadio(channel) {
+      memcpy(this->appKey, appKey, 16);
+    }
+
+    // answer in RX2 instead of RX1
+    bool useRx2 = false;
+    uint32_t rx2Freq = 869525000;
+    uint8_t rx2Sf = 9;
+
+    // delays in seconds, as configured on the device
+    uint8_t rxDelay = 1;
+    uint8_t joinDelay = 5;
+
+    // counters
+    uint32_t joins = 0;
+    uint32_t uplinks = 0;
+    uint32_t downlinks = 0;
+    uint32_t micErrors = 0;
+
+    // provision an ABP session instead of waiting for a join
+    void setSession(uint32_t addr, const uint8_t* nwkSKey, const uint8_t* appSKey) {
+      this->devAddr = addr;
+      memcpy(this->nwkSKey, nwkSKey, 16);
+      memcpy(this->appSKey, appSKey, 16);
+      this->fCntDown = 0;
+      this->joined = true;
+    }
+
+    // queue application payload for the next downlink
+    void queueDownlink(uint8_t port, const uint8_t* data, size_t len) {
+      this->dlPort = port;
+      this->dlLen = (len > sizeof(this->dlData)) ? sizeof(this->dlData) : len;
+      memcpy(this->dlData, data, this->dlLen);
+    }
+
+    bool isJoined() const {
+      return(this->joined);
+    }
+
+    // start of the last downlink in virtual microseconds
+    uint64_t lastDownlinkStart = 0;
+
+    void select() override {}
+    uint8_t transfer(uint8_t b) override { return(b); }
+    void deselect() override {}
+    void reset(bool level) override { (void)level; }
+    bool getIrq() override { return(false); }
+    bool getGpio() override { return(false); }
+
+    uint64_t nextEvent() override {
+      uint64_t ev = this->pending ? this->pendingStart : SIM_NEVER;
+      if(this->transmitting && (this->txPacket.end < ev)) {
+        ev = this->txPacket.end;
+      }
+      return(ev);
+    }
+
+    void update(uint64_t t) override {
+      if(this->transmitting && (t >= this->txPacket.end)) {
+        this->transmitting = false;
+        this->channel->deliver(this, this->txPacket);
+      }
+
+      if(this->pending && (t >= this->pendingStart)) {
+        this->pending = false;
+        this->startTx(this->pendingData, this->pendingLen, this->pendingStart);
+        this->lastDownlinkStart = this->pendingStart;
+        this->downlinks++;
+      }
+    }
+
+    // the gateway listens to all uplinks, on any channel and data rate
+    bool accepts(const SimPacket& pkt, uint64_t since) const override {
+      (void)since;
+      return(!pkt.iq && !this->transmitting);
+    }
+
+    void receive(const SimPacket& pkt, float rssi, float snr, bool crcErr) override {
+      (void)rssi;
+      (void)snr;
+      if(crcErr || (pkt.len < 1)) {
+        return;
+      }
+
+      switch(pkt.data[0] & 0xE0) {
+        case(0x00):
+          this->joinRequest(pkt);
+          break;
+        case(0x40):
+        case(0x80):
+          this->dataUplink(pkt);
+          break;
+        default:
+          break;
+      }
+    }
+
+  private:
+    uint8_t appKey[16];
+    uint8_t nwkSKey[16] = { 0 };
+    uint8_t appSKey[16] = { 0 };
+    uint32_t devAddr = 0x26011234;
+    uint32_t netId = 0x000013;
+    uint32_t appNonce = 0x000001;
+    uint32_t fCntDown = 0;
+    bool joined = false;
+
+    uint8_t dlPort = 0;
+    uint8_t dlData[32];
+    size_t dlLen = 0;
+
+    bool pending = false;
+    uint64_t pendingStart = 0;
+    uint8_t pendingData[64];
+    size_t pendingLen = 0;
+
+    // schedule a downlink in the receive window after the given uplink
+    void schedule(const SimPacket& up, uint8_t delay, const uint8_t* data, size_t len) {
+      this->freq = up.freq;
+      this->sf = up.sf;
+      if(this->useRx2) {
+        this->freq = this->rx2Freq;
+        this->sf = this->rx2Sf;
+        delay++;
+      }
+      this->bw = up.bw;
+      this->cr = 1;
+      this->crc = false;
+      this->implicit = false;
+      this->ldro = (this->sf >= 11) && (this->bw == 125000);
+      this->iqTx = true;
+      this->preamble = 8;
+
+      memcpy(this->pendingData, data, len);
+      this->pendingLen = len;
+      this->pendingStart = up.end + (uint64_t)delay*1000000UL;
+      this->pending = true;
+    }
+
+    static uint32_t get32(const uint8_t* buf) {
+      return((uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24));
+    }
+
+    static void set32(uint8_t* buf, uint32_t val) {
+      buf[0] = val;
+      buf[1] = val >> 8;
+      buf[2] = val >> 16;
+      buf[3] = val >> 24;
+    }
+
+    // LoRaWAN 1.0 data frame MIC
+    void dataMic(const uint8_t* key, uint8_t dir, uint32_t fCnt, const uint8_t* frame, size_t len, uint8_t* mic) {
+      uint8_t buf[16 + 256] = { 0x49 };
+      buf[5] = dir;
+      set32(&buf[6], this->devAddr);
+      set32(&buf[10], fCnt);
+      buf[15] = len;
+      memcpy(&buf[16], frame, len);
+      uint8_t cmac[16];
+      RadioLibAES128Instance.init((uint8_t*)key);
+      RadioLibAES128Instance.generateCMAC(buf, 16 + len, cmac);
+      memcpy(mic, cmac, 4);
+    }
+
+    // LoRaWAN 1.0 payload encryption, same operation in both directions
+    void dataCrypt(const uint8_t* key, uint8_t dir, uint32_t fCnt, uint8_t* data, size_t len) {
+      uint8_t a[16] = { 0x01 };
+      uint8_t s[16];
+      a[5] = dir;
+      set32(&a[6], this->devAddr);
+      set32(&a[10], fCnt);
+      RadioLibAES128Instance.init((uint8_t*)key);
+      for(size_t i = 0; i < len; i += 16) {
+        a[15] = i/16 + 1;
+        RadioLibAES128Instance.encryptECB(a, 16, s);
+        for(size_t j = 0; (j < 16) && (i + j < len); j++) {
+          data[i + j] ^= s[j];
+        }
+      }
+    }
+
+    void joinRequest(const SimPacket& pkt) {
+      if(pkt.len != 23) {
+        return;
+      }
+
+      uint8_t cmac[16];
+      RadioLibAES128Instance.init(this->appKey);
+      RadioLibAES128Instance.generateCMAC(pkt.data, 19, cmac);
+      if(memcmp(cmac, &pkt.data[19], 4) != 0) {
+        this->micErrors++;
+        return;
+      }
+      uint16_t devNonce = pkt.data[17] | ((uint16_t)pkt.data[18] << 8);
+
+      // MHDR, AppNonce, NetID, DevAddr, DLSettings, RxDelay, MIC
+      uint8_t ja[17] = { 0x20 };
+      this->appNonce++;
+      ja[1] = this->appNonce;
+      ja[2] = this->appNonce >> 8;
+      ja[3] = this->appNonce >> 16;
+      ja[4] = this->netId;
+      ja[5] = this->netId >> 8;
+      ja[6] = this->netId >> 16;
+      set32(&ja[7], this->devAddr);
+      // RX2 data rate, EU868 DR0 is SF12
+      ja[11] = 12 - this->rx2Sf;
+      ja[12] = this->rxDelay;
+      RadioLibAES128Instance.generateCMAC(ja, 13, cmac);
+      memcpy(&ja[13], cmac, 4);
+
+      // session keys from AppNonce, NetID and DevNonce
+      uint8_t block[16] = { 0x01 };
+      memcpy(&block[1], &ja[1], 6);
+      block[7] = devNonce;
+      block[8] = devNonce >> 8;
+      RadioLibAES128Instance.encryptECB(block, 16, this->nwkSKey);
+      block[0] = 0x02;
+      RadioLibAES128Instance.encryptECB(block, 16, this->appSKey);
+      this->fCntDown = 0;
+      this->joined = true;
+      this->joins++;
+
+      // the device encrypts the join accept to read it, so the network decrypts it
+      uint8_t enc[17];
+      enc[0] = ja[0];
+      RadioLibAES128Instance.decryptECB(&ja[1], 16, &enc[1]);
+      this->schedule(pkt, this->joinDelay, enc, sizeof(enc));
+    }
+
+    void dataUplink(const SimPacket& pkt) {
+      if(!this->joined || (pkt.len < 12) || (get32(&pkt.data[1]) != this->devAddr)) {
+        return;
+      }
+
+      uint8_t mic[4];
+      uint32_t fCnt = pkt.data[6] | ((uint32_t)pkt.data[7] << 8);
+      this->dataMic(this->nwkSKey, 0, fCnt, pkt.data, pkt.len - 4, mic);
+      if(memcmp(mic, &pkt.data[pkt.len - 4], 4) != 0) {
+        this->micErrors++;
+        return;
+      }
+      this->uplinks++;
+
+      bool confirmed = (pkt.data[0] & 0xE0) == 0x80;
+      if(!confirmed && (this->dlLen == 0)) {
+        return;
+      }
+
+      // unconfirmed downlink, with ACK if needed and the queued payload
+      uint8_t dn[64] = { 0x60 };
+      set32(&dn[1], this->devAddr);
+      dn[5] = confirmed ? 0x20 : 0x00;
+      dn[6] = this->fCntDown;
+      dn[7] = this->fCntDown >> 8;
+      size_t len = 8;
+      if(this->dlLen) {
+        dn[len++] = this->dlPort;
+        memcpy(&dn[len], this->dlData, this->dlLen);
+        this->dataCrypt(this->dlPort ? this->appSKey : this->nwkSKey, 1, this->fCntDown, &dn[len], this->dlLen);
+        len += this->dlLen;
+        this->dlLen = 0;
+      }
+      this->dataMic(this->nwkSKey, 1, this->fCntDown, dn, len, &dn[len]);
+      len += 4;
+      this->fCntDown++;
+
+      this->schedule(pkt, this->rxDelay, dn, len);
+    }
+};
+
+#endif // _sim_network_h_
@@ -0,0 +1,261 @@
+/*******************************************************************************
+ * This is the HAL to run LMIC on a Linux host, against the simulated SX1276
+ * and virtual clock from RadioLib's hal/Sim/SimHal.h.
+ *
+ * Time only moves when LMIC waits, sleeps or talks to the radio, so a run
+ * is deterministic and takes no wall-clock time apart from the CPU work.
+ *******************************************************************************/
+
+#include <lmic.h>
+#include "hal_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+hal_host_stats_t hal_host_stats;
+
+static SimRadio* radio = NULL;
+static SimChannel* channel = NULL;
+static uint32_t spi_speed;
+static uint64_t spi_nanos = 0;
+
+void hal_host_attach (SimRadio* r, SimChannel* c, uint32_t spiSpeed)
+{
+    radio = r;
+    channel = c;
+    spi_speed = spiSpeed;
+    memset(&hal_host_stats, 0, sizeof(hal_host_stats));
+}
+
+uint64_t hal_host_micros ()
+{
+    return channel->now();
+}
+
+static uint64_t cpu_nanos ()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// run the simulation up to the given time, keeping its CPU time out of the LMIC figures
+static void sim_advance (uint64_t t)
+{
+    uint64_t start = cpu_nanos();
+    channel->advance(t);
+    hal_host_stats.simNs += cpu_nanos() - start;
+}
+
+// -----------------------------------------------------------------------------
+// I/O
+
+void hal_pin_rxtx (u1_t val)
+{
+    (void)val;
+}
+
+// set radio RST pin to given value (or keep floating!)
+void hal_pin_rst (u1_t val)
+{
+    // floating lets the pull-up release the reset
+    radio->reset(val != 0);
+}
+
+static bool dio_states[2] = {0};
+
+static void hal_io_check ()
+{
+    bool levels[2] = { radio->getIrq(), radio->getGpio() };
+    for (u1_t i = 0; i < 2; ++i) {
+        if (dio_states[i] != levels[i]) {
+            dio_states[i] = levels[i];
+            if (dio_states[i]) {
+                hal_host_stats.irqs++;
+                radio_irq_handler(i);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// SPI
+
+static int spi_pos;
+static u1_t spi_addr;
+
+static void hal_spi_time (u1_t len)
+{
+    // account for the time the bytes take on the bus, in nanoseconds to keep the remainder
+    spi_nanos += ((uint64_t)len * 8 * 1000000000UL) / spi_speed;
+    if (spi_nanos >= 1000) {
+        sim_advance(channel->now() + spi_nanos / 1000);
+        spi_nanos %= 1000;
+    }
+}
+
+void hal_pin_nss (u1_t val)
+{
+    if (!val) {
+        radio->select();
+        spi_pos = 0;
+        hal_host_stats.spiTransactions++;
+    } else {
+        radio->deselect();
+    }
+}
+
+// watch operation mode writes, to find out when the radio transmits and receives
+static void hal_spi_snoop (u1_t out)
+{
+    if (spi_pos++ == 0) {
+        spi_addr = out;
+        return;
+    }
+    if (spi_addr != (0x01 | 0x80))
+        return;
+
+    uint64_t now = channel->now();
+    switch (out & 0x07) {
+    case 0x03: { // TX
+        const SimPacket* pkt = radio->onAir();
+        if (pkt) {
+            hal_host_stats.txStart = pkt->start;
+            hal_host_stats.txEnd = pkt->end;
+            hal_host_stats.rxCount = 0;
+        }
+        break;
+    }
+    case 0x06: // RX single
+        if (hal_host_stats.rxCount < 2)
+            hal_host_stats.rxOpen[hal_host_stats.rxCount++] = now;
+        break;
+    }
+}
+
+// perform SPI transaction with radio
+u1_t hal_spi (u1_t out)
+{
+    u1_t res = radio->transfer(out);
+    hal_spi_snoop(out);
+    hal_host_stats.spiBytes++;
+    hal_spi_time(1);
+    return res;
+}
+
+// perform SPI transaction with radio for a whole buffer
+void hal_spi_burst (u1_t* buf, u1_t len, u1_t write)
+{
+    for (u1_t i = 0; i < len; i++) {
+        u1_t res = radio->transfer(write ? buf[i] : 0x00);
+        if (!write)
+            buf[i] = res;
+    }
+    spi_pos += len;
+    hal_host_stats.spiBytes += len;
+    hal_spi_time(len);
+}
+
+// -----------------------------------------------------------------------------
+// TIME
+
+u4_t hal_ticks ()
+{
+    // Virtual time does not move while LMIC computes, but LMIC expects the
+    // clock to move between two reads (a job scheduled at txbeg-TX_RAMPUP
+    // would otherwise find itself too early forever), so every read costs
+    // a microsecond of CPU time
+    sim_advance(channel->now() + 1);
+    return (u4_t)(channel->now() >> US_PER_OSTICK_EXPONENT);
+}
+
+// Returns the number of ticks until time. Negative values indicate that
+// time has already passed.
+static s4_t delta_time(u4_t time)
+{
+    return (s4_t)(time - hal_ticks());
+}
+
+void hal_waitUntil (u4_t time)
+{
+    s4_t delta = delta_time(time);
+    if (delta > 0)
+        sim_advance(channel->now() + ((uint64_t)delta << US_PER_OSTICK_EXPONENT));
+}
+
+// Deadline set by hal_checkTimer for the next hal_sleep
+static bool timer_armed = false;
+static u4_t timer_target;
+
+// check and rewind for target time
+u1_t hal_checkTimer (u4_t time)
+{
+    if (delta_time(time) <= 0) {
+        timer_armed = false;
+        return 1;
+    }
+
+    timer_target = time;
+    timer_armed = true;
+    return 0;
+}
+
+static uint8_t irqlevel = 0;
+
+void hal_disableIRQs ()
+{
+    irqlevel++;
+}
+
+void hal_enableIRQs ()
+{
+    if (--irqlevel == 0) {
+        // DIO lines are polled, the same as the Arduino HAL does
+        hal_io_check();
+    }
+}
+
+void hal_sleep ()
+{
+    // Skip ahead to the timer deadline, but stop early at the radio event
+    // that changes a DIO line, as that would wake up a real MCU
+    uint64_t start = channel->now();
+    uint64_t until = SIM_NEVER;
+    if (timer_armed) {
+        until = start + ((uint64_t)delta_time(timer_target) << US_PER_OSTICK_EXPONENT);
+        timer_armed = false;
+    }
+
+    while (1) {
+        uint64_t next = channel->nextEvent();
+        if (next >= until || next == SIM_NEVER)
+            break;
+        sim_advance(next);
+        if (radio->getIrq() != dio_states[0] || radio->getGpio() != dio_states[1])
+            break;
+    }
+
+    // without a deadline or radio event, just let a millisecond pass
+    if (until == SIM_NEVER)
+        until = start + 1000;
+    if (channel->now() < until && radio->getIrq() == dio_states[0] && radio->getGpio() == dio_states[1])
+        sim_advance(until);
+
+    hal_host_stats.sleptUs += channel->now() - start;
+}
+
+// -----------------------------------------------------------------------------
+
+void lmic_hal_init ()
+{
+    if (!radio || !channel) {
+        fprintf(stderr, "hal_host_attach() must be called before os_init()\n");
+        exit(1);
+    }
+}
+
+void hal_failed (const char *file, u2_t line)
+{
+    fprintf(stderr, "FAILURE %s:%u\n", file, line);
+    exit(1);
+}
@@ -0,0 +1,35 @@
+/*******************************************************************************
+ * This is the HAL to run LMIC on a Linux host, against the simulated SX1276
+ * and virtual clock from RadioLib's hal/Sim/SimHal.h.
+ *******************************************************************************/
+#ifndef _hal_host_h_
+#define _hal_host_h_
+
+#include <hal/Sim/SimHal.h>
+
+// Radio activity as seen on the SPI bus, used to measure RX window timing
+struct hal_host_stats_t {
+    uint32_t spiTransactions;
+    uint32_t spiBytes;
+    uint32_t irqs;
+    // last uplink on air, in virtual microseconds
+    uint64_t txStart;
+    uint64_t txEnd;
+    // RX_SINGLE starts since the last uplink
+    uint64_t rxOpen[2];
+    uint8_t rxCount;
+    // virtual time skipped by hal_sleep
+    uint64_t sleptUs;
+    // host CPU time spent in the simulation rather than in LMIC
+    uint64_t simNs;
+};
+
+extern hal_host_stats_t hal_host_stats;
+
+// connect the HAL to the simulated radio, must be called before os_init()
+void hal_host_attach (SimRadio* radio, SimChannel* channel, uint32_t spiSpeed = 10000000);
+
+// current virtual time in microseconds
+uint64_t hal_host_micros ();
+
+#endif // _hal_host_h_
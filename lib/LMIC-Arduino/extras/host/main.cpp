@@ -0,0 +1,389 @@
+/*******************************************************************************
+ * Headless LMIC node for regression and timing tests.
+ *
+ * Runs the same setup as examples/LoRaWAN/LMIC_Library_OTTA against a
+ * simulated SX1276 and a scripted network, and reports how accurately the
+ * RX windows were opened, how much CPU time LMIC needed per frame and what
+ * the scheduler costs with extra timed jobs pending.
+ *
+ * With -r it runs a randomized scheduler test instead: thousands of timed
+ * jobs are scheduled, rescheduled and cancelled, and every job has to run
+ * exactly once per schedule, in deadline order and without delay.
+ *
+ * Usage: lmic-host [-a] [-c] [-d] [-2] [-n frames] [-l jobs] [-s sf] [-r jobs]
+ *   -a  ABP session instead of OTAA join
+ *   -c  confirmed uplinks, the network answers each one with an ACK
+ *   -d  the network sends application data after every uplink
+ *   -2  the network answers in RX2 instead of RX1
+ *   -n  number of uplinks to send (default 10)
+ *   -l  number of extra periodic timed jobs (default 0)
+ *   -s  uplink spreading factor, 7 - 12 (default 7)
+ *   -r  randomized scheduler test with the given number of jobs
+ *******************************************************************************/
+
+#include <lmic.h>
+#include "hal_host.h"
+#include "SimNetwork.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+// Same keys as the OTAA example
+static const u1_t APPEUI[8] = {0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0xBB, 0xAA};
+static const u1_t DEVEUI[8] = {0x8D, 0x6F, 0x06, 0xD0, 0x7E, 0xD5, 0xB3, 0x70};
+static const u1_t APPKEY[16] = {0xF4, 0x84, 0x2F, 0xE1, 0x08, 0x77, 0xCC, 0xAF, 0x31, 0x90, 0x9D, 0xB3, 0x45, 0x04, 0x90, 0xFD};
+
+// ABP session
+static const u4_t DEVADDR = 0x260B1234;
+static const u1_t NWKSKEY[16] = {0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C};
+static const u1_t APPSKEY[16] = {0x3C, 0x4F, 0xCF, 0x09, 0x88, 0x15, 0xF7, 0xAB, 0xA6, 0xD2, 0xAE, 0x28, 0x16, 0x15, 0x7E, 0x2B};
+
+static const unsigned TX_INTERVAL = 30;
+
+void os_getArtEui (u1_t *buf)
+{
+    memcpy(buf, APPEUI, 8);
+}
+
+void os_getDevEui (u1_t *buf)
+{
+    memcpy(buf, DEVEUI, 8);
+}
+
+void os_getDevKey (u1_t *buf)
+{
+    memcpy(buf, APPKEY, 16);
+}
+
+static osjob_t sendjob;
+static SimNetwork* network = NULL;
+static bool confirmed = false;
+static bool downlinks = false;
+static unsigned framesToSend = 10;
+static unsigned framesDone = 0;
+static unsigned acks = 0;
+static unsigned downlinkFrames = 0;
+static unsigned downlinkErrors = 0;
+
+static const u1_t DOWNLINK[] = {0xDE, 0xAD, 0xBE, 0xEF, 0x01, 0x02, 0x03, 0x04};
+
+// RX window timing, offsets of the RX_SINGLE start from the nominal window start
+struct window_stats_t {
+    unsigned count;
+    int64_t min;
+    int64_t max;
+    int64_t sum;
+};
+
+// join accept and data windows, RX1 and RX2
+static window_stats_t rxStats[2][2];
+
+static void window_add (window_stats_t* st, int64_t offset)
+{
+    if (st->count == 0 || offset < st->min)
+        st->min = offset;
+    if (st->count == 0 || offset > st->max)
+        st->max = offset;
+    st->sum += offset;
+    st->count++;
+}
+
+static void window_check (bool join)
+{
+    // RX2 opens one second after RX1
+    uint64_t nominal = hal_host_stats.txEnd + (join ? 5000000UL : 1000000UL);
+    for (u1_t i = 0; i < hal_host_stats.rxCount; i++)
+        window_add(&rxStats[join][i], (int64_t)hal_host_stats.rxOpen[i] - (int64_t)(nominal + i * 1000000UL));
+}
+
+static void do_send (osjob_t* j)
+{
+    (void)j;
+    if (LMIC.opmode & OP_TXRXPEND)
+        return;
+
+    static uint8_t mydata[] = "Hello, world!";
+    LMIC_setTxData2(1, mydata, sizeof(mydata) - 1, confirmed);
+    if (downlinks)
+        network->queueDownlink(2, DOWNLINK, sizeof(DOWNLINK));
+}
+
+void onEvent (ev_t ev)
+{
+    switch (ev) {
+    case EV_JOINED:
+        window_check(true);
+        LMIC_setLinkCheckMode(0);
+        break;
+    case EV_JOIN_FAILED:
+        fprintf(stderr, "join failed\n");
+        exit(1);
+        break;
+    case EV_TXCOMPLETE:
+        window_check(false);
+        if (LMIC.txrxFlags & TXRX_ACK)
+            acks++;
+        if (LMIC.dataLen) {
+            downlinkFrames++;
+            if (LMIC.dataLen != sizeof(DOWNLINK) || memcmp(LMIC.frame + LMIC.dataBeg, DOWNLINK, sizeof(DOWNLINK)) != 0)
+                downlinkErrors++;
+        }
+        framesDone++;
+        os_setTimedCallback(&sendjob, os_getTime() + sec2osticks(TX_INTERVAL), do_send);
+        break;
+    default:
+        break;
+    }
+}
+
+// Extra jobs to load the scheduler, each reschedules itself with its own period
+static osjob_t* loadjobs = NULL;
+static unsigned loadCount = 0;
+static uint32_t loadRuns = 0;
+
+static void do_load (osjob_t* j)
+{
+    unsigned idx = j - loadjobs;
+    loadRuns++;
+    os_setTimedCallback(j, os_getTime() + ms2osticks(10 + idx), do_load);
+}
+
+static uint64_t cpu_nanos ()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// Randomized scheduler test, each job knows whether and when it should run
+struct rjob_t {
+    osjob_t job;
+    bool pending;
+    ostime_t deadline;
+};
+
+static rjob_t* rjobs = NULL;
+static unsigned rjobCount = 0;
+static unsigned rjobOps = 0;
+static unsigned rjobRuns = 0;
+static unsigned rjobErrors = 0;
+static unsigned rjobPending = 0;
+static unsigned rjobMaxPending = 0;
+static ostime_t rjobLastDeadline = 0;
+static ostime_t rjobLastEnd = 0;
+static s4_t rjobMaxLate = 0;
+
+static void do_random (osjob_t* j);
+
+static void rjob_schedule (rjob_t* r)
+{
+    // up to one minute ahead, the deadlines of thousands of jobs interleave
+    r->deadline = os_getTime() + rand() % sec2osticks(60);
+    if (!r->pending && ++rjobPending > rjobMaxPending)
+        rjobMaxPending = rjobPending;
+    r->pending = true;
+    os_setTimedCallback(&r->job, r->deadline, do_random);
+    rjobOps++;
+}
+
+static void do_random (osjob_t* j)
+{
+    rjob_t* r = (rjob_t*)j;
+    ostime_t now = os_getTime();
+    rjobRuns++;
+
+    // the job must be expected, in deadline order and run as soon as the previous one allowed
+    s4_t late = now - ((s4_t)(r->deadline - rjobLastEnd) > 0 ? r->deadline : rjobLastEnd);
+    if (!r->pending || (s4_t)(now - r->deadline) < 0 || (s4_t)(r->deadline - rjobLastDeadline) < 0) {
+        fprintf(stderr, "job %u: pending %d, deadline %ld, ran at %ld, previous deadline %ld\n",
+                (unsigned)(r - rjobs), r->pending, (long)r->deadline, (long)now, (long)rjobLastDeadline);
+        rjobErrors++;
+    }
+    if (late > rjobMaxLate)
+        rjobMaxLate = late;
+    if (r->pending)
+        rjobPending--;
+    r->pending = false;
+    rjobLastDeadline = r->deadline;
+
+    // keep shuffling the schedule for a while: reschedule this job, cancel or move another one
+    if (rjobOps < 4 * rjobCount) {
+        if (rand() % 2)
+            rjob_schedule(r);
+        rjob_t* other = &rjobs[rand() % rjobCount];
+        if (other != r) {
+            if (rand() % 4 == 0) {
+                os_clearCallback(&other->job);
+                if (other->pending)
+                    rjobPending--;
+                other->pending = false;
+            } else {
+                rjob_schedule(other);
+            }
+        }
+    }
+    rjobLastEnd = os_getTime();
+}
+
+static int random_test ()
+{
+    rjobs = (rjob_t*)calloc(rjobCount, sizeof(rjob_t));
+    srand(1);
+    for (unsigned i = 0; i < rjobCount; i++)
+        rjob_schedule(&rjobs[i]);
+    rjobLastEnd = os_getTime();
+
+    uint64_t cpu = 0;
+    uint64_t iterations = 0;
+    while (rjobPending) {
+        uint64_t start = cpu_nanos();
+        os_runloop_once();
+        cpu += cpu_nanos() - start;
+        iterations++;
+    }
+
+    // a job may only be late by the few ticks it takes to read the clock
+    bool ok = (rjobErrors == 0) && (rjobMaxLate <= 2);
+    printf("mode:            randomized scheduler, %u jobs, %d in heap\n", rjobCount, LMIC_MAX_TIMED_JOBS);
+    printf("virtual time:    %.3f s\n", hal_host_micros() / 1e6);
+    printf("jobs:            %u scheduled, %u runs, %u errors, max %ld ticks late\n",
+           rjobOps, rjobRuns, rjobErrors, (long)rjobMaxLate);
+    printf("pending:         max %u, %u beyond the heap\n", rjobMaxPending,
+           rjobMaxPending > LMIC_MAX_TIMED_JOBS ? rjobMaxPending - LMIC_MAX_TIMED_JOBS : 0);
+    printf("scheduler:       %llu iterations, %.0f ns/iteration\n",
+           (unsigned long long)iterations, (double)cpu / iterations);
+    printf("result:          %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+int main (int argc, char** argv)
+{
+    bool abp = false;
+    bool rx2 = false;
+    int sf = 7;
+    int opt;
+    while ((opt = getopt(argc, argv, "acd2n:l:s:r:")) != -1) {
+        switch (opt) {
+        case 'a':
+            abp = true;
+            break;
+        case 'c':
+            confirmed = true;
+            break;
+        case 'd':
+            downlinks = true;
+            break;
+        case '2':
+            rx2 = true;
+            break;
+        case 'n':
+            framesToSend = atoi(optarg);
+            break;
+        case 'l':
+            loadCount = atoi(optarg);
+            break;
+        case 's':
+            sf = atoi(optarg);
+            break;
+        case 'r':
+            rjobCount = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-a] [-c] [-d] [-2] [-n frames] [-l jobs] [-s sf] [-r jobs]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (sf < 7 || sf > 12) {
+        fprintf(stderr, "spreading factor must be 7 - 12\n");
+        return 1;
+    }
+
+    SimChannel channel;
+    SimSX127x radio(&channel);
+    SimNetwork net(&channel, APPKEY);
+    net.useRx2 = rx2;
+    network = &net;
+    hal_host_attach(&radio, &channel);
+
+    os_init();
+    if (rjobCount)
+        return random_test();
+    LMIC_reset();
+    LMIC_setClockError(MAX_CLOCK_ERROR * 1 / 100);
+
+    if (abp) {
+        LMIC_setSession(0x13, DEVADDR, (xref2u1_t)NWKSKEY, (xref2u1_t)APPSKEY);
+        net.setSession(DEVADDR, NWKSKEY, APPSKEY);
+    }
+
+    // Same channel plan as the OTAA example
+    LMIC_setupChannel(0, 868100000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(1, 868300000, DR_RANGE_MAP(DR_SF12, DR_SF7B), BAND_CENTI);
+    LMIC_setupChannel(2, 868500000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(3, 867100000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(4, 867300000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(5, 867500000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(6, 867700000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(7, 867900000, DR_RANGE_MAP(DR_SF12, DR_SF7),  BAND_CENTI);
+    LMIC_setupChannel(8, 868800000, DR_RANGE_MAP(DR_FSK,  DR_FSK),  BAND_MILLI);
+    LMIC_setLinkCheckMode(0);
+    LMIC.dn2Dr = DR_SF9;
+    LMIC_setDrTxpow(DR_SF7 - (sf - 7), 14);
+
+    loadjobs = (osjob_t*)calloc(loadCount, sizeof(osjob_t));
+    for (unsigned i = 0; i < loadCount; i++)
+        os_setTimedCallback(&loadjobs[i], os_getTime() + ms2osticks(10 + i), do_load);
+
+    if (!abp)
+        LMIC_startJoining();
+    do_send(&sendjob);
+
+    uint64_t cpu = 0;
+    uint64_t iterations = 0;
+    uint64_t deadline = (uint64_t)(framesToSend + 2) * 10 * TX_INTERVAL * 1000000UL;
+    while (framesDone < framesToSend) {
+        uint64_t start = cpu_nanos();
+        os_runloop_once();
+        cpu += cpu_nanos() - start;
+        iterations++;
+
+        if (hal_host_micros() > deadline) {
+            fprintf(stderr, "timed out after %u frames\n", framesDone);
+            return 1;
+        }
+    }
+
+    // everything the simulation did inside the HAL is not LMIC's work
+    uint64_t lmicNs = cpu - hal_host_stats.simNs;
+
+    printf("mode:            %s, %s, SF%d, %s\n", abp ? "ABP" : "OTAA", confirmed ? "confirmed" : "unconfirmed",
+           sf, rx2 ? "answer in RX2" : "answer in RX1");
+    printf("virtual time:    %.3f s\n", hal_host_micros() / 1e6);
+    printf("frames:          %u sent, %u received by network, %u acked, %u downlinks (%u corrupted)\n",
+           framesDone, net.uplinks, acks, downlinkFrames, downlinkErrors);
+    printf("network:         %u joins, %u downlinks, %u MIC errors\n", net.joins, net.downlinks, net.micErrors);
+    for (int j = 1; j >= 0; j--) {
+        for (int i = 0; i < 2; i++) {
+            window_stats_t* st = &rxStats[j][i];
+            if (st->count == 0)
+                continue;
+            printf("%s RX%d offset: min %lld us, avg %lld us, max %lld us (%u windows)\n", j ? "join" : "data", i + 1,
+                   (long long)st->min, (long long)(st->sum / st->count), (long long)st->max, st->count);
+        }
+    }
+    printf("SPI:             %u transactions, %u bytes, %.1f transactions/frame\n",
+           hal_host_stats.spiTransactions, hal_host_stats.spiBytes,
+           (double)hal_host_stats.spiTransactions / framesDone);
+    printf("runloop CPU:     %.1f us/frame\n", lmicNs / 1e3 / framesDone);
+    printf("scheduler:       %u extra jobs, %llu iterations, %u load runs, %.0f ns/iteration\n",
+           loadCount, (unsigned long long)iterations, loadRuns, (double)lmicNs / iterations);
+
+    // anything the network expected but did not get is a regression
+    bool ok = (net.uplinks == framesDone) && (net.micErrors == 0) && (downlinkErrors == 0) &&
+              (!confirmed || acks == framesDone) && (!downlinks || downlinkFrames == framesDone);
+    printf("result:          %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
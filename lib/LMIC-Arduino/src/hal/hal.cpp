@@ -13,6 +13,10 @@
 #include "../lmic.h"
 #include "hal.h"
 #include <stdio.h>
+#if defined(ESP32) && defined(LMIC_LIGHT_SLEEP)
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#endif
 
 // -----------------------------------------------------------------------------
 // I/O
@@ -109,6 +113,23 @@ u1_t hal_spi (u1_t out)
     return res;
 }
 
+// perform SPI transaction with radio for a whole buffer
+void hal_spi_burst (u1_t* buf, u1_t len, u1_t write)
+{
+    if (write) {
+#if defined(ESP32)
+        SPI.writeBytes(buf, len);
+#else
+        // transfer(buf, len) would overwrite the buffer
+        for (u1_t i = 0; i < len; i++)
+            SPI.transfer(buf[i]);
+#endif
+    } else {
+        memset(buf, 0x00, len);
+        SPI.transfer(buf, len);
+    }
+}
+
 // -----------------------------------------------------------------------------
 // TIME
 
@@ -183,11 +204,22 @@ void hal_waitUntil (u4_t time)
         delayMicroseconds(delta * US_PER_OSTICK);
 }
 
+// Deadline set by hal_checkTimer for the next hal_sleep
+static bool timer_armed = false;
+static u4_t timer_target;
+
 // check and rewind for target time
 u1_t hal_checkTimer (u4_t time)
 {
-    // No need to schedule wakeup, since we're not sleeping
-    return delta_time(time) <= 0;
+    if (delta_time(time) <= 0) {
+        timer_armed = false;
+        return 1;
+    }
+
+    // Remember the deadline, hal_sleep() will wake up in time for it
+    timer_target = time;
+    timer_armed = true;
+    return 0;
 }
 
 static uint8_t irqlevel = 0;
@@ -215,9 +247,51 @@ void hal_enableIRQs ()
     }
 }
 
+#if defined(ESP32) && defined(LMIC_LIGHT_SLEEP)
+// Light sleep wakeup takes up to a few hundred μs, so don't bother for
+// short waits and wake up a bit early for longer ones.
+#define SLEEP_MIN_TICKS ms2osticks(5)
+#define SLEEP_MARGIN_TICKS ms2osticks(1)
+
+static void hal_light_sleep (s4_t ticks)
+{
+    uint8_t i;
+    // DIO changes are polled in hal_enableIRQs, so don't sleep while
+    // one is pending and wake up on the next one
+    for (i = 0; i < NUM_DIO; ++i) {
+        if (lmic_pins.dio[i] == LMIC_UNUSED_PIN)
+            continue;
+        if (dio_states[i] != digitalRead(lmic_pins.dio[i]))
+            return;
+        gpio_wakeup_enable((gpio_num_t)lmic_pins.dio[i], dio_states[i] ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup(osticks2us(ticks));
+
+    esp_light_sleep_start();
+
+    for (i = 0; i < NUM_DIO; ++i) {
+        if (lmic_pins.dio[i] != LMIC_UNUSED_PIN)
+            gpio_wakeup_disable((gpio_num_t)lmic_pins.dio[i]);
+    }
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+}
+#endif
+
 void hal_sleep ()
 {
-    // Not implemented
+    // Only sleep until the deadline armed by hal_checkTimer, without one
+    // return straight away so the caller's loop() keeps running
+    if (!timer_armed)
+        return;
+    timer_armed = false;
+
+#if defined(ESP32) && defined(LMIC_LIGHT_SLEEP)
+    s4_t delta = delta_time(timer_target);
+    if (delta > SLEEP_MIN_TICKS)
+        hal_light_sleep(delta - SLEEP_MARGIN_TICKS);
+#endif
 }
 
 // -----------------------------------------------------------------------------
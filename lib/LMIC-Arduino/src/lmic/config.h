@@ -20,6 +20,21 @@
 #define US_PER_OSTICK (1 << US_PER_OSTICK_EXPONENT)
 #define OSTICKS_PER_SEC (1000000 / US_PER_OSTICK)
 
+// Number of timed jobs (os_setTimedCallback) kept in the fast
+// scheduler heap. LMIC itself needs one, the rest is left for the
+// application. Jobs beyond this limit are still run on time, but are
+// kept in a sorted list that is walked on every insert, and move into
+// the heap as slots free up. Must not exceed 255.
+#ifndef LMIC_MAX_TIMED_JOBS
+#define LMIC_MAX_TIMED_JOBS 16
+#endif
+
+// Uncomment this to let the Arduino HAL put an ESP32 in light sleep
+// while os_runloop_once() waits for the next timed job. The radio DIO
+// pins are used as wakeup sources, so incoming radio interrupts still
+// wake it up. Note that this also stops the rest of loop() until then.
+//#define LMIC_LIGHT_SLEEP
+
 // Set this to 1 to enable some basic debug output (using printf) about
 // RF settings used during transmission and reception. Set to 2 to
 // enable more verbose output. Make sure that printf is actually
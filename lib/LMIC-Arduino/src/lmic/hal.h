@@ -43,6 +43,13 @@ void hal_pin_rst (u1_t val);
  */
 u1_t hal_spi (u1_t outval);
 
+/*
+ * perform SPI transaction with radio for a whole buffer.
+ *   - if 'write' is set, write 'len' bytes from 'buf'
+ *   - otherwise write 0x00 and store 'len' read bytes in 'buf'
+ */
+void hal_spi_burst (u1_t* buf, u1_t len, u1_t write);
+
 /*
  * disable all CPU interrupts.
  *   - might be invoked nested
@@ -57,6 +64,7 @@ void hal_enableIRQs (void);
 
 /*
  * put system and CPU in low-power mode, sleep until interrupt.
+ *   - the wakeup time is the one last set by hal_checkTimer(), if any
  */
 void hal_sleep (void);
 
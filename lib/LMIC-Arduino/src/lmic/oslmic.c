@@ -14,7 +14,9 @@
 
 // RUNTIME STATE
 static struct {
-    osjob_t *scheduledjobs;
+    osjob_t *scheduledjobs[LMIC_MAX_TIMED_JOBS]; // binary min-heap on deadline
+    u1_t nscheduled;
+    osjob_t *overflowjobs; // sorted list of timed jobs that did not fit in the heap
     osjob_t *runnablejobs;
 } OS;
 
@@ -31,6 +33,85 @@ ostime_t os_getTime ()
     return hal_ticks();
 }
 
+// true if job a is due before job b
+static bit_t jobbefore (osjob_t *a, osjob_t *b)
+{
+    return (s4_t)(a->deadline - b->deadline) < 0; // (cmp diff, not abs!)
+}
+
+static void heapset (u1_t idx, osjob_t *job)
+{
+    OS.scheduledjobs[idx] = job;
+    job->heapidx = idx + 1;
+}
+
+static void heapup (u1_t idx)
+{
+    osjob_t *job = OS.scheduledjobs[idx];
+    while (idx > 0) {
+        u1_t parent = (idx - 1) / 2;
+        if (!jobbefore(job, OS.scheduledjobs[parent]))
+            break;
+        heapset(idx, OS.scheduledjobs[parent]);
+        idx = parent;
+    }
+    heapset(idx, job);
+}
+
+static void heapdown (u1_t idx)
+{
+    osjob_t *job = OS.scheduledjobs[idx];
+    while (1) {
+        uint child = 2 * (uint)idx + 1;
+        if (child >= OS.nscheduled)
+            break;
+        if (child + 1 < OS.nscheduled && jobbefore(OS.scheduledjobs[child + 1], OS.scheduledjobs[child]))
+            child++;
+        if (!jobbefore(OS.scheduledjobs[child], job))
+            break;
+        heapset(idx, OS.scheduledjobs[child]);
+        idx = child;
+    }
+    heapset(idx, job);
+}
+
+static void heapinsert (osjob_t *job)
+{
+    heapset(OS.nscheduled++, job);
+    heapup(OS.nscheduled - 1);
+}
+
+static void heapremove (u1_t idx)
+{
+    osjob_t *job = OS.scheduledjobs[idx];
+    osjob_t *last = OS.scheduledjobs[--OS.nscheduled];
+    if (idx < OS.nscheduled) {
+        // move last job into the hole and restore heap order in whichever direction is needed
+        heapset(idx, last);
+        heapdown(idx);
+        heapup(last->heapidx - 1);
+    }
+    job->heapidx = 0;
+    // a slot is free again, the earliest job of the overflow list takes it
+    if (OS.overflowjobs) {
+        osjob_t *next = OS.overflowjobs;
+        OS.overflowjobs = next->next;
+        next->next = NULL;
+        heapinsert(next);
+    }
+}
+
+static u1_t unschedulejob (osjob_t *job)
+{
+    // heapidx is only trusted if it points back to the job, so jobs that
+    // were never scheduled need not be initialized
+    u1_t idx = job->heapidx;
+    if (idx == 0 || idx > OS.nscheduled || OS.scheduledjobs[idx - 1] != job)
+        return 0;
+    heapremove(idx - 1);
+    return 1;
+}
+
 static u1_t unlinkjob (osjob_t **pnext, osjob_t *job)
 {
     for ( ; *pnext; pnext = &((*pnext)->next)) {
@@ -42,11 +123,19 @@ static u1_t unlinkjob (osjob_t **pnext, osjob_t *job)
     return 0;
 }
 
+// earliest timed job, either the top of the heap or the head of the overflow list
+static osjob_t* nexttimedjob ()
+{
+    if (OS.nscheduled && (!OS.overflowjobs || !jobbefore(OS.overflowjobs, OS.scheduledjobs[0])))
+        return OS.scheduledjobs[0];
+    return OS.overflowjobs;
+}
+
 // clear scheduled job
 void os_clearCallback (osjob_t *job)
 {
     hal_disableIRQs();
-    u1_t res = unlinkjob(&OS.scheduledjobs, job) || unlinkjob(&OS.runnablejobs, job);
+    u1_t res = unschedulejob(job) || unlinkjob(&OS.overflowjobs, job) || unlinkjob(&OS.runnablejobs, job);
     hal_enableIRQs();
 #if LMIC_DEBUG_LEVEL > 1
     if (res)
@@ -76,7 +165,6 @@ void os_setCallback (osjob_t *job, osjobcb_t cb)
 // schedule timed job
 void os_setTimedCallback (osjob_t *job, ostime_t time, osjobcb_t cb)
 {
-    osjob_t **pnext;
     hal_disableIRQs();
     // remove if job was already queued
     os_clearCallback(job);
@@ -84,15 +172,20 @@ void os_setTimedCallback (osjob_t *job, ostime_t time, osjobcb_t cb)
     job->deadline = time;
     job->func = cb;
     job->next = NULL;
-    // insert into schedule
-    for (pnext = &OS.scheduledjobs; *pnext; pnext = &((*pnext)->next)) {
-        if ((*pnext)->deadline - time > 0) { // (cmp diff, not abs!)
-            // enqueue before next element and stop
-            job->next = *pnext;
-            break;
+    if (OS.nscheduled < LMIC_MAX_TIMED_JOBS) {
+        // insert into schedule
+        heapinsert(job);
+    } else {
+        // heap is full, fall back to a sorted list (slower, but never drops a job)
+        osjob_t **pnext;
+        job->heapidx = 0;
+        for (pnext = &OS.overflowjobs; *pnext; pnext = &((*pnext)->next)) {
+            if (jobbefore(job, *pnext))
+                break;
         }
+        job->next = *pnext;
+        *pnext = job;
     }
-    *pnext = job;
     hal_enableIRQs();
 #if LMIC_DEBUG_LEVEL > 1
     lmic_printf("%lu: Scheduled job %p, cb %p at %lu\n", os_getTime(), job, cb, time);
@@ -118,14 +211,17 @@ void os_runloop_once()
     if (OS.runnablejobs) {
         j = OS.runnablejobs;
         OS.runnablejobs = j->next;
-    } else if (OS.scheduledjobs && hal_checkTimer(OS.scheduledjobs->deadline)) { // check for expired timed jobs
-        j = OS.scheduledjobs;
-        OS.scheduledjobs = j->next;
+    } else if ((j = nexttimedjob()) && hal_checkTimer(j->deadline)) { // check for expired timed jobs
+        if (j->heapidx)
+            heapremove(j->heapidx - 1);
+        else
+            OS.overflowjobs = j->next;
 #if LMIC_DEBUG_LEVEL > 1
         has_deadline = true;
 #endif
     } else { // nothing pending
-        hal_sleep(); // wake by irq (timer already restarted)
+        j = NULL;
+        hal_sleep(); // wake by irq (timer already restarted for the earliest deadline, if any)
     }
     hal_enableIRQs();
     if (j) { // run job callback
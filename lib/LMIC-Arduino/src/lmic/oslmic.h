@@ -125,6 +125,7 @@ struct osjob_t {
     struct osjob_t* next;
     ostime_t deadline;
     osjobcb_t  func;
+    u1_t heapidx; // position in the timer heap + 1, 0 if not scheduled
 };
 TYPEDEF_xref2osjob_t;
 
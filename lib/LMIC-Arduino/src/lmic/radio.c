@@ -226,7 +226,7 @@
 #define MAP_DIO0_LORA_TXDONE   0x40  // 01------
 #define MAP_DIO1_LORA_RXTOUT   0x00  // --00----
 #define MAP_DIO1_LORA_NOP      0x30  // --11----
-#define MAP_DIO2_LORA_NOP      0xC0  // ----11--
+#define MAP_DIO2_LORA_NOP      0x0C  // ----11--
 
 #define MAP_DIO0_FSK_READY     0x00  // 00------ (packet sent / payload ready)
 #define MAP_DIO1_FSK_NOP       0x30  // --11----
@@ -278,21 +278,73 @@ static u1_t readReg (u1_t addr) {
 static void writeBuf (u1_t addr, xref2u1_t buf, u1_t len) {
     hal_pin_nss(0);
     hal_spi(addr | 0x80);
-    for (u1_t i=0; i<len; i++) {
-        hal_spi(buf[i]);
-    }
+    hal_spi_burst(buf, len, 1);
     hal_pin_nss(1);
 }
 
 static void readBuf (u1_t addr, xref2u1_t buf, u1_t len) {
     hal_pin_nss(0);
     hal_spi(addr & 0x7F);
-    for (u1_t i=0; i<len; i++) {
-        buf[i] = hal_spi(0x00);
-    }
+    hal_spi_burst(buf, len, 0);
     hal_pin_nss(1);
 }
 
+// Shadow of the configuration registers, which keep their value in
+// sleep mode. They are only written when the value changes, so that
+// switching between TX, RX1 and RX2 costs as few SPI transfers as
+// possible. The shadow is dropped on reset and whenever the FSK modem
+// is used, since that shares register addresses with LoRa.
+enum { SHADOW_FRF_MSB, SHADOW_FRF_MID, SHADOW_FRF_LSB,
+       SHADOW_PA_CONFIG, SHADOW_PA_RAMP, SHADOW_PA_DAC, SHADOW_LNA,
+       SHADOW_MC1, SHADOW_MC2, SHADOW_MC3,
+       SHADOW_PAYLOAD_MAX_LENGTH, SHADOW_SYMB_TIMEOUT, SHADOW_INVERT_IQ,
+       SHADOW_SYNC_WORD, SHADOW_DIO_MAPPING1, SHADOW_IRQ_FLAGS_MASK,
+       NUM_SHADOW };
+
+static CONST_TABLE(u1_t, shadowaddr)[] = {
+    [SHADOW_FRF_MSB]            = RegFrfMsb,
+    [SHADOW_FRF_MID]            = RegFrfMid,
+    [SHADOW_FRF_LSB]            = RegFrfLsb,
+    [SHADOW_PA_CONFIG]          = RegPaConfig,
+    [SHADOW_PA_RAMP]            = RegPaRamp,
+    [SHADOW_PA_DAC]             = RegPaDac,
+    [SHADOW_LNA]                = RegLna,
+    [SHADOW_MC1]                = LORARegModemConfig1,
+    [SHADOW_MC2]                = LORARegModemConfig2,
+    [SHADOW_MC3]                = LORARegModemConfig3,
+    [SHADOW_PAYLOAD_MAX_LENGTH] = LORARegPayloadMaxLength,
+    [SHADOW_SYMB_TIMEOUT]       = LORARegSymbTimeoutLsb,
+    [SHADOW_INVERT_IQ]          = LORARegInvertIQ,
+    [SHADOW_SYNC_WORD]          = LORARegSyncWord,
+    [SHADOW_DIO_MAPPING1]       = RegDioMapping1,
+    [SHADOW_IRQ_FLAGS_MASK]     = LORARegIrqFlagsMask,
+};
+
+static struct {
+    u1_t val[NUM_SHADOW];
+    u2_t valid; // bit per entry
+} shadow;
+
+static void invalidateShadow () {
+    shadow.valid = 0;
+}
+
+static void writeRegShadow (u1_t idx, u1_t data) {
+    if ((shadow.valid & (1 << idx)) && shadow.val[idx] == data)
+        return;
+    writeReg(TABLE_GET_U1(shadowaddr, idx), data);
+    shadow.val[idx] = data;
+    shadow.valid |= (1 << idx);
+}
+
+static u1_t readRegShadow (u1_t idx) {
+    if ((shadow.valid & (1 << idx)) == 0) {
+        shadow.val[idx] = readReg(TABLE_GET_U1(shadowaddr, idx));
+        shadow.valid |= (1 << idx);
+    }
+    return shadow.val[idx];
+}
+
 static void opmode (u1_t mode) {
     writeReg(RegOpMode, (readReg(RegOpMode) & ~OPMODE_MASK) | mode);
 }
@@ -306,6 +358,7 @@ static void opmodeLora() {
 }
 
 static void opmodeFSK() {
+    invalidateShadow();
     u1_t u = 0;
 #ifdef CFG_sx1276_radio
     u |= 0x8;   // TBD: sx1276 high freq
@@ -341,19 +394,19 @@ static void configLoraModem () {
             writeReg(LORARegPayloadLength, getIh(LMIC.rps)); // required length
         }
         // set ModemConfig1
-        writeReg(LORARegModemConfig1, mc1);
+        writeRegShadow(SHADOW_MC1, mc1);
 
         mc2 = (SX1272_MC2_SF7 + ((sf-1)<<4));
         if (getNocrc(LMIC.rps) == 0) {
             mc2 |= SX1276_MC2_RX_PAYLOAD_CRCON;
         }
-        writeReg(LORARegModemConfig2, mc2);
+        writeRegShadow(SHADOW_MC2, mc2);
 
         mc3 = SX1276_MC3_AGCAUTO;
         if ((sf == SF11 || sf == SF12) && getBw(LMIC.rps) == BW125) {
             mc3 |= SX1276_MC3_LOW_DATA_RATE_OPTIMIZE;
         }
-        writeReg(LORARegModemConfig3, mc3);
+        writeRegShadow(SHADOW_MC3, mc3);
 #elif CFG_sx1272_radio
         u1_t mc1 = (getBw(LMIC.rps)<<6);
 
@@ -377,10 +430,10 @@ static void configLoraModem () {
             writeReg(LORARegPayloadLength, getIh(LMIC.rps)); // required length
         }
         // set ModemConfig1
-        writeReg(LORARegModemConfig1, mc1);
+        writeRegShadow(SHADOW_MC1, mc1);
 
         // set ModemConfig2 (sf, AgcAutoOn=1 SymbTimeoutHi=00)
-        writeReg(LORARegModemConfig2, (SX1272_MC2_SF7 + ((sf-1)<<4)) | 0x04);
+        writeRegShadow(SHADOW_MC2, (SX1272_MC2_SF7 + ((sf-1)<<4)) | 0x04);
 #else
 #error Missing CFG_sx1272_radio/CFG_sx1276_radio
 #endif /* CFG_sx1272_radio */
@@ -389,9 +442,9 @@ static void configLoraModem () {
 static void configChannel () {
     // set frequency: FQ = (FRF * 32 Mhz) / (2 ^ 19)
     uint64_t frf = ((uint64_t)LMIC.freq << 19) / 32000000;
-    writeReg(RegFrfMsb, (u1_t)(frf>>16));
-    writeReg(RegFrfMid, (u1_t)(frf>> 8));
-    writeReg(RegFrfLsb, (u1_t)(frf>> 0));
+    writeRegShadow(SHADOW_FRF_MSB, (u1_t)(frf>>16));
+    writeRegShadow(SHADOW_FRF_MID, (u1_t)(frf>> 8));
+    writeRegShadow(SHADOW_FRF_LSB, (u1_t)(frf>> 0));
 }
 
 
@@ -406,8 +459,8 @@ static void configPower () {
         pw = 2;
     }
     // check board type for BOOST pin
-    writeReg(RegPaConfig, (u1_t)(0x80|(pw&0xf)));
-    writeReg(RegPaDac, readReg(RegPaDac)|0x4);
+    writeRegShadow(SHADOW_PA_CONFIG, (u1_t)(0x80|(pw&0xf)));
+    writeRegShadow(SHADOW_PA_DAC, readRegShadow(SHADOW_PA_DAC)|0x4);
 
 #elif CFG_sx1272_radio
     // set PA config (2-17 dBm using PA_BOOST)
@@ -417,13 +470,14 @@ static void configPower () {
     } else if(pw < 2) {
         pw = 2;
     }
-    writeReg(RegPaConfig, (u1_t)(0x80|(pw-2)));
+    writeRegShadow(SHADOW_PA_CONFIG, (u1_t)(0x80|(pw-2)));
 #else
 #error Missing CFG_sx1272_radio/CFG_sx1276_radio
 #endif /* CFG_sx1272_radio */
 }
 
 static void txfsk () {
+    invalidateShadow();
     // select FSK modem (from sleep mode)
     writeReg(RegOpMode, 0x10); // FSK, BT=0.5
     ASSERT(readReg(RegOpMode) == 0x10);
@@ -479,17 +533,17 @@ static void txlora () {
     // configure frequency
     configChannel();
     // configure output power
-    writeReg(RegPaRamp, (readReg(RegPaRamp) & 0xF0) | 0x08); // set PA ramp-up time 50 uSec
+    writeRegShadow(SHADOW_PA_RAMP, (readRegShadow(SHADOW_PA_RAMP) & 0xF0) | 0x08); // set PA ramp-up time 50 uSec
     configPower();
     // set sync word
-    writeReg(LORARegSyncWord, LORA_MAC_PREAMBLE);
+    writeRegShadow(SHADOW_SYNC_WORD, LORA_MAC_PREAMBLE);
 
     // set the IRQ mapping DIO0=TxDone DIO1=NOP DIO2=NOP
-    writeReg(RegDioMapping1, MAP_DIO0_LORA_TXDONE|MAP_DIO1_LORA_NOP|MAP_DIO2_LORA_NOP);
+    writeRegShadow(SHADOW_DIO_MAPPING1, MAP_DIO0_LORA_TXDONE|MAP_DIO1_LORA_NOP|MAP_DIO2_LORA_NOP);
     // clear all radio IRQ flags
     writeReg(LORARegIrqFlags, 0xFF);
     // mask all IRQs but TxDone
-    writeReg(LORARegIrqFlagsMask, ~IRQ_LORA_TXDONE_MASK);
+    writeRegShadow(SHADOW_IRQ_FLAGS_MASK, ~IRQ_LORA_TXDONE_MASK);
 
     // initialize the payload size and address pointers
     writeReg(LORARegFifoTxBaseAddr, 0x00);
@@ -547,8 +601,8 @@ static void rxlora (u1_t rxmode) {
     opmode(OPMODE_STANDBY);
     // don't use MAC settings at startup
     if(rxmode == RXMODE_RSSI) { // use fixed settings for rssi scan
-        writeReg(LORARegModemConfig1, RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG1);
-        writeReg(LORARegModemConfig2, RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG2);
+        writeRegShadow(SHADOW_MC1, RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG1);
+        writeRegShadow(SHADOW_MC2, RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG2);
     } else { // single or continuous rx mode
         // configure LoRa modem (cfg1, cfg2)
         configLoraModem();
@@ -556,24 +610,24 @@ static void rxlora (u1_t rxmode) {
         configChannel();
     }
     // set LNA gain
-    writeReg(RegLna, LNA_RX_GAIN);
+    writeRegShadow(SHADOW_LNA, LNA_RX_GAIN);
     // set max payload size
-    writeReg(LORARegPayloadMaxLength, 64);
+    writeRegShadow(SHADOW_PAYLOAD_MAX_LENGTH, 64);
 #if !defined(DISABLE_INVERT_IQ_ON_RX)
     // use inverted I/Q signal (prevent mote-to-mote communication)
-    writeReg(LORARegInvertIQ, readReg(LORARegInvertIQ)|(1<<6));
+    writeRegShadow(SHADOW_INVERT_IQ, readRegShadow(SHADOW_INVERT_IQ)|(1<<6));
 #endif
     // set symbol timeout (for single rx)
-    writeReg(LORARegSymbTimeoutLsb, LMIC.rxsyms);
+    writeRegShadow(SHADOW_SYMB_TIMEOUT, LMIC.rxsyms);
     // set sync word
-    writeReg(LORARegSyncWord, LORA_MAC_PREAMBLE);
+    writeRegShadow(SHADOW_SYNC_WORD, LORA_MAC_PREAMBLE);
 
     // configure DIO mapping DIO0=RxDone DIO1=RxTout DIO2=NOP
-    writeReg(RegDioMapping1, MAP_DIO0_LORA_RXDONE|MAP_DIO1_LORA_RXTOUT|MAP_DIO2_LORA_NOP);
+    writeRegShadow(SHADOW_DIO_MAPPING1, MAP_DIO0_LORA_RXDONE|MAP_DIO1_LORA_RXTOUT|MAP_DIO2_LORA_NOP);
     // clear all radio IRQ flags
     writeReg(LORARegIrqFlags, 0xFF);
     // enable required radio IRQs
-    writeReg(LORARegIrqFlagsMask, ~TABLE_GET_U1(rxlorairqmask, rxmode));
+    writeRegShadow(SHADOW_IRQ_FLAGS_MASK, ~TABLE_GET_U1(rxlorairqmask, rxmode));
 
     // enable antenna switch for RX
     hal_pin_rxtx(0);
@@ -680,6 +734,7 @@ void radio_init () {
     hal_waitUntil(os_getTime()+ms2osticks(1)); // wait >100us
     hal_pin_rst(2); // configure RST pin floating!
     hal_waitUntil(os_getTime()+ms2osticks(5)); // wait 5ms
+    invalidateShadow();
 
     opmode(OPMODE_SLEEP);
 
@@ -721,6 +776,7 @@ void radio_init () {
     // Launch Rx chain calibration for HF band
     writeReg(FSKRegImageCal, (readReg(FSKRegImageCal) & RF_IMAGECAL_IMAGECAL_MASK)|RF_IMAGECAL_IMAGECAL_START);
     while((readReg(FSKRegImageCal) & RF_IMAGECAL_IMAGECAL_RUNNING) == RF_IMAGECAL_IMAGECAL_RUNNING) { ; }
+    invalidateShadow();
 #endif /* CFG_sx1276mb1_board */
 
     opmode(OPMODE_SLEEP);
@@ -792,7 +848,7 @@ void radio_irq_handler (u1_t dio) {
             LMIC.dataLen = 0;
         }
         // mask all radio IRQs
-        writeReg(LORARegIrqFlagsMask, 0xFF);
+        writeRegShadow(SHADOW_IRQ_FLAGS_MASK, 0xFF);
         // clear radio IRQ flags
         writeReg(LORARegIrqFlags, 0xFF);
     } else { // FSK modem
@@ -55,7 +55,17 @@
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
 #define IRQ_RX_DONE_MASK           0x40
 
-#define MAX_PKT_LENGTH           255
+#define MAX_PKT_LENGTH           LORA_MAX_PKT_LENGTH
+
+// the receive queue is filled from the DIO0 interrupt, which on ESP32 may run on the other core,
+// so the indexes are published with release/acquire ordering rather than plain volatile accesses
+#if defined(__GNUC__)
+    #define QUEUE_LOAD(idx)        __atomic_load_n(&(idx), __ATOMIC_ACQUIRE)
+    #define QUEUE_STORE(idx, val)  __atomic_store_n(&(idx), (val), __ATOMIC_RELEASE)
+#else
+    #define QUEUE_LOAD(idx)        (idx)
+    #define QUEUE_STORE(idx, val)  ((idx) = (val))
+#endif
 
 #if (ESP8266 || ESP32)
     #define ISR_PREFIX ICACHE_RAM_ATTR
@@ -70,7 +80,18 @@ LoRaClass::LoRaClass() :
   _frequency(0),
   _packetIndex(0),
   _implicitHeaderMode(0),
-  _onReceive(NULL)
+  _onReceive(NULL),
+  _captureMode(false),
+  _captured(false),
+  _capturedLength(0),
+  _capturedSnr(0),
+  _capturedRssi(0),
+  _queue(NULL),
+  _queueSlots(0),
+  _queueHead(0),
+  _queueTail(0),
+  _queueDropped(0),
+  _fifoRxNext(0)
 {
   // overide Stream timeout value
   setTimeout(0);
@@ -214,6 +235,9 @@ int LoRaClass::parsePacket(int size)
   int packetLength = 0;
   int irqFlags = readRegister(REG_IRQ_FLAGS);
 
+  // any previously captured packet is superseded
+  _captured = false;
+
   if (size > 0) {
     implicitHeaderMode();
 
@@ -256,12 +280,16 @@ int LoRaClass::parsePacket(int size)
 
 int LoRaClass::packetRssi()
 {
-  return (readRegister(REG_PKT_RSSI_VALUE) - (_frequency < 868E6 ? 164 : 157));
+  uint8_t rssi = _captured ? _capturedRssi : readRegister(REG_PKT_RSSI_VALUE);
+
+  return (rssi - (_frequency < 868E6 ? 164 : 157));
 }
 
 float LoRaClass::packetSnr()
 {
-  return ((int8_t)readRegister(REG_PKT_SNR_VALUE)) * 0.25;
+  uint8_t snr = _captured ? _capturedSnr : readRegister(REG_PKT_SNR_VALUE);
+
+  return ((int8_t)snr) * 0.25;
 }
 
 long LoRaClass::packetFrequencyError()
@@ -298,9 +326,7 @@ size_t LoRaClass::write(const uint8_t *buffer, size_t size)
   }
 
   // write data
-  for (size_t i = 0; i < size; i++) {
-    writeRegister(REG_FIFO, buffer[i]);
-  }
+  writeBurst(REG_FIFO, buffer, size);
 
   // update length
   writeRegister(REG_PAYLOAD_LENGTH, currentLength + size);
@@ -310,6 +336,10 @@ size_t LoRaClass::write(const uint8_t *buffer, size_t size)
 
 int LoRaClass::available()
 {
+  if (_captured) {
+    return (_capturedLength - _packetIndex);
+  }
+
   return (readRegister(REG_RX_NB_BYTES) - _packetIndex);
 }
 
@@ -319,17 +349,48 @@ int LoRaClass::read()
     return -1;
   }
 
+  if (_captured) {
+    return _captureBuffer[_packetIndex++];
+  }
+
   _packetIndex++;
 
   return readRegister(REG_FIFO);
 }
 
+size_t LoRaClass::readBytes(uint8_t *buffer, size_t length)
+{
+  int avail = available();
+
+  if (avail <= 0) {
+    return 0;
+  }
+
+  if (length > (size_t)avail) {
+    length = avail;
+  }
+
+  if (_captured) {
+    memcpy(buffer, &_captureBuffer[_packetIndex], length);
+  } else {
+    readBurst(REG_FIFO, buffer, length);
+  }
+
+  _packetIndex += length;
+
+  return length;
+}
+
 int LoRaClass::peek()
 {
   if (!available()) {
     return -1;
   }
 
+  if (_captured) {
+    return _captureBuffer[_packetIndex];
+  }
+
   // store current FIFO address
   int currentAddress = readRegister(REG_FIFO_ADDR_PTR);
 
@@ -379,6 +440,107 @@ void LoRaClass::receive(int size)
 
   writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_CONTINUOUS);
 }
+
+void LoRaClass::enablePacketCapture()
+{
+  _captureMode = true;
+}
+
+void LoRaClass::disablePacketCapture()
+{
+  _captureMode = false;
+  _captured = false;
+}
+
+void LoRaClass::receiveContinuous(LoRaPacket *slots, int count, int size)
+{
+  // stop the ISR from filling the old queue
+  _queue = NULL;
+
+  if (!slots || count < 2) {
+    idle();
+
+    if (!_onReceive) {
+      detachInterrupt(digitalPinToInterrupt(_dio0));
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+      SPI.notUsingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+    }
+    return;
+  }
+
+  _queueSlots = count;
+  _queueHead = 0;
+  _queueTail = 0;
+  _queueDropped = 0;
+  _queue = slots;
+
+  // put in standby mode, so that the FIFO can be reset
+  idle();
+
+  if (size > 0) {
+    implicitHeaderMode();
+
+    writeRegister(REG_PAYLOAD_LENGTH, size & 0xff);
+  } else {
+    explicitHeaderMode();
+  }
+
+  // the radio writes packets back to back from the RX base address,
+  // wrapping around the 256 byte FIFO, and it is never reset in between
+  writeRegister(REG_FIFO_RX_BASE_ADDR, 0);
+  writeRegister(REG_FIFO_ADDR_PTR, 0);
+  _fifoRxNext = 0;
+
+  // clear stale IRQ's, a pending RX done would otherwise hold DIO0 high
+  writeRegister(REG_IRQ_FLAGS, 0xff);
+
+  pinMode(_dio0, INPUT);
+
+  writeRegister(REG_DIO_MAPPING_1, 0x00);
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+  SPI.usingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+  attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
+
+  writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_RX_CONTINUOUS);
+}
+
+int LoRaClass::queuedPackets()
+{
+  int queued = QUEUE_LOAD(_queueHead) - _queueTail;
+
+  if (queued < 0) {
+    queued += _queueSlots;
+  }
+
+  return queued;
+}
+
+LoRaPacket* LoRaClass::peekPacket()
+{
+  if (!_queue || (QUEUE_LOAD(_queueHead) == _queueTail)) {
+    return NULL;
+  }
+
+  return &_queue[_queueTail];
+}
+
+void LoRaClass::popPacket()
+{
+  if (!_queue || (QUEUE_LOAD(_queueHead) == _queueTail)) {
+    return;
+  }
+
+  // the slot is handed back to the ISR only after the caller is done reading it
+  int tail = _queueTail + 1;
+  QUEUE_STORE(_queueTail, (tail == _queueSlots) ? 0 : tail);
+}
+
+unsigned long LoRaClass::droppedPackets()
+{
+  return _queueDropped;
+}
 #endif
 
 void LoRaClass::idle()
@@ -634,6 +796,11 @@ void LoRaClass::implicitHeaderMode()
 
 void LoRaClass::handleDio0Rise()
 {
+  if (_queue) {
+    handleQueuedRx();
+    return;
+  }
+
   int irqFlags = readRegister(REG_IRQ_FLAGS);
 
   // clear IRQ's
@@ -649,12 +816,83 @@ void LoRaClass::handleDio0Rise()
     // set FIFO address to current RX address
     writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
 
+    _captured = false;
+    if (_captureMode) {
+      // drain the FIFO now, so the callback does not need the SPI bus
+      readBurst(REG_FIFO, _captureBuffer, packetLength);
+
+      // SNR and RSSI are adjacent registers, read both at once
+      uint8_t snrRssi[2];
+      readBurst(REG_PKT_SNR_VALUE, snrRssi, sizeof(snrRssi));
+      _capturedSnr = snrRssi[0];
+      _capturedRssi = snrRssi[1];
+
+      _capturedLength = packetLength;
+      _captured = true;
+    }
+
     if (_onReceive) {
       _onReceive(packetLength);
     }
   }
 }
 
+void LoRaClass::handleQueuedRx()
+{
+  unsigned long timestamp = micros();
+
+  int irqFlags = readRegister(REG_IRQ_FLAGS);
+
+  // clear IRQ's, the modem stays in continuous RX
+  writeRegister(REG_IRQ_FLAGS, irqFlags);
+
+  if ((irqFlags & IRQ_RX_DONE_MASK) == 0) {
+    return;
+  }
+
+  uint8_t currentAddr = readRegister(REG_FIFO_RX_CURRENT_ADDR);
+  uint8_t packetLength = _implicitHeaderMode ? readRegister(REG_PAYLOAD_LENGTH) : readRegister(REG_RX_NB_BYTES);
+
+  // the packet should start where the previous one ended,
+  // otherwise the radio received more than one packet since the last interrupt
+  if (currentAddr != _fifoRxNext) {
+    _queueDropped++;
+  }
+  _fifoRxNext = currentAddr + packetLength;
+
+  if (irqFlags & IRQ_PAYLOAD_CRC_ERROR_MASK) {
+    return;
+  }
+
+  // one slot is always left empty, so the packet returned by peekPacket() is never overwritten
+  int head = _queueHead + 1;
+  if (head == _queueSlots) {
+    head = 0;
+  }
+
+  if (head == QUEUE_LOAD(_queueTail)) {
+    _queueDropped++;
+    return;
+  }
+
+  LoRaPacket* packet = &_queue[_queueHead];
+
+  // the FIFO pointer wraps around at 256, so a packet spanning the end of the FIFO is read in one go
+  writeRegister(REG_FIFO_ADDR_PTR, currentAddr);
+  readBurst(REG_FIFO, packet->data, packetLength);
+
+  uint8_t snrRssi[2];
+  readBurst(REG_PKT_SNR_VALUE, snrRssi, sizeof(snrRssi));
+
+  packet->timestamp = timestamp;
+  packet->length = packetLength;
+  packet->snr = (int8_t)snrRssi[0];
+  packet->rssi = snrRssi[1] - (_frequency < 868E6 ? 164 : 157);
+
+  // publish the slot only after it has been filled
+  QUEUE_STORE(_queueHead, head);
+}
+
 uint8_t LoRaClass::readRegister(uint8_t address)
 {
   return singleTransfer(address & 0x7f, 0x00);
@@ -681,6 +919,34 @@ uint8_t LoRaClass::singleTransfer(uint8_t address, uint8_t value)
   return response;
 }
 
+void LoRaClass::readBurst(uint8_t address, uint8_t *buffer, size_t size)
+{
+  digitalWrite(_ss, LOW);
+
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address & 0x7f);
+  for (size_t i = 0; i < size; i++) {
+    buffer[i] = _spi->transfer(0x00);
+  }
+  _spi->endTransaction();
+
+  digitalWrite(_ss, HIGH);
+}
+
+void LoRaClass::writeBurst(uint8_t address, const uint8_t *buffer, size_t size)
+{
+  digitalWrite(_ss, LOW);
+
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address | 0x80);
+  for (size_t i = 0; i < size; i++) {
+    _spi->transfer(buffer[i]);
+  }
+  _spi->endTransaction();
+
+  digitalWrite(_ss, HIGH);
+}
+
 ISR_PREFIX void LoRaClass::onDio0Rise()
 {
   LoRa.handleDio0Rise();
@@ -30,6 +30,17 @@
 #define PA_OUTPUT_RFO_PIN          0
 #define PA_OUTPUT_PA_BOOST_PIN     1
 
+#define LORA_MAX_PKT_LENGTH        255
+
+// packet slot used by receiveContinuous()
+struct LoRaPacket {
+  unsigned long timestamp;           // micros() when RX done was signalled
+  int rssi;                          // dBm
+  int8_t snr;                        // in 0.25 dB steps
+  uint8_t length;
+  uint8_t data[LORA_MAX_PKT_LENGTH];
+};
+
 class LoRaClass : public Stream {
 public:
   LoRaClass();
@@ -55,10 +66,25 @@ public:
   virtual int peek();
   virtual void flush();
 
+  // burst reads, single SPI transaction for the whole buffer
+  size_t readBytes(uint8_t *buffer, size_t length);
+  size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+
 #ifndef ARDUINO_SAMD_MKRWAN1300
   void onReceive(void(*callback)(int));
 
   void receive(int size = 0);
+
+  // copy the payload, RSSI and SNR to RAM before calling onReceive
+  void enablePacketCapture();
+  void disablePacketCapture();
+
+  // keep the radio in continuous RX and queue packets into the provided slots
+  void receiveContinuous(LoRaPacket *slots, int count, int size = 0);
+  int queuedPackets();
+  LoRaPacket* peekPacket();
+  void popPacket();
+  unsigned long droppedPackets();
 #endif
   void idle();
   void sleep();
@@ -94,6 +120,7 @@ private:
   void implicitHeaderMode();
 
   void handleDio0Rise();
+  void handleQueuedRx();
   bool isTransmitting();
 
   int getSpreadingFactor();
@@ -104,6 +131,8 @@ private:
   uint8_t readRegister(uint8_t address);
   void writeRegister(uint8_t address, uint8_t value);
   uint8_t singleTransfer(uint8_t address, uint8_t value);
+  void readBurst(uint8_t address, uint8_t *buffer, size_t size);
+  void writeBurst(uint8_t address, const uint8_t *buffer, size_t size);
 
   static void onDio0Rise();
 
@@ -117,6 +146,18 @@ private:
   int _packetIndex;
   int _implicitHeaderMode;
   void (*_onReceive)(int);
+  bool _captureMode;
+  volatile bool _captured;
+  int _capturedLength;
+  uint8_t _capturedSnr;
+  uint8_t _capturedRssi;
+  uint8_t _captureBuffer[LORA_MAX_PKT_LENGTH];
+  LoRaPacket* _queue;
+  int _queueSlots;
+  volatile int _queueHead;
+  volatile int _queueTail;
+  volatile unsigned long _queueDropped;
+  uint8_t _fifoRxNext;
 };
 
 extern LoRaClass LoRa;
@@ -0,0 +1,151 @@
+/*
+  RadioLib SX126x Receive Queue Example
+
+  This example listens for LoRa transmissions and puts them
+  into a receive queue. Once a packet is received, an interrupt
+  is triggered and the packet is moved into the queue,
+  after which the radio immediately starts listening again.
+  The main loop can then process the queued packets
+  at its own pace, without losing packets that arrive
+  in the meantime.
+
+  Other modules from SX126x family can also be used.
+
+  For default module settings, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/Default-configuration#sx126x---lora-modem
+
+  For full API reference, see the GitHub Pages
+  https://jgromes.github.io/RadioLib/
+*/
+
+// include the library
+#include <RadioLib.h>
+
+// SX1262 has the following connections:
+// NSS pin:   10
+// DIO1 pin:  2
+// NRST pin:  3
+// BUSY pin:  9
+SX1262 radio = new Module(10, 2, 3, 9);
+
+// or detect the pinout automatically using RadioBoards
+// https://github.com/radiolib-org/RadioBoards
+/*
+#define RADIO_BOARD_AUTO
+#include <RadioBoards.h>
+Radio radio = new RadioModule();
+*/
+
+// storage for the receive queue
+RxQueuePacket_t queue[8];
+
+// flag to indicate that a packet was received
+volatile bool receivedFlag = false;
+
+// this function is called when a complete packet
+// is received by the module
+// IMPORTANT: this function MUST be 'void' type
+//            and MUST NOT have any arguments!
+#if defined(ESP8266) || defined(ESP32)
+  ICACHE_RAM_ATTR
+#endif
+void setFlag(void) {
+  // we got a packet, set the flag
+  receivedFlag = true;
+}
+
+void setup() {
+  Serial.begin(9600);
+
+  // initialize SX1262 with default settings
+  Serial.print(F("[SX1262] Initializing ... "));
+  int state = radio.begin();
+  if (state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true) { delay(10); }
+  }
+
+  // set up the receive queue
+  radio.setRxQueue(queue, 8);
+
+  // set the function that will be called
+  // when new packet is received
+  radio.setPacketReceivedAction(setFlag);
+
+  // start listening for LoRa packets
+  Serial.print(F("[SX1262] Starting to listen ... "));
+  state = radio.startReceive();
+  if (state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true) { delay(10); }
+  }
+}
+
+// move the packet into the queue as soon as possible
+// on multi-core platforms, this can also be done in a separate task
+void serviceRadio() {
+  if(receivedFlag) {
+    receivedFlag = false;
+    radio.rxQueueHandler();
+  }
+}
+
+void loop() {
+  serviceRadio();
+
+  // process all packets waiting in the queue
+  const RxQueuePacket_t* pkt;
+  while((pkt = radio.rxQueuePeek()) != NULL) {
+    if (pkt->state == RADIOLIB_ERR_NONE) {
+      Serial.print(F("[SX1262] Received "));
+      Serial.print(pkt->len);
+      Serial.print(F(" bytes at "));
+      Serial.print(pkt->timestamp);
+      Serial.print(F(" us, RSSI "));
+      Serial.print(pkt->rssi);
+      Serial.print(F(" dBm, SNR "));
+      Serial.print(pkt->snr);
+      Serial.print(F(" dB, frequency error "));
+      Serial.print(pkt->freqError);
+      Serial.println(F(" Hz"));
+
+    } else if (pkt->state == RADIOLIB_ERR_CRC_MISMATCH) {
+      // packet was received, but is malformed
+      Serial.println(F("CRC error!"));
+
+    } else {
+      // some other error occurred
+      Serial.print(F("failed, code "));
+      Serial.println(pkt->state);
+
+    }
+
+    // release the entry so that it can be reused
+    radio.rxQueueRelease();
+
+    // keep servicing the radio while the queue is drained
+    serviceRadio();
+  }
+
+  // print queue statistics every now and then
+  static unsigned long lastStats = 0;
+  if(millis() - lastStats > 10000) {
+    lastStats = millis();
+    RxQueueStats_t stats = radio.getRxQueueStats();
+    Serial.print(F("[SX1262] Queue received "));
+    Serial.print(stats.received);
+    Serial.print(F(", overflows "));
+    Serial.print(stats.overflows);
+    Serial.print(F(", high water mark "));
+    Serial.print(stats.highWater);
+    Serial.print(F(", max latency "));
+    Serial.print(stats.maxLatency);
+    Serial.println(F(" us"));
+  }
+}
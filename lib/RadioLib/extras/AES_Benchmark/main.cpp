@@ -0,0 +1,206 @@
+/*
+  Host benchmark of the AES-128 cores.
+
+  Measures ECB encryption and decryption, CTR and CMAC of RadioLibAES128
+  for message lengths typical of LoRaWAN, and reports nanoseconds and
+  cycles per byte. The AES core is selected at compile time by
+  RADIOLIB_AES_CORE, so CMakeLists.txt builds one executable per core.
+  Before benchmarking, each core is checked against the FIPS-197,
+  SP800-38A and RFC 4493 test vectors.
+
+  Cycles are read from the time stamp counter on x86, which counts at
+  a fixed reference frequency and not necessarily at the actual core clock.
+  On other architectures, only time is reported.
+
+  Usage: aes-benchmark-<core> [-n kilobytes]
+    -n  amount of data processed for each measurement (default 4096 kB)
+*/
+
+#include <utils/Cryptography.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLES  (1)
+static uint64_t cycles() {
+  return(__rdtsc());
+}
+#else
+#define HAS_CYCLES  (0)
+static uint64_t cycles() {
+  return(0);
+}
+#endif
+
+#if RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_TTABLE
+static const char* coreName = "ttable";
+#elif RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_BITSLICED
+static const char* coreName = "bitsliced";
+#else
+static const char* coreName = "byte";
+#endif
+
+// operations that are benchmarked
+enum AesOp {
+  OP_ECB_ENC = 0,
+  OP_ECB_DEC,
+  OP_CTR,
+  OP_CMAC,
+  OP_COUNT
+};
+
+static const char* opNames[OP_COUNT] = { "ECB encrypt", "ECB decrypt", "CTR", "CMAC" };
+
+static double wallTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec / 1e9);
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+// known-answer tests, so that a broken core is not benchmarked
+static void checkVectors(RadioLibAES128* aes) {
+  // FIPS-197 appendix C.1
+  uint8_t key[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+  const uint8_t plain[16] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF };
+  const uint8_t cipher[16] = { 0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A };
+  uint8_t out[16];
+  aes->init(key);
+  aes->encryptECB(plain, sizeof(plain), out);
+  check(memcmp(out, cipher, sizeof(cipher)) == 0, "ECB encrypt, FIPS-197 C.1");
+  aes->decryptECB(cipher, sizeof(cipher), out);
+  check(memcmp(out, plain, sizeof(plain)) == 0, "ECB decrypt, FIPS-197 C.1");
+
+  // SP800-38A F.5.1 and RFC 4493 use the same key and first block
+  uint8_t key2[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+  const uint8_t msg[16] = { 0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A };
+  const uint8_t ctrOut[16] = { 0x87, 0x4D, 0x61, 0x91, 0xB6, 0x20, 0xE3, 0x26, 0x1B, 0xEF, 0x68, 0x64, 0x99, 0x0D, 0xB6, 0xCE };
+  const uint8_t cmacEmpty[16] = { 0xBB, 0x1D, 0x69, 0x29, 0xE9, 0x59, 0x37, 0x28, 0x7F, 0xA3, 0x7D, 0x12, 0x9B, 0x75, 0x67, 0x46 };
+  const uint8_t cmacMsg[16] = { 0x07, 0x0A, 0x16, 0xB4, 0x6B, 0x4D, 0x41, 0x44, 0xF7, 0x9B, 0xDD, 0x9D, 0xD0, 0x4A, 0x28, 0x7C };
+  uint8_t ctr[16] = { 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF };
+  aes->init(key2);
+  aes->encryptCTR(ctr, msg, sizeof(msg), out);
+  check(memcmp(out, ctrOut, sizeof(ctrOut)) == 0, "CTR, SP800-38A F.5.1");
+  aes->generateCMAC(msg, 0, out);
+  check(memcmp(out, cmacEmpty, sizeof(cmacEmpty)) == 0, "CMAC of empty message, RFC 4493");
+  aes->generateCMAC(msg, sizeof(msg), out);
+  check(memcmp(out, cmacMsg, sizeof(cmacMsg)) == 0, "CMAC of 16 bytes, RFC 4493");
+}
+
+// run one operation on a message of the given length, the output is fed back so the work cannot be optimized out
+static void runOp(RadioLibAES128* aes, AesOp op, uint8_t* buff, size_t len, uint8_t* ctr) {
+  switch(op) {
+    case OP_ECB_ENC:
+      aes->encryptECB(buff, len, buff);
+      break;
+    case OP_ECB_DEC:
+      aes->decryptECB(buff, len, buff);
+      break;
+    case OP_CTR:
+      aes->encryptCTR(ctr, buff, len, buff);
+      break;
+    case OP_CMAC:
+      aes->generateCMAC(buff, len, buff);
+      break;
+    default:
+      break;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t total = 4096UL*1024UL;
+  int opt;
+  while((opt = getopt(argc, argv, "n:")) != -1) {
+    switch(opt) {
+      case 'n':
+        total = (size_t)atol(optarg)*1024UL;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n kilobytes]\n", argv[0]);
+        return(1);
+    }
+  }
+  if(total < 1024) {
+    total = 1024;
+  }
+
+  printf("AES core: %s\n", coreName);
+  RadioLibAES128 aes;
+  checkVectors(&aes);
+  if(failures) {
+    printf("result: FAIL\n");
+    return(1);
+  }
+
+  // LoRaWAN frames are short, the ECB and CTR lengths are whole blocks
+  const size_t lens[] = { 16, 64, 256 };
+  uint8_t key[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+  uint8_t buff[256];
+  uint8_t ctr[16] = { 0 };
+  for(size_t i = 0; i < sizeof(buff); i++) {
+    buff[i] = (uint8_t)i;
+  }
+  aes.init(key);
+
+  printf("\n%-12s %6s %10s %10s %12s\n", "operation", "bytes", "ns/byte", "MB/s", "cycles/byte");
+  for(int op = 0; op < OP_COUNT; op++) {
+    for(size_t l = 0; l < sizeof(lens)/sizeof(lens[0]); l++) {
+      size_t len = lens[l];
+      size_t iterations = total / len;
+
+      // warm up caches and the CMAC subkeys
+      runOp(&aes, (AesOp)op, buff, len, ctr);
+
+      double start = wallTime();
+      uint64_t startCycles = cycles();
+      for(size_t i = 0; i < iterations; i++) {
+        runOp(&aes, (AesOp)op, buff, len, ctr);
+      }
+      uint64_t elapsedCycles = cycles() - startCycles;
+      double elapsed = wallTime() - start;
+
+      double bytes = (double)iterations*len;
+      printf("%-12s %6u %10.2f %10.2f", opNames[op], (unsigned)len, 1e9*elapsed/bytes, bytes/elapsed/1e6);
+      if(HAS_CYCLES) {
+        printf(" %12.1f\n", (double)elapsedCycles/bytes);
+      } else {
+        printf(" %12s\n", "-");
+      }
+    }
+  }
+
+  // key expansion, alternating between two keys as init() skips the expansion when the key did not change
+  uint8_t keys[2][16];
+  memcpy(keys[0], key, sizeof(key));
+  memcpy(keys[1], key, sizeof(key));
+  keys[1][0] ^= 0xFF;
+  size_t iterations = total / 16;
+  double start = wallTime();
+  uint64_t startCycles = cycles();
+  for(size_t i = 0; i < iterations; i++) {
+    aes.init(keys[i & 1]);
+  }
+  uint64_t elapsedCycles = cycles() - startCycles;
+  double elapsed = wallTime() - start;
+  printf("\nkey expansion: %.1f ns", 1e9*elapsed/iterations);
+  if(HAS_CYCLES) {
+    printf(", %.0f cycles", (double)elapsedCycles/iterations);
+  }
+  printf(" per key\n");
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
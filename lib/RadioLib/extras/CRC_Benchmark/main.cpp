@@ -0,0 +1,138 @@
+/*
+  Host benchmark of the table-driven CRC presets.
+
+  For every preset in src/utils/CRC.h, the checksum of random buffers is
+  calculated with RadioLibCRC::checksum(preset, ...) and compared against
+  the bitwise RadioLibCRC configured with the same parameters. Then both are
+  timed on buffers of several lengths and the throughput in MB/s is reported.
+
+  Usage: crc-benchmark [-n kilobytes]
+    -n  amount of data processed for each measurement (default 4096 kB)
+*/
+
+#include <RadioLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// preset and the parameters of the equivalent bitwise CRC
+struct CrcCase {
+  const char* name;
+  const RadioLibCRCPreset_t* preset;
+  uint32_t poly;
+};
+
+static const CrcCase cases[] = {
+  { "CCITT (AX.25)", &RadioLibCRCPresetCCITT, RADIOLIB_CRC_CCITT_POLY },
+  { "LR-FHSS payload", &RadioLibCRCPresetLRFHSSPayload, 0x755B },
+  { "LR-FHSS header", &RadioLibCRCPresetLRFHSSHeader, 0x2F },
+  { "LR11x0 SPI", &RadioLibCRCPresetLR11x0, 0x65 },
+};
+
+static uint32_t rng = 1;
+
+// xorshift32, so that runs are repeatable
+static uint32_t random32() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return(rng);
+}
+
+static double wallTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec / 1e9);
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+static void configure(RadioLibCRC* crc, const CrcCase& c) {
+  crc->size = c.preset->size;
+  crc->poly = c.poly;
+  crc->init = c.preset->init;
+  crc->out = c.preset->out;
+  crc->refIn = c.preset->reflected;
+  crc->refOut = c.preset->reflected;
+}
+
+// throughput in MB/s, the result is accumulated so that the calls cannot be optimized out
+static double measure(const CrcCase& c, RadioLibCRC* bitwise, const uint8_t* buff, size_t len, size_t total, volatile uint32_t* sink) {
+  size_t iterations = total / len;
+  double start = wallTime();
+  if(bitwise) {
+    for(size_t i = 0; i < iterations; i++) {
+      *sink += bitwise->checksum(buff, len);
+    }
+  } else {
+    for(size_t i = 0; i < iterations; i++) {
+      *sink += RadioLibCRC::checksum(*c.preset, buff, len);
+    }
+  }
+  double elapsed = wallTime() - start;
+  return((double)iterations*len/elapsed/1e6);
+}
+
+int main(int argc, char** argv) {
+  size_t total = 4096UL*1024UL;
+  int opt;
+  while((opt = getopt(argc, argv, "n:")) != -1) {
+    switch(opt) {
+      case 'n':
+        total = (size_t)atol(optarg)*1024UL;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n kilobytes]\n", argv[0]);
+        return(1);
+    }
+  }
+  if(total < 1024) {
+    total = 1024;
+  }
+
+  uint8_t buff[256];
+  for(size_t i = 0; i < sizeof(buff); i++) {
+    buff[i] = (uint8_t)random32();
+  }
+
+  // the presets must match the bitwise implementation for all lengths
+  RadioLibCRC bitwise;
+  const size_t numCases = sizeof(cases)/sizeof(cases[0]);
+  for(size_t c = 0; c < numCases; c++) {
+    configure(&bitwise, cases[c]);
+    size_t mismatches = 0;
+    for(size_t len = 0; len <= sizeof(buff); len++) {
+      if(RadioLibCRC::checksum(*cases[c].preset, buff, len) != bitwise.checksum(buff, len)) {
+        mismatches++;
+      }
+    }
+    char what[64];
+    snprintf(what, sizeof(what), "%s preset matches bitwise CRC", cases[c].name);
+    check(mismatches == 0, what);
+  }
+
+  const size_t lens[] = { 16, 64, 256 };
+  volatile uint32_t sink = 0;
+  printf("\n%-16s %6s %14s %14s %8s\n", "preset", "bytes", "table MB/s", "bitwise MB/s", "speedup");
+  for(size_t c = 0; c < numCases; c++) {
+    configure(&bitwise, cases[c]);
+    for(size_t l = 0; l < sizeof(lens)/sizeof(lens[0]); l++) {
+      double table = measure(cases[c], NULL, buff, lens[l], total, &sink);
+      double bits = measure(cases[c], &bitwise, buff, lens[l], total, &sink);
+      printf("%-16s %6u %14.1f %14.1f %7.1fx\n", cases[c].name, (unsigned)lens[l], table, bits, table/bits);
+    }
+  }
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
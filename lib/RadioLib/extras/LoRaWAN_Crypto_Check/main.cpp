@@ -0,0 +1,184 @@
+/*
+  Host check of the LoRaWAN crypto backend interface.
+
+  Runs an ABP node on a simulated SX1262 (src/hal/Sim/SimHal.h) with a backend
+  that logs every call and forwards it to the software backend. Each step
+  checks which key slots LoRaWANNode uses, that errors returned by the backend
+  reach the caller, and that cached keys are invalidated when a session is
+  started or restored.
+
+  Usage: lora-crypto-check [-v]
+    -v  print every backend call
+*/
+
+#include <hal/Sim/SimHal.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// backend operations, for counting and fault injection
+enum CryptoOp {
+  OP_SET_KEY = 0,
+  OP_ECB,
+  OP_CTR,
+  OP_MIC,
+  OP_INVALIDATE,
+  OP_COUNT
+};
+
+static const char* opNames[OP_COUNT] = { "setKey", "encryptECB", "encryptCTR", "generateMIC", "invalidate" };
+
+static const char* keyNames[RADIOLIB_LORAWAN_NUM_KEYS] = {
+  "NwkKey", "AppKey", "JSIntKey", "AppSKey", "FNwkSIntKey", "SNwkSIntKey", "NwkSEncKey", "McAppSKey", "McNwkSKey"
+};
+
+// software backend with a log of all calls, can be told to fail a given operation
+class LoggingBackend : public LoRaWANCryptoSoftware {
+  public:
+    bool verbose = false;
+
+    // number of calls per operation, and per key slot for the keyed operations
+    uint32_t calls[OP_COUNT] = { 0 };
+    uint32_t keyUses[OP_COUNT][RADIOLIB_LORAWAN_NUM_KEYS] = { { 0 } };
+
+    // operation that returns failStatus instead of being executed, OP_COUNT for none
+    CryptoOp failOp = OP_COUNT;
+    int16_t failStatus = RADIOLIB_ERR_SPI_CMD_FAILED;
+
+    void clear() {
+      memset(this->calls, 0, sizeof(this->calls));
+      memset(this->keyUses, 0, sizeof(this->keyUses));
+    }
+
+    int16_t setKey(uint8_t keyId, const uint8_t* key) override {
+      RADIOLIB_ASSERT(this->log(OP_SET_KEY, keyId));
+      return(LoRaWANCryptoSoftware::setKey(keyId, key));
+    }
+
+    int16_t encryptECB(uint8_t keyId, const uint8_t* in, size_t len, uint8_t* out) override {
+      RADIOLIB_ASSERT(this->log(OP_ECB, keyId, len));
+      return(LoRaWANCryptoSoftware::encryptECB(keyId, in, len, out));
+    }
+
+    int16_t encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) override {
+      RADIOLIB_ASSERT(this->log(OP_CTR, keyId, len));
+      return(LoRaWANCryptoSoftware::encryptCTR(keyId, ctr, in, len, out));
+    }
+
+    int16_t generateMIC(uint8_t keyId, const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* mic) override {
+      RADIOLIB_ASSERT(this->log(OP_MIC, keyId, len));
+      return(LoRaWANCryptoSoftware::generateMIC(keyId, prefix, in, len, mic));
+    }
+
+    void invalidate() override {
+      (void)this->log(OP_INVALIDATE, RADIOLIB_LORAWAN_KEY_NONE);
+      LoRaWANCryptoSoftware::invalidate();
+    }
+
+  private:
+    int16_t log(CryptoOp op, uint8_t keyId, size_t len = 0) {
+      this->calls[op]++;
+      if(keyId < RADIOLIB_LORAWAN_NUM_KEYS) {
+        this->keyUses[op][keyId]++;
+      }
+      bool fail = (op == this->failOp);
+      if(this->verbose) {
+        printf("  %-12s %-12s %3u bytes%s\n", opNames[op], (keyId < RADIOLIB_LORAWAN_NUM_KEYS) ? keyNames[keyId] : "-",
+               (unsigned)len, fail ? "  -> injected failure" : "");
+      }
+      return(fail ? this->failStatus : RADIOLIB_ERR_NONE);
+    }
+};
+
+// same ABP session as examples/LoRaWAN/LoRaWAN_ABP
+static const uint32_t devAddr = 0x260B1234;
+static uint8_t fNwkSIntKey[] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+static uint8_t sNwkSIntKey[] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+static uint8_t nwkSEncKey[] =  { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+static uint8_t appSKey[] =     { 0x3C, 0x4F, 0xCF, 0x09, 0x88, 0x15, 0xF7, 0xAB, 0xA6, 0xD2, 0xAE, 0x28, 0x16, 0x15, 0x7E, 0x2B };
+
+static const uint8_t payload[] = "Hello, world!";
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+int main(int argc, char** argv) {
+  LoggingBackend crypto;
+  int opt;
+  while((opt = getopt(argc, argv, "v")) != -1) {
+    switch(opt) {
+      case 'v':
+        crypto.verbose = true;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+        return(1);
+    }
+  }
+
+  SimChannel channel;
+  SimSX126x chip(&channel);
+  SimHal hal(&chip, &channel);
+  SX1262 radio(new Module(&hal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO));
+  int16_t state = radio.begin();
+  if(state != RADIOLIB_ERR_NONE) {
+    fprintf(stderr, "radio.begin() failed, code %d\n", state);
+    return(1);
+  }
+
+  LoRaWANNode node(&radio, &EU868);
+  node.setCryptoBackend(&crypto);
+  check(crypto.calls[OP_INVALIDATE] == 1, "setCryptoBackend invalidates cached keys");
+
+  crypto.clear();
+  node.beginABP(devAddr, fNwkSIntKey, sNwkSIntKey, nwkSEncKey, appSKey);
+  check(crypto.calls[OP_INVALIDATE] > 0, "beginABP invalidates cached keys");
+  state = node.activateABP();
+  check((state == RADIOLIB_ERR_NONE) || (state == RADIOLIB_LORAWAN_NEW_SESSION), "activateABP");
+  node.setDutyCycle(false);
+
+  // the uplink payload is encrypted with AppSKey, the MIC is calculated with both network keys
+  crypto.clear();
+  state = node.sendReceive(payload, sizeof(payload) - 1);
+  check(state >= RADIOLIB_ERR_NONE, "uplink");
+  check(crypto.keyUses[OP_CTR][RADIOLIB_LORAWAN_KEY_APP_S] == 1, "payload encrypted with AppSKey");
+  check((crypto.keyUses[OP_MIC][RADIOLIB_LORAWAN_KEY_F_NWK_S_INT] > 0) &&
+        (crypto.keyUses[OP_MIC][RADIOLIB_LORAWAN_KEY_S_NWK_S_INT] > 0), "MIC calculated with FNwkSIntKey and SNwkSIntKey");
+  check(crypto.calls[OP_SET_KEY] == crypto.calls[OP_CTR] + crypto.calls[OP_ECB] + crypto.calls[OP_MIC],
+        "every operation is preceded by setKey");
+
+  // each backend failure must reach the caller instead of producing a corrupted frame
+  const CryptoOp faults[] = { OP_SET_KEY, OP_CTR, OP_MIC };
+  for(size_t i = 0; i < sizeof(faults)/sizeof(faults[0]); i++) {
+    char what[64];
+    snprintf(what, sizeof(what), "%s failure is returned by sendReceive", opNames[faults[i]]);
+    crypto.failOp = faults[i];
+    state = node.sendReceive(payload, sizeof(payload) - 1);
+    crypto.failOp = OP_COUNT;
+    check(state == crypto.failStatus, what);
+  }
+
+  // the node keeps working once the backend recovers
+  state = node.sendReceive(payload, sizeof(payload) - 1);
+  check(state >= RADIOLIB_ERR_NONE, "uplink after backend failures");
+
+  // restoring the session into another node must not rely on keys cached for the first one
+  uint8_t session[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+  memcpy(session, node.getBufferSession(), sizeof(session));
+  LoRaWANNode restored(&radio, &EU868);
+  restored.setCryptoBackend(&crypto);
+  crypto.clear();
+  state = restored.setBufferSession(session);
+  check(state == RADIOLIB_ERR_NONE, "setBufferSession");
+  check(crypto.calls[OP_INVALIDATE] > 0, "setBufferSession invalidates cached keys");
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
@@ -0,0 +1,423 @@
+/*
+  Host check of the LoRaWAN Rx window timing.
+
+  Runs an ABP node on a simulated SX1262 (src/hal/Sim/SimHal.h) against
+  a scripted gateway on the same simulated channel. The gateway answers each
+  uplink with a downlink that starts exactly RECEIVE_DELAY1 (or RECEIVE_DELAY2)
+  after the end of the uplink. The node is driven only through the non-blocking
+  API: startSendReceive(), then poll() whenever getNextDeadline() passes or
+  the radio interrupt fires, with the virtual clock advanced in between.
+
+  For every exchange, the program checks when the radio was put into Rx
+  (SetRx command on the SPI bus) against the end of the uplink plus the Rx delay,
+  that the downlink is received in the expected window, and the windowOffset
+  fields of the uplink and downlink events.
+
+  Usage: lorawan-rx-timing [-2] [-n <count>] [-v]
+    -2  answer in Rx2 instead of Rx1
+    -n  number of uplinks (default 10)
+    -v  print timing of each exchange
+*/
+
+#include <hal/Sim/SimHal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// delays between the end of the uplink and the Rx windows, in microseconds
+#define RX1_DELAY_US      ((uint64_t)RADIOLIB_LORAWAN_RECEIVE_DELAY_1_MS * 1000)
+#define RX2_DELAY_US      ((uint64_t)RADIOLIB_LORAWAN_RECEIVE_DELAY_2_MS * 1000)
+
+// how early a window may open: the node pads the window by at most half its default scanGuard on either side
+#define RX_LEAD_MAX_US    (5000)
+
+// maximum difference between the measured and planned window opening reported in windowOffset
+#define RX_OFFSET_MAX_US  (1000)
+
+// EU868 Rx2 defaults, DR0
+#define RX2_FREQ          (869525000UL)
+#define RX2_SF            (12)
+
+// scripted LoRaWAN 1.0 gateway and network server for a single ABP device
+// each uplink is answered by one unconfirmed downlink, sent at the exact start of Rx1 or Rx2
+class SimGateway : public SimRadio {
+  public:
+    SimGateway(SimChannel* channel, uint32_t devAddr, const uint8_t* nwkSKey, const uint8_t* appSKey)
+      : SimRadio(channel), devAddr(devAddr) {
+      memcpy(this->nwkSKey, nwkSKey, 16);
+      memcpy(this->appSKey, appSKey, 16);
+    }
+
+    // answer in Rx2 instead of Rx1
+    bool useRx2 = false;
+
+    // end of the last uplink and start of the last downlink, in virtual microseconds
+    uint64_t uplinkEnd = 0;
+    uint64_t downlinkStart = 0;
+
+    uint32_t uplinks = 0;
+    uint32_t downlinks = 0;
+    uint32_t micErrors = 0;
+
+    // queue application payload for the next downlink
+    void queueDownlink(uint8_t port, const uint8_t* data, size_t len) {
+      this->dlPort = port;
+      this->dlLen = (len > sizeof(this->dlData)) ? sizeof(this->dlData) : len;
+      memcpy(this->dlData, data, this->dlLen);
+    }
+
+    void select() override {}
+    uint8_t transfer(uint8_t b) override { return(b); }
+    void deselect() override {}
+    void reset(bool level) override { (void)level; }
+    bool getIrq() override { return(false); }
+    bool getGpio() override { return(false); }
+
+    uint64_t nextEvent() override {
+      uint64_t ev = this->pending ? this->pendingStart : SIM_NEVER;
+      if(this->transmitting && (this->txPacket.end < ev)) {
+        ev = this->txPacket.end;
+      }
+      return(ev);
+    }
+
+    void update(uint64_t t) override {
+      if(this->transmitting && (t >= this->txPacket.end)) {
+        this->transmitting = false;
+        this->channel->deliver(this, this->txPacket);
+      }
+
+      if(this->pending && (t >= this->pendingStart)) {
+        this->pending = false;
+        this->startTx(this->pendingData, this->pendingLen, this->pendingStart);
+        this->downlinkStart = this->pendingStart;
+        this->downlinks++;
+      }
+    }
+
+    // the gateway listens to all uplinks, on any channel and data rate
+    bool accepts(const SimPacket& pkt, uint64_t since) const override {
+      (void)since;
+      return(!pkt.iq && !this->transmitting);
+    }
+
+    void receive(const SimPacket& pkt, float rssi, float snr, bool crcErr) override {
+      (void)rssi;
+      (void)snr;
+      if(crcErr || (pkt.len < 12) || ((pkt.data[0] & 0xE0) != 0x40) || (get32(&pkt.data[1]) != this->devAddr)) {
+        return;
+      }
+
+      uint8_t mic[4];
+      uint32_t fCnt = pkt.data[6] | ((uint32_t)pkt.data[7] << 8);
+      this->dataMic(0, fCnt, pkt.data, pkt.len - 4, mic);
+      if(memcmp(mic, &pkt.data[pkt.len - 4], 4) != 0) {
+        this->micErrors++;
+        return;
+      }
+      this->uplinks++;
+      this->uplinkEnd = pkt.end;
+      if(this->dlLen == 0) {
+        return;
+      }
+
+      // MHDR, DevAddr, FCtrl, FCnt, FPort, encrypted payload, MIC
+      uint8_t dn[64] = { 0x60 };
+      set32(&dn[1], this->devAddr);
+      dn[6] = this->fCntDown;
+      dn[7] = this->fCntDown >> 8;
+      size_t len = 8;
+      dn[len++] = this->dlPort;
+      memcpy(&dn[len], this->dlData, this->dlLen);
+      this->dataCrypt(this->fCntDown, &dn[len], this->dlLen);
+      len += this->dlLen;
+      this->dataMic(1, this->fCntDown, dn, len, &dn[len]);
+      len += 4;
+      this->fCntDown++;
+      this->dlLen = 0;
+
+      // Rx1 uses the uplink channel and data rate, Rx2 the fixed defaults
+      this->freq = this->useRx2 ? RX2_FREQ : pkt.freq;
+      this->sf = this->useRx2 ? RX2_SF : pkt.sf;
+      this->bw = pkt.bw;
+      this->cr = 1;
+      this->crc = false;
+      this->implicit = false;
+      this->ldro = (this->sf >= 11) && (this->bw == 125000);
+      this->iqTx = true;
+      this->preamble = 8;
+
+      memcpy(this->pendingData, dn, len);
+      this->pendingLen = len;
+      this->pendingStart = pkt.end + (this->useRx2 ? RX2_DELAY_US : RX1_DELAY_US);
+      this->pending = true;
+    }
+
+  private:
+    const uint32_t devAddr;
+    uint8_t nwkSKey[16];
+    uint8_t appSKey[16];
+    uint32_t fCntDown = 0;
+
+    uint8_t dlPort = 0;
+    uint8_t dlData[32];
+    size_t dlLen = 0;
+
+    bool pending = false;
+    uint64_t pendingStart = 0;
+    uint8_t pendingData[64];
+    size_t pendingLen = 0;
+
+    static uint32_t get32(const uint8_t* buf) {
+      return((uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24));
+    }
+
+    static void set32(uint8_t* buf, uint32_t val) {
+      buf[0] = val;
+      buf[1] = val >> 8;
+      buf[2] = val >> 16;
+      buf[3] = val >> 24;
+    }
+
+    // LoRaWAN 1.0 data frame MIC
+    void dataMic(uint8_t dir, uint32_t fCnt, const uint8_t* frame, size_t len, uint8_t* mic) {
+      uint8_t buf[16 + 256] = { 0x49 };
+      buf[5] = dir;
+      set32(&buf[6], this->devAddr);
+      set32(&buf[10], fCnt);
+      buf[15] = len;
+      memcpy(&buf[16], frame, len);
+      uint8_t cmac[16];
+      RadioLibAES128Instance.init(this->nwkSKey);
+      RadioLibAES128Instance.generateCMAC(buf, 16 + len, cmac);
+      memcpy(mic, cmac, 4);
+    }
+
+    // LoRaWAN 1.0 downlink payload encryption
+    void dataCrypt(uint32_t fCnt, uint8_t* data, size_t len) {
+      uint8_t a[16] = { 0x01 };
+      uint8_t s[16];
+      a[5] = 1;
+      set32(&a[6], this->devAddr);
+      set32(&a[10], fCnt);
+      RadioLibAES128Instance.init(this->appSKey);
+      for(size_t i = 0; i < len; i += 16) {
+        a[15] = i/16 + 1;
+        RadioLibAES128Instance.encryptECB(a, 16, s);
+        for(size_t j = 0; (j < 16) && (i + j < len); j++) {
+          data[i + j] ^= s[j];
+        }
+      }
+    }
+};
+
+// simulated HAL that timestamps each SetRx command sent to the radio
+class TimingHal : public SimHal {
+  public:
+    TimingHal(SimRadio* radio, SimChannel* channel) : SimHal(radio, channel), clock(channel) {}
+
+    // virtual time at which the radio was put into Rx since the last call to clearWindows
+    uint64_t rxStart[16] = { 0 };
+    size_t numRx = 0;
+
+    void clearWindows() {
+      this->numRx = 0;
+    }
+
+    void spiBeginTransaction() override {
+      SimHal::spiBeginTransaction();
+      this->opcode = true;
+    }
+
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override {
+      bool setRx = this->opcode && out && (len > 0) && (out[0] == RADIOLIB_SX126X_CMD_SET_RX);
+      this->opcode = false;
+      SimHal::spiTransfer(out, len, in);
+      if(setRx && (this->numRx < sizeof(this->rxStart)/sizeof(this->rxStart[0]))) {
+        this->rxStart[this->numRx++] = this->clock->now();
+      }
+    }
+
+  private:
+    SimChannel* clock;
+    bool opcode = false;
+};
+
+// same ABP session as examples/LoRaWAN/LoRaWAN_ABP, with LoRaWAN 1.0 keys
+static const uint32_t devAddr = 0x260B1234;
+static uint8_t nwkSKey[] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+static uint8_t appSKey[] = { 0x3C, 0x4F, 0xCF, 0x09, 0x88, 0x15, 0xF7, 0xAB, 0xA6, 0xD2, 0xAE, 0x28, 0x16, 0x15, 0x7E, 0x2B };
+
+static const uint8_t payload[] = "Hello, world!";
+static const uint8_t downlink[] = { 0xCA, 0xFE, 0xBA, 0xBE };
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+// set from the radio interrupt, wakes up the loop that drives poll()
+static volatile bool wakeup = false;
+
+static void onRadioEvent(void) {
+  wakeup = true;
+}
+
+int main(int argc, char** argv) {
+  bool rx2 = false;
+  int count = 10;
+  bool verbose = false;
+  int opt;
+  while((opt = getopt(argc, argv, "2n:v")) != -1) {
+    switch(opt) {
+      case '2':
+        rx2 = true;
+        break;
+      case 'n':
+        count = atoi(optarg);
+        break;
+      case 'v':
+        verbose = true;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-2] [-n <count>] [-v]\n", argv[0]);
+        return(1);
+    }
+  }
+
+  SimChannel channel;
+  SimSX126x chip(&channel);
+  TimingHal hal(&chip, &channel);
+  SimGateway gateway(&channel, devAddr, nwkSKey, appSKey);
+  gateway.useRx2 = rx2;
+  SX1262 radio(new Module(&hal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO));
+  int16_t state = radio.begin();
+  if(state != RADIOLIB_ERR_NONE) {
+    fprintf(stderr, "radio.begin() failed, code %d\n", state);
+    return(1);
+  }
+
+  LoRaWANNode node(&radio, &EU868);
+  node.beginABP(devAddr, NULL, NULL, nwkSKey, appSKey);
+  state = node.activateABP();
+  if((state != RADIOLIB_ERR_NONE) && (state != RADIOLIB_LORAWAN_NEW_SESSION)) {
+    fprintf(stderr, "node.activateABP() failed, code %d\n", state);
+    return(1);
+  }
+  node.setDutyCycle(false);
+  node.setEventAction(onRadioEvent);
+
+  const int window = rx2 ? 2 : 1;
+  const size_t windows = rx2 ? 2 : 1;
+  int received = 0;
+  int windowsOk = 0;
+  int offsetsOk = 0;
+  int deadlinesOk = 0;
+  uint32_t polls = 0;
+  int64_t leadMin = INT64_MAX;
+  int64_t leadMax = INT64_MIN;
+  int32_t offsetMax = 0;
+
+  for(int i = 0; i < count; i++) {
+    gateway.queueDownlink(1, downlink, sizeof(downlink));
+    hal.clearWindows();
+
+    uint8_t dataDown[RADIOLIB_LORAWAN_MAX_PAYLOAD_SIZE + 1];
+    size_t lenDown = 0;
+    LoRaWANEvent_t eventUp;
+    LoRaWANEvent_t eventDown;
+    memset(&eventUp, 0xAA, sizeof(eventUp));
+    memset(&eventDown, 0xAA, sizeof(eventDown));
+
+    state = node.startSendReceive(payload, sizeof(payload) - 1);
+    if(state != RADIOLIB_ERR_NONE) {
+      fprintf(stderr, "startSendReceive failed, code %d\n", state);
+      failures++;
+      break;
+    }
+
+    // poll only when the deadline passes or the radio interrupt fires, the clock jumps straight to the next event
+    bool deadlineOk = true;
+    while((state = node.poll(dataDown, &lenDown, &eventUp, &eventDown)) == RADIOLIB_LORAWAN_PENDING) {
+      polls++;
+      RadioLibTime_t deadline = node.getNextDeadline();
+      if(deadline == 0) {
+        deadlineOk = false;
+        break;
+      }
+
+      wakeup = false;
+      uint64_t target = (uint64_t)deadline * 1000;
+      while(!wakeup && (channel.now() < target)) {
+        uint64_t next = channel.nextEvent();
+        uint64_t until = ((next > channel.now()) && (next < target)) ? next : target;
+        hal.delayMicroseconds(until - channel.now());
+      }
+    }
+    deadlineOk = deadlineOk && (node.getNextDeadline() == 0);
+
+    bool ok = (state == window) && (lenDown == sizeof(downlink)) && (memcmp(dataDown, downlink, lenDown) == 0);
+    received += ok;
+    deadlinesOk += deadlineOk;
+
+    // Rx before the end of the uplink is not a window, e.g. the radio samples noise for random numbers
+    size_t first = 0;
+    while((first < hal.numRx) && (hal.rxStart[first] < gateway.uplinkEnd)) {
+      first++;
+    }
+    const uint64_t* rxStart = &hal.rxStart[first];
+    size_t numRx = hal.numRx - first;
+
+    // each window has to be open when the downlink starts, but not much earlier
+    bool windowOk = (numRx == windows);
+    for(size_t w = 0; (w < numRx) && (w < 2); w++) {
+      uint64_t planned = gateway.uplinkEnd + (w ? RX2_DELAY_US : RX1_DELAY_US);
+      int64_t lead = (int64_t)planned - (int64_t)rxStart[w];
+      windowOk = windowOk && (lead >= 0) && (lead <= RX_LEAD_MAX_US);
+      leadMin = (lead < leadMin) ? lead : leadMin;
+      leadMax = (lead > leadMax) ? lead : leadMax;
+    }
+    windowsOk += windowOk;
+
+    // uplink offsets are measured for the windows that were opened, downlinks always report 0
+    bool offsetOk = (eventDown.windowOffset[0] == 0) && (eventDown.windowOffset[1] == 0);
+    for(size_t w = 0; w < 2; w++) {
+      int32_t offset = eventUp.windowOffset[w];
+      int32_t mag = (offset < 0) ? -offset : offset;
+      offsetOk = offsetOk && ((w < windows) ? (mag <= RX_OFFSET_MAX_US) : (offset == 0));
+      offsetMax = (mag > offsetMax) ? mag : offsetMax;
+    }
+    offsetsOk += offsetOk;
+
+    if(verbose) {
+      printf("  uplink %d: state %d, uplink end %llu us, Rx opened", i, state, (unsigned long long)gateway.uplinkEnd);
+      for(size_t w = 0; w < numRx; w++) {
+        printf(" +%llu us", (unsigned long long)(rxStart[w] - gateway.uplinkEnd));
+      }
+      printf(", downlink +%llu us, windowOffset %ld/%ld us\n", (unsigned long long)(gateway.downlinkStart - gateway.uplinkEnd),
+             (long)eventUp.windowOffset[0], (long)eventUp.windowOffset[1]);
+    }
+  }
+
+  printf("%d uplinks answered in Rx%d, %.1f polls per exchange\n", count, window, count ? (double)polls / count : 0.0);
+  printf("window opened %lld to %lld us before the downlink, windowOffset up to %ld us\n",
+         (long long)leadMin, (long long)leadMax, (long)offsetMax);
+
+  char what[64];
+  check((gateway.uplinks == (uint32_t)count) && (gateway.micErrors == 0), "gateway received every uplink");
+  snprintf(what, sizeof(what), "downlink received in Rx%d", window);
+  check(received == count, what);
+  snprintf(what, sizeof(what), "Rx window opened within %d us before the downlink", RX_LEAD_MAX_US);
+  check(windowsOk == count, what);
+  check(offsetsOk == count, "windowOffset set for opened windows only, 0 for downlinks");
+  check(deadlinesOk == count, "getNextDeadline set while pending, 0 when done");
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
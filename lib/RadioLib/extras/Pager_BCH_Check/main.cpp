@@ -0,0 +1,183 @@
+/*
+  Host check of the POCSAG BCH(31,21) decoder.
+
+  Encodes random data words with RadioLibBCH, flips bits and runs
+  RadioLibBCH::decode on the result. Two kinds of errors are injected:
+  a fixed number of flipped bits per code word (0 to 4), and independent
+  bit errors with a given bit error rate, for which the fraction of code words
+  and of whole batches (16 code words) that are received intact is reported
+  with and without error correction. The time per decode is also reported.
+
+  Usage: pager-bch-check [-n count] [-s seed]
+    -n  number of code words per test (default 100000)
+    -s  seed of the random number generator (default 1)
+*/
+
+#include <RadioLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// number of code words in a POCSAG batch, without the sync word
+#define BATCH_CODE_WORDS  (16)
+
+static uint32_t rng = 1;
+
+// xorshift32, so that runs are repeatable for a given seed
+static uint32_t random32() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return(rng);
+}
+
+static double random01() {
+  return((double)random32() / 4294967296.0);
+}
+
+static double wallTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec / 1e9);
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+// random code word, data bits are the 21 most significant bits like in PagerClient
+static uint32_t randomCodeWord(RadioLibBCH* bch) {
+  return(bch->encode(random32() & ~RADIOLIB_PAGER_BCH_BITS_MASK));
+}
+
+// flip the given number of distinct bits
+static uint32_t flipBits(uint32_t word, int num) {
+  uint32_t mask = 0;
+  while(num > 0) {
+    uint32_t bit = (uint32_t)1 << (random32() % 32);
+    if(!(mask & bit)) {
+      mask |= bit;
+      num--;
+    }
+  }
+  return(word ^ mask);
+}
+
+// flip each bit with the given probability
+static uint32_t addNoise(uint32_t word, double ber) {
+  for(int i = 0; i < 32; i++) {
+    if(random01() < ber) {
+      word ^= (uint32_t)1 << i;
+    }
+  }
+  return(word);
+}
+
+int main(int argc, char** argv) {
+  long count = 100000;
+  int opt;
+  while((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch(opt) {
+      case 'n':
+        count = atol(optarg);
+        break;
+      case 's':
+        rng = (uint32_t)strtoul(optarg, NULL, 0);
+        rng = rng ? rng : 1;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n count] [-s seed]\n", argv[0]);
+        return(1);
+    }
+  }
+  if(count < 1) {
+    count = 1;
+  }
+
+  RadioLibBCH bch;
+  bch.begin(RADIOLIB_PAGER_BCH_N, RADIOLIB_PAGER_BCH_K, RADIOLIB_PAGER_BCH_PRIMITIVE_POLY);
+
+  // fixed number of errors: up to 2 must be corrected, 3 must be detected, 4 are beyond the code and only reported
+  printf("errors  corrected  rejected  miscorrected\n");
+  long corrected[5] = { 0 };
+  long rejected[5] = { 0 };
+  long wrong[5] = { 0 };
+  for(int e = 0; e <= 4; e++) {
+    for(long i = 0; i < count; i++) {
+      uint32_t sent = randomCodeWord(&bch);
+      uint32_t word = flipBits(sent, e);
+      int8_t res = bch.decode(&word);
+      if(res < 0) {
+        rejected[e]++;
+      } else if((word == sent) && (res == e)) {
+        corrected[e]++;
+      } else {
+        wrong[e]++;
+      }
+    }
+    printf("%6d  %8.3f%%  %7.3f%%  %11.3f%%\n", e, 100.0*corrected[e]/count, 100.0*rejected[e]/count, 100.0*wrong[e]/count);
+  }
+
+  // random bit errors, a batch is only usable if none of its code words is corrupted
+  const double bers[] = { 0.001, 0.005, 0.01, 0.02, 0.05 };
+  printf("\n   BER  words raw  words decoded  batches raw  batches decoded\n");
+  for(size_t b = 0; b < sizeof(bers)/sizeof(bers[0]); b++) {
+    long wordsRaw = 0;
+    long wordsDec = 0;
+    long batchesRaw = 0;
+    long batchesDec = 0;
+    long batches = (count + BATCH_CODE_WORDS - 1) / BATCH_CODE_WORDS;
+    for(long i = 0; i < batches; i++) {
+      bool batchRaw = true;
+      bool batchDec = true;
+      for(int j = 0; j < BATCH_CODE_WORDS; j++) {
+        uint32_t sent = randomCodeWord(&bch);
+        uint32_t word = addNoise(sent, bers[b]);
+        bool raw = (word == sent);
+        bool dec = (bch.decode(&word) >= 0) && (word == sent);
+        wordsRaw += raw;
+        wordsDec += dec;
+        batchRaw = batchRaw && raw;
+        batchDec = batchDec && dec;
+      }
+      batchesRaw += batchRaw;
+      batchesDec += batchDec;
+    }
+    long words = batches * BATCH_CODE_WORDS;
+    printf("%6.3f  %8.3f%%  %12.3f%%  %10.3f%%  %14.3f%%\n", bers[b], 100.0*wordsRaw/words, 100.0*wordsDec/words,
+           100.0*batchesRaw/batches, 100.0*batchesDec/batches);
+  }
+
+  // decode time, code words are prepared first so that only decode() is measured
+  const size_t num = 4096;
+  uint32_t words[num];
+  for(size_t i = 0; i < num; i++) {
+    words[i] = flipBits(randomCodeWord(&bch), random32() % 3);
+  }
+  long rounds = (count + num - 1) / num;
+  volatile int32_t sink = 0;
+  double start = wallTime();
+  for(long r = 0; r < rounds; r++) {
+    for(size_t i = 0; i < num; i++) {
+      uint32_t word = words[i];
+      sink += bch.decode(&word);
+    }
+  }
+  double elapsed = wallTime() - start;
+  printf("\ndecode: %.1f ns per code word (%ld code words with 0-2 errors)\n", 1e9*elapsed/(rounds*num), (long)(rounds*num));
+  (void)sink;
+
+  printf("\n");
+  check((corrected[0] == count) && (corrected[1] == count) && (corrected[2] == count), "up to 2 errors are corrected");
+  check(rejected[3] == count, "3 errors are rejected");
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
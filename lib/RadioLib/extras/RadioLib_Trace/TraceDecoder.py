@@ -0,0 +1,178 @@
+#!/usr/bin/python3
+# -*- encoding: utf-8 -*-
+
+import argparse
+import struct
+import sys
+
+from argparse import RawTextHelpFormatter
+
+# event framing, see src/utils/Trace.h
+SYNC = b'\xa5\x5a'
+EVENT_FMT = '<IHBBI'
+EVENT_LEN = struct.calcsize(EVENT_FMT)
+
+# default settings
+DEFAULT_BAUDRATE = 115200
+
+EVENT_TYPES = {
+    0x01: 'CMD W',
+    0x02: 'CMD R',
+    0x03: 'REG W',
+    0x04: 'REG R',
+    0x05: 'CHAIN W',
+    0x06: 'CHAIN R',
+    0x07: 'GPIO',
+    0x08: 'MODE',
+    0x09: 'IRQ',
+    0x0A: 'USER',
+    0x0F: 'OVERFLOW',
+}
+
+# Module::OpMode_t
+MODES = {
+    1: 'IDLE',
+    2: 'RX',
+    3: 'TX',
+}
+
+# names of the most common commands, so that the timeline is easier to read
+# SX126x commands are a single byte, register/buffer address may follow in the low byte of the code
+SX126X_COMMANDS = {
+    0x80: 'SetStandby',
+    0x82: 'SetRx',
+    0x83: 'SetTx',
+    0x84: 'SetSleep',
+    0x86: 'SetRfFrequency',
+    0x89: 'Calibrate',
+    0x8A: 'SetPacketType',
+    0x8B: 'SetModulationParams',
+    0x8C: 'SetPacketParams',
+    0x8E: 'SetTxParams',
+    0x8F: 'SetBufferBaseAddress',
+    0x95: 'SetPaConfig',
+    0x98: 'CalibrateImage',
+    0xC0: 'GetStatus',
+    0x02: 'ClearIrqStatus',
+    0x08: 'SetDioIrqParams',
+    0x0D: 'WriteRegister',
+    0x0E: 'WriteBuffer',
+    0x11: 'GetPacketType',
+    0x12: 'GetIrqStatus',
+    0x13: 'GetRxBufferStatus',
+    0x14: 'GetPacketStatus',
+    0x15: 'GetRssiInst',
+    0x1D: 'ReadRegister',
+    0x1E: 'ReadBuffer',
+}
+
+CHIPS = {
+    'none': {},
+    'sx126x': SX126X_COMMANDS,
+}
+
+def command_name(code, commands):
+    if code in commands:
+        return commands[code]
+    return commands.get(code >> 8, '')
+
+def decode(ev, commands):
+    time, code, type, length, value = ev
+    name = EVENT_TYPES.get(type, f'0x{type:02X}')
+    if type in (0x01, 0x02, 0x05, 0x06):
+        cmd = command_name(code, commands)
+        data = value.to_bytes(4, 'big')[:min(length, 4)].hex(' ').upper()
+        more = '..' if length > 4 else ''
+        return f'{name:<8} {code:04X} {cmd:<20} len={length:<3} {data}{more}'
+    if type in (0x03, 0x04):
+        data = value.to_bytes(4, 'big')[:min(length, 4)].hex(' ').upper()
+        more = '..' if length > 4 else ''
+        return f'{name:<8} {code:04X} {"":<20} len={length:<3} {data}{more}'
+    if type == 0x07:
+        res = 'TIMEOUT' if length else 'ok'
+        return f'{name:<8} {"post" if code else "pre":<4} {value} us {res}'
+    if type == 0x08:
+        return f'{name:<8} {MODES.get(code, code)}'
+    if type == 0x09:
+        return f'{name:<8} 0x{value:08X}'
+    if type == 0x0F:
+        return f'{name:<8} {value} events lost'
+    return f'{name:<8} code=0x{code:04X} len={length} value=0x{value:08X}'
+
+def events(stream):
+    buff = b''
+    while True:
+        chunk = stream.read(64)
+        if not chunk:
+            return
+        buff += chunk
+        while True:
+            pos = buff.find(SYNC)
+            if pos < 0:
+                buff = buff[-1:]
+                break
+            if len(buff) < pos + len(SYNC) + EVENT_LEN:
+                buff = buff[pos:]
+                break
+            start = pos + len(SYNC)
+            yield struct.unpack(EVENT_FMT, buff[start:start + EVENT_LEN])
+            buff = buff[start + EVENT_LEN:]
+
+def main():
+    parser = argparse.ArgumentParser(formatter_class=RawTextHelpFormatter, description='''
+        RadioLib trace decoder. Converts binary output of rlb_trace_dump() into a timeline.
+
+        Reading from COM port depends on pyserial, install by:
+        'python3 -m pip install pyserial'
+
+        Step-by-step guide on how to use the script:
+        1. Build your sketch with RADIOLIB_TRACE enabled and call rlb_trace_dump() periodically,
+           e.g. from loop() when the radio is idle. Other output to the same port is skipped.
+        2. Run the script with appropriate arguments.
+    ''')
+    parser.add_argument('input',
+        type=str,
+        help='COM port to connect to the device, or file with captured output ("-" for stdin)')
+    parser.add_argument('--speed',
+        default=DEFAULT_BAUDRATE,
+        type=int,
+        help=f'COM port baudrate (defaults to {DEFAULT_BAUDRATE})')
+    parser.add_argument('--file',
+        action='store_true',
+        help='Read input from file instead of COM port')
+    parser.add_argument('--chip',
+        default='sx126x',
+        choices=CHIPS.keys(),
+        help='Radio chip for naming the commands (defaults to sx126x)')
+    args = parser.parse_args()
+
+    if args.file:
+        stream = sys.stdin.buffer if args.input == '-' else open(args.input, 'rb')
+    else:
+        import serial
+        stream = serial.Serial(args.input, args.speed, timeout=None)
+
+    # timestamps are 32-bit microseconds, unwrap them to keep the timeline monotonic
+    offset = 0
+    prev = None
+    start = None
+    with stream:
+        for ev in events(stream):
+            # overflow is reported when draining, so it only marks a gap in the timeline
+            if ev[2] == 0x0F:
+                print(f'{"":12} {"":9} {decode(ev, CHIPS[args.chip])}')
+                continue
+
+            time = ev[0]
+            if (prev is not None) and (time < prev) and (prev - time > 0x80000000):
+                offset += 1 << 32
+            prev = time
+            time += offset
+            if start is None:
+                start = time
+                last = time
+            print(f'{(time - start)/1e6:12.6f} +{time - last:<8} {decode(ev, CHIPS[args.chip])}')
+            last = time
+
+if __name__ == "__main__":
+    main()
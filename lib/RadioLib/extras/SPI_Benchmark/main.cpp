@@ -0,0 +1,368 @@
+/*
+  Host benchmark of the Module SPI transfer path.
+
+  Runs typical SX126x transfers (register read, IRQ status poll, 255-byte
+  buffer write and read) against the simulated SX1262 from
+  src/hal/Sim/SimHal.h and reports the number of transfers per second,
+  spiTransfer calls per transfer and heap allocations per transfer.
+  Allocations are counted by replacing the global operator new, so the
+  program fails if any transfer allocates.
+
+  With -r, it measures end-to-end readData instead: a second simulated
+  SX1262 transmits packets and the SPI transactions, simulated time and
+  wall-clock time of each readData call are reported.
+
+  With -c, it counts the SPI transactions of SX1276 begin() and of a
+  setSpreadingFactor + setBandwidth hop, to compare builds with and without
+  RADIOLIB_SPI_REG_SHADOW.
+
+  Usage: spi-benchmark [-n iterations] [-f] [-r length] [-c]
+    -n  number of transfers of each type (default 20000), packets with -r (default 500)
+        or hops with -c (default 100)
+    -f  frame mode: the whole frame is passed to spiTransfer at once,
+        like on HALs with hardware chip select (RadioLibHal::spiFramePerTransfer)
+    -r  benchmark readData of packets with the given length
+    -c  count transactions of SX1276 configuration
+*/
+
+#include <hal/Sim/SimHal.h>
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// heap allocations are only counted while a benchmark is running
+static bool countAllocs = false;
+static uint32_t numAllocs = 0;
+
+void* operator new(size_t size) {
+  if(countAllocs) {
+    numAllocs++;
+  }
+  void* ptr = malloc(size ? size : 1);
+  if(!ptr) {
+    throw std::bad_alloc();
+  }
+  return(ptr);
+}
+
+void* operator new[](size_t size) {
+  return(operator new(size));
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept {
+  (void)size;
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t size) noexcept {
+  (void)size;
+  free(ptr);
+}
+
+// simulated HAL that also counts the calls to spiTransfer and chip select assertions
+// (a chain of transactions is a single spiBeginTransaction, so SimHal::spiTransactions counts chains)
+class CountingHal : public SimHal {
+  public:
+    using SimHal::SimHal;
+
+    uint32_t spiCalls = 0;
+    uint32_t csAssertions = 0;
+
+    void clearCounters() {
+      this->spiCalls = 0;
+      this->csAssertions = 0;
+    }
+
+    void digitalWrite(uint32_t pin, uint32_t value) override {
+      if((pin == SIM_PIN_CS) && (value == SIM_LOW)) {
+        this->csAssertions++;
+      }
+      SimHal::digitalWrite(pin, value);
+    }
+
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override {
+      this->spiCalls++;
+      SimHal::spiTransfer(out, len, in);
+    }
+};
+
+enum BenchOp {
+  OP_REG_READ = 0,
+  OP_IRQ_POLL,
+  OP_BUFF_WRITE,
+  OP_BUFF_READ,
+  OP_COUNT
+};
+
+static const char* opNames[OP_COUNT] = { "register read", "IRQ status poll", "buffer write 255 B", "buffer read 255 B" };
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s  %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+static double wallTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec / 1e9);
+}
+
+static int16_t runOp(Module* mod, BenchOp op, uint8_t* tx, uint8_t* rx) {
+  // status is not verified by a separate transaction, only the transfer itself is measured
+  switch(op) {
+    case OP_REG_READ: {
+      const uint8_t cmd[] = { RADIOLIB_SX126X_CMD_READ_REGISTER, 0x07, 0x40 };
+      return(mod->SPIreadStream(cmd, sizeof(cmd), rx, 1, true, false));
+    }
+    case OP_IRQ_POLL:
+      return(mod->SPIreadStream(RADIOLIB_SX126X_CMD_GET_IRQ_STATUS, rx, 2, true, false));
+    case OP_BUFF_WRITE: {
+      const uint8_t cmd[] = { RADIOLIB_SX126X_CMD_WRITE_BUFFER, 0x00 };
+      return(mod->SPIwriteStream(cmd, sizeof(cmd), tx, 255, true, false));
+    }
+    case OP_BUFF_READ: {
+      const uint8_t cmd[] = { RADIOLIB_SX126X_CMD_READ_BUFFER, 0x00 };
+      return(mod->SPIreadStream(cmd, sizeof(cmd), rx, 255, true, false));
+    }
+    default:
+      return(RADIOLIB_ERR_UNKNOWN);
+  }
+}
+
+// switch the HAL to frame mode, returns false if it is not available
+static bool setFrameMode(CountingHal* hal, bool frame) {
+  #if defined(RADIOLIB_SPI_FRAME_SIZE)
+  hal->spiFramePerTransfer = frame;
+  return(true);
+  #else
+  // older versions have no frame mode, frames are always built in a heap buffer
+  (void)hal;
+  if(frame) {
+    printf("frame mode is not available in this RadioLib version\n");
+  }
+  return(!frame);
+  #endif
+}
+
+static void benchTransfers(uint32_t iterations, bool frame) {
+  SimChannel channel;
+  SimSX126x chip(&channel);
+  CountingHal hal(&chip, &channel);
+  if(!setFrameMode(&hal, frame)) {
+    failures++;
+    return;
+  }
+  Module* mod = new Module(&hal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO);
+  SX1262 radio(mod);
+  int16_t state = radio.begin();
+  check(state == RADIOLIB_ERR_NONE, "begin");
+  if(state != RADIOLIB_ERR_NONE) {
+    return;
+  }
+
+  uint8_t tx[255];
+  uint8_t rx[255];
+  for(size_t i = 0; i < sizeof(tx); i++) {
+    tx[i] = (uint8_t)(i * 7 + 1);
+  }
+
+  printf("%s mode, %lu transfers of each type\n", frame ? "frame" : "segment", (unsigned long)iterations);
+  printf("%-20s %14s %14s %14s %14s\n", "transfer", "transfers/s", "transactions", "spiTransfer", "allocations");
+  uint32_t totalAllocs = 0;
+  for(int op = 0; op < OP_COUNT; op++) {
+    hal.clearCounters();
+    numAllocs = 0;
+    countAllocs = true;
+    double start = wallTime();
+    for(uint32_t i = 0; (i < iterations) && (state == RADIOLIB_ERR_NONE); i++) {
+      state = runOp(mod, (BenchOp)op, tx, rx);
+    }
+    double elapsed = wallTime() - start;
+    countAllocs = false;
+    totalAllocs += numAllocs;
+
+    // values per transfer
+    printf("%-20s %14.0f %14.2f %14.2f %14.2f\n", opNames[op], (double)iterations / elapsed,
+           (double)hal.csAssertions / iterations, (double)hal.spiCalls / iterations,
+           (double)numAllocs / iterations);
+  }
+
+  if(state != RADIOLIB_ERR_NONE) {
+    printf("transfer failed with status %d\n", state);
+  }
+  check(state == RADIOLIB_ERR_NONE, "all transfers succeeded");
+  check(memcmp(tx, rx, sizeof(tx)) == 0, "buffer read returns the written data");
+  check(totalAllocs == 0, "transfers do not allocate");
+}
+
+// end-to-end packet read: one radio transmits, the other one reads the packet with readData
+// simulated time includes the SPI bus at 2 MHz and BUSY waits of the chip model
+static void benchReadData(uint32_t packets, bool frame, size_t len) {
+  SimChannel channel;
+  SimSX126x txChip(&channel);
+  SimSX126x rxChip(&channel);
+  CountingHal txHal(&txChip, &channel);
+  CountingHal rxHal(&rxChip, &channel);
+  if(!setFrameMode(&rxHal, frame)) {
+    failures++;
+    return;
+  }
+  SX1262 tx(new Module(&txHal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO));
+  SX1262 rx(new Module(&rxHal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO));
+  int16_t state = tx.begin();
+  check(state == RADIOLIB_ERR_NONE, "transmitter begin");
+  state = rx.begin();
+  check(state == RADIOLIB_ERR_NONE, "receiver begin");
+
+  // fastest modulation, so that most of the run time is spent on reading and not on air
+  SX1262* radios[] = { &tx, &rx };
+  for(size_t i = 0; i < 2; i++) {
+    state = radios[i]->setSpreadingFactor(7);
+    if(state == RADIOLIB_ERR_NONE) {
+      state = radios[i]->setBandwidth(500.0);
+    }
+    check(state == RADIOLIB_ERR_NONE, "configuration");
+  }
+  if(failures) {
+    return;
+  }
+
+  uint8_t out[255];
+  uint8_t in[255];
+  uint32_t received = 0;
+  uint32_t transactions = 0;
+  uint64_t simTime = 0;
+  double wall = 0;
+  for(uint32_t i = 0; (i < packets) && (state == RADIOLIB_ERR_NONE); i++) {
+    for(size_t j = 0; j < len; j++) {
+      out[j] = (uint8_t)(i + j);
+    }
+    state = rx.startReceive();
+    if(state == RADIOLIB_ERR_NONE) {
+      state = tx.transmit(out, len);
+    }
+    if(state != RADIOLIB_ERR_NONE) {
+      break;
+    }
+
+    // only the read itself is measured
+    rxHal.clearCounters();
+    uint64_t simStart = channel.now();
+    double wallStart = wallTime();
+    state = rx.readData(in, len);
+    wall += wallTime() - wallStart;
+    simTime += channel.now() - simStart;
+    transactions += rxHal.csAssertions;
+    if((state == RADIOLIB_ERR_NONE) && (memcmp(in, out, len) == 0)) {
+      received++;
+    }
+  }
+
+  printf("%s mode, readData of %lu packets, %lu bytes each\n", frame ? "frame" : "segment", (unsigned long)packets, (unsigned long)len);
+  printf("%-20s %14s %14s %14s\n", "", "transactions", "simulated us", "wall us");
+  printf("%-20s %14.2f %14.1f %14.2f\n", "per packet", (double)transactions / packets,
+         (double)simTime / packets, wall * 1e6 / packets);
+
+  if(state != RADIOLIB_ERR_NONE) {
+    printf("readData failed with status %d\n", state);
+  }
+  check(received == packets, "all packets received intact");
+}
+
+// SX127x configuration cost: SPI transactions of begin() and of a spreading factor and bandwidth hop
+// register-access modules do read-modify-write of single bits, so these depend on RADIOLIB_SPI_REG_SHADOW
+static void benchConfig(uint32_t hops) {
+  SimChannel channel;
+  SimSX127x chip(&channel);
+  CountingHal hal(&chip, &channel);
+  SX1276 radio(new Module(&hal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO));
+
+  #if defined(RADIOLIB_SPI_REG_SHADOW)
+  printf("SX1276, register shadow %s\n", RADIOLIB_SPI_REG_SHADOW ? "enabled" : "disabled");
+  #else
+  printf("SX1276, no register shadow in this RadioLib version\n");
+  #endif
+  printf("%-28s %14s %14s %14s\n", "", "transactions", "bytes", "simulated us");
+
+  hal.clearCounters();
+  hal.resetStats();
+  uint64_t start = channel.now();
+  int16_t state = radio.begin();
+  printf("%-28s %14lu %14lu %14lu\n", "begin()", (unsigned long)hal.csAssertions, (unsigned long)hal.spiBytes,
+         (unsigned long)(channel.now() - start));
+  check(state == RADIOLIB_ERR_NONE, "begin");
+
+  // hop between two typical settings, e.g. data rates of a LoRaWAN channel plan
+  const uint8_t sf[2] = { 9, 7 };
+  const float bw[2] = { 250.0, 125.0 };
+  hal.clearCounters();
+  hal.resetStats();
+  start = channel.now();
+  for(uint32_t i = 0; (i < hops) && (state == RADIOLIB_ERR_NONE); i++) {
+    state = radio.setSpreadingFactor(sf[i % 2]);
+    if(state == RADIOLIB_ERR_NONE) {
+      state = radio.setBandwidth(bw[i % 2]);
+    }
+  }
+  printf("%-28s %14.1f %14.1f %14.1f\n", "setSpreadingFactor + BW hop", (double)hal.csAssertions / hops,
+         (double)hal.spiBytes / hops, (double)(channel.now() - start) / hops);
+  check(state == RADIOLIB_ERR_NONE, "all hops succeeded");
+}
+
+int main(int argc, char** argv) {
+  uint32_t iterations = 0;
+  bool frame = false;
+  size_t readLen = 0;
+  int opt;
+  bool config = false;
+  while((opt = getopt(argc, argv, "n:fr:c")) != -1) {
+    switch(opt) {
+      case 'n':
+        iterations = strtoul(optarg, NULL, 0);
+        break;
+      case 'f':
+        frame = true;
+        break;
+      case 'r':
+        readLen = strtoul(optarg, NULL, 0);
+        if((readLen == 0) || (readLen > 255)) {
+          fprintf(stderr, "Packet length must be 1 to 255 bytes\n");
+          return(2);
+        }
+        break;
+      case 'c':
+        config = true;
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-n iterations] [-f] [-r length] [-c]\n", argv[0]);
+        return(2);
+    }
+  }
+
+  if(config) {
+    benchConfig(iterations ? iterations : 100);
+  } else if(readLen > 0) {
+    benchReadData(iterations ? iterations : 500, frame, readLen);
+  } else {
+    benchTransfers(iterations ? iterations : 20000, frame);
+  }
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
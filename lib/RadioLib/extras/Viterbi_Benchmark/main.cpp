@@ -0,0 +1,191 @@
+/*
+  Host benchmark of the Viterbi and LR-FHSS decoders.
+
+  Encodes random data with RadioLibConvCode and measures hard- and
+  soft-decision Viterbi decoding for the rate 1/2 and 1/3 codes, with and
+  without channel bit errors. Then LR-FHSS frames built by the transmit path
+  of SX126x are decoded with SX126x::decodeLRFHSSPacket for all coding rates.
+  Throughput is reported as decoded (payload) bits per second, and every
+  decoded frame is compared to the original data.
+
+  The LR-FHSS frames are built by a private method of SX126x, so this program
+  is compiled with RADIOLIB_GODMODE. No radio is needed, the SX1262 instance
+  only holds the LR-FHSS configuration.
+
+  Usage: viterbi-benchmark [-n count]
+    -n  number of frames decoded for each measurement (default 500)
+*/
+
+#include <hal/Sim/SimHal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// length of the convolutional coded frames in bits
+#define CONV_DATA_BITS    (1024)
+
+static uint32_t rng = 1;
+
+// xorshift32, so that runs are repeatable
+static uint32_t random32() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return(rng);
+}
+
+static double wallTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec / 1e9);
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if(!ok) {
+    failures++;
+  }
+}
+
+// number of differing bits in the first len bits, both buffers are MSB first
+static size_t bitErrors(const uint8_t* a, const uint8_t* b, size_t len) {
+  size_t errors = 0;
+  for(size_t i = 0; i < len; i++) {
+    errors += GET_BIT_IN_ARRAY_LSB(a, i) != GET_BIT_IN_ARRAY_LSB(b, i);
+  }
+  return(errors);
+}
+
+// decode the same coded frame count times, returns decoded bits per second and the output bit errors of the last run
+static double benchConv(uint8_t rate, bool soft, const uint8_t* coded, size_t codedBits, const uint8_t* data, int count, size_t* errors) {
+  uint8_t decoded[CONV_DATA_BITS/8 + 1];
+  size_t decodedBits = 0;
+  double start = wallTime();
+  for(int i = 0; i < count; i++) {
+    RadioLibConvCodeInstance.begin(rate);
+    if(soft) {
+      RadioLibConvCodeInstance.decodeSoft(coded, codedBits, decoded, &decodedBits);
+    } else {
+      RadioLibConvCodeInstance.decode(coded, codedBits, decoded, &decodedBits);
+    }
+  }
+  double elapsed = wallTime() - start;
+  *errors = (decodedBits == CONV_DATA_BITS) ? bitErrors(data, decoded, CONV_DATA_BITS) : CONV_DATA_BITS;
+  return((double)count*CONV_DATA_BITS/elapsed);
+}
+
+int main(int argc, char** argv) {
+  int count = 500;
+  int opt;
+  while((opt = getopt(argc, argv, "n:")) != -1) {
+    switch(opt) {
+      case 'n':
+        count = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n count]\n", argv[0]);
+        return(1);
+    }
+  }
+  if(count < 1) {
+    count = 1;
+  }
+
+  // convolutional code alone, the channel flips the given fraction of coded bits
+  int convErrors = 0;
+  const uint8_t rates[] = { 2, 3 };
+  const double bers[] = { 0, 0.01, 0.05 };
+  printf("%-6s %5s %-5s %14s %12s\n", "rate", "BER", "input", "decoded bit/s", "bit errors");
+  for(size_t r = 0; r < sizeof(rates)/sizeof(rates[0]); r++) {
+    for(size_t b = 0; b < sizeof(bers)/sizeof(bers[0]); b++) {
+      uint8_t data[CONV_DATA_BITS/8];
+      for(size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)random32();
+      }
+
+      uint8_t coded[3*CONV_DATA_BITS/8 + 3] = { 0 };
+      size_t codedBits = 0;
+      RadioLibConvCodeInstance.begin(rates[r]);
+      RadioLibConvCodeInstance.encode(data, CONV_DATA_BITS, coded, &codedBits);
+
+      // hard input is the coded bits, soft input is one byte per coded bit, both with the same errors
+      uint8_t softIn[3*CONV_DATA_BITS];
+      for(size_t i = 0; i < codedBits; i++) {
+        if((double)random32() / 4294967296.0 < bers[b]) {
+          coded[i/8] ^= (1 << (7 - (i % 8)));
+        }
+        softIn[i] = GET_BIT_IN_ARRAY_LSB(coded, i) ? 255 : 0;
+      }
+
+      for(int soft = 0; soft < 2; soft++) {
+        size_t errors = 0;
+        double rate = benchConv(rates[r], soft, soft ? softIn : coded, codedBits, data, count, &errors);
+        printf("1/%-4u %5.2f %-5s %14.0f %12u\n", rates[r], bers[b], soft ? "soft" : "hard", rate, (unsigned)errors);
+        if((bers[b] == 0) && (errors != 0)) {
+          convErrors++;
+        }
+      }
+    }
+  }
+
+  // LR-FHSS frames as built for transmission, the radio is never started
+  SimChannel channel;
+  SimSX126x chip(&channel);
+  SimHal hal(&chip, &channel);
+  SX1262 radio(new Module(&hal, SIM_PIN_CS, SIM_PIN_IRQ, SIM_PIN_RST, SIM_PIN_GPIO));
+
+  const uint8_t crs[] = { RADIOLIB_SX126X_LR_FHSS_CR_5_6, RADIOLIB_SX126X_LR_FHSS_CR_2_3,
+                          RADIOLIB_SX126X_LR_FHSS_CR_1_2, RADIOLIB_SX126X_LR_FHSS_CR_1_3 };
+  const char* crNames[] = { "5/6", "2/3", "1/2", "1/3" };
+  const size_t lens[] = { 16, 48 };
+  int lrErrors = 0;
+  printf("\n%-4s %7s %11s %10s %14s\n", "CR", "payload", "frame bits", "frames/s", "payload bit/s");
+  for(size_t c = 0; c < sizeof(crs)/sizeof(crs[0]); c++) {
+    radio.setLrFhssConfig(RADIOLIB_SX126X_LR_FHSS_BW_136_72, crs[c], 3);
+    for(size_t l = 0; l < sizeof(lens)/sizeof(lens[0]); l++) {
+      uint8_t payload[64];
+      for(size_t i = 0; i < lens[l]; i++) {
+        payload[i] = (uint8_t)random32();
+      }
+
+      // build the frame, the payload buffer is reused by the builder, so it is copied first
+      uint8_t frame[RADIOLIB_SX126X_MAX_PACKET_LENGTH] = { 0 };
+      uint8_t in[64];
+      memcpy(in, payload, lens[l]);
+      size_t frameLen = 0;
+      size_t frameBits = 0;
+      size_t frameHops = 0;
+      int16_t state = radio.buildLRFHSSPacket(in, lens[l], frame, &frameLen, &frameBits, &frameHops);
+      if(state != RADIOLIB_ERR_NONE) {
+        printf("%-4s %7u frame could not be built, code %d\n", crNames[c], (unsigned)lens[l], state);
+        lrErrors++;
+        continue;
+      }
+
+      uint8_t out[RADIOLIB_SX126X_MAX_PACKET_LENGTH];
+      size_t outLen = 0;
+      double start = wallTime();
+      for(int i = 0; i < count; i++) {
+        state = SX126x::decodeLRFHSSPacket(frame, frameBits, out, &outLen);
+      }
+      double elapsed = wallTime() - start;
+      printf("%-4s %7u %11u %10.0f %14.0f\n", crNames[c], (unsigned)lens[l], (unsigned)frameBits,
+             count/elapsed, (double)count*lens[l]*8/elapsed);
+      if((state != RADIOLIB_ERR_NONE) || (outLen != lens[l]) || (memcmp(out, payload, outLen) != 0)) {
+        lrErrors++;
+      }
+    }
+  }
+
+  printf("\n");
+  check(convErrors == 0, "Viterbi decoding without channel errors is bit-exact");
+  check(lrErrors == 0, "LR-FHSS frames are decoded bit-exactly");
+
+  printf("result: %s\n", failures ? "FAIL" : "PASS");
+  return(failures ? 1 : 0);
+}
@@ -46,6 +46,18 @@
   #define RADIOLIB_SPI_PARANOID (1)
 #endif
 
+/*
+ * Register shadow for register-access modules (currently SX127x), set RADIOLIB_SPI_REG_SHADOW to 1 to enable.
+ * Configuration registers are cached in RAM, so that unchanged writes and repeated reads do not need SPI access.
+ * The shadow is write-through and is invalidated on reset and sleep. Costs 144 bytes of RAM per module.
+ * Warning: Registers changed behind RadioLib's back (brown-out, reset without calling reset(),
+ *          another driver on the same module) are not detected until the next sleep or reset.
+ * Note: Disabled by default.
+ */
+#if !defined(RADIOLIB_SPI_REG_SHADOW)
+  #define RADIOLIB_SPI_REG_SHADOW (0)
+#endif
+
 /*
  * Comment to disable parameter range checking
  * RadioLib will check provided parameters (such as frequency) against limits determined by the device manufacturer.
@@ -112,6 +124,109 @@
   #define RADIOLIB_STATIC_SPI_ARRAY_SIZE   (3*sizeof(uint32_t) + (RADIOLIB_STATIC_ARRAY_SIZE))
 #endif
 
+// size of the per-module scratch buffer used for SPI transfers
+// payload is clocked directly to/from the caller's buffer, the scratch only supplies NOP bytes
+// and absorbs unused input, in chunks of this size - so SPI transfers never allocate
+#if !defined(RADIOLIB_SPI_SCRATCH_SIZE)
+  #define RADIOLIB_SPI_SCRATCH_SIZE   (32)
+#endif
+
+// size of the per-module frame buffer, only used by HALs that need the whole SPI frame
+// in a single spiTransfer call (RadioLibHal::spiFramePerTransfer, e.g. Raspberry Pi)
+// longer frames are rejected, Arduino HALs never need it, so it is disabled there by default
+#if !defined(RADIOLIB_SPI_FRAME_SIZE)
+  #if ARDUINO >= 100
+    #define RADIOLIB_SPI_FRAME_SIZE   (0)
+  #else
+    // same as RADIOLIB_STATIC_SPI_ARRAY_SIZE, but usable in preprocessor conditions
+    #define RADIOLIB_SPI_FRAME_SIZE   (3*4 + (RADIOLIB_STATIC_ARRAY_SIZE))
+  #endif
+#endif
+
+// maximum number of transactions in a single chained SPI transfer (Module::SPItransferChain)
+#if !defined(RADIOLIB_SPI_CHAIN_SIZE)
+  #define RADIOLIB_SPI_CHAIN_SIZE   (4)
+#endif
+
+// time in microseconds to busy-spin when waiting for GPIO (e.g. BUSY) before yielding or blocking on interrupt
+#if !defined(RADIOLIB_GPIO_WAIT_SPIN_US)
+  #define RADIOLIB_GPIO_WAIT_SPIN_US   (100)
+#endif
+
+// fixed delays in microseconds used instead of waiting for GPIO, when the module has no GPIO (BUSY) pin connected
+#if !defined(RADIOLIB_GPIO_NC_DELAY_PRE_US)
+  #define RADIOLIB_GPIO_NC_DELAY_PRE_US   (50000)
+#endif
+#if !defined(RADIOLIB_GPIO_NC_DELAY_POST_US)
+  #define RADIOLIB_GPIO_NC_DELAY_POST_US  (1000)
+#endif
+
+/*
+ * Collect per-command statistics of time spent waiting for GPIO (e.g. BUSY), see Module::getGpioWaitStats.
+ * Up to RADIOLIB_GPIO_WAIT_STATS_SIZE distinct commands are tracked.
+ */
+#if !defined(RADIOLIB_GPIO_WAIT_STATS)
+  #define RADIOLIB_GPIO_WAIT_STATS  (0)
+#endif
+#if !defined(RADIOLIB_GPIO_WAIT_STATS_SIZE)
+  #define RADIOLIB_GPIO_WAIT_STATS_SIZE   (16)
+#endif
+
+/*
+ * Collect per-command SPI statistics, see Module::getSPIStats and Module::dumpSPIStats.
+ * For every command (or register for register accesses) the number of transfers and bytes is counted,
+ * and latency histograms are kept for GPIO wait before the transfer, the transfer itself and GPIO wait after it.
+ * Histogram bin n counts latencies shorter than 4^(n+1) microseconds, the last bin counts all the longer ones.
+ * Up to RADIOLIB_SPI_STATS_SIZE distinct commands/registers are tracked.
+ * Independent of RADIOLIB_GPIO_WAIT_STATS, which attributes wait before a transfer to the previous command.
+ */
+#if !defined(RADIOLIB_SPI_STATS)
+  #define RADIOLIB_SPI_STATS  (0)
+#endif
+#if !defined(RADIOLIB_SPI_STATS_SIZE)
+  #define RADIOLIB_SPI_STATS_SIZE   (24)
+#endif
+#if !defined(RADIOLIB_SPI_STATS_BINS)
+  #define RADIOLIB_SPI_STATS_BINS   (8)
+#endif
+
+/*
+ * Binary trace of SPI transfers, GPIO waits, mode transitions and IRQ flags, see utils/Trace.h.
+ * Events are only stored in a RAM ring buffer and have to be drained by the user (e.g. by rlb_trace_dump()),
+ * so unlike RADIOLIB_DEBUG_SPI, this does not disturb timing of the traced code.
+ * Output can be decoded by extras/RadioLib_Trace/TraceDecoder.py.
+ * RADIOLIB_TRACE_SIZE is the number of 12-byte events in the buffer, must be a power of 2.
+ */
+#if !defined(RADIOLIB_TRACE)
+  #define RADIOLIB_TRACE  (0)
+#endif
+#if !defined(RADIOLIB_TRACE_SIZE)
+  #define RADIOLIB_TRACE_SIZE   (128)
+#endif
+
+/*
+ * AES-128 core implementation used by RadioLibAES128 (LoRaWAN encryption and MIC).
+ * RADIOLIB_AES_CORE_BYTE - compact byte-oriented implementation.
+ * RADIOLIB_AES_CORE_TTABLE - 32-bit T-table implementation, fastest encryption, but needs extra 1 kB lookup table.
+ *                            Table lookups depend on secret data, so it should not be used where timing side channels matter.
+ *                            Decryption is not accelerated, as it is not used by any of the protocols.
+ * RADIOLIB_AES_CORE_BITSLICED - constant-time implementation with bitsliced S-box and no secret-dependent lookups or branches.
+ *                               Slowest of the three, for deployments that care about side channels.
+ * Note: Byte-oriented core is used by default.
+ */
+#define RADIOLIB_AES_CORE_BYTE        (0)
+#define RADIOLIB_AES_CORE_TTABLE      (1)
+#define RADIOLIB_AES_CORE_BITSLICED   (2)
+#if !defined(RADIOLIB_AES_CORE)
+  #define RADIOLIB_AES_CORE   (RADIOLIB_AES_CORE_BYTE)
+#endif
+
+// maximum payload length kept by each entry of the PhysicalLayer receive queue,
+// longer packets are truncated
+#if !defined(RADIOLIB_RX_QUEUE_PACKET_LEN)
+  #define RADIOLIB_RX_QUEUE_PACKET_LEN   (RADIOLIB_STATIC_ARRAY_SIZE)
+#endif
+
 /*
  * Uncomment on boards whose clock runs too slow or too fast
  * Set the value according to the following scheme:
@@ -221,11 +336,20 @@
   // ESP8266 boards
   #define RADIOLIB_PLATFORM                           "ESP8266"
 
+  // SPIClass can clock the whole buffer through the hardware FIFO
+  #define RADIOLIB_SPI_TRANSFER_BYTES
+
 #elif defined(ESP32) || defined(ARDUINO_ARCH_ESP32)
   #define RADIOLIB_ESP32
 
   // ESP32 boards
   #define RADIOLIB_PLATFORM                           "ESP32"
+
+  // SPIClass can clock the whole buffer through the hardware FIFO
+  #define RADIOLIB_SPI_TRANSFER_BYTES
+
+  // GPIO waits can block on pin interrupt and FreeRTOS semaphore
+  #define RADIOLIB_GPIO_WAIT_IRQ
   
   // ESP32 doesn't support tone(), but it can be emulated via LED control peripheral
   #define RADIOLIB_TONE_UNSUPPORTED
@@ -618,6 +742,19 @@
   #define RADIOLIB_ERRATA_SX127X(...) {}
 #endif
 
+/*!
+  \brief Acquire load and release store, used to hand over data between an interrupt (or another core) and the main code,
+  e.g. in single-producer single-consumer queues. The data must be written before the index is published with a release store,
+  and the index must be read with an acquire load before the data is accessed.
+*/
+#if defined(__GNUC__)
+  #define RADIOLIB_ATOMIC_LOAD_ACQUIRE(PTR)         __atomic_load_n((PTR), __ATOMIC_ACQUIRE)
+  #define RADIOLIB_ATOMIC_STORE_RELEASE(PTR, VAL)   __atomic_store_n((PTR), (VAL), __ATOMIC_RELEASE)
+#else
+  #define RADIOLIB_ATOMIC_LOAD_ACQUIRE(PTR)         (*(PTR))
+  #define RADIOLIB_ATOMIC_STORE_RELEASE(PTR, VAL)   { *(PTR) = (VAL); }
+#endif
+
 // these macros are usually defined by Arduino, but some platforms undef them, so its safer to use our own
 #define RADIOLIB_MIN(a,b)				((a)<(b)?(a):(b))
 #define RADIOLIB_MAX(a,b)				((a)>(b)?(a):(b))
@@ -47,6 +47,79 @@ void RadioLibHal::pullUpDown(uint32_t pin, bool enable, bool up) {
   (void)up;
 }
 
+bool RadioLibHal::waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) {
+  // most commands finish within a few tens of microseconds, so spin for a while first
+  // longer waits (calibration, wake up from sleep) yield to other threads
+  RadioLibTime_t start = this->micros();
+  while((this->digitalRead(pin) != 0) != (level != 0)) {
+    RadioLibTime_t elapsed = this->micros() - start;
+    if(elapsed >= timeout) {
+      return(false);
+    }
+    if(elapsed >= RADIOLIB_GPIO_WAIT_SPIN_US) {
+      this->yield();
+    }
+  }
+  return(true);
+}
+
+size_t RadioLibHal::spiTransferChain(const RadioLibSpiSegment_t* segs, size_t num, uint32_t csPin, uint32_t gpioPin, RadioLibTime_t timeout) {
+  // scratch buffer used when the received data should be discarded
+  uint8_t discard[16];
+  size_t done = 0;
+  bool selected = false;
+
+  this->spiBeginTransaction();
+  for(size_t i = 0; i < num; i++) {
+    const RadioLibSpiSegment_t* seg = &segs[i];
+    if(!selected) {
+      // wait for the GPIO before every transaction except the first one
+      if(done > 0) {
+        if(gpioPin == RADIOLIB_NC) {
+          this->delay(RADIOLIB_GPIO_NC_DELAY_POST_US / 1000);
+          this->delayMicroseconds(RADIOLIB_GPIO_NC_DELAY_POST_US % 1000);
+        } else {
+          this->delayMicroseconds(1);
+          if(!this->waitForPin(gpioPin, this->GpioLevelLow, timeout*1000UL)) {
+            this->spiEndTransaction();
+            return(done);
+          }
+        }
+      }
+      this->digitalWrite(csPin, this->GpioLevelLow);
+      selected = true;
+    }
+
+    // HAL interface is not const-correct, but output buffer is never written to unless it is also the input
+    uint8_t* out = const_cast<uint8_t*>(seg->out);
+    if(seg->in != NULL) {
+      this->spiTransfer(out, seg->len, seg->in);
+    } else {
+      for(size_t pos = 0; pos < seg->len; pos += sizeof(discard)) {
+        size_t chunk = seg->len - pos;
+        if(chunk > sizeof(discard)) {
+          chunk = sizeof(discard);
+        }
+        this->spiTransfer(&out[pos], chunk, discard);
+      }
+    }
+
+    if(seg->last) {
+      this->digitalWrite(csPin, this->GpioLevelHigh);
+      selected = false;
+      done++;
+    }
+  }
+
+  // release chip select in case the last segment was not marked
+  if(selected) {
+    this->digitalWrite(csPin, this->GpioLevelHigh);
+    done++;
+  }
+  this->spiEndTransaction();
+  return(done);
+}
+
 RadioLibTime_t rlb_time_us() {
   return(rlb_timestamp_hal == nullptr ? 0 : rlb_timestamp_hal->micros());
 }
@@ -9,6 +9,24 @@
 /*! \brief Global-scope function that returns timestamp since start (in microseconds). */
 RadioLibTime_t rlb_time_us();
 
+/*!
+  \struct RadioLibSpiSegment_t
+  \brief One element of a chain of SPI transfers, see RadioLibHal::spiTransferChain.
+*/
+struct RadioLibSpiSegment_t {
+  /*! \brief Data to send, must not be NULL. */
+  const uint8_t* out;
+
+  /*! \brief Buffer to save received data into, may be the same as out. Set to NULL to discard received data. */
+  uint8_t* in;
+
+  /*! \brief Number of bytes to transfer. */
+  size_t len;
+
+  /*! \brief Whether this is the last segment of a transaction, chip select will be released after it. */
+  bool last;
+};
+
 /*!
   \class RadioLibHal
   \brief Hardware abstraction library base interface.
@@ -49,6 +67,14 @@ class RadioLibHal {
     */
     const uint32_t GpioInterruptFalling;
 
+    /*!
+      \brief Set to true by platforms where chip select is driven by the SPI peripheral for each spiTransfer call
+      (e.g. lgSpiXfer on Raspberry Pi), rather than by digitalWrite. Every SPI frame is then assembled
+      in the per-module frame buffer (RADIOLIB_SPI_FRAME_SIZE) and passed to spiTransfer at once,
+      instead of being clocked in several parts. Chained transactions are sent one by one, without spiTransferChain.
+    */
+    bool spiFramePerTransfer = false;
+
     /*!
       \brief Default constructor.
       \param input Value to be used as the "input" GPIO direction.
@@ -157,9 +183,10 @@ class RadioLibHal {
 
     /*!
       \brief Method to transfer buffer over SPI.
+      The whole buffer should be transferred at once if the platform allows it.
       \param out Buffer to send.
       \param len Number of data to send or receive.
-      \param in Buffer to save received data into.
+      \param in Buffer to save received data into. May be the same as out, in which case the data is transferred in-place.
     */
     virtual void spiTransfer(uint8_t* out, size_t len, uint8_t* in) = 0;
 
@@ -223,6 +250,32 @@ class RadioLibHal {
       \param up Pull direction, true for pull up, false for pull down.
     */
     virtual void pullUpDown(uint32_t pin, bool enable, bool up);
+
+    /*!
+      \brief Wait for a pin to reach the given logic level, e.g. for BUSY line to go low.
+      The default implementation busy-spins for RADIOLIB_GPIO_WAIT_SPIN_US and then keeps polling with yield.
+      Platforms with RTOS may override it to block on a pin interrupt instead.
+      \param pin Pin to wait for.
+      \param level Logic level to wait for, GpioLevelLow or GpioLevelHigh.
+      \param timeout Timeout in microseconds.
+      \returns True when the level was reached, false on timeout.
+    */
+    virtual bool waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout);
+
+    /*!
+      \brief Method to perform a chain of SPI transactions back-to-back, within a single SPI transaction.
+      Chip select is asserted at the start of each transaction and released after its last segment.
+      Before each transaction except the first, the method waits for the GPIO pin (e.g. BUSY) to go low.
+      Waiting for GPIO before the first and after the last transaction is left up to the caller.
+      The default implementation uses spiTransfer, platforms with queued or DMA transfers may override it.
+      \param segs Segments to transfer.
+      \param num Number of segments.
+      \param csPin Chip select pin.
+      \param gpioPin Pin to wait for between transactions, RADIOLIB_NC to wait a fixed time instead.
+      \param timeout GPIO timeout in milliseconds.
+      \returns Number of transactions completed, less than the number of transactions in the chain if GPIO timed out.
+    */
+    virtual size_t spiTransferChain(const RadioLibSpiSegment_t* segs, size_t num, uint32_t csPin, uint32_t gpioPin, RadioLibTime_t timeout);
 };
 
 #endif
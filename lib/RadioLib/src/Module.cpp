@@ -34,6 +34,7 @@ Module& Module::operator=(const Module& mod) {
 }
 
 static volatile const char info[] = RADIOLIB_INFO;
+
 void Module::init() {
   this->hal->init();
   this->hal->pinMode(csPin, this->hal->GpioModeOutput);
@@ -82,6 +83,10 @@ int16_t Module::SPIsetRegValue(uint32_t reg, uint8_t value, uint8_t msb, uint8_t
     uint8_t readValue = 0x00;
     #endif
     while(this->hal->micros() - start < ((RadioLibTime_t)checkInterval * 1000UL)) {
+      #if RADIOLIB_SPI_REG_SHADOW
+      // verification has to read the actual register, not the shadow
+      this->regShadowDrop(reg);
+      #endif
       uint8_t val = SPIreadRegister(reg);
       if((val & checkMask) == (newValue & checkMask)) {
         // check passed, we can stop the loop
@@ -111,6 +116,9 @@ int16_t Module::SPIsetRegValue(uint32_t reg, uint8_t value, uint8_t msb, uint8_t
 void Module::SPIreadRegisterBurst(uint32_t reg, size_t numBytes, uint8_t* inBytes) {
   if(!this->spiConfig.stream) {
     SPItransfer(this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ], reg, NULL, inBytes, numBytes);
+    #if RADIOLIB_SPI_REG_SHADOW
+    this->regShadowUpdate(reg, inBytes, numBytes);
+    #endif
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -127,7 +135,16 @@ void Module::SPIreadRegisterBurst(uint32_t reg, size_t numBytes, uint8_t* inByte
 uint8_t Module::SPIreadRegister(uint32_t reg) {
   uint8_t resp = 0;
   if(!spiConfig.stream) {
+    #if RADIOLIB_SPI_REG_SHADOW
+    // only cacheable registers are ever marked as valid
+    if((this->regShadowValid != NULL) && (reg < this->regShadowNum) && (this->regShadowValid[reg / 8] & (1 << (reg % 8)))) {
+      return(this->regShadow[reg]);
+    }
+    #endif
     SPItransfer(this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ], reg, NULL, &resp, 1);
+    #if RADIOLIB_SPI_REG_SHADOW
+    this->regShadowUpdate(reg, &resp, 1);
+    #endif
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -145,6 +162,9 @@ uint8_t Module::SPIreadRegister(uint32_t reg) {
 void Module::SPIwriteRegisterBurst(uint32_t reg, const uint8_t* data, size_t numBytes) {
   if(!spiConfig.stream) {
     SPItransfer(spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE], reg, data, NULL, numBytes);
+    #if RADIOLIB_SPI_REG_SHADOW
+    this->regShadowUpdate(reg, data, numBytes);
+    #endif
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -161,6 +181,9 @@ void Module::SPIwriteRegisterBurst(uint32_t reg, const uint8_t* data, size_t num
 void Module::SPIwriteRegister(uint32_t reg, uint8_t data) {
   if(!spiConfig.stream) {
     SPItransfer(spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE], reg, &data, NULL, 1);
+    #if RADIOLIB_SPI_REG_SHADOW
+    this->regShadowUpdate(reg, &data, 1);
+    #endif
   } else {
     uint8_t cmd[6];
     uint8_t* cmdPtr = cmd;
@@ -174,66 +197,114 @@ void Module::SPIwriteRegister(uint32_t reg, uint8_t data) {
   }
 }
 
-void Module::SPItransfer(uint16_t cmd, uint32_t reg, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes) {
-  // prepare the buffers
-  size_t buffLen = this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD]/8 + this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR]/8 + numBytes;
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffOut[RADIOLIB_STATIC_SPI_ARRAY_SIZE];
-    uint8_t buffIn[RADIOLIB_STATIC_SPI_ARRAY_SIZE];
-  #else
-    uint8_t* buffOut = new uint8_t[buffLen];
-    uint8_t* buffIn = new uint8_t[buffLen];
-  #endif
-  uint8_t* buffOutPtr = buffOut;
+#if RADIOLIB_SPI_REG_SHADOW
+void Module::SPIsetRegShadow(uint8_t* values, uint8_t* valid, const uint8_t* cacheable, size_t numRegs) {
+  if((values == NULL) || (valid == NULL) || (cacheable == NULL)) {
+    this->regShadow = NULL;
+    this->regShadowValid = NULL;
+    this->regShadowMask = NULL;
+    this->regShadowNum = 0;
+    return;
+  }
+
+  this->regShadow = values;
+  this->regShadowValid = valid;
+  this->regShadowMask = cacheable;
+  this->regShadowNum = numRegs;
+  this->SPIinvalidateRegShadow();
+}
 
-  // copy the command
+void Module::SPIinvalidateRegShadow() {
+  if(this->regShadowValid != NULL) {
+    memset(this->regShadowValid, 0x00, (this->regShadowNum + 7) / 8);
+  }
+}
+
+bool Module::regShadowCacheable(uint32_t reg) {
+  if((this->regShadowMask == NULL) || (reg >= this->regShadowNum)) {
+    return(false);
+  }
+  uint8_t* ptr = const_cast<uint8_t*>(&this->regShadowMask[reg / 8]);
+  return(RADIOLIB_NONVOLATILE_READ_BYTE(ptr) & (1 << (reg % 8)));
+}
+
+void Module::regShadowDrop(uint32_t reg) {
+  if((this->regShadowValid != NULL) && (reg < this->regShadowNum)) {
+    this->regShadowValid[reg / 8] &= ~(1 << (reg % 8));
+  }
+}
+
+void Module::regShadowUpdate(uint32_t reg, const uint8_t* data, size_t numBytes) {
+  // burst access to a non-cacheable register (e.g. FIFO) does not auto-increment the address
+  if((data == NULL) || !this->regShadowCacheable(reg)) {
+    return;
+  }
+
+  for(size_t i = 0; i < numBytes; i++) {
+    uint32_t addr = reg + i;
+    if(this->regShadowCacheable(addr)) {
+      this->regShadow[addr] = data[i];
+      this->regShadowValid[addr / 8] |= (1 << (addr % 8));
+    } else {
+      this->regShadowDrop(addr);
+    }
+  }
+}
+#endif
+
+void Module::SPItransfer(uint16_t cmd, uint32_t reg, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes) {
+  // prepare the address/command header
   // TODO properly handle variable commands and addresses
+  uint8_t header[2];
+  size_t headerLen = 0;
   if(this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR] <= 8) {
-    *(buffOutPtr++) = reg | cmd;
+    header[headerLen++] = reg | cmd;
   } else {
-    *(buffOutPtr++) = (reg >> 8) | cmd;
-    *(buffOutPtr++) = reg & 0xFF;
+    header[headerLen++] = (reg >> 8) | cmd;
+    header[headerLen++] = reg & 0xFF;
   }
 
-  // copy the data
-  if(cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE]) {
-    memcpy(buffOutPtr, dataOut, numBytes);
-  } else {
-    memset(buffOutPtr, this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], numBytes);
-  }
+  // data is transferred directly from/to the caller buffer
+  bool write = (cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE]);
+  bool read = (cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ]);
 
   // do the transfer
+  #if RADIOLIB_SPI_STATS
+  RadioLibTime_t start = this->hal->micros();
+  #endif
   this->hal->spiBeginTransaction();
   this->hal->digitalWrite(this->csPin, this->hal->GpioLevelLow);
-  this->hal->spiTransfer(buffOut, buffLen, buffIn);
+  // SPI transfer method has no status to return, a rejected frame is only reported in debug output
+  (void)this->SPItransferFrame(header, headerLen, 0, write ? dataOut : NULL, read ? dataIn : NULL, numBytes, NULL);
   this->hal->digitalWrite(this->csPin, this->hal->GpioLevelHigh);
   this->hal->spiEndTransaction();
-  
-  // copy the data
-  if(cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ]) {
-    memcpy(dataIn, &buffIn[this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR]/8], numBytes);
+  this->spiTransactions++;
+  #if RADIOLIB_SPI_STATS
+  RadioLibTime_t bus = this->hal->micros() - start;
+  this->spiStatsAdd(this->spiStatsEntry(reg, write ? SPI_STATS_REG_WRITE : SPI_STATS_REG_READ), numBytes, NULL, &bus, NULL);
+  #endif
+
+  #if RADIOLIB_TRACE
+  if(write || read) {
+    RADIOLIB_TRACE_DATA(write ? RADIOLIB_TRACE_SPI_REG_WRITE : RADIOLIB_TRACE_SPI_REG_READ, reg, write ? dataOut : dataIn, numBytes);
   }
+  #endif
 
   // print debug information
   #if RADIOLIB_DEBUG_SPI
     const uint8_t* debugBuffPtr = NULL;
-    if(cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE]) {
+    if(write) {
       RADIOLIB_DEBUG_SPI_PRINT("W\t%X\t", reg);
-      debugBuffPtr = &buffOut[this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR]/8];
-    } else if(cmd == spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ]) {
+      debugBuffPtr = dataOut;
+    } else if(read) {
       RADIOLIB_DEBUG_SPI_PRINT("R\t%X\t", reg);
-      debugBuffPtr = &buffIn[this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR]/8];
+      debugBuffPtr = dataIn;
     }
-    for(size_t n = 0; n < numBytes; n++) {
+    for(size_t n = 0; (debugBuffPtr != NULL) && (n < numBytes); n++) {
       RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%X\t", debugBuffPtr[n]);
     }
     RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG("");
   #endif
-
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] buffOut;
-    delete[] buffIn;
-  #endif
 }
 
 int16_t Module::SPIreadStream(uint16_t cmd, uint8_t* data, size_t numBytes, bool waitForGpio, bool verify) {
@@ -316,101 +387,60 @@ int16_t Module::SPIcheckStream() {
 }
 
 int16_t Module::SPItransferStream(const uint8_t* cmd, uint8_t cmdLen, bool write, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio) {
-  // prepare the output buffer
+  // the frame consists of the command, status bytes (only for reads) and data
+  // data is transferred directly from/to the caller buffer, so there is no need to build the frame in memory
   int16_t state = RADIOLIB_ERR_NONE;
-  size_t buffLen = cmdLen + numBytes;
-  if(!write) {
-    buffLen += (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8);
-  }
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffOut[RADIOLIB_STATIC_SPI_ARRAY_SIZE];
-  #else
-    uint8_t* buffOut = new uint8_t[buffLen];
-  #endif
-  uint8_t* buffOutPtr = buffOut;
-
-  // copy the command
-  for(uint8_t n = 0; n < cmdLen; n++) {
-    *(buffOutPtr++) = cmd[n];
-  }
-
-  // copy the data
-  if(write) {
-    memcpy(buffOutPtr, dataOut, numBytes);
-  } else {
-    memset(buffOutPtr, this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], numBytes + (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8));
-  }
+  size_t statusLen = write ? 0 : (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8);
 
   // ensure GPIO is low
+  #if RADIOLIB_SPI_STATS
+  RadioLibTime_t times[4];
+  times[0] = this->hal->micros();
+  #endif
   if(waitForGpio) {
-    if(this->gpioPin == RADIOLIB_NC) {
-      this->hal->delay(50);
-    } else {
-      RadioLibTime_t start = this->hal->millis();
-      while(this->hal->digitalRead(this->gpioPin)) {
-        this->hal->yield();
-
-        // this timeout check triggers a false positive from cppcheck
-        // cppcheck-suppress unsignedLessThanZero
-        if(this->hal->millis() - start >= this->spiConfig.timeout) {
-          RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO pre-transfer timeout, is it connected?");
-          #if !RADIOLIB_STATIC_ONLY
-            delete[] buffOut;
-          #endif
-          return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
-        }
-      
-      }
-    }
+    state = this->SPIwaitForGpio(false);
+    RADIOLIB_ASSERT(state);
   }
 
-  // prepare the input buffer
-  #if RADIOLIB_STATIC_ONLY
-    uint8_t buffIn[RADIOLIB_STATIC_SPI_ARRAY_SIZE];
-  #else
-    uint8_t* buffIn = new uint8_t[buffLen];
+  #if RADIOLIB_GPIO_WAIT_STATS
+  this->gpioWaitStatsSetCmd(cmd, cmdLen);
   #endif
 
   // do the transfer
+  #if RADIOLIB_SPI_STATS
+  times[1] = this->hal->micros();
+  #endif
+  uint8_t status = 0;
   this->hal->spiBeginTransaction();
   this->hal->digitalWrite(this->csPin, this->hal->GpioLevelLow);
-  this->hal->spiTransfer(buffOut, buffLen, buffIn);
+  int16_t frameState = this->SPItransferFrame(cmd, cmdLen, statusLen, write ? dataOut : NULL, write ? NULL : dataIn, numBytes, &status);
   this->hal->digitalWrite(this->csPin, this->hal->GpioLevelHigh);
   this->hal->spiEndTransaction();
+  RADIOLIB_ASSERT(frameState);
+  this->spiTransactions++;
+  #if RADIOLIB_TRACE
+  this->SPItraceStream(write ? RADIOLIB_TRACE_SPI_CMD_WRITE : RADIOLIB_TRACE_SPI_CMD_READ, cmd, cmdLen, write ? dataOut : dataIn, numBytes);
+  #endif
 
   // wait for GPIO to go high and then low
+  // do not return yet on timeout to display the debug output
+  #if RADIOLIB_SPI_STATS
+  times[2] = this->hal->micros();
+  #endif
   if(waitForGpio) {
-    if(this->gpioPin == RADIOLIB_NC) {
-      this->hal->delay(1);
-    } else {
-      this->hal->delayMicroseconds(1);
-      RadioLibTime_t start = this->hal->millis();
-      while(this->hal->digitalRead(this->gpioPin)) {
-        this->hal->yield();
-        
-        // this timeout check triggers a false positive from cppcheck
-        // cppcheck-suppress unsignedLessThanZero
-        if(this->hal->millis() - start >= this->spiConfig.timeout) {
-          RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO post-transfer timeout, is it connected?");
-
-          // do not return yet to display the debug output
-          state = RADIOLIB_ERR_SPI_CMD_TIMEOUT;
-          break;
-        }
-      
-      }
-    }
+    state = this->SPIwaitForGpio(true);
   }
+  #if RADIOLIB_SPI_STATS
+  times[3] = this->hal->micros();
+  for(size_t i = 0; i < 3; i++) {
+    times[i] = times[i + 1] - times[i];
+  }
+  this->spiStatsAdd(this->spiStatsEntry(cmd, cmdLen), numBytes, waitForGpio ? &times[0] : NULL, &times[1], waitForGpio ? &times[2] : NULL);
+  #endif
 
   // parse status (only if GPIO did not timeout)
   if((state == RADIOLIB_ERR_NONE) && (this->spiConfig.parseStatusCb != nullptr) && (numBytes > 0)) {
-    state = this->spiConfig.parseStatusCb(buffIn[this->spiConfig.statusPos]);
-  }
-  
-  // copy the data
-  if(!write) {
-    // skip the status bytes if present
-    memcpy(dataIn, &buffIn[cmdLen + (this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8)], numBytes);
+    state = this->spiConfig.parseStatusCb(status);
   }
 
   // print debug information
@@ -431,28 +461,525 @@ int16_t Module::SPItransferStream(const uint8_t* cmd, uint8_t cmdLen, bool write
     RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG("");
 
     // print data bytes
+    // only the data part of the frame is kept, received bytes during command are not available
     RADIOLIB_DEBUG_SPI_PRINT("SI\t");
     for(n = 0; n < cmdLen; n++) {
       RADIOLIB_DEBUG_SPI_PRINT_NOTAG("\t");
     }
-    // initialization of n to 0 is skipped here, because we want to skip the command bytes
-    for(; n < buffLen; n++) {
-      RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X\t", buffOut[n]);
+    for(n = 0; n < statusLen + numBytes; n++) {
+      if(write) {
+        RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X\t", dataOut[n]);
+      } else {
+        RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X\t", this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP] & 0xFF);
+      }
     }
     RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG("");
     RADIOLIB_DEBUG_SPI_PRINT("SO\t");
-    for(n = 0; n < buffLen; n++) {
-      RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X\t", buffIn[n]);
+    for(n = 0; n < cmdLen + statusLen; n++) {
+      RADIOLIB_DEBUG_SPI_PRINT_NOTAG("\t");
+    }
+    for(n = 0; (!write) && (n < numBytes); n++) {
+      RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X\t", dataIn[n]);
     }
     RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG("");
   #endif
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] buffOut;
-    delete[] buffIn;
+  return(state);
+}
+
+int16_t Module::SPItransferChain(SPITransaction_t* trans, size_t num) {
+  RADIOLIB_ASSERT_PTR(trans);
+  if(num > RADIOLIB_SPI_CHAIN_SIZE) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+
+  // chip select is released after every spiTransfer call, so each transaction has to be sent as a separate frame
+  if(this->hal->spiFramePerTransfer) {
+    int16_t first = RADIOLIB_ERR_NONE;
+    for(size_t i = 0; i < num; i++) {
+      SPITransaction_t* t = &trans[i];
+      t->state = this->SPItransferStream(t->cmd, t->cmdLen, t->write, t->dataOut, t->dataIn, t->numBytes, true);
+      if(first == RADIOLIB_ERR_NONE) {
+        first = t->state;
+      }
+
+      // none of the following results are valid if GPIO timed out
+      if(t->state == RADIOLIB_ERR_SPI_CMD_TIMEOUT) {
+        for(size_t j = i + 1; j < num; j++) {
+          trans[j].state = t->state;
+        }
+        break;
+      }
+    }
+    return(first);
+  }
+
+  // every transaction is split into command, status and data segments
+  // command and status are received into the scratch buffer, so that the status byte can be captured
+  // data is transferred directly from/to the caller buffer - for reads, it is clocked in-place
+  // for writes, the bytes up to status position are also received into scratch
+  RadioLibSpiSegment_t segs[4*RADIOLIB_SPI_CHAIN_SIZE];
+  size_t hdrPos[RADIOLIB_SPI_CHAIN_SIZE];
+  size_t numSegs = 0;
+  size_t scratchPos = 0;
+  uint8_t statusPos = this->spiConfig.statusPos;
+  uint8_t nop = this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP];
+  size_t statusLen = this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_STATUS] / 8;
+  memset(this->spiScratchOut, nop, statusLen);
+  for(size_t i = 0; i < num; i++) {
+    SPITransaction_t* t = &trans[i];
+    size_t stLen = t->write ? 0 : statusLen;
+    size_t hdrLen = t->cmdLen + stLen;
+    size_t capLen = 0;
+    if(t->write && (statusPos >= hdrLen) && (statusPos < hdrLen + t->numBytes)) {
+      capLen = statusPos - hdrLen + 1;
+    }
+    if(scratchPos + hdrLen + capLen > RADIOLIB_SPI_SCRATCH_SIZE) {
+      return(RADIOLIB_ERR_PACKET_TOO_LONG);
+    }
+    hdrPos[i] = scratchPos;
+    uint8_t* hdrIn = &this->spiScratchIn[scratchPos];
+    scratchPos += hdrLen + capLen;
+
+    segs[numSegs++] = { t->cmd, hdrIn, t->cmdLen, false };
+    if(stLen > 0) {
+      segs[numSegs++] = { this->spiScratchOut, &hdrIn[t->cmdLen], stLen, false };
+    }
+    if(t->write) {
+      if(capLen > 0) {
+        segs[numSegs++] = { t->dataOut, &hdrIn[hdrLen], capLen, false };
+      }
+      if(t->numBytes > capLen) {
+        segs[numSegs++] = { &t->dataOut[capLen], NULL, t->numBytes - capLen, false };
+      }
+    } else if(t->numBytes > 0) {
+      memset(t->dataIn, nop, t->numBytes);
+      segs[numSegs++] = { t->dataIn, t->dataIn, t->numBytes, false };
+    }
+    segs[numSegs - 1].last = true;
+  }
+
+  // run the whole chain in the HAL
+  #if RADIOLIB_SPI_STATS
+  RadioLibTime_t times[4];
+  times[0] = this->hal->micros();
+  #endif
+  int16_t state = this->SPIwaitForGpio(false);
+  if(state != RADIOLIB_ERR_NONE) {
+    // nothing was transferred, so callers checking per-transaction results must see the timeout too
+    for(size_t i = 0; i < num; i++) {
+      trans[i].state = state;
+    }
+    return(state);
+  }
+  #if RADIOLIB_SPI_STATS
+  times[1] = this->hal->micros();
+  #endif
+  #if RADIOLIB_GPIO_WAIT_STATS
+  // waits within the chain are done by the HAL, only the final one is attributed to the last command
+  if(num > 0) {
+    this->gpioWaitStatsSetCmd(trans[num - 1].cmd, trans[num - 1].cmdLen);
+  }
+  #endif
+  size_t done = this->hal->spiTransferChain(segs, numSegs, this->csPin, this->gpioPin, this->spiConfig.timeout);
+  this->spiTransactions += done;
+  #if RADIOLIB_SPI_STATS
+  times[2] = this->hal->micros();
+  #endif
+  if(done < num) {
+    RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO chain timeout after %d transactions, is it connected?", (int)done);
+    state = RADIOLIB_ERR_SPI_CMD_TIMEOUT;
+  } else {
+    state = this->SPIwaitForGpio(true);
+  }
+
+  #if RADIOLIB_SPI_STATS
+  // bus time of the chain includes GPIO waits between transactions done by the HAL
+  times[3] = this->hal->micros();
+  for(size_t i = 0; i < 3; i++) {
+    times[i] = times[i + 1] - times[i];
+  }
+  for(size_t i = 0; i < num; i++) {
+    bool last = (i == num - 1);
+    this->spiStatsAdd(this->spiStatsEntry(trans[i].cmd, trans[i].cmdLen), trans[i].numBytes,
+                      (i == 0) ? &times[0] : NULL, last ? &times[1] : NULL, last ? &times[2] : NULL);
+  }
   #endif
 
-  return(state);
+  // none of the results are valid if GPIO timed out
+  if(state != RADIOLIB_ERR_NONE) {
+    for(size_t i = 0; i < num; i++) {
+      trans[i].state = state;
+    }
+    return(state);
+  }
+
+  // parse status of each transaction
+  int16_t first = RADIOLIB_ERR_NONE;
+  for(size_t i = 0; i < num; i++) {
+    SPITransaction_t* t = &trans[i];
+    t->state = RADIOLIB_ERR_NONE;
+    if((this->spiConfig.parseStatusCb != nullptr) && (t->numBytes > 0)) {
+      size_t hdrLen = t->cmdLen + (t->write ? 0 : statusLen);
+      uint8_t status = 0;
+      if(t->write || (statusPos < hdrLen)) {
+        status = this->spiScratchIn[hdrPos[i] + statusPos];
+      } else if(statusPos < hdrLen + t->numBytes) {
+        status = t->dataIn[statusPos - hdrLen];
+      }
+      t->state = this->spiConfig.parseStatusCb(status);
+    }
+    if(first == RADIOLIB_ERR_NONE) {
+      first = t->state;
+    }
+    #if RADIOLIB_TRACE
+    this->SPItraceStream(t->write ? RADIOLIB_TRACE_SPI_CHAIN_WRITE : RADIOLIB_TRACE_SPI_CHAIN_READ, t->cmd, t->cmdLen, t->write ? t->dataOut : t->dataIn, t->numBytes);
+    #endif
+
+    #if RADIOLIB_DEBUG_SPI
+      RADIOLIB_DEBUG_SPI_PRINT("CHAIN%c\t", t->write ? 'W' : 'R');
+      for(size_t n = 0; n < t->cmdLen; n++) {
+        RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X", t->cmd[n]);
+      }
+      RADIOLIB_DEBUG_SPI_PRINT_NOTAG("\t");
+      const uint8_t* debugBuffPtr = t->write ? t->dataOut : t->dataIn;
+      for(size_t n = 0; n < t->numBytes; n++) {
+        RADIOLIB_DEBUG_SPI_PRINT_NOTAG("%02X\t", debugBuffPtr[n]);
+      }
+      RADIOLIB_DEBUG_SPI_PRINTLN_NOTAG("");
+    #endif
+  }
+
+  return(first);
+}
+
+int16_t Module::SPIwaitForGpio(bool post) {
+  if(this->gpioPin == RADIOLIB_NC) {
+    this->SPIdelay(post ? RADIOLIB_GPIO_NC_DELAY_POST_US : RADIOLIB_GPIO_NC_DELAY_PRE_US);
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // after the transfer, give the module some time to raise GPIO first
+  if(post) {
+    this->hal->delayMicroseconds(1);
+  }
+
+  #if RADIOLIB_GPIO_WAIT_STATS || RADIOLIB_TRACE
+  RadioLibTime_t start = this->hal->micros();
+  #endif
+  bool ready = this->hal->waitForPin(this->gpioPin, this->hal->GpioLevelLow, this->spiConfig.timeout * 1000UL);
+  #if RADIOLIB_GPIO_WAIT_STATS
+  this->gpioWaitStatsAdd(this->hal->micros() - start);
+  #endif
+  RADIOLIB_TRACE_EVENT(RADIOLIB_TRACE_GPIO_WAIT, post, !ready, this->hal->micros() - start);
+  if(!ready) {
+    RADIOLIB_DEBUG_BASIC_PRINTLN("GPIO %s-transfer timeout, is it connected?", post ? "post" : "pre");
+    return(RADIOLIB_ERR_SPI_CMD_TIMEOUT);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+void Module::SPIdelay(RadioLibTime_t us) {
+  // some platforms can only do short delays in microseconds
+  if(us >= 1000) {
+    this->hal->delay(us / 1000);
+  }
+  this->hal->delayMicroseconds(us % 1000);
+}
+
+#if RADIOLIB_GPIO_WAIT_STATS
+const Module::GpioWaitStats_t* Module::getGpioWaitStats(size_t* num) const {
+  if(num) {
+    *num = this->gpioWaitStatsNum;
+  }
+  return(this->gpioWaitStats);
+}
+
+void Module::resetGpioWaitStats() {
+  this->gpioWaitStatsNum = 0;
+}
+
+void Module::gpioWaitStatsSetCmd(const uint8_t* cmd, uint8_t cmdLen) {
+  // only the opcode part of the command is used, not the address that may follow it
+  size_t opLen = this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD] / 8;
+  if((cmdLen == 0) || (opLen == 0) || (cmd == NULL)) {
+    // e.g. read phase of a two-transaction command, keep the previous opcode
+    return;
+  }
+  this->gpioWaitCmd = (opLen > 1) && (cmdLen > 1) ? (((uint16_t)cmd[0] << 8) | cmd[1]) : cmd[0];
+}
+
+void Module::gpioWaitStatsAdd(RadioLibTime_t us) {
+  GpioWaitStats_t* entry = NULL;
+  for(size_t i = 0; i < this->gpioWaitStatsNum; i++) {
+    if(this->gpioWaitStats[i].cmd == this->gpioWaitCmd) {
+      entry = &this->gpioWaitStats[i];
+      break;
+    }
+  }
+
+  // new command, drop it if the table is already full
+  if(!entry) {
+    if(this->gpioWaitStatsNum >= RADIOLIB_GPIO_WAIT_STATS_SIZE) {
+      return;
+    }
+    entry = &this->gpioWaitStats[this->gpioWaitStatsNum++];
+    entry->cmd = this->gpioWaitCmd;
+    entry->count = 0;
+    entry->total = 0;
+    entry->max = 0;
+  }
+
+  entry->count++;
+  entry->total += us;
+  if(us > entry->max) {
+    entry->max = us;
+  }
+}
+#endif
+
+#if RADIOLIB_SPI_STATS || RADIOLIB_TRACE
+bool Module::SPIdecodeStreamCmd(const uint8_t* cmd, uint8_t cmdLen, uint32_t* op, uint32_t* addr, bool* reg) {
+  size_t opLen = this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_CMD] / 8;
+  size_t addrLen = this->spiConfig.widths[RADIOLIB_MODULE_SPI_WIDTH_ADDR] / 8;
+  if((cmd == NULL) || (cmdLen < opLen) || (opLen == 0)) {
+    return(false);
+  }
+
+  *op = 0;
+  for(size_t i = 0; i < opLen; i++) {
+    *op = (*op << 8) | cmd[i];
+  }
+
+  *addr = 0;
+  *reg = (cmdLen == opLen + addrLen) && (addrLen > 0) &&
+         ((*op == this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ]) || (*op == this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE]));
+  for(size_t i = opLen; *reg && (i < cmdLen); i++) {
+    *addr = (*addr << 8) | cmd[i];
+  }
+  return(true);
+}
+#endif
+
+#if RADIOLIB_TRACE
+void Module::SPItraceStream(uint8_t type, const uint8_t* cmd, uint8_t cmdLen, const uint8_t* data, size_t numBytes) {
+  uint32_t op = 0;
+  uint32_t addr = 0;
+  bool reg = false;
+  if(this->SPIdecodeStreamCmd(cmd, cmdLen, &op, &addr, &reg) && reg) {
+    // only the lower 16 bits of longer addresses (e.g. LR11x0) fit into the event code
+    bool write = (op == this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_WRITE]);
+    RADIOLIB_TRACE_DATA(write ? RADIOLIB_TRACE_SPI_REG_WRITE : RADIOLIB_TRACE_SPI_REG_READ, (uint16_t)addr, data, numBytes);
+    return;
+  }
+
+  // other commands are traced by their first (up to) two bytes, e.g. opcode and buffer offset
+  uint16_t code = 0;
+  for(uint8_t i = 0; (cmd != NULL) && (i < cmdLen) && (i < 2); i++) {
+    code = (code << 8) | cmd[i];
+  }
+  RADIOLIB_TRACE_DATA(type, code, data, numBytes);
+}
+#endif
+
+#if RADIOLIB_SPI_STATS
+const Module::SPIStats_t* Module::getSPIStats(size_t* num) const {
+  if(num) {
+    *num = this->spiStatsNum;
+  }
+  return(this->spiStats);
+}
+
+void Module::resetSPIStats() {
+  this->spiStatsNum = 0;
+  this->spiStatsLast = NULL;
+}
+
+void Module::dumpSPIStats() const {
+  static const char* const types[] = { "CMD", "REG R", "REG W" };
+  static const char* const phases[] = { "pre", "bus", "post" };
+  rlb_printf(false, "type\tkey\tcount\tbytes\tphase\tavg\tmax\thistogram (<4, <16, <64 ... us)" RADIOLIB_LINE_FEED);
+  for(size_t i = 0; i < this->spiStatsNum; i++) {
+    const SPIStats_t* entry = &this->spiStats[i];
+    const SPILatency_t* lat[] = { &entry->pre, &entry->bus, &entry->post };
+    for(size_t p = 0; p < 3; p++) {
+      if(p == 0) {
+        rlb_printf(false, "%s\t%lX\t%lu\t%lu", types[entry->type], (unsigned long)entry->key, (unsigned long)entry->count, (unsigned long)entry->bytes);
+      } else {
+        rlb_printf(false, "\t\t\t");
+      }
+      // not every phase is measured for every transfer, so average over the histogram
+      uint32_t n = 0;
+      for(size_t b = 0; b < RADIOLIB_SPI_STATS_BINS; b++) {
+        n += lat[p]->hist[b];
+      }
+      unsigned long avg = n ? (unsigned long)(lat[p]->total / n) : 0;
+      rlb_printf(false, "\t%s\t%lu\t%lu\t", phases[p], avg, (unsigned long)lat[p]->max);
+      for(size_t b = 0; b < RADIOLIB_SPI_STATS_BINS; b++) {
+        rlb_printf(false, "%lu ", (unsigned long)lat[p]->hist[b]);
+      }
+      rlb_printf(false, RADIOLIB_LINE_FEED);
+    }
+  }
+}
+
+Module::SPIStats_t* Module::spiStatsEntry(uint32_t key, SPIStatsType_t type) {
+  for(size_t i = 0; i < this->spiStatsNum; i++) {
+    if((this->spiStats[i].key == key) && (this->spiStats[i].type == type)) {
+      return(&this->spiStats[i]);
+    }
+  }
+
+  // new entry, drop it if the table is already full
+  if(this->spiStatsNum >= RADIOLIB_SPI_STATS_SIZE) {
+    return(NULL);
+  }
+  SPIStats_t* entry = &this->spiStats[this->spiStatsNum++];
+  memset(entry, 0, sizeof(SPIStats_t));
+  entry->key = key;
+  entry->type = type;
+  return(entry);
+}
+
+Module::SPIStats_t* Module::spiStatsEntry(const uint8_t* cmd, uint8_t cmdLen) {
+  uint32_t op = 0;
+  uint32_t addr = 0;
+  bool reg = false;
+  if(!this->SPIdecodeStreamCmd(cmd, cmdLen, &op, &addr, &reg)) {
+    return(this->spiStatsLast);
+  }
+
+  // register accesses are keyed by the address
+  SPIStats_t* entry = NULL;
+  if(reg) {
+    SPIStatsType_t type = (op == this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_READ]) ? SPI_STATS_REG_READ : SPI_STATS_REG_WRITE;
+    entry = this->spiStatsEntry(addr, type);
+  } else {
+    entry = this->spiStatsEntry(op, SPI_STATS_CMD);
+  }
+  this->spiStatsLast = entry;
+  return(entry);
+}
+
+void Module::spiStatsAdd(SPIStats_t* entry, size_t numBytes, const RadioLibTime_t* pre, const RadioLibTime_t* bus, const RadioLibTime_t* post) {
+  if(!entry) {
+    return;
+  }
+
+  entry->count++;
+  entry->bytes += numBytes;
+  const RadioLibTime_t* times[] = { pre, bus, post };
+  SPILatency_t* lat[] = { &entry->pre, &entry->bus, &entry->post };
+  for(size_t p = 0; p < 3; p++) {
+    if(!times[p]) {
+      continue;
+    }
+    RadioLibTime_t us = *times[p];
+    lat[p]->total += us;
+    if(us > lat[p]->max) {
+      lat[p]->max = us;
+    }
+
+    // bins grow by a factor of 4
+    size_t bin = 0;
+    while((us >= 4) && (bin < RADIOLIB_SPI_STATS_BINS - 1)) {
+      us >>= 2;
+      bin++;
+    }
+    lat[p]->hist[bin]++;
+  }
+}
+#endif
+
+size_t Module::SPItransferSegment(const uint8_t* out, uint8_t* in, size_t len, size_t pos, uint8_t* status) {
+  // when only the input buffer is provided, fill it with NOP bytes and clock it in-place in one go
+  if((out == NULL) && (in != NULL) && (len > 0)) {
+    memset(in, this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], len);
+    out = in;
+  }
+
+  while(len > 0) {
+    // when both buffers are provided by the caller, the whole segment can be clocked at once
+    size_t chunk = len;
+    if(((out == NULL) || (in == NULL)) && (chunk > RADIOLIB_SPI_SCRATCH_SIZE)) {
+      chunk = RADIOLIB_SPI_SCRATCH_SIZE;
+    }
+
+    // HAL interface is not const-correct, but output buffer is never written to unless it is also the input
+    uint8_t* outPtr = const_cast<uint8_t*>(out);
+    if(out == NULL) {
+      memset(this->spiScratchOut, this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], chunk);
+      outPtr = this->spiScratchOut;
+    }
+    uint8_t* inPtr = (in == NULL) ? this->spiScratchIn : in;
+    this->hal->spiTransfer(outPtr, chunk, inPtr);
+
+    // capture the status byte if it was in this chunk
+    if((status != NULL) && (this->spiConfig.statusPos >= pos) && (this->spiConfig.statusPos < pos + chunk)) {
+      *status = inPtr[this->spiConfig.statusPos - pos];
+    }
+
+    pos += chunk;
+    len -= chunk;
+    if(out != NULL) {
+      out += chunk;
+    }
+    if(in != NULL) {
+      in += chunk;
+    }
+  }
+  return(pos);
+}
+
+int16_t Module::SPItransferFrame(const uint8_t* hdr, size_t hdrLen, size_t fillLen, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, uint8_t* status) {
+  // short frames (register access, status polls) are assembled in the scratch buffer and clocked at once
+  size_t buffLen = hdrLen + fillLen + numBytes;
+  if(buffLen <= RADIOLIB_SPI_SCRATCH_SIZE) {
+    this->SPItransferFrameBuffer(this->spiScratchIn, hdr, hdrLen, fillLen, dataOut, dataIn, numBytes, status);
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // longer ones are split into segments, so that the payload is transferred directly from/to the caller buffer
+  if(!this->hal->spiFramePerTransfer) {
+    size_t pos = this->SPItransferSegment(hdr, NULL, hdrLen, 0, status);
+    pos = this->SPItransferSegment(NULL, NULL, fillLen, pos, status);
+    this->SPItransferSegment(dataOut, dataIn, numBytes, pos, status);
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // chip select is released after every spiTransfer call, so the frame has to be built in memory
+  // splitting it would end the transaction, so frames that do not fit are rejected
+  #if RADIOLIB_SPI_FRAME_SIZE > 0
+  if(buffLen > RADIOLIB_SPI_FRAME_SIZE) {
+    RADIOLIB_DEBUG_BASIC_PRINTLN("SPI frame of %d bytes exceeds RADIOLIB_SPI_FRAME_SIZE", (int)buffLen);
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+  this->SPItransferFrameBuffer(this->spiFrameBuff, hdr, hdrLen, fillLen, dataOut, dataIn, numBytes, status);
+  return(RADIOLIB_ERR_NONE);
+  #else
+  RADIOLIB_DEBUG_BASIC_PRINTLN("SPI frame of %d bytes exceeds RADIOLIB_SPI_FRAME_SIZE", (int)buffLen);
+  return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  #endif
+}
+
+void Module::SPItransferFrameBuffer(uint8_t* buff, const uint8_t* hdr, size_t hdrLen, size_t fillLen, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, uint8_t* status) {
+  size_t buffLen = hdrLen + fillLen + numBytes;
+  memcpy(buff, hdr, hdrLen);
+  if(dataOut != NULL) {
+    memset(&buff[hdrLen], this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], fillLen);
+    memcpy(&buff[hdrLen + fillLen], dataOut, numBytes);
+  } else {
+    memset(&buff[hdrLen], this->spiConfig.cmds[RADIOLIB_MODULE_SPI_COMMAND_NOP], fillLen + numBytes);
+  }
+
+  // clock the frame in-place
+  this->hal->spiTransfer(buff, buffLen, buff);
+  if((status != NULL) && (this->spiConfig.statusPos < buffLen)) {
+    *status = buff[this->spiConfig.statusPos];
+  }
+  if(dataIn != NULL) {
+    memcpy(dataIn, &buff[hdrLen + fillLen], numBytes);
+  }
 }
 
 void Module::waitForMicroseconds(RadioLibTime_t start, RadioLibTime_t len) {
@@ -524,6 +1051,7 @@ const Module::RfSwitchMode_t *Module::findRfSwitchMode(uint8_t mode) const {
 }
 
 void Module::setRfSwitchState(uint8_t mode) {
+  RADIOLIB_TRACE_EVENT(RADIOLIB_TRACE_MODE, mode, 0, 0);
   const RfSwitchMode_t *row = findRfSwitchMode(mode);
   if(!row) {
     // RF switch control is disabled or does not have this mode
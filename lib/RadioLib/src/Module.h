@@ -4,6 +4,7 @@
 #include "TypeDef.h"
 #include "Hal.h"
 #include "utils/Utils.h"
+#include "utils/Trace.h"
 
 #if defined(RADIOLIB_BUILD_ARDUINO)
   #include <SPI.h>
@@ -223,6 +224,112 @@ class Module {
       .timeout = 1000,
     };
 
+    /*!
+      \struct SPITransaction_t
+      \brief Single transaction of a stream-type SPI chain, see SPItransferChain.
+    */
+    struct SPITransaction_t {
+      /*! \brief SPI operation command. */
+      const uint8_t* cmd;
+
+      /*! \brief SPI command length in bytes. */
+      uint8_t cmdLen;
+
+      /*! \brief Set to true for write commands, false for read commands. */
+      bool write;
+
+      /*! \brief Data that will be transferred from master to slave (write commands only). */
+      const uint8_t* dataOut;
+
+      /*! \brief Data that was transferred from slave to master (read commands only). */
+      uint8_t* dataIn;
+
+      /*! \brief Number of bytes to transfer. */
+      size_t numBytes;
+
+      /*! \brief Result of the transaction, filled in by SPItransferChain. */
+      int16_t state;
+    };
+
+    #if RADIOLIB_SPI_STATS
+    /*!
+      \enum SPIStatsType_t
+      \brief What the key of SPI statistics entry refers to.
+    */
+    enum SPIStatsType_t {
+      /*! \brief SPI command, key is the opcode. */
+      SPI_STATS_CMD = 0,
+
+      /*! \brief Register read, key is the register address. */
+      SPI_STATS_REG_READ,
+
+      /*! \brief Register write, key is the register address. */
+      SPI_STATS_REG_WRITE,
+    };
+
+    /*!
+      \struct SPILatency_t
+      \brief Latency of a single phase of SPI transfer.
+    */
+    struct SPILatency_t {
+      /*! \brief Total time in microseconds. */
+      RadioLibTime_t total;
+
+      /*! \brief Longest single occurrence in microseconds. */
+      RadioLibTime_t max;
+
+      /*! \brief Histogram, bin n counts latencies shorter than 4^(n+1) microseconds. */
+      uint32_t hist[RADIOLIB_SPI_STATS_BINS];
+    };
+
+    /*!
+      \struct SPIStats_t
+      \brief Statistics of a single SPI command or register, see getSPIStats.
+    */
+    struct SPIStats_t {
+      /*! \brief Opcode or register address. */
+      uint32_t key;
+
+      /*! \brief What the key refers to. */
+      SPIStatsType_t type;
+
+      /*! \brief Number of transfers. */
+      uint32_t count;
+
+      /*! \brief Number of data bytes transferred. */
+      uint32_t bytes;
+
+      /*! \brief Wait for GPIO before the transfer. */
+      SPILatency_t pre;
+
+      /*! \brief Time with chip select asserted. */
+      SPILatency_t bus;
+
+      /*! \brief Wait for GPIO after the transfer. */
+      SPILatency_t post;
+    };
+    #endif
+
+    #if RADIOLIB_GPIO_WAIT_STATS
+    /*!
+      \struct GpioWaitStats_t
+      \brief Time spent waiting for GPIO (e.g. BUSY) attributed to a single SPI command, see getGpioWaitStats.
+    */
+    struct GpioWaitStats_t {
+      /*! \brief SPI command opcode. */
+      uint16_t cmd;
+
+      /*! \brief Number of waits. */
+      uint32_t count;
+
+      /*! \brief Total time spent waiting in microseconds. */
+      RadioLibTime_t total;
+
+      /*! \brief Longest single wait in microseconds. */
+      RadioLibTime_t max;
+    };
+    #endif
+
     #if RADIOLIB_INTERRUPT_TIMING
 
     /*!
@@ -308,6 +415,24 @@ class Module {
     */
     void SPIwriteRegister(uint32_t reg, uint8_t data);
 
+    #if RADIOLIB_SPI_REG_SHADOW
+    /*!
+      \brief Set up write-through shadow of the register map. When set, cacheable registers are only read from the module once,
+      and writes that do not change the shadowed value are skipped. The shadow is invalidated by this call.
+      \param values Buffer for shadowed register values, one byte per register.
+      \param valid Buffer for bitmap of registers currently held in the shadow, one bit per register.
+      \param cacheable Bitmap of registers that can be shadowed, one bit per register, stored in RADIOLIB_NONVOLATILE memory.
+      Set to NULL to disable the shadow.
+      \param numRegs Number of registers covered by the shadow, starting from address 0.
+    */
+    void SPIsetRegShadow(uint8_t* values, uint8_t* valid, const uint8_t* cacheable, size_t numRegs);
+
+    /*!
+      \brief Invalidate the register shadow, e.g. after the module was reset or put to sleep.
+    */
+    void SPIinvalidateRegShadow();
+    #endif
+
     /*!
       \brief SPI single transfer method.
       \param cmd SPI access command (read/write/burst/...).
@@ -383,6 +508,65 @@ class Module {
     */
     int16_t SPItransferStream(const uint8_t* cmd, uint8_t cmdLen, bool write, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, bool waitForGpio);
 
+    /*!
+      \brief SPI chained transfer method for modules with stream-type SPI interface (SX126x, SX128x etc.).
+      All transactions are handed over to the HAL at once and executed back-to-back,
+      the HAL waits for GPIO between the transactions. Status of each transaction is saved in its state field,
+      if GPIO times out, state of all transactions is set to RADIOLIB_ERR_SPI_CMD_TIMEOUT.
+      On HALs with RadioLibHal::spiFramePerTransfer set, transactions are performed one by one by SPItransferStream.
+      \param trans Transactions to perform, at most RADIOLIB_SPI_CHAIN_SIZE.
+      \param num Number of transactions.
+      \returns \ref status_codes of the first failed transaction, or RADIOLIB_ERR_NONE if all succeeded.
+    */
+    int16_t SPItransferChain(SPITransaction_t* trans, size_t num);
+
+    /*!
+      \brief Get the number of SPI transactions (chip select assertions) since the last reset of the counter.
+      \returns Number of SPI transactions.
+    */
+    uint32_t getSPItransactions() const { return(this->spiTransactions); }
+
+    /*!
+      \brief Reset the SPI transaction counter.
+    */
+    void resetSPItransactions() { this->spiTransactions = 0; }
+
+    #if RADIOLIB_GPIO_WAIT_STATS
+    /*!
+      \brief Get statistics of time spent waiting for GPIO (e.g. BUSY) per SPI command.
+      Wait after a transfer is attributed to its command, wait before a transfer to the previous command.
+      \param num Pointer to a variable to save the number of entries into.
+      \returns Pointer to the statistics table.
+    */
+    const GpioWaitStats_t* getGpioWaitStats(size_t* num) const;
+
+    /*!
+      \brief Reset statistics of time spent waiting for GPIO.
+    */
+    void resetGpioWaitStats();
+    #endif
+
+    #if RADIOLIB_SPI_STATS
+    /*!
+      \brief Get per-command SPI statistics. Transactions of a chain are counted separately,
+      but wait before the chain is attributed to its first transaction and the bus time and wait after
+      the chain to the last one. Unlike getGpioWaitStats, wait before a transfer is attributed to the transfer itself.
+      \param num Pointer to a variable to save the number of entries into.
+      \returns Pointer to the statistics table.
+    */
+    const SPIStats_t* getSPIStats(size_t* num) const;
+
+    /*!
+      \brief Reset per-command SPI statistics.
+    */
+    void resetSPIStats();
+
+    /*!
+      \brief Print per-command SPI statistics to the debug port.
+    */
+    void dumpSPIStats() const;
+    #endif
+
     // pin number access methods
     // getCs is omitted on purpose, as it can interfere when accessing the SPI in a concurrent environment
     // so it is considered to be part of the SPI pins and hence not accessible from outside
@@ -534,9 +718,92 @@ class Module {
     uint32_t rfSwitchPins[RFSWITCH_MAX_PINS] = { RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC };
     const RfSwitchMode_t *rfSwitchTable = nullptr;
 
+    // scratch buffers for SPI transfers, used instead of heap-allocated frame buffers
+    uint8_t spiScratchOut[RADIOLIB_SPI_SCRATCH_SIZE] = { 0 };
+    uint8_t spiScratchIn[RADIOLIB_SPI_SCRATCH_SIZE] = { 0 };
+    #if RADIOLIB_SPI_FRAME_SIZE > 0
+    uint8_t spiFrameBuff[RADIOLIB_SPI_FRAME_SIZE] = { 0 };
+    #endif
+    uint32_t spiTransactions = 0;
+
     #if RADIOLIB_INTERRUPT_TIMING
     uint32_t prevTimingLen = 0;
     #endif
+
+    #if RADIOLIB_SPI_REG_SHADOW
+    uint8_t* regShadow = NULL;
+    uint8_t* regShadowValid = NULL;
+    const uint8_t* regShadowMask = NULL;
+    size_t regShadowNum = 0;
+
+    // check whether a register can be held in the shadow
+    bool regShadowCacheable(uint32_t reg);
+
+    // drop a single register from the shadow, so that the next read goes to the module
+    void regShadowDrop(uint32_t reg);
+
+    // update shadow after a burst of registers was transferred
+    void regShadowUpdate(uint32_t reg, const uint8_t* data, size_t numBytes);
+    #endif
+
+    // clock a part of the SPI frame, NULL output sends NOP bytes and NULL input discards the received data
+    // pos is the position of the segment within the frame, used to capture the status byte
+    size_t SPItransferSegment(const uint8_t* out, uint8_t* in, size_t len, size_t pos, uint8_t* status);
+
+    // clock a complete SPI frame: header, fillLen NOP bytes and data, NULL dataOut sends NOP bytes and NULL dataIn discards the data
+    // short frames are assembled in the scratch buffer, longer ones are split into segments,
+    // or assembled in spiFrameBuff if required by the HAL (RadioLibHal::spiFramePerTransfer)
+    // returns RADIOLIB_ERR_PACKET_TOO_LONG without clocking anything if the frame does not fit RADIOLIB_SPI_FRAME_SIZE
+    int16_t SPItransferFrame(const uint8_t* hdr, size_t hdrLen, size_t fillLen, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, uint8_t* status);
+
+    // assemble the frame in buff, clock it in a single spiTransfer call and copy out the received data
+    void SPItransferFrameBuffer(uint8_t* buff, const uint8_t* hdr, size_t hdrLen, size_t fillLen, const uint8_t* dataOut, uint8_t* dataIn, size_t numBytes, uint8_t* status);
+
+    // wait for GPIO to go low before (post = false) or after (post = true) the transfer
+    int16_t SPIwaitForGpio(bool post);
+
+    // wait for a fixed time, used when there is no GPIO to wait for
+    void SPIdelay(RadioLibTime_t us);
+
+    #if RADIOLIB_SPI_STATS || RADIOLIB_TRACE
+    // get opcode of a stream command, register accesses are recognized by the read/write opcode followed by the address
+    // returns false if the command does not contain the whole opcode (e.g. read phase of a two-transaction command)
+    bool SPIdecodeStreamCmd(const uint8_t* cmd, uint8_t cmdLen, uint32_t* op, uint32_t* addr, bool* reg);
+    #endif
+
+    #if RADIOLIB_TRACE
+    // record a stream transfer, register accesses are recorded as RADIOLIB_TRACE_SPI_REG_* events with their address
+    void SPItraceStream(uint8_t type, const uint8_t* cmd, uint8_t cmdLen, const uint8_t* data, size_t numBytes);
+    #endif
+
+    #if RADIOLIB_GPIO_WAIT_STATS
+    GpioWaitStats_t gpioWaitStats[RADIOLIB_GPIO_WAIT_STATS_SIZE];
+    size_t gpioWaitStatsNum = 0;
+    uint16_t gpioWaitCmd = 0;
+
+    // set the command that subsequent GPIO waits are attributed to
+    void gpioWaitStatsSetCmd(const uint8_t* cmd, uint8_t cmdLen);
+
+    // add a single GPIO wait to the statistics
+    void gpioWaitStatsAdd(RadioLibTime_t us);
+    #endif
+
+    #if RADIOLIB_SPI_STATS
+    SPIStats_t spiStats[RADIOLIB_SPI_STATS_SIZE];
+    size_t spiStatsNum = 0;
+
+    // find (or create) statistics entry, returns NULL if the table is full
+    SPIStats_t* spiStatsEntry(uint32_t key, SPIStatsType_t type);
+
+    SPIStats_t* spiStatsLast = NULL;
+
+    // find statistics entry for a command, register accesses are keyed by the address
+    // commands without opcode (e.g. read phase of a two-transaction command) are attributed to the previous one
+    SPIStats_t* spiStatsEntry(const uint8_t* cmd, uint8_t cmdLen);
+
+    // add a single transfer to the statistics, phases that were not measured are passed as NULL
+    void spiStatsAdd(SPIStats_t* entry, size_t numBytes, const RadioLibTime_t* pre, const RadioLibTime_t* bus, const RadioLibTime_t* post);
+    #endif
 };
 
 #endif
@@ -608,6 +608,11 @@
 */
 #define RADIOLIB_ERR_INVALID_MODE                               (-1121)
 
+/*!
+  \brief The asynchronous uplink/downlink exchange is still in progress.
+*/
+#define RADIOLIB_LORAWAN_PENDING                                (-1122)
+
 // LR11x0-specific status codes
 
 /*!
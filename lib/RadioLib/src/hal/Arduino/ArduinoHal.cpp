@@ -19,6 +19,12 @@ void ArduinoHal::term() {
   if(initInterface) {
     spiEnd();
   }
+  #if defined(RADIOLIB_GPIO_WAIT_IRQ)
+  if(this->gpioWaitSem != NULL) {
+    vSemaphoreDelete(this->gpioWaitSem);
+    this->gpioWaitSem = NULL;
+  }
+  #endif
 }
 
 void inline ArduinoHal::pinMode(uint32_t pin, uint32_t mode) {
@@ -104,9 +110,14 @@ void inline ArduinoHal::spiBeginTransaction() {
 }
 
 void ArduinoHal::spiTransfer(uint8_t* out, size_t len, uint8_t* in) {
+  #if defined(RADIOLIB_SPI_TRANSFER_BYTES)
+  // transfer the whole buffer at once, this also works in-place
+  spi->transferBytes(out, in, len);
+  #else
   for(size_t i = 0; i < len; i++) {
     in[i] = spi->transfer(out[i]);
   }
+  #endif
 }
 
 void inline ArduinoHal::spiEndTransaction() {
@@ -202,4 +213,55 @@ uint32_t inline ArduinoHal::pinToInterrupt(uint32_t pin) {
   return(digitalPinToInterrupt(pin));
 }
 
+#if defined(RADIOLIB_GPIO_WAIT_IRQ)
+static void IRAM_ATTR waitForPinIsr(void* arg) {
+  BaseType_t woken = pdFALSE;
+  (void)xSemaphoreGiveFromISR((SemaphoreHandle_t)arg, &woken);
+  if(woken == pdTRUE) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+bool ArduinoHal::waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) {
+  // short waits are cheaper to spin through than to set up the interrupt
+  RadioLibTime_t start = ::micros();
+  RadioLibTime_t elapsed = 0;
+  while((::digitalRead(pin) != 0) != (level != 0)) {
+    elapsed = ::micros() - start;
+    if(elapsed >= RADIOLIB_GPIO_WAIT_SPIN_US) {
+      break;
+    }
+  }
+  if(elapsed < RADIOLIB_GPIO_WAIT_SPIN_US) {
+    return(true);
+  }
+
+  // the edge is signalled through a semaphore owned by this HAL,
+  // task notifications are left for the application
+  if(this->gpioWaitSem == NULL) {
+    this->gpioWaitSem = xSemaphoreCreateBinary();
+    if(this->gpioWaitSem == NULL) {
+      return(RadioLibHal::waitForPin(pin, level, timeout));
+    }
+  }
+
+  // drop any stale edge, then block until the edge arrives
+  // the level is checked again after the interrupt is attached, in case the edge came in between
+  (void)xSemaphoreTake(this->gpioWaitSem, 0);
+  uint32_t irq = digitalPinToInterrupt(pin);
+  ::attachInterruptArg(irq, waitForPinIsr, (void*)this->gpioWaitSem, level ? RISING : FALLING);
+  bool reached = true;
+  while((::digitalRead(pin) != 0) != (level != 0)) {
+    elapsed = ::micros() - start;
+    if(elapsed >= timeout) {
+      reached = false;
+      break;
+    }
+    (void)xSemaphoreTake(this->gpioWaitSem, pdMS_TO_TICKS((timeout - elapsed) / 1000) + 1);
+  }
+  ::detachInterrupt(irq);
+  return(reached);
+}
+#endif
+
 #endif
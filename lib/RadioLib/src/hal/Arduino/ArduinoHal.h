@@ -15,6 +15,11 @@
 
 #include <SPI.h>
 
+#if defined(RADIOLIB_GPIO_WAIT_IRQ)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
 /*!
   \class ArduinoHal
   \brief Arduino default hardware abstraction library implementation.
@@ -59,6 +64,18 @@ class ArduinoHal : public RadioLibHal {
     void yield() override;
     uint32_t pinToInterrupt(uint32_t pin) override;
 
+    #if defined(RADIOLIB_GPIO_WAIT_IRQ)
+    /*!
+      \brief Wait for pin level, blocking the calling task on pin interrupt after a short busy-spin.
+      The edge is signalled through a binary semaphore of this HAL, task notifications of the caller are not used.
+      \param pin Pin to wait for.
+      \param level Logic level to wait for.
+      \param timeout Timeout in microseconds.
+      \returns True when the level was reached, false on timeout.
+    */
+    bool waitForPin(uint32_t pin, uint32_t level, RadioLibTime_t timeout) override;
+    #endif
+
 #if !RADIOLIB_GODMODE
   protected:
 #endif
@@ -73,6 +90,11 @@ class ArduinoHal : public RadioLibHal {
     #if defined(RADIOLIB_ESP32)
     int32_t prev = -1;
     #endif
+
+    #if defined(RADIOLIB_GPIO_WAIT_IRQ)
+    // given from the pin interrupt in waitForPin, created on first use
+    SemaphoreHandle_t gpioWaitSem = NULL;
+    #endif
 };
 
 #endif
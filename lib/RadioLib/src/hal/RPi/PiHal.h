@@ -29,6 +29,8 @@ class PiHal : public RadioLibHal {
       _spiDevice(spiDevice),
       _spiSpeed(spiSpeed),
       _spiChannel(spiChannel) {
+      // lgSpiXfer toggles the hardware chip select around each transfer
+      this->spiFramePerTransfer = true;
     }
 
     void init() override {
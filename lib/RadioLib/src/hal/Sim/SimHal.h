@@ -0,0 +1,1199 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+// include RadioLib
+#include <RadioLib.h>
+
+#include <stdint.h>
+#include <string.h>
+
+// simulated HAL - runs RadioLib on the host against virtual radio chips
+// the chips share a simulated channel and a virtual clock,
+// so that several nodes can talk to each other in a single process
+// without any real hardware or wall-clock delays
+
+#define SIM_INPUT         (0)
+#define SIM_OUTPUT        (1)
+#define SIM_LOW           (0)
+#define SIM_HIGH          (1)
+#define SIM_RISING        (1)
+#define SIM_FALLING       (2)
+
+// each HAL instance has exactly one radio attached, so the pin numbers are fixed
+#define SIM_PIN_CS        (0)
+#define SIM_PIN_IRQ       (1)
+#define SIM_PIN_RST       (2)
+#define SIM_PIN_GPIO      (3)
+#define SIM_PIN_MAX       (4)
+
+// maximum number of radios sharing one channel
+#define SIM_MAX_RADIOS    (8)
+
+// maximum SPI frame that is processed by the chip models (opcode, address and data)
+#define SIM_MAX_FRAME     (300)
+
+// number of preamble symbols a receiver needs to lock on a packet
+#define SIM_LOCK_SYMBOLS  (4)
+
+// value of virtual time that is never reached
+#define SIM_NEVER         (UINT64_MAX)
+
+class SimRadio;
+
+// one LoRa packet on air
+struct SimPacket {
+  uint8_t data[256];
+  size_t len;
+  uint32_t freq;
+  uint32_t bw;
+  uint8_t sf;
+  bool iq;
+  bool crc;
+  uint64_t start;
+  uint64_t end;
+};
+
+// shared medium and virtual clock
+// packets are delivered to all radios that listen with the same frequency, bandwidth, spreading factor
+// and IQ polarity, and that were already receiving when the packet started
+// sync words and collisions are not modelled
+class SimChannel {
+  public:
+    explicit SimChannel(uint32_t seed = 1) : rng(seed ? seed : 1) {}
+
+    // current virtual time in microseconds
+    uint64_t now() const {
+      return(this->time);
+    }
+
+    // move the virtual time forward, processing radio events in chronological order
+    void advance(uint64_t t);
+
+    // time of the earliest pending event of any radio, or SIM_NEVER
+    uint64_t nextEvent() const;
+
+    // attach radio to the channel, returns false if there is no room left
+    bool attach(SimRadio* radio) {
+      if(this->numRadios >= SIM_MAX_RADIOS) {
+        return(false);
+      }
+      this->radios[this->numRadios++] = radio;
+      return(true);
+    }
+
+    // probability of a packet being lost for each receiver
+    void setLoss(float prob) {
+      this->loss = prob;
+    }
+
+    // probability of a packet being received with CRC error
+    void setCorruption(float prob) {
+      this->corruption = prob;
+    }
+
+    // signal parameters reported by the receivers
+    void setSignal(float rssi, float snr) {
+      this->rssi = rssi;
+      this->snr = snr;
+    }
+
+    // power level reported in spectral scans when there is no signal
+    void setNoise(float noise) {
+      this->noise = noise;
+    }
+
+    // called by the transmitting radio at the end of the packet
+    void deliver(SimRadio* src, const SimPacket& pkt);
+
+    // power at the given frequency as seen by the radio, signal level if any packet overlaps it, noise otherwise
+    float power(const SimRadio* dst, uint32_t freq, uint32_t bw);
+
+    // check whether a packet matching the receiver is on air right now
+    bool isBusy(const SimRadio* dst, uint64_t since);
+
+    // number of packets sent, received, lost and corrupted
+    uint32_t packetsSent = 0;
+    uint32_t packetsDelivered = 0;
+    uint32_t packetsLost = 0;
+    uint32_t packetsCorrupted = 0;
+
+  private:
+    uint64_t time = 0;
+    SimRadio* radios[SIM_MAX_RADIOS] = { NULL };
+    size_t numRadios = 0;
+    float loss = 0;
+    float corruption = 0;
+    float rssi = -60;
+    float snr = 10;
+    float noise = -120;
+    uint32_t rng;
+
+    // xorshift32, so that the runs are repeatable for a given seed
+    float random() {
+      this->rng ^= this->rng << 13;
+      this->rng ^= this->rng >> 17;
+      this->rng ^= this->rng << 5;
+      return((float)(this->rng >> 8) / (float)(1UL << 24));
+    }
+};
+
+// virtual chip connected over SPI
+class SimRadio {
+  public:
+    explicit SimRadio(SimChannel* channel) : channel(channel) {
+      channel->attach(this);
+    }
+
+    virtual ~SimRadio() = default;
+
+    // SPI interface, the chip select edges delimit the frames
+    virtual void select() = 0;
+    virtual uint8_t transfer(uint8_t b) = 0;
+    virtual void deselect() = 0;
+
+    // reset pin
+    virtual void reset(bool level) = 0;
+
+    // pin levels as seen by the host
+    virtual bool getIrq() = 0;
+    virtual bool getGpio() = 0;
+
+    // process internal events up to the given time
+    virtual void update(uint64_t t) = 0;
+
+    // time of the next internal event, or SIM_NEVER
+    virtual uint64_t nextEvent() = 0;
+
+    // check whether a packet would be picked up by this radio
+    virtual bool accepts(const SimPacket& pkt, uint64_t since) const = 0;
+
+    // packet received from the channel
+    virtual void receive(const SimPacket& pkt, float rssi, float snr, bool crcErr) = 0;
+
+    // packet currently being transmitted, NULL if not transmitting
+    const SimPacket* onAir() const {
+      return(this->transmitting ? &this->txPacket : NULL);
+    }
+
+  protected:
+    SimChannel* channel;
+    SimPacket txPacket = {};
+    bool transmitting = false;
+
+    // LoRa configuration
+    uint32_t freq = 0;
+    uint32_t bw = 125000;
+    uint8_t sf = 7;
+    uint8_t cr = 1;
+    bool crc = true;
+    bool implicit = false;
+    bool ldro = false;
+    bool iqTx = false;
+    bool iqRx = false;
+    uint16_t preamble = 8;
+
+    // duration of a LoRa symbol in microseconds
+    uint64_t symbolTime() const {
+      return(((uint64_t)1000000 << this->sf) / this->bw);
+    }
+
+    // LoRa time-on-air in microseconds, as given by Semtech AN1200.13
+    uint64_t timeOnAir(size_t len) const {
+      int32_t num = 8*(int32_t)len - 4*(int32_t)this->sf + 28 + (this->crc ? 16 : 0) - (this->implicit ? 20 : 0);
+      int32_t den = 4*((int32_t)this->sf - (this->ldro ? 2 : 0));
+      int32_t payloadSymb = 8;
+      if(num > 0) {
+        payloadSymb += ((num + den - 1) / den) * (this->cr + 4);
+      }
+      return(((uint64_t)(4*this->preamble + 17) * this->symbolTime()) / 4 + payloadSymb * this->symbolTime());
+    }
+
+    // start transmission of the given payload
+    void startTx(const uint8_t* data, size_t len, uint64_t t) {
+      this->txPacket.len = len;
+      memcpy(this->txPacket.data, data, len);
+      this->txPacket.freq = this->freq;
+      this->txPacket.bw = this->bw;
+      this->txPacket.sf = this->sf;
+      this->txPacket.iq = this->iqTx;
+      this->txPacket.crc = this->crc;
+      this->txPacket.start = t;
+      this->txPacket.end = t + this->timeOnAir(len);
+      this->transmitting = true;
+      this->channel->packetsSent++;
+    }
+
+    // check LoRa parameters of a packet against the receiver configuration
+    // a receiver started during the preamble still locks on, as long as enough preamble symbols are left
+    bool matches(const SimPacket& pkt, uint64_t since) const {
+      uint32_t df = (pkt.freq > this->freq) ? (pkt.freq - this->freq) : (this->freq - pkt.freq);
+      uint64_t lock = (this->preamble > SIM_LOCK_SYMBOLS) ? (this->preamble - SIM_LOCK_SYMBOLS) * this->symbolTime() : 0;
+      return((df <= this->bw / 4) && (pkt.bw == this->bw) && (pkt.sf == this->sf) &&
+             (pkt.iq == this->iqRx) && (pkt.start + lock >= since));
+    }
+};
+
+inline uint64_t SimChannel::nextEvent() const {
+  uint64_t next = SIM_NEVER;
+  for(size_t i = 0; i < this->numRadios; i++) {
+    uint64_t ev = this->radios[i]->nextEvent();
+    if(ev < next) {
+      next = ev;
+    }
+  }
+  return(next);
+}
+
+inline void SimChannel::advance(uint64_t t) {
+  while(true) {
+    uint64_t next = this->nextEvent();
+
+    if((next > t) || (next == SIM_NEVER)) {
+      break;
+    }
+
+    // events in the past are processed at the current time
+    if(next > this->time) {
+      this->time = next;
+    }
+    for(size_t i = 0; i < this->numRadios; i++) {
+      this->radios[i]->update(this->time);
+    }
+  }
+
+  if(t > this->time) {
+    this->time = t;
+  }
+}
+
+inline void SimChannel::deliver(SimRadio* src, const SimPacket& pkt) {
+  for(size_t i = 0; i < this->numRadios; i++) {
+    SimRadio* dst = this->radios[i];
+    if((dst == src) || !dst->accepts(pkt, 0)) {
+      continue;
+    }
+
+    if(this->random() < this->loss) {
+      this->packetsLost++;
+      continue;
+    }
+
+    bool crcErr = pkt.crc && (this->random() < this->corruption);
+    if(crcErr) {
+      this->packetsCorrupted++;
+    }
+    dst->receive(pkt, this->rssi, this->snr, crcErr);
+    this->packetsDelivered++;
+  }
+}
+
+inline float SimChannel::power(const SimRadio* dst, uint32_t freq, uint32_t bw) {
+  for(size_t i = 0; i < this->numRadios; i++) {
+    const SimPacket* pkt = this->radios[i]->onAir();
+    if((this->radios[i] == dst) || !pkt) {
+      continue;
+    }
+    uint32_t df = (pkt->freq > freq) ? (pkt->freq - freq) : (freq - pkt->freq);
+    if(df < (pkt->bw + bw) / 2) {
+      return(this->rssi);
+    }
+  }
+  return(this->noise);
+}
+
+inline bool SimChannel::isBusy(const SimRadio* dst, uint64_t since) {
+  for(size_t i = 0; i < this->numRadios; i++) {
+    const SimPacket* pkt = this->radios[i]->onAir();
+    if((this->radios[i] != dst) && pkt && dst->accepts(*pkt, since)) {
+      return(true);
+    }
+  }
+  return(false);
+}
+
+// command-level model of SX126x
+// covers register and buffer access, IRQ handling, BUSY signalling and LoRa packet modem
+// GFSK, LR-FHSS and the less common commands are accepted and ignored
+class SimSX126x : public SimRadio {
+  public:
+    explicit SimSX126x(SimChannel* channel, const char* version = "SX1261 V2D 2D02") : SimRadio(channel) {
+      strncpy(this->version, version, sizeof(this->version) - 1);
+      this->powerOn();
+    }
+
+    // time the chip stays busy after each command, in microseconds
+    uint32_t busyTime = 10;
+
+    void select() override {
+      this->pos = 0;
+
+      // falling edge on NSS wakes the chip up
+      if(this->mode == ModeSleep) {
+        this->mode = ModeStandbyRc;
+        this->busyUntil = this->channel->now() + 400;
+      }
+    }
+
+    uint8_t transfer(uint8_t b) override {
+      uint8_t out = this->status();
+      if(this->pos < SIM_MAX_FRAME) {
+        this->frame[this->pos] = b;
+      }
+      size_t p = this->pos;
+      this->pos++;
+
+      // the response depends only on the bytes that were already shifted in
+      switch(this->frame[0]) {
+        case(RADIOLIB_SX126X_CMD_READ_REGISTER):
+          if(p >= 4) {
+            out = this->regs[((this->frame[1] << 8) + this->frame[2] + (p - 4)) & 0xFFFF];
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_READ_BUFFER):
+          if(p >= 3) {
+            out = this->buffer[(this->frame[1] + (p - 3)) & 0xFF];
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_GET_IRQ_STATUS):
+          if(p == 2) {
+            out = (uint8_t)(this->irq >> 8);
+          } else if(p == 3) {
+            out = (uint8_t)this->irq;
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_GET_RX_BUFFER_STATUS):
+          if(p == 2) {
+            out = this->rxLen;
+          } else if(p == 3) {
+            out = this->rxStart;
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_GET_PACKET_STATUS):
+          if((p == 2) || (p == 4)) {
+            out = this->rssiPkt;
+          } else if(p == 3) {
+            out = this->snrPkt;
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_GET_RSSI_INST):
+          if(p == 2) {
+            out = this->rssiPkt;
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_GET_PACKET_TYPE):
+          if(p == 2) {
+            out = this->packetType;
+          }
+          break;
+        case(RADIOLIB_SX126X_CMD_GET_DEVICE_ERRORS):
+        case(RADIOLIB_SX126X_CMD_GET_STATS):
+          if(p >= 2) {
+            out = 0;
+          }
+          break;
+      }
+      return(out);
+    }
+
+    void deselect() override {
+      if(this->pos == 0) {
+        return;
+      }
+      this->execute();
+      this->busyUntil = this->channel->now() + this->busyTime;
+    }
+
+    void reset(bool level) override {
+      if(!level) {
+        this->inReset = true;
+        return;
+      }
+      if(this->inReset) {
+        this->inReset = false;
+        this->powerOn();
+        this->busyUntil = this->channel->now() + 3500;
+      }
+    }
+
+    bool getIrq() override {
+      return((this->irq & this->dio1Mask) != 0);
+    }
+
+    bool getGpio() override {
+      return(this->inReset || (this->mode == ModeSleep) || (this->channel->now() < this->busyUntil));
+    }
+
+    uint64_t nextEvent() override {
+      uint64_t ev = this->timeout;
+      if(this->transmitting && (this->txPacket.end < ev)) {
+        ev = this->txPacket.end;
+      }
+      if(this->scanEnd < ev) {
+        ev = this->scanEnd;
+      }
+      return(ev);
+    }
+
+    void update(uint64_t t) override {
+      if(t >= this->scanEnd) {
+        this->scanEnd = SIM_NEVER;
+        this->finishScan();
+      }
+
+      if(this->transmitting && (t >= this->txPacket.end)) {
+        this->transmitting = false;
+        this->mode = ModeStandbyRc;
+        this->channel->deliver(this, this->txPacket);
+        this->setIrq(RADIOLIB_SX126X_IRQ_TX_DONE);
+      }
+
+      if(t >= this->timeout) {
+        this->timeout = SIM_NEVER;
+        if(this->mode == ModeCad) {
+          this->mode = ModeStandbyRc;
+          this->setIrq(RADIOLIB_SX126X_IRQ_CAD_DONE |
+            (this->channel->isBusy(this, 0) ? RADIOLIB_SX126X_IRQ_CAD_DETECTED : 0));
+
+        } else if(this->mode == ModeRx) {
+          if(this->channel->isBusy(this, this->rxSince)) {
+            // preamble was already detected, the packet will be received regardless of timeout
+            return;
+          }
+          this->mode = ModeStandbyRc;
+          this->cmdStatus = RADIOLIB_SX126X_STATUS_CMD_TIMEOUT;
+          this->setIrq(RADIOLIB_SX126X_IRQ_TIMEOUT);
+        }
+      }
+    }
+
+    bool accepts(const SimPacket& pkt, uint64_t since) const override {
+      return((this->mode == ModeRx) && this->matches(pkt, since > this->rxSince ? since : this->rxSince));
+    }
+
+    void receive(const SimPacket& pkt, float rssi, float snr, bool crcErr) override {
+      this->rxStart = this->rxBase;
+      this->rxLen = this->implicit ? this->payloadLen : (uint8_t)pkt.len;
+      for(size_t i = 0; i < this->rxLen; i++) {
+        this->buffer[(this->rxStart + i) & 0xFF] = (i < pkt.len) ? pkt.data[i] : 0;
+      }
+      this->rssiPkt = (uint8_t)(-2.0f*rssi);
+      this->snrPkt = (uint8_t)(int8_t)(4.0f*snr);
+
+      // single mode returns to standby, continuous keeps listening
+      if(!this->continuous) {
+        this->mode = ModeStandbyRc;
+        this->timeout = SIM_NEVER;
+      }
+      this->cmdStatus = RADIOLIB_SX126X_STATUS_DATA_AVAILABLE;
+      this->setIrq(RADIOLIB_SX126X_IRQ_PREAMBLE_DETECTED | RADIOLIB_SX126X_IRQ_HEADER_VALID |
+        RADIOLIB_SX126X_IRQ_RX_DONE | (crcErr ? RADIOLIB_SX126X_IRQ_CRC_ERR : 0));
+    }
+
+  private:
+    enum Mode {
+      ModeSleep,
+      ModeStandbyRc,
+      ModeStandbyXosc,
+      ModeFs,
+      ModeRx,
+      ModeTx,
+      ModeCad,
+    };
+
+    char version[17] = { 0 };
+    uint8_t regs[0x10000];
+    uint8_t buffer[256];
+    uint8_t frame[SIM_MAX_FRAME];
+    size_t pos = 0;
+
+    Mode mode = ModeStandbyRc;
+    uint8_t cmdStatus = 0;
+    bool inReset = false;
+    uint64_t busyUntil = 0;
+    uint64_t timeout = SIM_NEVER;
+    uint64_t rxSince = 0;
+    bool continuous = false;
+
+    uint16_t irq = 0;
+    uint16_t irqMask = 0;
+    uint16_t dio1Mask = 0;
+    uint8_t packetType = RADIOLIB_SX126X_PACKET_TYPE_GFSK;
+    uint8_t txBase = 0;
+    uint8_t rxBase = 0;
+    uint8_t payloadLen = 0xFF;
+    uint8_t rxStart = 0;
+    uint8_t rxLen = 0;
+    uint8_t rssiPkt = 0;
+    uint8_t snrPkt = 0;
+
+    // spectral scan, all samples are put into the bin of the channel power at the end of the scan
+    uint64_t scanEnd = SIM_NEVER;
+    uint16_t scanSamples = 0;
+
+    void finishScan() {
+      float power = this->channel->power(this, this->freq, this->bw);
+      int bin = (int)((-11.0f - power) / 4.0f + 0.5f);
+      bin = (bin < 0) ? 0 : ((bin >= RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE) ? RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE - 1 : bin);
+      memset(&this->regs[RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT], 0x00, 2*RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE);
+      this->regs[RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT + 2*bin] = (uint8_t)(this->scanSamples >> 8);
+      this->regs[RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT + 2*bin + 1] = (uint8_t)this->scanSamples;
+      this->regs[RADIOLIB_SX126X_REG_SPECTRAL_SCAN_STATUS] = RADIOLIB_SX126X_SPECTRAL_SCAN_COMPLETED;
+    }
+
+    void powerOn() {
+      memset(this->regs, 0x00, sizeof(this->regs));
+      memset(this->buffer, 0x00, sizeof(this->buffer));
+      memcpy(&this->regs[RADIOLIB_SX126X_REG_VERSION_STRING], this->version, 16);
+      this->regs[RADIOLIB_SX126X_REG_LORA_SYNC_WORD_MSB] = 0x14;
+      this->regs[RADIOLIB_SX126X_REG_LORA_SYNC_WORD_LSB] = 0x24;
+      this->mode = ModeStandbyRc;
+      this->cmdStatus = 0;
+      this->timeout = SIM_NEVER;
+      this->transmitting = false;
+      this->irq = 0;
+      this->irqMask = 0;
+      this->dio1Mask = 0;
+      this->packetType = RADIOLIB_SX126X_PACKET_TYPE_GFSK;
+      this->scanEnd = SIM_NEVER;
+    }
+
+    uint8_t status() const {
+      uint8_t m = RADIOLIB_SX126X_STATUS_MODE_STDBY_RC;
+      switch(this->mode) {
+        case(ModeStandbyXosc):
+          m = RADIOLIB_SX126X_STATUS_MODE_STDBY_XOSC;
+          break;
+        case(ModeFs):
+          m = RADIOLIB_SX126X_STATUS_MODE_FS;
+          break;
+        case(ModeRx):
+        case(ModeCad):
+          m = RADIOLIB_SX126X_STATUS_MODE_RX;
+          break;
+        case(ModeTx):
+          m = RADIOLIB_SX126X_STATUS_MODE_TX;
+          break;
+        default:
+          break;
+      }
+      return(m | this->cmdStatus);
+    }
+
+    void setIrq(uint16_t flags) {
+      this->irq |= flags & this->irqMask;
+    }
+
+    void execute() {
+      uint64_t t = this->channel->now();
+      uint8_t* f = this->frame;
+      size_t len = (this->pos < SIM_MAX_FRAME) ? this->pos : SIM_MAX_FRAME;
+
+      // command status is reported only until the next command
+      if(f[0] != RADIOLIB_SX126X_CMD_GET_STATUS) {
+        this->cmdStatus = 0;
+      }
+
+      switch(f[0]) {
+        case(RADIOLIB_SX126X_CMD_WRITE_REGISTER): {
+          uint16_t addr = (f[1] << 8) | f[2];
+          for(size_t i = 3; i < len; i++) {
+            this->regs[(uint16_t)(addr + i - 3)] = f[i];
+          }
+
+          // clearing RSSI averaging window aborts spectral scan
+          if((addr == RADIOLIB_SX126X_REG_RSSI_AVG_WINDOW) && (len > 3) && (f[3] == 0) && (this->scanEnd != SIM_NEVER)) {
+            this->scanEnd = SIM_NEVER;
+            this->regs[RADIOLIB_SX126X_REG_SPECTRAL_SCAN_STATUS] = RADIOLIB_SX126X_SPECTRAL_SCAN_ABORTED;
+          }
+        } break;
+
+        case(RADIOLIB_SX126X_CMD_SET_SPECTR_SCAN_PARAMS): {
+          if(this->mode != ModeRx) {
+            break;
+          }
+
+          // interval codes 10, 11 and 12 are roughly 7.68, 8.20 and 8.68 us
+          this->scanSamples = ((uint16_t)f[1] << 8) | f[2];
+          uint64_t interval = 7680 + 500*(uint64_t)(f[3] > 10 ? f[3] - 10 : 0);
+          this->scanEnd = t + ((uint64_t)this->scanSamples * interval) / 1000;
+          this->regs[RADIOLIB_SX126X_REG_SPECTRAL_SCAN_STATUS] = RADIOLIB_SX126X_SPECTRAL_SCAN_ONGOING;
+        } break;
+
+        case(RADIOLIB_SX126X_CMD_WRITE_BUFFER):
+          for(size_t i = 2; i < len; i++) {
+            this->buffer[(f[1] + i - 2) & 0xFF] = f[i];
+          }
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_SLEEP):
+          this->mode = ModeSleep;
+          this->transmitting = false;
+          this->timeout = SIM_NEVER;
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_STANDBY):
+          this->mode = (f[1] == RADIOLIB_SX126X_STANDBY_XOSC) ? ModeStandbyXosc : ModeStandbyRc;
+          this->transmitting = false;
+          this->timeout = SIM_NEVER;
+          this->scanEnd = SIM_NEVER;
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_FS):
+          this->mode = ModeFs;
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_TX): {
+          if(this->packetType != RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+            break;
+          }
+          uint8_t data[256];
+          for(size_t i = 0; i < this->payloadLen; i++) {
+            data[i] = this->buffer[(this->txBase + i) & 0xFF];
+          }
+          this->mode = ModeTx;
+          this->timeout = SIM_NEVER;
+          this->startTx(data, this->payloadLen, t);
+        } break;
+
+        case(RADIOLIB_SX126X_CMD_SET_RX): {
+          uint32_t raw = ((uint32_t)f[1] << 16) | ((uint32_t)f[2] << 8) | f[3];
+          this->mode = ModeRx;
+          this->rxSince = t;
+          this->continuous = (raw == RADIOLIB_SX126X_RX_TIMEOUT_INF);
+          this->timeout = SIM_NEVER;
+          if((raw != RADIOLIB_SX126X_RX_TIMEOUT_INF) && (raw != RADIOLIB_SX126X_RX_TIMEOUT_NONE)) {
+            // timeout step is 15.625 us
+            this->timeout = t + ((uint64_t)raw * 15625) / 1000;
+          }
+        } break;
+
+        case(RADIOLIB_SX126X_CMD_SET_CAD):
+          this->mode = ModeCad;
+          this->timeout = t + 2*this->symbolTime();
+          break;
+
+        case(RADIOLIB_SX126X_CMD_CLEAR_IRQ_STATUS):
+          this->irq &= ~(((uint16_t)f[1] << 8) | f[2]);
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_DIO_IRQ_PARAMS):
+          this->irqMask = ((uint16_t)f[1] << 8) | f[2];
+          this->dio1Mask = ((uint16_t)f[3] << 8) | f[4];
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_BUFFER_BASE_ADDRESS):
+          this->txBase = f[1];
+          this->rxBase = f[2];
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY): {
+          uint32_t raw = ((uint32_t)f[1] << 24) | ((uint32_t)f[2] << 16) | ((uint32_t)f[3] << 8) | f[4];
+          this->freq = (uint32_t)(((uint64_t)raw * 32000000UL) >> 25);
+        } break;
+
+        case(RADIOLIB_SX126X_CMD_SET_PACKET_TYPE):
+          this->packetType = f[1];
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS):
+          if(this->packetType == RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+            this->sf = f[1];
+            this->bw = bandwidth(f[2]);
+            this->cr = ((f[3] - 1) & 0x03) + 1;
+            this->ldro = (f[4] != 0);
+          }
+          break;
+
+        case(RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS):
+          if(this->packetType == RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+            this->preamble = ((uint16_t)f[1] << 8) | f[2];
+            this->implicit = (f[3] == RADIOLIB_SX126X_LORA_HEADER_IMPLICIT);
+            this->payloadLen = f[4];
+            this->crc = (f[5] == RADIOLIB_SX126X_LORA_CRC_ON);
+            this->iqTx = (f[6] == RADIOLIB_SX126X_LORA_IQ_INVERTED);
+            this->iqRx = this->iqTx;
+          }
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    static uint32_t bandwidth(uint8_t raw) {
+      switch(raw) {
+        case(RADIOLIB_SX126X_LORA_BW_7_8):
+          return(7812);
+        case(RADIOLIB_SX126X_LORA_BW_10_4):
+          return(10417);
+        case(RADIOLIB_SX126X_LORA_BW_15_6):
+          return(15625);
+        case(RADIOLIB_SX126X_LORA_BW_20_8):
+          return(20833);
+        case(RADIOLIB_SX126X_LORA_BW_31_25):
+          return(31250);
+        case(RADIOLIB_SX126X_LORA_BW_41_7):
+          return(41667);
+        case(RADIOLIB_SX126X_LORA_BW_62_5):
+          return(62500);
+        case(RADIOLIB_SX126X_LORA_BW_250_0):
+          return(250000);
+        case(RADIOLIB_SX126X_LORA_BW_500_0):
+          return(500000);
+        default:
+          return(125000);
+      }
+    }
+};
+
+// register-level model of SX1276/77/78/79 in LoRa mode
+// register contents are kept as written, so that read-back verification in the driver works,
+// only the registers with side effects (FIFO, operation mode, IRQ flags) are handled specially
+class SimSX127x : public SimRadio {
+  public:
+    explicit SimSX127x(SimChannel* channel, uint8_t version = 0x12) : SimRadio(channel), chipVersion(version) {
+      this->powerOn();
+    }
+
+    void select() override {
+      this->pos = 0;
+    }
+
+    uint8_t transfer(uint8_t b) override {
+      if(this->pos++ == 0) {
+        this->addr = b & 0x7F;
+        this->write = (b & 0x80) != 0;
+        return(0x00);
+      }
+
+      uint8_t out = 0x00;
+      if(this->write) {
+        this->writeReg(this->addr, b);
+      } else {
+        out = this->readReg(this->addr);
+      }
+
+      // burst access auto-increments the address, except for the FIFO
+      if(this->addr != RADIOLIB_SX127X_REG_FIFO) {
+        this->addr = (this->addr + 1) & 0x7F;
+      }
+      return(out);
+    }
+
+    void deselect() override {}
+
+    void reset(bool level) override {
+      if(!level) {
+        this->inReset = true;
+        return;
+      }
+      if(this->inReset) {
+        this->inReset = false;
+        this->powerOn();
+      }
+    }
+
+    // DIO0
+    bool getIrq() override {
+      uint8_t flags = this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS];
+      switch(this->regs[RADIOLIB_SX127X_REG_DIO_MAPPING_1] >> 6) {
+        case(0):
+          return(flags & RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_DONE);
+        case(1):
+          return(flags & RADIOLIB_SX127X_CLEAR_IRQ_FLAG_TX_DONE);
+        case(2):
+          return(flags & RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DONE);
+        default:
+          return(false);
+      }
+    }
+
+    // DIO1
+    bool getGpio() override {
+      uint8_t flags = this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS];
+      switch((this->regs[RADIOLIB_SX127X_REG_DIO_MAPPING_1] >> 4) & 0x03) {
+        case(0):
+          return(flags & RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT);
+        case(2):
+          return(flags & RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED);
+        default:
+          return(false);
+      }
+    }
+
+    uint64_t nextEvent() override {
+      uint64_t ev = this->timeout;
+      if(this->transmitting && (this->txPacket.end < ev)) {
+        ev = this->txPacket.end;
+      }
+      return(ev);
+    }
+
+    void update(uint64_t t) override {
+      if(this->transmitting && (t >= this->txPacket.end)) {
+        this->transmitting = false;
+        this->setMode(RADIOLIB_SX127X_STANDBY);
+        this->channel->deliver(this, this->txPacket);
+        this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_TX_DONE);
+      }
+
+      if(t >= this->timeout) {
+        this->timeout = SIM_NEVER;
+        uint8_t mode = this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0x07;
+        if(mode == RADIOLIB_SX127X_CAD) {
+          this->setMode(RADIOLIB_SX127X_STANDBY);
+          this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DONE |
+            (this->channel->isBusy(this, 0) ? RADIOLIB_SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED : 0));
+
+        } else if(mode == RADIOLIB_SX127X_RXSINGLE) {
+          if(this->channel->isBusy(this, this->rxSince)) {
+            return;
+          }
+          this->setMode(RADIOLIB_SX127X_STANDBY);
+          this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT);
+        }
+      }
+    }
+
+    bool accepts(const SimPacket& pkt, uint64_t since) const override {
+      uint8_t mode = this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0x07;
+      return(((mode == RADIOLIB_SX127X_RXCONTINUOUS) || (mode == RADIOLIB_SX127X_RXSINGLE)) &&
+             this->lora() && this->matches(pkt, since > this->rxSince ? since : this->rxSince));
+    }
+
+    void receive(const SimPacket& pkt, float rssi, float snr, bool crcErr) override {
+      uint8_t base = this->regs[RADIOLIB_SX127X_REG_FIFO_RX_BASE_ADDR];
+      uint8_t len = this->implicit ? this->regs[RADIOLIB_SX127X_REG_PAYLOAD_LENGTH] : (uint8_t)pkt.len;
+      for(size_t i = 0; i < len; i++) {
+        this->fifo[(base + i) & 0xFF] = (i < pkt.len) ? pkt.data[i] : 0;
+      }
+      this->regs[RADIOLIB_SX127X_REG_FIFO_RX_CURRENT_ADDR] = base;
+      this->regs[RADIOLIB_SX127X_REG_FIFO_RX_BYTE_ADDR] = base + len;
+      this->regs[RADIOLIB_SX127X_REG_RX_NB_BYTES] = len;
+      this->regs[RADIOLIB_SX127X_REG_HOP_CHANNEL] = pkt.crc ? 0x40 : 0x00;
+
+      // packet RSSI offset depends on the band
+      int16_t offset = (this->freq >= 868000000UL) ? 157 : 164;
+      int16_t rssiRaw = (int16_t)rssi + offset;
+      this->regs[RADIOLIB_SX127X_REG_PKT_RSSI_VALUE] = (rssiRaw < 0) ? 0 : (uint8_t)rssiRaw;
+      this->regs[RADIOLIB_SX127X_REG_PKT_SNR_VALUE] = (uint8_t)(int8_t)(4.0f*snr);
+
+      if((this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0x07) == RADIOLIB_SX127X_RXSINGLE) {
+        this->setMode(RADIOLIB_SX127X_STANDBY);
+        this->timeout = SIM_NEVER;
+      }
+      this->setIrq(RADIOLIB_SX127X_CLEAR_IRQ_FLAG_VALID_HEADER | RADIOLIB_SX127X_CLEAR_IRQ_FLAG_RX_DONE |
+        (crcErr ? RADIOLIB_SX127X_CLEAR_IRQ_FLAG_PAYLOAD_CRC_ERROR : 0));
+    }
+
+  private:
+    const uint8_t chipVersion;
+    uint8_t regs[0x80];
+    uint8_t fifo[256];
+    size_t pos = 0;
+    uint8_t addr = 0;
+    bool write = false;
+    bool inReset = false;
+    uint64_t timeout = SIM_NEVER;
+    uint64_t rxSince = 0;
+    uint32_t noise = 1;
+
+    void powerOn() {
+      memset(this->regs, 0x00, sizeof(this->regs));
+      memset(this->fifo, 0x00, sizeof(this->fifo));
+      this->regs[RADIOLIB_SX127X_REG_OP_MODE] = RADIOLIB_SX127X_STANDBY;
+      this->regs[RADIOLIB_SX127X_REG_FRF_MSB] = 0x6C;
+      this->regs[RADIOLIB_SX127X_REG_FRF_MID] = 0x80;
+      this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_1] = 0x72;
+      this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2] = 0x70;
+      this->regs[RADIOLIB_SX127X_REG_SYMB_TIMEOUT_LSB] = 0x64;
+      this->regs[RADIOLIB_SX127X_REG_PREAMBLE_LSB] = 0x08;
+      this->regs[RADIOLIB_SX127X_REG_PAYLOAD_LENGTH] = 0x01;
+      this->regs[RADIOLIB_SX127X_REG_MAX_PAYLOAD_LENGTH] = 0xFF;
+      this->regs[RADIOLIB_SX127X_REG_FIFO_TX_BASE_ADDR] = 0x80;
+      this->regs[RADIOLIB_SX127X_REG_INVERT_IQ] = 0x27;
+      this->regs[RADIOLIB_SX127X_REG_SYNC_WORD] = 0x12;
+      this->regs[RADIOLIB_SX127X_REG_VERSION] = this->chipVersion;
+      this->timeout = SIM_NEVER;
+      this->transmitting = false;
+      this->config();
+    }
+
+    bool lora() const {
+      return(this->regs[RADIOLIB_SX127X_REG_OP_MODE] & RADIOLIB_SX127X_LORA);
+    }
+
+    void setMode(uint8_t mode) {
+      this->regs[RADIOLIB_SX127X_REG_OP_MODE] = (this->regs[RADIOLIB_SX127X_REG_OP_MODE] & 0xF8) | mode;
+    }
+
+    void setIrq(uint8_t flags) {
+      this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS] |= flags & ~this->regs[RADIOLIB_SX127X_REG_IRQ_FLAGS_MASK];
+    }
+
+    // refresh LoRa parameters from the registers
+    void config() {
+      static const uint32_t bandwidths[] = { 7812, 10417, 15625, 20833, 31250, 41667, 62500, 125000, 250000, 500000 };
+      uint8_t cfg1 = this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_1];
+      uint8_t cfg2 = this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2];
+      uint32_t frf = ((uint32_t)this->regs[RADIOLIB_SX127X_REG_FRF_MSB] << 16) |
+                     ((uint32_t)this->regs[RADIOLIB_SX127X_REG_FRF_MID] << 8) |
+                     this->regs[RADIOLIB_SX127X_REG_FRF_LSB];
+      this->freq = (uint32_t)(((uint64_t)frf * 32000000UL) >> 19);
+      this->bw = bandwidths[(cfg1 >> 4) < 10 ? (cfg1 >> 4) : 7];
+      this->cr = ((((cfg1 >> 1) & 0x07) - 1) & 0x03) + 1;
+      this->implicit = (cfg1 & 0x01);
+      this->sf = cfg2 >> 4;
+      this->crc = (cfg2 & 0x04);
+      this->ldro = (this->regs[RADIOLIB_SX1278_REG_MODEM_CONFIG_3] & 0x08);
+      this->preamble = ((uint16_t)this->regs[RADIOLIB_SX127X_REG_PREAMBLE_MSB] << 8) | this->regs[RADIOLIB_SX127X_REG_PREAMBLE_LSB];
+      this->iqRx = this->regs[RADIOLIB_SX127X_REG_INVERT_IQ] & 0x40;
+      // TX path bit is inverted in practice, see SX127x::invertIQ
+      this->iqTx = !(this->regs[RADIOLIB_SX127X_REG_INVERT_IQ] & 0x01);
+    }
+
+    uint8_t readReg(uint8_t reg) {
+      if(reg == RADIOLIB_SX127X_REG_FIFO) {
+        return(this->fifo[this->regs[RADIOLIB_SX127X_REG_FIFO_ADDR_PTR]++]);
+      }
+      if(reg == RADIOLIB_SX127X_REG_RSSI_WIDEBAND) {
+        // drivers wait for the LSB to change when collecting entropy, so it must not be constant
+        this->noise ^= this->noise << 13;
+        this->noise ^= this->noise >> 17;
+        this->noise ^= this->noise << 5;
+        return((uint8_t)this->noise);
+      }
+      return(this->regs[reg]);
+    }
+
+    void writeReg(uint8_t reg, uint8_t val) {
+      switch(reg) {
+        case(RADIOLIB_SX127X_REG_FIFO):
+          this->fifo[this->regs[RADIOLIB_SX127X_REG_FIFO_ADDR_PTR]++] = val;
+          return;
+        case(RADIOLIB_SX127X_REG_IRQ_FLAGS):
+          this->regs[reg] &= ~val;
+          return;
+        case(RADIOLIB_SX127X_REG_VERSION):
+          return;
+        case(RADIOLIB_SX127X_REG_OP_MODE):
+          this->regs[reg] = val;
+          this->config();
+          this->startMode(val & 0x07);
+          return;
+        default:
+          this->regs[reg] = val;
+          return;
+      }
+    }
+
+    void startMode(uint8_t mode) {
+      uint64_t t = this->channel->now();
+      this->transmitting = false;
+      this->timeout = SIM_NEVER;
+      if(!this->lora()) {
+        return;
+      }
+
+      switch(mode) {
+        case(RADIOLIB_SX127X_TX): {
+          uint8_t data[256];
+          uint8_t base = this->regs[RADIOLIB_SX127X_REG_FIFO_TX_BASE_ADDR];
+          uint8_t len = this->regs[RADIOLIB_SX127X_REG_PAYLOAD_LENGTH];
+          for(size_t i = 0; i < len; i++) {
+            data[i] = this->fifo[(base + i) & 0xFF];
+          }
+          this->startTx(data, len, t);
+        } break;
+
+        case(RADIOLIB_SX127X_RXSINGLE): {
+          uint16_t symbols = ((uint16_t)(this->regs[RADIOLIB_SX127X_REG_MODEM_CONFIG_2] & 0x03) << 8) |
+                             this->regs[RADIOLIB_SX127X_REG_SYMB_TIMEOUT_LSB];
+          this->timeout = t + symbols*this->symbolTime();
+          this->rxSince = t;
+        } break;
+
+        case(RADIOLIB_SX127X_RXCONTINUOUS):
+          this->rxSince = t;
+          break;
+
+        case(RADIOLIB_SX127X_CAD):
+          this->timeout = t + this->symbolTime();
+          break;
+
+        default:
+          break;
+      }
+    }
+};
+
+// create a new simulated hardware abstraction layer
+// the HAL must inherit from the base RadioLibHal class
+// and implement all of its virtual methods
+class SimHal : public RadioLibHal {
+  public:
+    // default constructor - attaches the HAL to a virtual radio
+    // spiSpeed is used to account for the time taken by SPI transfers
+    explicit SimHal(SimRadio* radio, SimChannel* channel, uint32_t spiSpeed = 2000000)
+      : RadioLibHal(SIM_INPUT, SIM_OUTPUT, SIM_LOW, SIM_HIGH, SIM_RISING, SIM_FALLING),
+      radio(radio),
+      channel(channel),
+      spiSpeed(spiSpeed) {
+    }
+
+    // time that passes on each pin poll, so that busy-wait loops make progress
+    uint32_t pollTime = 1;
+
+    // number of SPI transactions and bytes since the last call to resetStats
+    uint32_t spiTransactions = 0;
+    uint32_t spiBytes = 0;
+
+    void resetStats() {
+      this->spiTransactions = 0;
+      this->spiBytes = 0;
+    }
+
+    void pinMode(uint32_t pin, uint32_t mode) override {
+      (void)pin;
+      (void)mode;
+    }
+
+    void digitalWrite(uint32_t pin, uint32_t value) override {
+      if(pin == SIM_PIN_CS) {
+        if(!value && this->csHigh) {
+          this->radio->select();
+        } else if(value && !this->csHigh) {
+          this->radio->deselect();
+        }
+        this->csHigh = value;
+      } else if(pin == SIM_PIN_RST) {
+        this->radio->reset(value);
+      }
+    }
+
+    uint32_t digitalRead(uint32_t pin) override {
+      this->advance(this->pollTime);
+      return(this->readPin(pin));
+    }
+
+    void attachInterrupt(uint32_t interruptNum, void (*interruptCb)(void), uint32_t mode) override {
+      if(interruptNum >= SIM_PIN_MAX) {
+        return;
+      }
+      this->interruptCallbacks[interruptNum] = interruptCb;
+      this->interruptModes[interruptNum] = mode;
+      this->interruptLevels[interruptNum] = this->readPin(interruptNum);
+    }
+
+    void detachInterrupt(uint32_t interruptNum) override {
+      if(interruptNum >= SIM_PIN_MAX) {
+        return;
+      }
+      this->interruptCallbacks[interruptNum] = NULL;
+    }
+
+    void delay(RadioLibTime_t ms) override {
+      this->advance((uint64_t)ms * 1000);
+    }
+
+    void delayMicroseconds(RadioLibTime_t us) override {
+      this->advance(us);
+    }
+
+    void yield() override {
+      this->advance(this->pollTime);
+    }
+
+    RadioLibTime_t millis() override {
+      return((RadioLibTime_t)(this->channel->now() / 1000));
+    }
+
+    RadioLibTime_t micros() override {
+      return((RadioLibTime_t)this->channel->now());
+    }
+
+    long pulseIn(uint32_t pin, uint32_t state, RadioLibTime_t timeout) override {
+      RadioLibTime_t start = this->micros();
+      while(this->digitalRead(pin) == state) {
+        if((this->micros() - start) > timeout) {
+          return(0);
+        }
+      }
+      return(this->micros() - start);
+    }
+
+    void spiBegin() override {}
+
+    void spiBeginTransaction() override {
+      this->spiTransactions++;
+    }
+
+    void spiTransfer(uint8_t* out, size_t len, uint8_t* in) override {
+      for(size_t i = 0; i < len; i++) {
+        uint8_t b = this->radio->transfer(out ? out[i] : 0x00);
+        if(in) {
+          in[i] = b;
+        }
+      }
+      this->spiBytes += len;
+
+      // account for the time the bytes take on the bus, in nanoseconds to keep the remainder
+      this->spiNanos += ((uint64_t)len * 8 * 1000000000UL) / this->spiSpeed;
+      this->advance(this->spiNanos / 1000);
+      this->spiNanos %= 1000;
+    }
+
+    void spiEndTransaction() override {}
+
+    void spiEnd() override {}
+
+  private:
+    SimRadio* radio;
+    SimChannel* channel;
+    const uint32_t spiSpeed;
+    uint64_t spiNanos = 0;
+    uint32_t csHigh = SIM_HIGH;
+
+    // interrupt emulation
+    typedef void (*RadioLibISR)(void);
+    RadioLibISR interruptCallbacks[SIM_PIN_MAX] = { NULL };
+    uint32_t interruptModes[SIM_PIN_MAX] = { 0 };
+    uint32_t interruptLevels[SIM_PIN_MAX] = { 0 };
+    bool inInterrupt = false;
+
+    uint32_t readPin(uint32_t pin) {
+      switch(pin) {
+        case(SIM_PIN_IRQ):
+          return(this->radio->getIrq() ? SIM_HIGH : SIM_LOW);
+        case(SIM_PIN_GPIO):
+          return(this->radio->getGpio() ? SIM_HIGH : SIM_LOW);
+        default:
+          return(SIM_LOW);
+      }
+    }
+
+    // move the shared clock and fire callbacks on matching pin edges
+    void advance(uint64_t us) {
+      this->channel->advance(this->channel->now() + us);
+      if(this->inInterrupt) {
+        return;
+      }
+
+      this->inInterrupt = true;
+      for(uint32_t pin = 0; pin < SIM_PIN_MAX; pin++) {
+        if(!this->interruptCallbacks[pin]) {
+          continue;
+        }
+        uint32_t level = this->readPin(pin);
+        if(level != this->interruptLevels[pin]) {
+          this->interruptLevels[pin] = level;
+          if((level && (this->interruptModes[pin] == SIM_RISING)) || (!level && (this->interruptModes[pin] == SIM_FALLING))) {
+            this->interruptCallbacks[pin]();
+          }
+        }
+      }
+      this->inInterrupt = false;
+    }
+};
+
+#endif
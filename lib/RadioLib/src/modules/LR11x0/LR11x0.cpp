@@ -153,6 +153,13 @@ int16_t LR11x0::transmit(const uint8_t* data, size_t len, uint8_t addr) {
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
 
+  // timeout is calculated from the current configuration, so the staged profile has to be applied first
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   // check packet length
   if (this->codingRate > RADIOLIB_LR11X0_LORA_CR_4_8_SHORT) {
     // Long Interleaver needs at least 8 bytes
@@ -210,6 +217,13 @@ int16_t LR11x0::receive(uint8_t* data, size_t len, RadioLibTime_t timeout) {
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
 
+  // timeout is calculated from the current configuration, so the staged profile has to be applied first
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   // calculate timeout based on the configured modem
   RadioLibTime_t timeoutInternal = timeout;
   if(!timeoutInternal) {
@@ -1171,7 +1185,9 @@ RadioLibTime_t LR11x0::getTimeOnAir(size_t len) {
 }
 
 uint32_t LR11x0::getIrqFlags() {
-  return((uint32_t)this->getIrqStatus());
+  uint32_t irq = (uint32_t)this->getIrqStatus();
+  RADIOLIB_TRACE_EVENT(RADIOLIB_TRACE_IRQ, 0, 0, irq);
+  return(irq);
 }
 
 int16_t LR11x0::setIrqFlags(uint32_t irq) {
@@ -1408,9 +1424,66 @@ int16_t LR11x0::getModem(ModemType_t* modem) {
   return(RADIOLIB_ERR_WRONG_MODEM);
 }
 
+int16_t LR11x0::applyProfile(const LR11x0Profile_t& profile) {
+  // check the profile was built correctly
+  RADIOLIB_ASSERT(profile.err);
+
+  // check if we need to recalibrate image
+  int16_t state;
+  if(fabsf(profile.freq - this->freqMHz) >= RADIOLIB_LR11X0_CAL_IMG_FREQ_TRIG_MHZ) {
+    state = LR11x0::calibrateImageRejection(profile.freq - 4.0f, profile.freq + 4.0f);
+    RADIOLIB_ASSERT(state);
+  }
+
+  // packet type has to be set first, the rest of the commands depends on it
+  const uint8_t cmdType[] = { (uint8_t)((RADIOLIB_LR11X0_CMD_SET_PACKET_TYPE >> 8) & 0xFF), (uint8_t)(RADIOLIB_LR11X0_CMD_SET_PACKET_TYPE & 0xFF) };
+  const uint8_t cmdFreq[] = { (uint8_t)((RADIOLIB_LR11X0_CMD_SET_RF_FREQUENCY >> 8) & 0xFF), (uint8_t)(RADIOLIB_LR11X0_CMD_SET_RF_FREQUENCY & 0xFF) };
+  const uint8_t cmdMod[] = { (uint8_t)((RADIOLIB_LR11X0_CMD_SET_MODULATION_PARAMS >> 8) & 0xFF), (uint8_t)(RADIOLIB_LR11X0_CMD_SET_MODULATION_PARAMS & 0xFF) };
+  const uint8_t cmdPkt[] = { (uint8_t)((RADIOLIB_LR11X0_CMD_SET_PACKET_PARAMS >> 8) & 0xFF), (uint8_t)(RADIOLIB_LR11X0_CMD_SET_PACKET_PARAMS & 0xFF) };
+  const uint8_t type[] = { RADIOLIB_LR11X0_PACKET_TYPE_LORA };
+  Module::SPITransaction_t config[] = {
+    { cmdType, 2, true, type, NULL, 1, RADIOLIB_ERR_NONE },
+    { cmdFreq, 2, true, profile.frf, NULL, 4, RADIOLIB_ERR_NONE },
+    { cmdMod, 2, true, profile.modParams, NULL, 4, RADIOLIB_ERR_NONE },
+    { cmdPkt, 2, true, profile.pktParams, NULL, 6, RADIOLIB_ERR_NONE },
+  };
+  state = this->mod->SPItransferChain(config, 4);
+  RADIOLIB_ASSERT(state);
+
+  // sync word
+  state = setLoRaSyncWord(profile.syncWord[0]);
+  RADIOLIB_ASSERT(state);
+
+  // everything was written, update the cached configuration
+  this->freqMHz = profile.freq;
+  this->bandwidthKhz = profile.bw;
+  this->spreadingFactor = profile.modParams[0];
+  this->bandwidth = profile.modParams[1];
+  this->codingRate = profile.modParams[2];
+  this->ldrOptimize = profile.modParams[3];
+  this->ldroAuto = true;
+  this->preambleLengthLoRa = ((uint16_t)profile.pktParams[0] << 8) | profile.pktParams[1];
+  this->headerType = profile.pktParams[2];
+  this->implicitLen = profile.pktParams[3];
+  this->crcTypeLoRa = profile.pktParams[4];
+  this->invertIQEnabled = (profile.pktParams[5] == RADIOLIB_LR11X0_LORA_IQ_INVERTED);
+  return(state);
+}
+
+void LR11x0::stageProfile(const LR11x0Profile_t* profile) {
+  this->stagedProfile = profile;
+}
+
 int16_t LR11x0::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
   int16_t state;
 
+  // apply the staged profile first, so that the mode is configured with the new settings
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   switch(mode) {
     case(RADIOLIB_RADIO_MODE_RX): {
       // check active modem
@@ -448,7 +448,7 @@ class LR11x0: public LRxxxx {
       \brief Gets frequency error of the latest received packet.
       \returns Frequency error in Hz.
     */
-    float getFrequencyError();
+    float getFrequencyError() override;
 
     /*!
       \brief Query modem for the packet length of received payload.
@@ -740,6 +740,45 @@ class LR11x0: public LRxxxx {
     */
     int16_t calibrateImageRejection(float freqMin, float freqMax);
     
+    /*!
+      \brief Build LoRa configuration profile. All parameters are validated and converted
+      to command payloads at compile time when the result is assigned to a constexpr variable.
+      Low data rate optimization is set automatically, same as with autoLDRO.
+      \param freq Carrier frequency in MHz. Only the sub-GHz band is supported, allowed values range from 150.0 MHz to 960.0 MHz.
+      \param bw LoRa bandwidth in kHz. Allowed values are 62.5, 125.0, 250.0 and 500.0 kHz.
+      \param sf LoRa spreading factor. Allowed values are in range 5 to 12.
+      \param cr LoRa coding rate denominator. Allowed values range from 5 to 8.
+      \param syncWord 1-byte LoRa sync word.
+      \param preambleLength LoRa preamble length in symbols.
+      \param crc Whether payload CRC is enabled.
+      \param implicitLen Payload length in implicit header mode, 0 for explicit header.
+      \param invertIQ Whether IQ inversion is enabled.
+      \returns The profile, check its err member for build status.
+    */
+    static constexpr LR11x0Profile_t profileLoRa(float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord = RADIOLIB_LR11X0_LORA_SYNC_WORD_PRIVATE, uint16_t preambleLength = 8, bool crc = true,
+      uint8_t implicitLen = 0, bool invertIQ = false) {
+      return(profileLoRaImage(freq, bw, sf, cr, syncWord, preambleLength, crc, implicitLen, invertIQ,
+        profileBandwidth(bw), (freq >= 150.0f) && (freq <= 960.0f) ? (uint32_t)(freq*1000000.0f) : 0));
+    }
+
+    /*!
+      \brief Apply a precompiled LoRa configuration profile. Packet type, frequency, modulation
+      and packet parameters are sent in a single chained SPI transaction, followed by the sync word,
+      regardless of how many of the parameters differ from the current configuration.
+      Image calibration is only performed when needed. Must be called while the radio is in standby mode.
+      \param profile Profile to apply.
+      \returns \ref status_codes
+    */
+    int16_t applyProfile(const LR11x0Profile_t& profile);
+
+    /*!
+      \brief Stage a configuration profile to be applied when the next transmission or reception is started,
+      right before the mode is staged. The profile must stay valid until then.
+      \param profile Profile to stage, or NULL to cancel the previously staged profile.
+    */
+    void stageProfile(const LR11x0Profile_t* profile);
+
     /*! \copydoc PhysicalLayer::stageMode */
     int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override;
 
@@ -931,6 +970,42 @@ class LR11x0: public LRxxxx {
 #endif
     uint8_t wifiScanMode = 0;
     bool gnss = false;
+    const LR11x0Profile_t* stagedProfile = NULL;
+
+    // configuration profile builders, split up so that each one is a single return statement
+    static constexpr bool profileBandwidthMatch(float bw, float ref) {
+      return((bw > ref - 0.001f) && (bw < ref + 0.001f));
+    }
+
+    static constexpr uint8_t profileBandwidth(float bw) {
+      return(profileBandwidthMatch(bw, 62.5f) ? RADIOLIB_LR11X0_LORA_BW_62_5 :
+             profileBandwidthMatch(bw, 125.0f) ? RADIOLIB_LR11X0_LORA_BW_125_0 :
+             profileBandwidthMatch(bw, 250.0f) ? RADIOLIB_LR11X0_LORA_BW_250_0 :
+             profileBandwidthMatch(bw, 500.0f) ? RADIOLIB_LR11X0_LORA_BW_500_0 : 0xFF);
+    }
+
+    static constexpr LR11x0Profile_t profileLoRaImage(float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord, uint16_t preambleLength, bool crc, uint8_t implicitLen, bool invertIQ,
+      uint8_t bwCode, uint32_t frf) {
+      return(LR11x0Profile_t{
+        (int16_t)(frf == 0 ? RADIOLIB_ERR_INVALID_FREQUENCY :
+          bwCode == 0xFF ? RADIOLIB_ERR_INVALID_BANDWIDTH :
+          (sf < 5) || (sf > 12) ? RADIOLIB_ERR_INVALID_SPREADING_FACTOR :
+          (cr < 5) || (cr > 8) ? RADIOLIB_ERR_INVALID_CODING_RATE : RADIOLIB_ERR_NONE),
+        freq, bw,
+        { (uint8_t)((frf >> 24) & 0xFF), (uint8_t)((frf >> 16) & 0xFF), (uint8_t)((frf >> 8) & 0xFF), (uint8_t)(frf & 0xFF) },
+        { sf, bwCode, (uint8_t)(cr - 4),
+          (uint8_t)((bwCode != 0xFF) && (sf <= 12) && ((float)(uint32_t(1) << sf) / bw >= 16.0f) ?
+            RADIOLIB_LR11X0_LORA_LDRO_ENABLED : RADIOLIB_LR11X0_LORA_LDRO_DISABLED) },
+        { (uint8_t)((preambleLength >> 8) & 0xFF), (uint8_t)(preambleLength & 0xFF),
+          (uint8_t)(implicitLen ? RADIOLIB_LRXXXX_LORA_HEADER_IMPLICIT : RADIOLIB_LRXXXX_LORA_HEADER_EXPLICIT),
+          (uint8_t)(implicitLen ? implicitLen : 0xFF),
+          (uint8_t)(crc ? RADIOLIB_LRXXXX_LORA_CRC_ENABLED : RADIOLIB_LRXXXX_LORA_CRC_DISABLED),
+          (uint8_t)(invertIQ ? RADIOLIB_LR11X0_LORA_IQ_INVERTED : RADIOLIB_LR11X0_LORA_IQ_STANDARD) },
+        { syncWord },
+      });
+    }
+
     int16_t modSetup(float tcxoVoltage, uint8_t modem);
     bool findChip(uint8_t ver);
     int16_t config(uint8_t modem);
@@ -941,6 +1016,9 @@ class LR11x0: public LRxxxx {
     // common methods to avoid some copy-paste
     int16_t bleBeaconCommon(uint16_t cmd, uint8_t chan, const uint8_t* payload, size_t len);
     int16_t cryptoCommon(uint16_t cmd, uint8_t keyId, const uint8_t* dataIn, size_t len, uint8_t* dataOut);
+
+    // allow the LoRaWAN crypto backend to access the crypto engine commands
+    friend class LoRaWANCryptoLR11x0;
 };
 
 #endif
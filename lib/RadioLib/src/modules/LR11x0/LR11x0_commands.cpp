@@ -316,12 +316,7 @@ int16_t LR11x0::enableSpiCrc(bool en) {
   // TODO implement this
   (void)en;
   // LR11X0 CRC is gen 0xA6 (0x65 but reflected), init 0xFF, input and result reflected
-  /*RadioLibCRCInstance.size = 8;
-  RadioLibCRCInstance.poly = 0xA6;
-  RadioLibCRCInstance.init = 0xFF;
-  RadioLibCRCInstance.out = 0x00;
-  RadioLibCRCInstance.refIn = true;
-  RadioLibCRCInstance.refOut = true;*/
+  // once implemented, it can be calculated using RadioLibCRCPresetLR11x0
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
 
@@ -225,6 +225,34 @@ struct LR11x0GnssAlmanacStatus_t {
   RadioLibTime_t start;
 };
 
+/*!
+  \struct LR11x0Profile_t
+  \brief Precompiled LoRa configuration for %LR11x0 series, holding the exact command payloads.
+  Should be created by LR11x0::profileLoRa, preferably as a constexpr variable.
+*/
+struct LR11x0Profile_t {
+  /*! \brief Status code of the profile build, RADIOLIB_ERR_NONE when the profile is valid. */
+  int16_t err;
+
+  /*! \brief Carrier frequency in MHz. */
+  float freq;
+
+  /*! \brief LoRa bandwidth in kHz. */
+  float bw;
+
+  /*! \brief SetRfFrequency payload. */
+  uint8_t frf[4];
+
+  /*! \brief SetModulationParams payload. */
+  uint8_t modParams[4];
+
+  /*! \brief SetPacketParams payload. */
+  uint8_t pktParams[6];
+
+  /*! \brief SetLoRaSyncWord payload. */
+  uint8_t syncWord[1];
+};
+
 #endif
 
 #endif
@@ -97,6 +97,12 @@ class LRxxxx: public PhysicalLayer {
     */
     bool XTAL;
 
+    /*!
+      \brief Number of times the chip was reset by reset(). Anything held in the chip's RAM
+      (e.g. keys in the crypto engine) is lost on reset, this allows users of such state to notice.
+    */
+    uint16_t resetCount = 0;
+
     /*!
       \brief Reset method. Will reset the chip to the default state using RST pin.
       \returns \ref status_codes
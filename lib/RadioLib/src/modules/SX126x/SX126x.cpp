@@ -215,6 +215,13 @@ int16_t SX126x::transmit(const uint8_t* data, size_t len, uint8_t addr) {
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
 
+  // timeout is calculated from the current configuration, so the staged profile has to be applied first
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   // check packet length
   if(this->codingRate > RADIOLIB_SX126X_LORA_CR_4_8) {
     // Long Interleaver needs at least 8 bytes
@@ -277,6 +284,13 @@ int16_t SX126x::receive(uint8_t* data, size_t len, RadioLibTime_t timeout) {
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
 
+  // timeout is calculated from the current configuration, so the staged profile has to be applied first
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   RadioLibTime_t timeoutInternal = timeout;
   if(!timeoutInternal) {
     // calculate timeout (500 % of expected time-one-air)
@@ -584,16 +598,33 @@ int16_t SX126x::startReceiveCommon(uint32_t timeout, RadioLibIrqFlags_t irqFlags
 }
 
 int16_t SX126x::readData(uint8_t* data, size_t len) {
+  // read IRQ status and Rx buffer status in a single chain
+  const uint8_t cmdIrq[] = { RADIOLIB_SX126X_CMD_GET_IRQ_STATUS };
+  const uint8_t cmdBuff[] = { RADIOLIB_SX126X_CMD_GET_RX_BUFFER_STATUS };
+  uint8_t irqRaw[2] = { 0, 0 };
+  uint8_t rxBufStatus[2] = { 0, 0 };
+  Module::SPITransaction_t status[] = {
+    { cmdIrq, 1, false, NULL, irqRaw, 2, RADIOLIB_ERR_NONE },
+    { cmdBuff, 1, false, NULL, rxBufStatus, 2, RADIOLIB_ERR_NONE },
+  };
+  this->mod->SPItransferChain(status, 2);
+  uint16_t irq = ((uint16_t)irqRaw[0] << 8) | irqRaw[1];
+
   // this method may get called from receive() after Rx timeout
-  // if that's the case, the first call will return "SPI command timeout error"
+  // if that's the case, the status of the first command will be "SPI command timeout error"
   // check the IRQ to be sure this really originated from timeout event
-  int16_t state = this->mod->SPIcheckStream();
-  uint16_t irq = getIrqFlags();
+  int16_t state = RADIOLIB_ERR_NONE;
+  #if RADIOLIB_SPI_PARANOID
+  state = status[0].state;
   if((state == RADIOLIB_ERR_SPI_CMD_TIMEOUT) && (irq & RADIOLIB_SX126X_IRQ_TIMEOUT)) {
     // this is definitely Rx timeout
     return(RADIOLIB_ERR_RX_TIMEOUT);
   }
   RADIOLIB_ASSERT(state);
+  #endif
+
+  // without a valid Rx buffer status (e.g. BUSY timed out), there is nothing to read
+  RADIOLIB_ASSERT(status[1].state);
 
   // check integrity CRC
   int16_t crcState = RADIOLIB_ERR_NONE;
@@ -603,19 +634,23 @@ int16_t SX126x::readData(uint8_t* data, size_t len) {
   }
   
   // get packet length and Rx buffer offset
-  uint8_t offset = 0;
-  size_t length = getPacketLength(true, &offset);
+  size_t length = rxBufStatus[0];
   if((len != 0) && (len < length)) {
     // user requested less data than we got, only return what was requested
     length = len;
   }
 
-  // read packet data starting at offset
-  state = readBuffer(data, length, offset);
-  RADIOLIB_ASSERT(state);
-
-  // clear interrupt flags
-  state = clearIrqStatus();
+  // read packet data starting at offset and clear interrupt flags in a single chain
+  const uint8_t cmdRead[] = { RADIOLIB_SX126X_CMD_READ_BUFFER, rxBufStatus[1] };
+  const uint8_t cmdClear[] = { RADIOLIB_SX126X_CMD_CLEAR_IRQ_STATUS };
+  const uint8_t clearIrq[] = { (uint8_t)((RADIOLIB_SX126X_IRQ_ALL >> 8) & 0xFF), (uint8_t)(RADIOLIB_SX126X_IRQ_ALL & 0xFF) };
+  Module::SPITransaction_t read[] = {
+    { cmdRead, 2, false, NULL, data, length, RADIOLIB_ERR_NONE },
+    { cmdClear, 1, true, clearIrq, NULL, 2, RADIOLIB_ERR_NONE },
+  };
+  this->mod->SPItransferChain(read, 2);
+  RADIOLIB_ASSERT(read[0].state);
+  state = read[1].state;
 
   // check if CRC failed - this is done after reading data to give user the option to keep them
   RADIOLIB_ASSERT(crcState);
@@ -935,7 +970,9 @@ RadioLibTime_t SX126x::calculateRxTimeout(RadioLibTime_t timeoutUs) {
 uint32_t SX126x::getIrqFlags() {
   uint8_t data[] = { 0x00, 0x00 };
   this->mod->SPIreadStream(RADIOLIB_SX126X_CMD_GET_IRQ_STATUS, data, 2);
-  return(((uint32_t)(data[0]) << 8) | data[1]);
+  uint32_t irq = ((uint32_t)(data[0]) << 8) | data[1];
+  RADIOLIB_TRACE_EVENT(RADIOLIB_TRACE_IRQ, 0, 0, irq);
+  return(irq);
 }
 
 int16_t SX126x::setIrqFlags(uint32_t irq) {
@@ -997,6 +1034,13 @@ int16_t SX126x::getModem(ModemType_t* modem) {
 int16_t SX126x::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
   int16_t state;
 
+  // apply the staged profile first, so that the mode is configured with the new settings
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   switch(mode) {
     case(RADIOLIB_RADIO_MODE_RX): {
       // in implicit header mode, use the provided length if it is nonzero
@@ -1251,6 +1295,133 @@ int16_t SX126x::spectralScanGetResult(uint16_t* results) {
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t SX126x::spectralSweepStart(SX126xSweep_t* sweep) {
+  RADIOLIB_ASSERT_PTR(sweep);
+  if((sweep->numSteps == 0) || ((sweep->waterfall != NULL) && (sweep->numRows == 0))) {
+    return(RADIOLIB_ERR_INVALID_NUM_SAMPLES);
+  }
+
+  // tune to the start frequency the usual way, so that image calibration is done if needed
+  // this overwrites the cached frequency, so keep the previous one to restore it when stopped
+  float freqPrev = this->freqMHz;
+  int16_t state = this->setFrequency(sweep->freqStart);
+  RADIOLIB_ASSERT(state);
+
+  // frequency of each step is calculated from raw values, so that there is no floating point math during the sweep
+  this->sweepFrfStart = (sweep->freqStart * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ;
+  this->sweepFrfStep = (sweep->freqStep * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ + 0.5f;
+  sweep->step = 0;
+  sweep->row = 0;
+  sweep->sweeps = 0;
+  this->sweep = sweep;
+  this->sweepFreqPrev = freqPrev;
+
+  // make sure there is no scan ongoing, the first scan is then started like every other step
+  spectralScanAbort();
+  return(spectralSweepStep());
+}
+
+int16_t SX126x::spectralSweepUpdate() {
+  RADIOLIB_ASSERT_PTR(this->sweep);
+  int16_t state = spectralScanGetStatus();
+  RADIOLIB_ASSERT(state);
+
+  // grab the results and start the next step immediately, processing is done while the radio scans
+  uint8_t raw[2*RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE];
+  this->mod->SPIreadRegisterBurst(RADIOLIB_SX126X_REG_SPECTRAL_SCAN_RESULT, sizeof(raw), raw);
+  uint16_t done = this->sweep->step;
+  this->sweep->step = (done + 1 >= this->sweep->numSteps) ? 0 : done + 1;
+  state = spectralSweepStep();
+  spectralSweepProcess(done, raw);
+  RADIOLIB_ASSERT(state);
+
+  // check if this was the last step
+  if(this->sweep->step != 0) {
+    return(RADIOLIB_ERR_RANGING_TIMEOUT);
+  }
+  this->sweep->sweeps++;
+  if(this->sweep->numRows) {
+    this->sweep->row = (this->sweep->row + 1 >= this->sweep->numRows) ? 0 : this->sweep->row + 1;
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+void SX126x::spectralSweepStop() {
+  if(!this->sweep) {
+    return;
+  }
+  this->sweep = NULL;
+  spectralScanAbort();
+  standby();
+
+  // return to the frequency used before the sweep, recalibrating image rejection if it is in another band
+  setFrequency(this->sweepFreqPrev);
+}
+
+int16_t SX126x::spectralSweepStep() {
+  // tune, enable the scan, enter Rx and set scan parameters in one chain
+  uint32_t frf = this->sweepFrfStart + (uint32_t)this->sweep->step * this->sweepFrfStep;
+  const uint8_t cmdFreq[] = { RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY };
+  const uint8_t cmdWindow[] = { RADIOLIB_SX126X_CMD_WRITE_REGISTER,
+    (uint8_t)((RADIOLIB_SX126X_REG_RSSI_AVG_WINDOW >> 8) & 0xFF), (uint8_t)(RADIOLIB_SX126X_REG_RSSI_AVG_WINDOW & 0xFF) };
+  const uint8_t cmdRx[] = { RADIOLIB_SX126X_CMD_SET_RX };
+  const uint8_t cmdScan[] = { RADIOLIB_SX126X_CMD_SET_SPECTR_SCAN_PARAMS };
+  const uint8_t freq[] = { (uint8_t)((frf >> 24) & 0xFF), (uint8_t)((frf >> 16) & 0xFF), (uint8_t)((frf >> 8) & 0xFF), (uint8_t)(frf & 0xFF) };
+  const uint8_t rx[] = { (uint8_t)((RADIOLIB_SX126X_RX_TIMEOUT_INF >> 16) & 0xFF), (uint8_t)((RADIOLIB_SX126X_RX_TIMEOUT_INF >> 8) & 0xFF), (uint8_t)(RADIOLIB_SX126X_RX_TIMEOUT_INF & 0xFF) };
+  const uint8_t scan[] = { (uint8_t)((this->sweep->numSamples >> 8) & 0xFF), (uint8_t)(this->sweep->numSamples & 0xFF), this->sweep->interval };
+  Module::SPITransaction_t trans[] = {
+    { cmdFreq, 1, true, freq, NULL, 4, RADIOLIB_ERR_NONE },
+    { cmdWindow, 3, true, &this->sweep->window, NULL, 1, RADIOLIB_ERR_NONE },
+    { cmdRx, 1, true, rx, NULL, 3, RADIOLIB_ERR_NONE },
+    { cmdScan, 1, true, scan, NULL, 3, RADIOLIB_ERR_NONE },
+  };
+
+  // split the chain in case it was configured to be shorter
+  const size_t numTrans = sizeof(trans) / sizeof(trans[0]);
+  for(size_t i = 0; i < numTrans; i += RADIOLIB_SPI_CHAIN_SIZE) {
+    size_t num = (numTrans - i > RADIOLIB_SPI_CHAIN_SIZE) ? RADIOLIB_SPI_CHAIN_SIZE : numTrans - i;
+    int16_t state = this->mod->SPItransferChain(&trans[i], num);
+    RADIOLIB_ASSERT(state);
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+void SX126x::spectralSweepProcess(uint16_t step, const uint8_t* raw) {
+  // each bin of the result is the number of samples at that power level, from the strongest one
+  uint32_t total = 0;
+  uint32_t sum = 0;
+  uint8_t peak = 0;
+  for(uint8_t i = 0; i < RADIOLIB_SX126X_SPECTRAL_SCAN_RES_SIZE; i++) {
+    uint16_t count = ((uint16_t)raw[i*2] << 8) | (uint16_t)raw[i*2 + 1];
+    uint8_t level = RADIOLIB_SX126X_SWEEP_LEVEL_BIN_0 - RADIOLIB_SX126X_SWEEP_LEVEL_BIN_STEP*i;
+    if(count && !peak) {
+      peak = level;
+    }
+    total += count;
+    sum += (uint32_t)count * level;
+  }
+  if(total == 0) {
+    return;
+  }
+
+  // mean level in 8.8 fixed point, split up to avoid overflow
+  uint16_t mean = (uint16_t)(((sum / total) << 8) | (((sum % total) << 8) / total));
+  if(this->sweep->maxHold && (peak > this->sweep->maxHold[step])) {
+    this->sweep->maxHold[step] = peak;
+  }
+  if(this->sweep->average) {
+    uint16_t* avg = &this->sweep->average[step];
+    if(this->sweep->sweeps == 0) {
+      *avg = mean;
+    } else {
+      *avg = (uint16_t)((int32_t)*avg + (((int32_t)mean - (int32_t)*avg) >> this->sweep->averageShift));
+    }
+  }
+  if(this->sweep->waterfall) {
+    this->sweep->waterfall[(size_t)this->sweep->row * this->sweep->numSteps + step] = (uint8_t)((mean + 0x80) >> 8);
+  }
+}
+
 int16_t SX126x::calibrateImage(float freq) {
   uint8_t data[2] = { 0, 0 };
 
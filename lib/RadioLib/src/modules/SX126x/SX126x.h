@@ -29,6 +29,90 @@
 #define RADIOLIB_SX126X_LR_FHSS_BLOCK_PREAMBLE_BITS             (2)
 #define RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS                      (RADIOLIB_SX126X_LR_FHSS_FRAG_BITS + RADIOLIB_SX126X_LR_FHSS_BLOCK_PREAMBLE_BITS)
 
+/*!
+  \struct SX126xProfile_t
+  \brief Precompiled LoRa configuration for %SX126x series, holding the exact command payloads.
+  Should be created by SX126x::profileLoRa, preferably as a constexpr variable.
+*/
+struct SX126xProfile_t {
+  /*! \brief Status code of the profile build, RADIOLIB_ERR_NONE when the profile is valid. */
+  int16_t err;
+
+  /*! \brief Carrier frequency in MHz. */
+  float freq;
+
+  /*! \brief LoRa bandwidth in kHz. */
+  float bw;
+
+  /*! \brief SetRfFrequency payload. */
+  uint8_t frf[4];
+
+  /*! \brief SetModulationParams payload. */
+  uint8_t modParams[4];
+
+  /*! \brief SetPacketParams payload. */
+  uint8_t pktParams[6];
+
+  /*! \brief LoRa sync word register image. */
+  uint8_t syncWord[2];
+};
+
+// spectral sweep power levels, see SX126xSweep_t
+// level is in 1 dB steps above RADIOLIB_SX126X_SWEEP_LEVEL_MIN dBm, first spectral scan bin is -11 dBm, step between bins is 4 dB
+#define RADIOLIB_SX126X_SWEEP_LEVEL_MIN                         (-160)
+#define RADIOLIB_SX126X_SWEEP_LEVEL_BIN_0                       (-11 - RADIOLIB_SX126X_SWEEP_LEVEL_MIN)
+#define RADIOLIB_SX126X_SWEEP_LEVEL_BIN_STEP                    (4)
+
+/*!
+  \struct SX126xSweep_t
+  \brief Configuration, result buffers and state of spectral sweep, see SX126x::spectralSweepStart.
+  Power is stored as level in 1 dB steps, 0 corresponds to RADIOLIB_SX126X_SWEEP_LEVEL_MIN dBm.
+  All result buffers are provided by the user and may be NULL when not needed.
+*/
+struct SX126xSweep_t {
+  /*! \brief Frequency of the first step in MHz. */
+  float freqStart;
+
+  /*! \brief Frequency step in MHz, should not be larger than the configured receiver bandwidth. */
+  float freqStep;
+
+  /*! \brief Number of frequency steps in one sweep. */
+  uint16_t numSteps;
+
+  /*! \brief Number of samples in each spectral scan, fewer samples = faster sweep. */
+  uint16_t numSamples;
+
+  /*! \brief RSSI averaging window, see SX126x::spectralScanStart. */
+  uint8_t window;
+
+  /*! \brief Scan interval, one of RADIOLIB_SX126X_SCAN_INTERVAL_* macros. */
+  uint8_t interval;
+
+  /*! \brief Highest level seen at each step, numSteps long. Reset by the user (e.g. by zeroing). */
+  uint8_t* maxHold;
+
+  /*! \brief Exponential average of mean level at each step in 8.8 fixed point, numSteps long. */
+  uint16_t* average;
+
+  /*! \brief Weight of new sweep in the average is 1/2^averageShift. */
+  uint8_t averageShift;
+
+  /*! \brief Mean level at each step for the last numRows sweeps, numRows*numSteps long, used as ring buffer. */
+  uint8_t* waterfall;
+
+  /*! \brief Number of rows in waterfall. */
+  uint16_t numRows;
+
+  /*! \brief Step that is currently being scanned, updated by the driver. */
+  uint16_t step;
+
+  /*! \brief Waterfall row that is currently being filled, updated by the driver. */
+  uint16_t row;
+
+  /*! \brief Number of completed sweeps, updated by the driver. */
+  uint32_t sweeps;
+};
+
 /*!
   \class SX126x
   \brief Base class for %SX126x series. All derived classes for %SX126x (e.g. SX1262 or SX1268) inherit from this base class.
@@ -127,6 +211,18 @@ class SX126x: public PhysicalLayer {
     */
     int16_t setLrFhssConfig(uint8_t bw, uint8_t cr, uint8_t hdrCount = 3, uint16_t hopSeqId = 0x100);
 
+    /*!
+      \brief Decode LR-FHSS frame back to payload. This reverses the interleaving, convolutional coding,
+      CRC and whitening applied on transmission, so it is mostly useful to verify transmitted frames bit-exactly
+      or to process frames demodulated from a recording. Does not require a radio to be present.
+      \param in Physical frame bits (headers followed by payload blocks), as transmitted.
+      \param in_bits Number of bits in the frame.
+      \param out Buffer to save the payload into, must be large enough for the payload length indicated in the header.
+      \param out_len Pointer to a variable to save the payload length into.
+      \returns \ref status_codes
+    */
+    static int16_t decodeLRFHSSPacket(const uint8_t* in, size_t in_bits, uint8_t* out, size_t* out_len);
+
     /*!
       \brief Reset method. Will reset the chip to the default state using RST pin.
       \param verify Whether correct module startup should be verified. When set to true, RadioLib will attempt to verify the module has started correctly
@@ -570,7 +666,7 @@ class SX126x: public PhysicalLayer {
 
       \returns Frequency error in Hz.
     */
-    float getFrequencyError();
+    float getFrequencyError() override;
 
     /*!
       \brief Query modem for the packet length of received payload.
@@ -729,6 +825,47 @@ class SX126x: public PhysicalLayer {
     */
     int16_t getModem(ModemType_t* modem) override;
     
+    /*!
+      \brief Build LoRa configuration profile. All parameters are validated and converted
+      to command payloads at compile time when the result is assigned to a constexpr variable.
+      Low data rate optimization is set automatically, same as with autoLDRO.
+      \param freq Carrier frequency in MHz. Allowed values range from 150.0 MHz to 960.0 MHz,
+      the device-specific range is not checked.
+      \param bw LoRa bandwidth in kHz.
+      \param sf LoRa spreading factor. Allowed values are in range 5 to 12.
+      \param cr LoRa coding rate denominator. Allowed values range from 5 to 8.
+      \param syncWord 1-byte LoRa sync word.
+      \param preambleLength LoRa preamble length in symbols.
+      \param crc Whether payload CRC is enabled.
+      \param implicitLen Payload length in implicit header mode, 0 for explicit header.
+      \param invertIQ Whether IQ inversion is enabled.
+      \returns The profile, check its err member for build status.
+    */
+    static constexpr SX126xProfile_t profileLoRa(float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord = RADIOLIB_SX126X_SYNC_WORD_PRIVATE, uint16_t preambleLength = 8, bool crc = true,
+      uint8_t implicitLen = 0, bool invertIQ = false) {
+      return(profileLoRaImage(freq, bw, sf, cr, syncWord, preambleLength, crc, implicitLen, invertIQ,
+        profileBandwidth(bw), profileFrf(freq)));
+    }
+
+    /*!
+      \brief Apply a precompiled LoRa configuration profile. Packet type, frequency, modulation,
+      packet parameters and sync word are sent in two chained SPI transactions, regardless
+      of how many of the parameters differ from the current configuration.
+      Image calibration and inverted IQ fix are only performed when needed.
+      Must be called while the radio is in standby mode.
+      \param profile Profile to apply.
+      \returns \ref status_codes
+    */
+    int16_t applyProfile(const SX126xProfile_t& profile);
+
+    /*!
+      \brief Stage a configuration profile to be applied when the next transmission or reception is started,
+      right before the mode is staged. The profile must stay valid until then.
+      \param profile Profile to stage, or NULL to cancel the previously staged profile.
+    */
+    void stageProfile(const SX126xProfile_t* profile);
+
     /*! \copydoc PhysicalLayer::stageMode */
     int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override;
 
@@ -787,6 +924,37 @@ class SX126x: public PhysicalLayer {
     */
     int16_t spectralScanGetResult(uint16_t* results);
 
+    /*!
+      \brief Start spectral sweep across a frequency range. Requires binary patch to be uploaded
+      and the radio to be configured the same way as for spectralScanStart. Image calibration
+      is only performed for the start frequency, so the range should stay within a single band.
+      \param sweep Sweep configuration, must stay valid until the sweep is stopped.
+      \returns \ref status_codes
+    */
+    int16_t spectralSweepStart(SX126xSweep_t* sweep);
+
+    /*!
+      \brief Non-blocking update of spectral sweep, to be called periodically. When the scan at current step
+      is done, the next step is started right after reading the results, which are then processed while the radio scans.
+      \returns RADIOLIB_ERR_NONE when a full sweep was just completed, RADIOLIB_ERR_RANGING_TIMEOUT
+      when the sweep is still in progress, or other \ref status_codes on error.
+    */
+    int16_t spectralSweepUpdate();
+
+    /*!
+      \brief Stop spectral sweep.
+    */
+    void spectralSweepStop();
+
+    /*!
+      \brief Convert spectral sweep level to power.
+      \param level Level from SX126xSweep_t result buffers.
+      \returns Power in dBm.
+    */
+    static constexpr int16_t spectralSweepPower(uint8_t level) {
+      return((int16_t)level + RADIOLIB_SX126X_SWEEP_LEVEL_MIN);
+    }
+
     /*!
       \brief Set the PA configuration. Allows user to optimize PA for a specific output power
       and matching network. Any calls to this method must be done after calling begin/beginFSK and/or setOutputPower.
@@ -927,6 +1095,64 @@ class SX126x: public PhysicalLayer {
     size_t lrFhssFrameHopsRem = 0;
     size_t lrFhssHopNum = 0;
 
+    const SX126xProfile_t* stagedProfile = NULL;
+
+    SX126xSweep_t* sweep = NULL;
+    uint32_t sweepFrfStart = 0;
+    uint32_t sweepFrfStep = 0;
+    float sweepFreqPrev = 0;
+
+    // start spectral scan at the current sweep step
+    int16_t spectralSweepStep();
+
+    // process scan results of a single sweep step
+    void spectralSweepProcess(uint16_t step, const uint8_t* raw);
+
+    // configuration profile builders, split up so that each one is a single return statement
+    static constexpr bool profileBandwidthMatch(float bw, float ref) {
+      return((bw > ref - 0.001f) && (bw < ref + 0.001f));
+    }
+
+    static constexpr uint8_t profileBandwidth(float bw) {
+      return(profileBandwidthMatch(bw, 7.8f) ? RADIOLIB_SX126X_LORA_BW_7_8 :
+             profileBandwidthMatch(bw, 10.4f) ? RADIOLIB_SX126X_LORA_BW_10_4 :
+             profileBandwidthMatch(bw, 15.6f) ? RADIOLIB_SX126X_LORA_BW_15_6 :
+             profileBandwidthMatch(bw, 20.8f) ? RADIOLIB_SX126X_LORA_BW_20_8 :
+             profileBandwidthMatch(bw, 31.25f) ? RADIOLIB_SX126X_LORA_BW_31_25 :
+             profileBandwidthMatch(bw, 41.7f) ? RADIOLIB_SX126X_LORA_BW_41_7 :
+             profileBandwidthMatch(bw, 62.5f) ? RADIOLIB_SX126X_LORA_BW_62_5 :
+             profileBandwidthMatch(bw, 125.0f) ? RADIOLIB_SX126X_LORA_BW_125_0 :
+             profileBandwidthMatch(bw, 250.0f) ? RADIOLIB_SX126X_LORA_BW_250_0 :
+             profileBandwidthMatch(bw, 500.0f) ? RADIOLIB_SX126X_LORA_BW_500_0 : 0xFF);
+    }
+
+    static constexpr uint32_t profileFrf(float freq) {
+      return((freq >= 150.0f) && (freq <= 960.0f) ?
+        (uint32_t)((freq * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ) : 0);
+    }
+
+    static constexpr SX126xProfile_t profileLoRaImage(float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord, uint16_t preambleLength, bool crc, uint8_t implicitLen, bool invertIQ,
+      uint8_t bwCode, uint32_t frf) {
+      return(SX126xProfile_t{
+        (int16_t)(frf == 0 ? RADIOLIB_ERR_INVALID_FREQUENCY :
+          bwCode == 0xFF ? RADIOLIB_ERR_INVALID_BANDWIDTH :
+          (sf < 5) || (sf > 12) ? RADIOLIB_ERR_INVALID_SPREADING_FACTOR :
+          (cr < 5) || (cr > 8) ? RADIOLIB_ERR_INVALID_CODING_RATE : RADIOLIB_ERR_NONE),
+        freq, bw,
+        { (uint8_t)((frf >> 24) & 0xFF), (uint8_t)((frf >> 16) & 0xFF), (uint8_t)((frf >> 8) & 0xFF), (uint8_t)(frf & 0xFF) },
+        { sf, bwCode, (uint8_t)(cr - 4),
+          (uint8_t)((bwCode != 0xFF) && (sf <= 12) && ((float)(uint32_t(1) << sf) / bw >= 16.0f) ?
+            RADIOLIB_SX126X_LORA_LOW_DATA_RATE_OPTIMIZE_ON : RADIOLIB_SX126X_LORA_LOW_DATA_RATE_OPTIMIZE_OFF) },
+        { (uint8_t)((preambleLength >> 8) & 0xFF), (uint8_t)(preambleLength & 0xFF),
+          (uint8_t)(implicitLen ? RADIOLIB_SX126X_LORA_HEADER_IMPLICIT : RADIOLIB_SX126X_LORA_HEADER_EXPLICIT),
+          (uint8_t)(implicitLen ? implicitLen : 0xFF),
+          (uint8_t)(crc ? RADIOLIB_SX126X_LORA_CRC_ON : RADIOLIB_SX126X_LORA_CRC_OFF),
+          (uint8_t)(invertIQ ? RADIOLIB_SX126X_LORA_IQ_INVERTED : RADIOLIB_SX126X_LORA_IQ_STANDARD) },
+        { (uint8_t)((syncWord & 0xF0) | 0x04), (uint8_t)(((syncWord & 0x0F) << 4) | 0x04) },
+      });
+    }
+
     int16_t modSetup(float tcxoVoltage, bool useRegulatorLDO, uint8_t modem);
     int16_t config(uint8_t modem);
     bool findChip(const char* verStr);
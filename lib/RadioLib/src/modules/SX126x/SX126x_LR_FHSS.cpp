@@ -66,11 +66,7 @@ int16_t SX126x::buildLRFHSSPacket(const uint8_t* in, size_t in_len, uint8_t* out
   }
 
   // calculate the CRC-16 over the whitened data, looks like something custom
-  RadioLibCRCInstance.size = 16;
-  RadioLibCRCInstance.poly = 0x755B;
-  RadioLibCRCInstance.init = 0xFFFF;
-  RadioLibCRCInstance.out = 0x0000;
-  uint16_t crc16 = RadioLibCRCInstance.checksum(out, in_len);
+  uint16_t crc16 = RadioLibCRC::checksum(RadioLibCRCPresetLRFHSSPayload, out, in_len);
 
   // add payload CRC
   out[in_len] = (crc16 >> 8) & 0xFF;
@@ -181,16 +177,12 @@ int16_t SX126x::buildLRFHSSPacket(const uint8_t* in, size_t in_len, uint8_t* out
   raw_header[3] = ((this->lrFhssHopSeqId & 0x000F) << 4);
 
   // CRC-8 used seems to based on 8H2F, but without final XOR
-  RadioLibCRCInstance.size = 8;
-  RadioLibCRCInstance.poly = 0x2F;
-  RadioLibCRCInstance.init = 0xFF;
-  RadioLibCRCInstance.out = 0x00;
 
   uint16_t header_offset = 0;
   for(size_t i = 0; i < this->lrFhssHdrCount; i++) {
     // insert index and calculate the header CRC
     raw_header[3] = (raw_header[3] & ~0x0C) | ((this->lrFhssHdrCount - i - 1) << 2);
-    raw_header[4] = RadioLibCRCInstance.checksum(raw_header, (RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2 - 1));
+    raw_header[4] = RadioLibCRC::checksum(RadioLibCRCPresetLRFHSSHeader, raw_header, (RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2 - 1));
 
     // convolutional encode
     uint8_t coded_header[RADIOLIB_SX126X_LR_FHSS_HDR_BYTES] = { 0 };
@@ -264,6 +256,166 @@ int16_t SX126x::buildLRFHSSPacket(const uint8_t* in, size_t in_len, uint8_t* out
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t SX126x::decodeLRFHSSPacket(const uint8_t* in, size_t in_bits, uint8_t* out, size_t* out_len) {
+  RADIOLIB_ASSERT_PTR(in);
+  RADIOLIB_ASSERT_PTR(out);
+  RADIOLIB_ASSERT_PTR(out_len);
+
+  // find the first header that passes CRC check
+  uint8_t raw_header[RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2] = { 0 };
+  uint8_t hdrCount = 0;
+  const size_t hdrBits = 8*RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2;
+  for(size_t i = 0; (i < 4) && (hdrCount == 0); i++) {
+    size_t header_offset = i*RADIOLIB_SX126X_LR_FHSS_HEADER_BITS;
+    if(header_offset + RADIOLIB_SX126X_LR_FHSS_HEADER_BITS > in_bits) {
+      break;
+    }
+
+    // de-interleave, the coded header is surrounded by the sync word
+    // it is repeated three times so that the tail-biting code can be decoded from the middle copy
+    uint8_t coded_header[3*RADIOLIB_SX126X_LR_FHSS_HDR_BYTES] = { 0 };
+    for(size_t j = 0; j < 2*hdrBits; j++) {
+      size_t pos = header_offset + 2 + j;
+      if(j >= hdrBits) {
+        pos += 8*RADIOLIB_SX126X_LR_FHSS_SYNC_WORD_BYTES;
+      }
+      if(TEST_BIT_IN_ARRAY_LSB(in, pos)) {
+        for(size_t k = 0; k < 3; k++) {
+          SET_BIT_IN_ARRAY_LSB(coded_header, k*2*hdrBits + LrFhssHeaderInterleaver[j]);
+        }
+      }
+    }
+
+    uint8_t decoded[3*RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2] = { 0 };
+    RadioLibConvCodeInstance.begin(2);
+    RadioLibConvCodeInstance.decode(coded_header, 3*2*hdrBits, decoded);
+    memcpy(raw_header, &decoded[RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2], sizeof(raw_header));
+
+    if(raw_header[4] == RadioLibCRC::checksum(RadioLibCRCPresetLRFHSSHeader, raw_header, (RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2 - 1))) {
+      // the header index counts down to the last header
+      hdrCount = i + ((raw_header[3] >> 2) & 0x03) + 1;
+    }
+  }
+
+  if(hdrCount == 0) {
+    return(RADIOLIB_ERR_LORA_HEADER_DAMAGED);
+  }
+
+  // the payload has to fit into the same intermediate buffer as on transmission
+  size_t in_len = raw_header[0];
+  uint8_t cr = (raw_header[1] >> 3) & 0x03;
+  const size_t nb_bits_coded = 3*(8*(in_len + 2) + 6);
+  if(nb_bits_coded > 8*RADIOLIB_SX126X_LR_FHSS_MAX_ENC_SIZE) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+
+  // number of bits that survived puncturing
+  const uint8_t matrix[15] = { 1, 1, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0, 1, 0, 0 };
+  uint8_t matrix_len = 0;
+  switch(cr) {
+    case RADIOLIB_SX126X_LR_FHSS_CR_5_6:
+      matrix_len = 15;
+      break;
+    case RADIOLIB_SX126X_LR_FHSS_CR_2_3:
+      matrix_len = 6;
+      break;
+    case RADIOLIB_SX126X_LR_FHSS_CR_1_2:
+      matrix_len = 3;
+      break;
+  }
+  size_t nb_bits = nb_bits_coded;
+  if(cr != RADIOLIB_SX126X_LR_FHSS_CR_1_3) {
+    nb_bits = 0;
+    for(size_t i = 0; i < nb_bits_coded; i++) {
+      nb_bits += matrix[i % matrix_len];
+    }
+  }
+
+  // de-interleave the payload, walking the same position sequence as the interleaver
+  uint8_t tmp[RADIOLIB_SX126X_LR_FHSS_MAX_ENC_SIZE] = { 0 };
+  uint16_t step = 0;
+  while((size_t)(step * step) < nb_bits) {
+    step++;
+  }
+  const uint16_t step_v = step >> 1;
+  step <<= 1;
+
+  uint16_t pos           = 0;
+  uint16_t st_idx        = 0;
+  uint16_t st_idx_init   = 0;
+  int16_t  bits_left     = nb_bits;
+  size_t   in_row_index  = RADIOLIB_SX126X_LR_FHSS_HEADER_BITS * hdrCount;
+  while(bits_left > 0) {
+    int16_t in_row_width = bits_left;
+    if(in_row_width > RADIOLIB_SX126X_LR_FHSS_FRAG_BITS) {
+      in_row_width = RADIOLIB_SX126X_LR_FHSS_FRAG_BITS;
+    }
+    if(in_row_index + 2 + in_row_width > in_bits) {
+      return(RADIOLIB_ERR_PACKET_TOO_SHORT);
+    }
+
+    for(int16_t j = 0; j < in_row_width; j++) {
+      if(TEST_BIT_IN_ARRAY_LSB(in, j + 2 + in_row_index)) {
+        SET_BIT_IN_ARRAY_LSB(tmp, pos);
+      }
+
+      pos += step;
+      if(pos >= nb_bits) {
+        st_idx += step_v;
+        if(st_idx >= step) {
+          st_idx_init++;
+          st_idx = st_idx_init;
+        }
+        pos = st_idx;
+      }
+    }
+
+    bits_left -= RADIOLIB_SX126X_LR_FHSS_FRAG_BITS;
+    in_row_index += 2 + in_row_width;
+  }
+
+  // de-puncture into soft bits, the removed ones are erasures
+  #if RADIOLIB_STATIC_ONLY
+    uint8_t soft[8*RADIOLIB_SX126X_LR_FHSS_MAX_ENC_SIZE];
+  #else
+    uint8_t* soft = new uint8_t[nb_bits_coded];
+  #endif
+  size_t j = 0;
+  for(size_t i = 0; i < nb_bits_coded; i++) {
+    if((cr == RADIOLIB_SX126X_LR_FHSS_CR_1_3) || matrix[i % matrix_len]) {
+      soft[i] = TEST_BIT_IN_ARRAY_LSB(tmp, j) ? 0xFF : 0x00;
+      j++;
+    } else {
+      soft[i] = 0x80;
+    }
+  }
+
+  // decode the payload with CRC, the encoder is flushed with zeros so it ends in the zero state
+  uint8_t decoded[RADIOLIB_SX126X_MAX_PACKET_LENGTH + 3] = { 0 };
+  RadioLibConvCodeInstance.begin(3);
+  int16_t state = RadioLibConvCodeInstance.decodeSoft(soft, nb_bits_coded, decoded, NULL, true);
+  #if !RADIOLIB_STATIC_ONLY
+    delete[] soft;
+  #endif
+  RADIOLIB_ASSERT(state);
+
+  uint16_t crc16 = RadioLibCRC::checksum(RadioLibCRCPresetLRFHSSPayload, decoded, in_len);
+  if(crc16 != (((uint16_t)decoded[in_len] << 8) | decoded[in_len + 1])) {
+    return(RADIOLIB_ERR_CRC_MISMATCH);
+  }
+
+  // finally, undo the whitening
+  uint8_t lfsr = 0xFF;
+  for(size_t i = 0; i < in_len; i++) {
+    uint8_t u = ((decoded[i] & 0x0F) << 4 ) | ((decoded[i] & 0xF0) >> 4);
+    out[i] = u ^ lfsr;
+    lfsr = (lfsr << 1) | (((lfsr & 0x80) >> 7) ^ (((lfsr & 0x20) >> 5) ^ (((lfsr & 0x10) >> 4) ^ ((lfsr & 0x08) >> 3))));
+  }
+  *out_len = in_len;
+
+  return(RADIOLIB_ERR_NONE);
+}
+
 int16_t SX126x::resetLRFHSS() {
   // initialize hopping configuration
   const uint16_t numChan[] = { 80, 176, 280, 376, 688, 792, 1480, 1584, 3120, 3224 };
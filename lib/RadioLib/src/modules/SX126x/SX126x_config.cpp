@@ -769,6 +769,63 @@ int16_t SX126x::setHeaderType(uint8_t hdrType, size_t len) {
   return(state);
 }
 
+int16_t SX126x::applyProfile(const SX126xProfile_t& profile) {
+  // check the profile was built correctly
+  RADIOLIB_ASSERT(profile.err);
+
+  // check if we need to recalibrate image
+  int16_t state;
+  if(fabsf(profile.freq - this->freqMHz) >= RADIOLIB_SX126X_CAL_IMG_FREQ_TRIG_MHZ) {
+    state = this->calibrateImage(profile.freq);
+    RADIOLIB_ASSERT(state);
+  }
+
+  // the inverted IQ fix is a read-modify-write, only do it when IQ setup actually changes
+  uint8_t invertIQ = profile.pktParams[5];
+  if(invertIQ != this->invertIQEnabled) {
+    state = fixInvertedIQ(invertIQ);
+    RADIOLIB_ASSERT(state);
+  }
+
+  // packet type has to be set first, the rest of the commands depends on it
+  const uint8_t cmdType[] = { RADIOLIB_SX126X_CMD_SET_PACKET_TYPE };
+  const uint8_t cmdFreq[] = { RADIOLIB_SX126X_CMD_SET_RF_FREQUENCY };
+  const uint8_t cmdMod[] = { RADIOLIB_SX126X_CMD_SET_MODULATION_PARAMS };
+  const uint8_t cmdPkt[] = { RADIOLIB_SX126X_CMD_SET_PACKET_PARAMS };
+  const uint8_t type[] = { RADIOLIB_SX126X_PACKET_TYPE_LORA };
+  Module::SPITransaction_t config[] = {
+    { cmdType, 1, true, type, NULL, 1, RADIOLIB_ERR_NONE },
+    { cmdFreq, 1, true, profile.frf, NULL, 4, RADIOLIB_ERR_NONE },
+    { cmdMod, 1, true, profile.modParams, NULL, 4, RADIOLIB_ERR_NONE },
+    { cmdPkt, 1, true, profile.pktParams, NULL, 6, RADIOLIB_ERR_NONE },
+  };
+  state = this->mod->SPItransferChain(config, 4);
+  RADIOLIB_ASSERT(state);
+
+  // sync word register
+  state = writeRegister(RADIOLIB_SX126X_REG_LORA_SYNC_WORD_MSB, profile.syncWord, 2);
+  RADIOLIB_ASSERT(state);
+
+  // everything was written, update the cached configuration
+  this->freqMHz = profile.freq;
+  this->bandwidthKhz = profile.bw;
+  this->spreadingFactor = profile.modParams[0];
+  this->bandwidth = profile.modParams[1];
+  this->codingRate = profile.modParams[2];
+  this->ldrOptimize = profile.modParams[3];
+  this->ldroAuto = true;
+  this->preambleLengthLoRa = ((uint16_t)profile.pktParams[0] << 8) | profile.pktParams[1];
+  this->headerType = profile.pktParams[2];
+  this->implicitLen = profile.pktParams[3];
+  this->crcTypeLoRa = profile.pktParams[4];
+  this->invertIQEnabled = invertIQ;
+  return(state);
+}
+
+void SX126x::stageProfile(const SX126xProfile_t* profile) {
+  this->stagedProfile = profile;
+}
+
 int16_t SX126x::setFrequencyRaw(float freq) {
   // calculate raw value
   this->freqMHz = freq;
@@ -172,6 +172,30 @@ class SX1272: public SX127x {
     */
     int16_t setCodingRate(uint8_t cr);
 
+    /*!
+      \brief Build %LoRa configuration profile to be applied by SX127x::applyProfile. All parameters
+      are validated and converted to register values at compile time when the result is assigned
+      to a constexpr variable. Low data rate optimization is set automatically, SF6 enables implicit header mode.
+      \param freq Carrier frequency in MHz. Allowed values range from 860.0 MHz to 1020.0 MHz.
+      \param bw %LoRa link bandwidth in kHz. Allowed values are 125, 250 and 500 kHz.
+      \param sf %LoRa link spreading factor. Allowed values range from 6 to 12.
+      \param cr %LoRa link coding rate denominator. Allowed values range from 5 to 8.
+      \param syncWord %LoRa sync word.
+      \param preambleLength Length of %LoRa transmission preamble in symbols, minimum 6.
+      \param crc Whether payload CRC is enabled.
+      \returns The profile, check its err member for build status.
+    */
+    static constexpr SX127xProfile_t profileLoRa(float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord = RADIOLIB_SX127X_SYNC_WORD, uint16_t preambleLength = 8, bool crc = true) {
+      return(profileLoRaImage(profileCheck(freq < 860.0f ? 0 : profileFrf(freq), profileBandwidth(bw), sf, cr, preambleLength),
+        freq, bw, sf, cr, syncWord, preambleLength, crc, profileLdro(bw, sf), profileFrf(freq),
+        (uint8_t)(profileBandwidth(bw) | ((uint8_t)(cr - 4) << 3) | (sf == 6 ? RADIOLIB_SX1272_HEADER_IMPL_MODE : RADIOLIB_SX1272_HEADER_EXPL_MODE) |
+          (crc ? RADIOLIB_SX1272_RX_CRC_MODE_ON : RADIOLIB_SX1272_RX_CRC_MODE_OFF) |
+          (profileLdro(bw, sf) ? RADIOLIB_SX1272_LOW_DATA_RATE_OPT_ON : RADIOLIB_SX1272_LOW_DATA_RATE_OPT_OFF)),
+        (uint8_t)((uint8_t)(sf << 4) | RADIOLIB_SX127X_TX_MODE_SINGLE), 0xF8,
+        0x00, 0x00, 0x00));
+    }
+
     /*!
       \brief Sets FSK bit rate. Allowed values range from 0.5 to 300 kbps. Only available in FSK mode.
       \param br Bit rate to be set (in kbps).
@@ -325,6 +349,12 @@ class SX1272: public SX127x {
     int16_t setSpreadingFactorRaw(uint8_t newSpreadingFactor);
     int16_t setCodingRateRaw(uint8_t newCodingRate);
 
+    static constexpr uint8_t profileBandwidth(float bw) {
+      return(profileBandwidthMatch(bw, 125.0f) ? RADIOLIB_SX1272_BW_125_00_KHZ :
+             profileBandwidthMatch(bw, 250.0f) ? RADIOLIB_SX1272_BW_250_00_KHZ :
+             profileBandwidthMatch(bw, 500.0f) ? RADIOLIB_SX1272_BW_500_00_KHZ : 0xFF);
+    }
+
     int16_t configFSK() override;
     void errataFix(bool rx) override;
 
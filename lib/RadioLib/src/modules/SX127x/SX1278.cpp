@@ -80,6 +80,11 @@ void SX1278::reset() {
   mod->hal->delay(1);
   mod->hal->digitalWrite(mod->getRst(), mod->hal->GpioLevelHigh);
   mod->hal->delay(5);
+
+  #if RADIOLIB_SPI_REG_SHADOW
+  // all registers are back at their defaults
+  mod->SPIinvalidateRegShadow();
+  #endif
 }
 
 int16_t SX1278::setFrequency(float freq) {
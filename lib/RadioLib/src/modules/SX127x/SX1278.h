@@ -183,6 +183,30 @@ class SX1278: public SX127x {
     */
     int16_t setCodingRate(uint8_t cr);
 
+    /*!
+      \brief Build %LoRa configuration profile to be applied by SX127x::applyProfile. All parameters
+      are validated and converted to register values at compile time when the result is assigned
+      to a constexpr variable. Low data rate optimization is set automatically, SF6 enables implicit header mode.
+      \param freq Carrier frequency in MHz. Allowed values range from 137.0 MHz to 1020.0 MHz,
+      the device-specific range is not checked.
+      \param bw %LoRa link bandwidth in kHz. Allowed values are 7.8, 10.4, 15.6, 20.8, 31.25, 41.7, 62.5, 125, 250 and 500 kHz.
+      \param sf %LoRa link spreading factor. Allowed values range from 6 to 12.
+      \param cr %LoRa link coding rate denominator. Allowed values range from 5 to 8.
+      \param syncWord %LoRa sync word.
+      \param preambleLength Length of %LoRa transmission preamble in symbols, minimum 6.
+      \param crc Whether payload CRC is enabled.
+      \returns The profile, check its err member for build status.
+    */
+    static constexpr SX127xProfile_t profileLoRa(float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord = RADIOLIB_SX127X_SYNC_WORD, uint16_t preambleLength = 8, bool crc = true) {
+      return(profileLoRaImage(profileCheck(profileFrf(freq), profileBandwidth(bw), sf, cr, preambleLength),
+        freq, bw, sf, cr, syncWord, preambleLength, crc, profileLdro(bw, sf), profileFrf(freq),
+        (uint8_t)(profileBandwidth(bw) | ((uint8_t)(cr - 4) << 1) | (sf == 6 ? RADIOLIB_SX1278_HEADER_IMPL_MODE : RADIOLIB_SX1278_HEADER_EXPL_MODE)),
+        (uint8_t)((uint8_t)(sf << 4) | RADIOLIB_SX127X_TX_MODE_SINGLE | (crc ? RADIOLIB_SX1278_RX_CRC_MODE_ON : RADIOLIB_SX1278_RX_CRC_MODE_OFF)), 0xFC,
+        RADIOLIB_SX1278_REG_MODEM_CONFIG_3,
+        (uint8_t)(profileLdro(bw, sf) ? RADIOLIB_SX1278_LOW_DATA_RATE_OPT_ON : RADIOLIB_SX1278_LOW_DATA_RATE_OPT_OFF), 0x08));
+    }
+
     /*!
       \brief Sets FSK bit rate. Allowed values range from 0.5 to 300 kbps. Only available in FSK mode.
       \param br Bit rate to be set (in kbps).
@@ -337,6 +361,19 @@ class SX1278: public SX127x {
     int16_t setSpreadingFactorRaw(uint8_t newSpreadingFactor);
     int16_t setCodingRateRaw(uint8_t newCodingRate);
 
+    static constexpr uint8_t profileBandwidth(float bw) {
+      return(profileBandwidthMatch(bw, 7.8f) ? RADIOLIB_SX1278_BW_7_80_KHZ :
+             profileBandwidthMatch(bw, 10.4f) ? RADIOLIB_SX1278_BW_10_40_KHZ :
+             profileBandwidthMatch(bw, 15.6f) ? RADIOLIB_SX1278_BW_15_60_KHZ :
+             profileBandwidthMatch(bw, 20.8f) ? RADIOLIB_SX1278_BW_20_80_KHZ :
+             profileBandwidthMatch(bw, 31.25f) ? RADIOLIB_SX1278_BW_31_25_KHZ :
+             profileBandwidthMatch(bw, 41.7f) ? RADIOLIB_SX1278_BW_41_70_KHZ :
+             profileBandwidthMatch(bw, 62.5f) ? RADIOLIB_SX1278_BW_62_50_KHZ :
+             profileBandwidthMatch(bw, 125.0f) ? RADIOLIB_SX1278_BW_125_00_KHZ :
+             profileBandwidthMatch(bw, 250.0f) ? RADIOLIB_SX1278_BW_250_00_KHZ :
+             profileBandwidthMatch(bw, 500.0f) ? RADIOLIB_SX1278_BW_500_00_KHZ : 0xFF);
+    }
+
     int16_t configFSK() override;
     void errataFix(bool rx) override;
 
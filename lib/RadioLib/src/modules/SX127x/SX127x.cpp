@@ -2,6 +2,18 @@
 #include <math.h>
 #if !RADIOLIB_EXCLUDE_SX127X
 
+#if RADIOLIB_SPI_REG_SHADOW
+// registers that may be held in the register shadow, one bit per register, LSB first
+// excluded are the FIFO, operation mode, IRQ flags, status and measurement registers and self-clearing triggers
+static const uint8_t regShadowLoRa[RADIOLIB_SX127X_REG_SHADOW_SIZE / 8] RADIOLIB_NONVOLATILE = {
+  0xFC, 0xDF, 0x02, 0xE0, 0xDF, 0xE8, 0xFF, 0x2F, 0xFF, 0xFF, 0xFF, 0xF7, 0xFF, 0xEF, 0xFF, 0xFF,
+};
+
+static const uint8_t regShadowFSK[RADIOLIB_SX127X_REG_SHADOW_SIZE / 8] RADIOLIB_NONVOLATILE = {
+  0xFC, 0xDF, 0xFD, 0x83, 0xEF, 0xFF, 0xBF, 0x27, 0xFF, 0xFF, 0xFF, 0xF7, 0xFF, 0xEF, 0xFF, 0xFF,
+};
+#endif
+
 SX127x::SX127x(Module* mod) : PhysicalLayer() {
   this->freqStep = RADIOLIB_SX127X_FREQUENCY_STEP_SIZE;
   this->maxPacketLength = RADIOLIB_SX127X_MAX_PACKET_LENGTH;
@@ -47,6 +59,9 @@ int16_t SX127x::begin(const uint8_t* chipVersions, uint8_t numVersions, uint8_t
     // set LoRa mode
     state = setActiveModem(RADIOLIB_SX127X_LORA);
     RADIOLIB_ASSERT(state);
+  } else {
+    // modem is already active, but register shadow has to be set up
+    setRegShadow(RADIOLIB_SX127X_LORA);
   }
 
   // set LoRa sync word
@@ -103,6 +118,9 @@ int16_t SX127x::beginFSK(const uint8_t* chipVersions, uint8_t numVersions, float
     // set FSK mode
     state = setActiveModem(RADIOLIB_SX127X_FSK_OOK);
     RADIOLIB_ASSERT(state);
+  } else {
+    // modem is already active, but register shadow has to be set up
+    setRegShadow(RADIOLIB_SX127X_FSK_OOK);
   }
 
   // enable/disable OOK
@@ -169,6 +187,13 @@ int16_t SX127x::transmit(const uint8_t* data, size_t len, uint8_t addr) {
   int16_t state = setMode(RADIOLIB_SX127X_STANDBY);
   RADIOLIB_ASSERT(state);
 
+  // timeout is calculated from the current configuration, so the staged profile has to be applied first
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   int16_t modem = getActiveModem();
   RadioLibTime_t start = 0;
   RadioLibTime_t timeout = 0;
@@ -209,6 +234,13 @@ int16_t SX127x::receive(uint8_t* data, size_t len, RadioLibTime_t timeout) {
   int16_t state = setMode(RADIOLIB_SX127X_STANDBY);
   RADIOLIB_ASSERT(state);
 
+  // timeout is calculated from the current configuration, so the staged profile has to be applied first
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   // calculate timeout based on the configured modem
   RadioLibTime_t timeoutInternal = timeout;
   uint32_t timeoutValue = 0;
@@ -710,6 +742,10 @@ int16_t SX127x::invertPreamble(bool enable) {
   return(RADIOLIB_ERR_UNKNOWN);
 }
 
+float SX127x::getFrequencyError() {
+  return(this->getFrequencyError(false));
+}
+
 float SX127x::getFrequencyError(bool autoCorrect) {
   int16_t modem = getActiveModem();
   if(modem == RADIOLIB_SX127X_LORA) {
@@ -1251,7 +1287,9 @@ RadioLibTime_t SX127x::calculateRxTimeout(RadioLibTime_t timeoutUs) {
 }
 
 uint32_t SX127x::getIrqFlags() {
-  return((uint32_t)this->getIRQFlags());
+  uint32_t irq = (uint32_t)this->getIRQFlags();
+  RADIOLIB_TRACE_EVENT(RADIOLIB_TRACE_IRQ, 0, 0, irq);
+  return(irq);
 }
 
 int16_t SX127x::setIrqFlags(uint32_t irq) {
@@ -1646,7 +1684,15 @@ int16_t SX127x::setMode(uint8_t mode) {
     // disable checking of RX bit in FSK RX mode, as it sometimes seem to fail (#276)
     checkMask = 0xFE;
   }
-  return(this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_OP_MODE, mode, 2, 0, 5, checkMask));
+  int16_t state = this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_OP_MODE, mode, 2, 0, 5, checkMask);
+
+  #if RADIOLIB_SPI_REG_SHADOW
+  // do not trust the shadow after sleep
+  if(mode == RADIOLIB_SX127X_SLEEP) {
+    this->mod->SPIinvalidateRegShadow();
+  }
+  #endif
+  return(state);
 }
 
 int16_t SX127x::getActiveModem() {
@@ -1662,11 +1708,26 @@ int16_t SX127x::setActiveModem(uint8_t modem) {
   // so we exclude it from the check 
   state |= this->mod->SPIsetRegValue(RADIOLIB_SX127X_REG_OP_MODE, modem, 7, 7, 5, 0xF7);
 
+  // register map has changed
+  setRegShadow(modem);
+
   // set mode to STANDBY
   state |= setMode(RADIOLIB_SX127X_STANDBY);
   return(state);
 }
 
+void SX127x::setRegShadow(uint8_t modem) {
+  #if RADIOLIB_SPI_REG_SHADOW
+  const uint8_t* cacheable = (modem == RADIOLIB_SX127X_LORA) ? regShadowLoRa : regShadowFSK;
+  this->mod->SPIsetRegShadow(this->regShadow, this->regShadowValid, cacheable, RADIOLIB_SX127X_REG_SHADOW_SIZE);
+
+  // fill the shadow with a single burst read, skipping FIFO and operation mode
+  this->mod->SPIreadRegisterBurst(RADIOLIB_SX127X_REG_OP_MODE + 1, RADIOLIB_SX127X_REG_SHADOW_SIZE - (RADIOLIB_SX127X_REG_OP_MODE + 1), &this->regShadow[RADIOLIB_SX127X_REG_OP_MODE + 1]);
+  #else
+  (void)modem;
+  #endif
+}
+
 void SX127x::clearFIFO(size_t count) {
   while(count) {
     this->mod->SPIreadRegister(RADIOLIB_SX127X_REG_FIFO);
@@ -1712,9 +1773,87 @@ int16_t SX127x::getModem(ModemType_t* modem) {
   return(RADIOLIB_ERR_WRONG_MODEM);
 }
 
+int16_t SX127x::applyProfile(const SX127xProfile_t& profile) {
+  // check the profile was built correctly
+  RADIOLIB_ASSERT(profile.err);
+
+  // check active modem
+  if(getActiveModem() != RADIOLIB_SX127X_LORA) {
+    return(RADIOLIB_ERR_WRONG_MODEM);
+  }
+
+  // set mode to standby
+  int16_t state = setMode(RADIOLIB_SX127X_STANDBY);
+  RADIOLIB_ASSERT(state);
+
+  // build the new register image, registers that already hold the value are skipped
+  // with register shadow enabled, the current values are usually read from the shadow without any SPI access
+  uint8_t values[RADIOLIB_SX127X_PROFILE_NUM_REGS];
+  bool changed[RADIOLIB_SX127X_PROFILE_NUM_REGS];
+  for(size_t i = 0; i < RADIOLIB_SX127X_PROFILE_NUM_REGS; i++) {
+    const SX127xProfileReg_t* reg = &profile.regs[i];
+    values[i] = reg->value;
+    changed[i] = (reg->mask != 0x00);
+    #if !RADIOLIB_SPI_REG_SHADOW
+    if(reg->mask == 0xFF) {
+      continue;
+    }
+    #endif
+    if(changed[i]) {
+      uint8_t current = this->mod->SPIreadRegister(reg->addr);
+      values[i] = (current & ~reg->mask) | (reg->value & reg->mask);
+      changed[i] = (values[i] != current);
+    }
+  }
+
+  // frequency is only updated after LSB is written, so all FRF registers must be written together
+  // the profile image starts with FRF MSB, MID and LSB
+  if(changed[0] || changed[1] || changed[2]) {
+    changed[0] = changed[1] = changed[2] = true;
+  }
+
+  // write runs of consecutive changed registers in bursts
+  size_t i = 0;
+  while(i < RADIOLIB_SX127X_PROFILE_NUM_REGS) {
+    if(!changed[i]) {
+      i++;
+      continue;
+    }
+    size_t len = 1;
+    while((i + len < RADIOLIB_SX127X_PROFILE_NUM_REGS) && changed[i + len] &&
+          (profile.regs[i + len].addr == profile.regs[i].addr + len)) {
+      len++;
+    }
+    this->mod->SPIwriteRegisterBurst(profile.regs[i].addr, &values[i], len);
+    i += len;
+  }
+
+  // update the cached configuration
+  this->frequency = profile.freq;
+  this->bandwidth = profile.bw;
+  this->spreadingFactor = profile.sf;
+  this->codingRate = profile.cr;
+  this->crcEnabled = profile.crc;
+  this->implicitHdr = (profile.sf == 6);
+  this->ldroEnabled = profile.ldro;
+  this->ldroAuto = true;
+  return(state);
+}
+
+void SX127x::stageProfile(const SX127xProfile_t* profile) {
+  this->stagedProfile = profile;
+}
+
 int16_t SX127x::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
   int16_t state;
 
+  // apply the staged profile first, so that the mode is configured with the new settings
+  if(this->stagedProfile) {
+    state = applyProfile(*this->stagedProfile);
+    this->stagedProfile = NULL;
+    RADIOLIB_ASSERT(state);
+  }
+
   switch(mode) {
     case(RADIOLIB_RADIO_MODE_RX): {
       this->rxMode = RADIOLIB_SX127X_RXCONTINUOUS;
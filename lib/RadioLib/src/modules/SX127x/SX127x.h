@@ -16,6 +16,12 @@
 #define RADIOLIB_SX127X_CRYSTAL_FREQ                            32.0f
 #define RADIOLIB_SX127X_DIV_EXPONENT                            19
 
+// number of registers covered by the register shadow (RADIOLIB_SPI_REG_SHADOW)
+#define RADIOLIB_SX127X_REG_SHADOW_SIZE                         0x80
+
+// number of registers in LoRa configuration profile
+#define RADIOLIB_SX127X_PROFILE_NUM_REGS                        11
+
 // SX127x series common LoRa registers
 #define RADIOLIB_SX127X_REG_FIFO                                0x00
 #define RADIOLIB_SX127X_REG_OP_MODE                             0x01
@@ -575,6 +581,52 @@
 #define RADIOLIB_SX127X_PLL_BANDWIDTH_225_KHZ                   0b10000000  //  7     6                  225 kHz
 #define RADIOLIB_SX127X_PLL_BANDWIDTH_300_KHZ                   0b11000000  //  7     6                  300 kHz (default)
 
+/*!
+  \struct SX127xProfileReg_t
+  \brief Single register in %SX127x configuration profile.
+*/
+struct SX127xProfileReg_t {
+  /*! \brief Register address. */
+  uint8_t addr;
+
+  /*! \brief Register value. */
+  uint8_t value;
+
+  /*! \brief Bits of the register covered by the profile, 0 when the register is not used. */
+  uint8_t mask;
+};
+
+/*!
+  \struct SX127xProfile_t
+  \brief Precompiled LoRa configuration for %SX127x series, holding the register image.
+  Should be created by SX1278::profileLoRa or SX1272::profileLoRa, preferably as a constexpr variable.
+*/
+struct SX127xProfile_t {
+  /*! \brief Status code of the profile build, RADIOLIB_ERR_NONE when the profile is valid. */
+  int16_t err;
+
+  /*! \brief Carrier frequency in MHz. */
+  float freq;
+
+  /*! \brief LoRa bandwidth in kHz. */
+  float bw;
+
+  /*! \brief LoRa spreading factor. */
+  uint8_t sf;
+
+  /*! \brief LoRa coding rate denominator. */
+  uint8_t cr;
+
+  /*! \brief Whether payload CRC is enabled. */
+  bool crc;
+
+  /*! \brief Whether low data rate optimization is enabled. */
+  bool ldro;
+
+  /*! \brief Register image, sorted by address. */
+  SX127xProfileReg_t regs[RADIOLIB_SX127X_PROFILE_NUM_REGS];
+};
+
 /*!
   \class SX127x
   \brief Base class for SX127x series. All derived classes for SX127x (e.g. SX1278 or SX1272) inherit from this base class.
@@ -888,12 +940,18 @@ class SX127x: public PhysicalLayer {
     */
     int16_t invertPreamble(bool enable);
 
+    /*!
+      \brief Gets frequency error of the latest received packet.
+      \returns Frequency error in Hz.
+    */
+    float getFrequencyError() override;
+
     /*!
       \brief Gets frequency error of the latest received packet.
       \param autoCorrect When set to true, frequency will be automatically corrected.
       \returns Frequency error in Hz.
     */
-    float getFrequencyError(bool autoCorrect = false);
+    float getFrequencyError(bool autoCorrect);
 
     /*!
       \brief Gets current AFC error.
@@ -1180,6 +1238,22 @@ class SX127x: public PhysicalLayer {
     */
     int16_t getModem(ModemType_t* modem) override;
     
+    /*!
+      \brief Apply a precompiled LoRa configuration profile. Registers that already hold the profile value
+      are skipped, the rest is written in burst transactions of consecutive registers.
+      Radio is switched to standby. Only available in %LoRa mode.
+      \param profile Profile to apply.
+      \returns \ref status_codes
+    */
+    int16_t applyProfile(const SX127xProfile_t& profile);
+
+    /*!
+      \brief Stage a configuration profile to be applied when the next transmission or reception is started,
+      right before the mode is staged. The profile must stay valid until then.
+      \param profile Profile to stage, or NULL to cancel the previously staged profile.
+    */
+    void stageProfile(const SX127xProfile_t* profile);
+
     /*! \copydoc PhysicalLayer::stageMode */
     int16_t stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) override;
 
@@ -1282,6 +1356,46 @@ class SX127x: public PhysicalLayer {
     float getRSSI(bool packet, bool skipReceive, int16_t offset);
     int16_t setHeaderType(uint8_t headerType, uint8_t bitIndex, size_t len = 0xFF);
 
+    // configuration profile helpers shared by SX1278 and SX1272 builders
+    static constexpr uint32_t profileFrf(float freq) {
+      return((freq >= 137.0f) && (freq <= 1020.0f) ?
+        (uint32_t)((freq * (uint32_t(1) << RADIOLIB_SX127X_DIV_EXPONENT)) / RADIOLIB_SX127X_CRYSTAL_FREQ) : 0);
+    }
+
+    static constexpr bool profileBandwidthMatch(float bw, float ref) {
+      return((bw > ref - 0.001f) && (bw < ref + 0.001f));
+    }
+
+    static constexpr bool profileLdro(float bw, uint8_t sf) {
+      return((bw > 0.0f) && (sf <= 12) && ((float)(uint32_t(1) << sf) / bw >= 16.0f));
+    }
+
+    static constexpr int16_t profileCheck(uint32_t frf, uint8_t bwCode, uint8_t sf, uint8_t cr, uint16_t preambleLength) {
+      return(frf == 0 ? RADIOLIB_ERR_INVALID_FREQUENCY :
+             bwCode == 0xFF ? RADIOLIB_ERR_INVALID_BANDWIDTH :
+             (sf < 6) || (sf > 12) ? RADIOLIB_ERR_INVALID_SPREADING_FACTOR :
+             (cr < 5) || (cr > 8) ? RADIOLIB_ERR_INVALID_CODING_RATE :
+             preambleLength < 6 ? RADIOLIB_ERR_INVALID_PREAMBLE_LENGTH : RADIOLIB_ERR_NONE);
+    }
+
+    static constexpr SX127xProfile_t profileLoRaImage(int16_t err, float freq, float bw, uint8_t sf, uint8_t cr,
+      uint8_t syncWord, uint16_t preambleLength, bool crc, bool ldro, uint32_t frf,
+      uint8_t modemConfig1, uint8_t modemConfig2, uint8_t modemConfig2Mask, uint8_t modemConfig3Addr, uint8_t modemConfig3, uint8_t modemConfig3Mask) {
+      return(SX127xProfile_t{ err, freq, bw, sf, cr, crc, ldro, {
+        { RADIOLIB_SX127X_REG_FRF_MSB, (uint8_t)((frf >> 16) & 0xFF), 0xFF },
+        { RADIOLIB_SX127X_REG_FRF_MID, (uint8_t)((frf >> 8) & 0xFF), 0xFF },
+        { RADIOLIB_SX127X_REG_FRF_LSB, (uint8_t)(frf & 0xFF), 0xFF },
+        { RADIOLIB_SX127X_REG_MODEM_CONFIG_1, modemConfig1, 0xFF },
+        { RADIOLIB_SX127X_REG_MODEM_CONFIG_2, modemConfig2, modemConfig2Mask },
+        { RADIOLIB_SX127X_REG_PREAMBLE_MSB, (uint8_t)((preambleLength >> 8) & 0xFF), 0xFF },
+        { RADIOLIB_SX127X_REG_PREAMBLE_LSB, (uint8_t)(preambleLength & 0xFF), 0xFF },
+        { modemConfig3Addr, modemConfig3, modemConfig3Mask },
+        { RADIOLIB_SX127X_REG_DETECT_OPTIMIZE, (uint8_t)(sf == 6 ? RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_6 : RADIOLIB_SX127X_DETECT_OPTIMIZE_SF_7_12), 0x07 },
+        { RADIOLIB_SX127X_REG_DETECTION_THRESHOLD, (uint8_t)(sf == 6 ? RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_6 : RADIOLIB_SX127X_DETECTION_THRESHOLD_SF_7_12), 0xFF },
+        { RADIOLIB_SX127X_REG_SYNC_WORD, syncWord, 0xFF },
+      }});
+    }
+
 #if !RADIOLIB_GODMODE
   private:
 #endif
@@ -1292,6 +1406,7 @@ class SX127x: public PhysicalLayer {
     bool packetLengthQueried = false; // FSK packet length is the first byte in FIFO, length can only be queried once
     uint8_t packetLengthConfig = RADIOLIB_SX127X_PACKET_VARIABLE;
     uint8_t rxMode = RADIOLIB_SX127X_RXCONTINUOUS;
+    const SX127xProfile_t* stagedProfile = NULL;
 
     int16_t config();
     int16_t directMode();
@@ -1301,6 +1416,14 @@ class SX127x: public PhysicalLayer {
     int16_t setActiveModem(uint8_t modem);
     void clearFIFO(size_t count); // used mostly to clear remaining bytes in FIFO after a packet read
 
+    #if RADIOLIB_SPI_REG_SHADOW
+    uint8_t regShadow[RADIOLIB_SX127X_REG_SHADOW_SIZE] = { 0 };
+    uint8_t regShadowValid[RADIOLIB_SX127X_REG_SHADOW_SIZE / 8] = { 0 };
+    #endif
+
+    // select the register shadow for the active modem, register map is different in LoRa and FSK/OOK mode
+    void setRegShadow(uint8_t modem);
+
     /*!
       \brief Calculate exponent and mantissa values for receiver bandwidth and AFC
       \param bandwidth bandwidth to be set (in kHz).
@@ -6,6 +6,36 @@
 
 #if !RADIOLIB_EXCLUDE_LORAWAN
 
+// flag to indicate whether there was some action during Tx or Rx mode (Tx done, Rx timeout or downlink)
+static volatile bool radioAction = false;
+
+// user-provided function to call on radio action, e.g. to wake up the task that polls the node
+// this is a copy of the callback of the node that last armed the interrupt
+static void (*radioActionCb)(void) = NULL;
+
+// time of the last radio action in microseconds, captured in the interrupt to avoid the servicing latency
+static RadioLibHal* radioActionHal = NULL;
+static volatile RadioLibTime_t radioActionUs = 0;
+
+// interrupt service routine to handle uplinks and downlinks automatically
+#if defined(ESP8266) || defined(ESP32)
+  IRAM_ATTR
+#endif
+static void LoRaWANNodeOnRadioAction(void) {
+  if(radioActionHal) {
+    radioActionUs = radioActionHal->micros();
+  }
+  radioAction = true;
+  if(radioActionCb) {
+    radioActionCb();
+  }
+}
+
+// check whether a deadline was reached, correct across the rollover of the millisecond clock
+static inline bool LoRaWANNodeDeadlineReached(RadioLibTime_t tNow, RadioLibTime_t deadline) {
+  return((int32_t)(tNow - deadline) >= 0);
+}
+
 LoRaWANNode::LoRaWANNode(PhysicalLayer* phy, const LoRaWANBand_t* band, uint8_t subBand) {
   this->phyLayer = phy;
   this->band = band;
@@ -64,9 +94,39 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
 }
 
 int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort, uint8_t* dataDown, size_t* lenDown, bool isConfirmed, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown) {
-  if((lenUp > 0 && !dataUp) || !dataDown || !lenDown) {
+  if(!dataDown || !lenDown) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  int16_t state = this->startSendReceive(dataUp, lenUp, fPort, isConfirmed);
+  RADIOLIB_ASSERT(state);
+
+  // run the exchange to completion, sleeping until the next deadline whenever possible
+  Module* mod = this->phyLayer->getMod();
+  while((state = this->poll(dataDown, lenDown, eventUp, eventDown)) == RADIOLIB_LORAWAN_PENDING) {
+    RadioLibTime_t tNow = mod->hal->millis();
+    if(this->asyncIrq || LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+      // yield for multi-threaded platforms
+      mod->hal->yield();
+    } else {
+      // the radio may only be turned off while it is not on air or listening
+      bool radioOff = (this->asyncState != RADIOLIB_LORAWAN_ASYNC_TX) && (this->asyncState != RADIOLIB_LORAWAN_ASYNC_RX);
+      this->sleepDelay(this->asyncDeadline - tNow, radioOff);
+    }
+  }
+
+  return(state);
+}
+
+int16_t LoRaWANNode::startSendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort, bool isConfirmed) {
+  if(lenUp > 0 && !dataUp) {
     return(RADIOLIB_ERR_NULL_POINTER);
   }
+
+  // only one exchange may be in progress
+  if(this->asyncState != RADIOLIB_LORAWAN_ASYNC_IDLE) {
+    return(RADIOLIB_ERR_UPLINK_UNAVAILABLE);
+  }
   int16_t state = RADIOLIB_ERR_UNKNOWN;
   
   // if after (at) ADR_ACK_LIMIT frames no RekeyConf was received, revert to Join state
@@ -109,12 +169,12 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   this->fOptsDownLen = 0;
 
   // the first 16 bytes are reserved for MIC calculation blocks
-  size_t uplinkMsgLen = RADIOLIB_LORAWAN_FRAME_LEN(lenUp, this->fOptsUpLen);
+  // the uplink message is kept until the exchange is finished, as it may have to be retransmitted
+  this->asyncMsgLen = RADIOLIB_LORAWAN_FRAME_LEN(lenUp, this->fOptsUpLen);
   #if RADIOLIB_STATIC_ONLY
-  uint8_t uplinkMsg[RADIOLIB_STATIC_ARRAY_SIZE];
   uint8_t frmPayload[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-  uint8_t* uplinkMsg = new uint8_t[uplinkMsgLen];
+  this->asyncMsg = new uint8_t[this->asyncMsgLen];
   uint8_t* frmPayload = new uint8_t[lenUp + this->fOptsUpLen];
   #endif
 
@@ -137,72 +197,371 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   }
   
   // build the encrypted uplink message
-  this->composeUplink(frmPayload, frmLen, uplinkMsg, fPort, isConfirmed);
+  state = this->composeUplink(frmPayload, frmLen, this->asyncMsg, fPort, isConfirmed);
+
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] frmPayload;
+  #endif
+
+  if(state != RADIOLIB_ERR_NONE) {
+    #if !RADIOLIB_STATIC_ONLY
+    delete[] this->asyncMsg;
+    this->asyncMsg = NULL;
+    #endif
+    this->asyncState = RADIOLIB_LORAWAN_ASYNC_IDLE;
+    return(state);
+  }
 
   // reset Time-on-Air as we are starting new uplink sequence
   this->lastToA = 0;
 
-  // repeat uplink+downlink up to 'nbTrans' times (ADR)
-  uint8_t trans = 0;
-  for(; trans < this->nbTrans; trans++) {
+  this->asyncTrans = 0;
+  this->asyncConfirmed = isConfirmed;
+  this->asyncPort = fPort;
+  state = this->asyncTransmit();
+  if(state != RADIOLIB_ERR_NONE) {
+    // act as if a transmission occurred, same as when the uplink fails later on
+    this->fCntUp += 1;
 
-    // keep track of number of hopped channels
-    uint8_t numHops = this->maxChanges;
+    #if !RADIOLIB_STATIC_ONLY
+    delete[] this->asyncMsg;
+    this->asyncMsg = NULL;
+    #endif
+    this->asyncState = RADIOLIB_LORAWAN_ASYNC_IDLE;
+  }
+  return(state);
+}
 
-    // number of additional CAD tries
-    uint8_t numBackoff = 0;
-    if(this->backoffMax) {
-      numBackoff = 1 + rand() % this->backoffMax;
-    }
+int16_t LoRaWANNode::poll(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown) {
+  if(!dataDown || !lenDown) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
 
-    do {
-      // select a pair of Tx/Rx channels for uplink+downlink
-      this->selectChannels();
+  if(this->asyncState == RADIOLIB_LORAWAN_ASYNC_IDLE) {
+    return(RADIOLIB_ERR_INVALID_MODE);
+  }
 
-      // generate and set uplink MIC (depends on selected channel)
-      this->micUplink(uplinkMsg, uplinkMsgLen);
+  Module* mod = this->phyLayer->getMod();
+  RadioLibTime_t tNow = mod->hal->millis();
+  int16_t state = RADIOLIB_ERR_NONE;
+  bool txFailed = false;
 
-    // if CSMA is enabled, repeat channel selection & encryption up to numHops times
-    } while(this->csmaEnabled && numHops-- > 0 && !this->csmaChannelClear(this->difsSlots, numBackoff));
-    
-    // send it (without the MIC calculation blocks)
-    state = this->transmitUplink(&this->channels[RADIOLIB_LORAWAN_UPLINK],
-                                &uplinkMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], 
-                                (uint8_t)(uplinkMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS));
-    if(state != RADIOLIB_ERR_NONE) {
-      // sometimes, a spurious error can occur even though the uplink was transmitted
-      // therefore, just to be safe, increase frame counter by one for the next uplink
-      this->fCntUp += 1;
+  switch(this->asyncState) {
+    case(RADIOLIB_LORAWAN_ASYNC_TX_WAIT):
+      if(!LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+        return(RADIOLIB_LORAWAN_PENDING);
+      }
 
-      #if !RADIOLIB_STATIC_ONLY
-      delete[] uplinkMsg;
-      delete[] frmPayload;
-      #endif
-      return(state);
-    }
+      state = this->launchUplink();
+      if(state != RADIOLIB_ERR_NONE) {
+        txFailed = true;
+        break;
+      }
+
+      // the transmission will not be done before its Time-on-Air elapses
+      this->asyncState = RADIOLIB_LORAWAN_ASYNC_TX;
+      this->asyncDeadline = mod->hal->millis() + this->txToa;
+      this->asyncIrq = false;
+      return(RADIOLIB_LORAWAN_PENDING);
+
+    case(RADIOLIB_LORAWAN_ASYNC_TX):
+      if(!mod->hal->digitalRead(mod->getIrq())) {
+        if(!LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+          return(RADIOLIB_LORAWAN_PENDING);
+        }
+
+        // wait for an additional scanGuard as Tx timeout period
+        if(!this->asyncIrq) {
+          this->asyncIrq = true;
+          this->asyncDeadline = tNow + this->scanGuard + 1;
+          return(RADIOLIB_LORAWAN_PENDING);
+        }
+
+        state = RADIOLIB_ERR_TX_TIMEOUT;
+        txFailed = true;
+        break;
+      }
+
+      state = this->finishUplink();
+      if(state != RADIOLIB_ERR_NONE) {
+        txFailed = true;
+        break;
+      }
+
+      // handle Rx windows
+      this->asyncStep = 0;
+      state = this->asyncNextWindow();
+      break;
+
+    case(RADIOLIB_LORAWAN_ASYNC_RX_WAIT):
+      if(!LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+        return(RADIOLIB_LORAWAN_PENDING);
+      }
+
+      state = this->launchWindow();
+      if(state != RADIOLIB_ERR_NONE) {
+        break;
+      }
+
+      // the Rx window is padded, so the RxTimeout interrupt will not fire before it elapses
+      this->asyncState = RADIOLIB_LORAWAN_ASYNC_RX;
+      this->asyncDeadline = this->rxOpen + this->rxTimeout;
+      this->asyncIrq = false;
+      return(RADIOLIB_LORAWAN_PENDING);
+
+    case(RADIOLIB_LORAWAN_ASYNC_RX):
+      if(!radioAction) {
+        if(!LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+          return(RADIOLIB_LORAWAN_PENDING);
+        }
+
+        // use a small additional delay in case the RxTimeout interrupt is slow to fire
+        if(!this->asyncIrq) {
+          RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window closing", this->rxWindow);
+          this->asyncIrq = true;
+          this->asyncDeadline = this->rxOpen + this->rxTimeout + this->scanGuard + 1;
+          return(RADIOLIB_LORAWAN_PENDING);
+        }
+      }
+
+      // check IRQ bit for RxTimeout, if the window timed out, move on to the next one
+      state = this->checkWindowTimeout();
+      if(state < RADIOLIB_ERR_NONE) {
+        break;
+      } else if(state > 0) {
+        state = this->asyncNextWindow();
+        break;
+      }
+
+      // if the IRQ bit for RxTimeout is not set, something is being received, 
+      // so keep listening for maximum ToA waiting for the DIO to fire
+      if(!radioAction && (this->rxWindow != RADIOLIB_LORAWAN_RX_BC)) {
+        this->asyncState = RADIOLIB_LORAWAN_ASYNC_RX_EXTEND;
+        this->asyncDeadline = this->rxOpen + this->rxToaMax + this->scanGuard;
+        return(RADIOLIB_LORAWAN_PENDING);
+      }
+
+      state = this->asyncFinishWindow(tNow);
+      break;
+
+    case(RADIOLIB_LORAWAN_ASYNC_RX_EXTEND):
+      if(!radioAction && !LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+        return(RADIOLIB_LORAWAN_PENDING);
+      }
+
+      state = this->asyncFinishWindow(tNow);
+      break;
+
+    case(RADIOLIB_LORAWAN_ASYNC_RX_FINISH):
+      state = this->asyncFinishWindow(tNow);
+      break;
+
+    case(RADIOLIB_LORAWAN_ASYNC_RETRANSMIT):
+      if(!LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+        return(RADIOLIB_LORAWAN_PENDING);
+      }
 
-    // handle Rx windows - returns window > 0 if a downlink is received
-    state = this->receiveDownlink();
+      // all transmissions done without a downlink
+      if(this->asyncTrans >= this->nbTrans) {
+        state = 0;
+        break;
+      }
 
-    // if an error occured or a downlink was received, stop retransmission
-    if(state != RADIOLIB_ERR_NONE) {
+      state = this->asyncTransmit();
+      if(state != RADIOLIB_ERR_NONE) {
+        txFailed = true;
+        break;
+      }
+      return(RADIOLIB_LORAWAN_PENDING);
+
+    default:
+      state = RADIOLIB_ERR_INVALID_MODE;
       break;
+  }
+
+  if(state == RADIOLIB_LORAWAN_PENDING) {
+    return(state);
+  }
+
+  // on error, the interrupt may still be attached for the step that failed
+  if(state < RADIOLIB_ERR_NONE) {
+    this->phyLayer->clearPacketSentAction();
+    this->phyLayer->clearPacketReceivedAction();
+  }
+
+  if(txFailed) {
+    // sometimes, a spurious error can occur even though the uplink was transmitted
+    // therefore, just to be safe, increase frame counter by one for the next uplink
+    this->fCntUp += 1;
+
+    #if !RADIOLIB_STATIC_ONLY
+    delete[] this->asyncMsg;
+    this->asyncMsg = NULL;
+    #endif
+    this->asyncState = RADIOLIB_LORAWAN_ASYNC_IDLE;
+    return(state);
+  }
+
+  return(this->asyncFinish(state, dataDown, lenDown, eventUp, eventDown));
+}
+
+RadioLibTime_t LoRaWANNode::getNextDeadline() {
+  if(this->asyncState == RADIOLIB_LORAWAN_ASYNC_IDLE) {
+    return(0);
+  }
+  return(this->asyncDeadline);
+}
+
+void LoRaWANNode::setEventAction(void (*func)(void)) {
+  this->eventAction = func;
+
+  // if this node has armed the interrupt, the change applies immediately
+  if(this->asyncState != RADIOLIB_LORAWAN_ASYNC_IDLE) {
+    radioActionCb = func;
+  }
+}
+
+int16_t LoRaWANNode::asyncTransmit() {
+  // keep track of number of hopped channels
+  uint8_t numHops = this->maxChanges;
+
+  // number of additional CAD tries
+  uint8_t numBackoff = 0;
+  if(this->backoffMax) {
+    numBackoff = 1 + this->prng() % this->backoffMax;
+  }
+
+  int16_t state = RADIOLIB_ERR_NONE;
+  do {
+    // select a pair of Tx/Rx channels for uplink+downlink
+    this->selectChannels();
+
+    // generate and set uplink MIC (depends on selected channel)
+    state = this->micUplink(this->asyncMsg, this->asyncMsgLen);
+    RADIOLIB_ASSERT(state);
+
+  // if CSMA is enabled, repeat channel selection & encryption up to numHops times
+  } while(this->csmaEnabled && numHops-- > 0 && !this->csmaChannelClear(this->difsSlots, numBackoff));
+
+  // stage it (without the MIC calculation blocks)
+  state = this->stageUplink(&this->channels[RADIOLIB_LORAWAN_UPLINK],
+                                    &this->asyncMsg[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS], 
+                                    (uint8_t)(this->asyncMsgLen - RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS));
+  RADIOLIB_ASSERT(state);
+
+  // if requested, wait until transmitting uplink
+  Module* mod = this->phyLayer->getMod();
+  RadioLibTime_t tNow = mod->hal->millis();
+  this->asyncDeadline = tNow;
+  if(!LoRaWANNodeDeadlineReached(tNow + this->launchDuration, this->tUplink)) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Delaying transmission by %lu ms", (unsigned long)(this->tUplink - tNow - this->launchDuration));
+    this->asyncDeadline = this->tUplink - this->launchDuration;
+  }
+  this->asyncState = RADIOLIB_LORAWAN_ASYNC_TX_WAIT;
+  this->asyncIrq = false;
+
+  return(state);
+}
+
+int16_t LoRaWANNode::asyncNextWindow() {
+  Module* mod = this->phyLayer->getMod();
+  int16_t state = RADIOLIB_ERR_NONE;
+
+  // the sequence is RxC, Rx1, RxC, Rx2 - see receiveDownlink for details
+  while(this->asyncStep < 4) {
+    uint8_t step = this->asyncStep++;
+    uint8_t window = (step < 2) ? RADIOLIB_LORAWAN_RX1 : RADIOLIB_LORAWAN_RX2;
+
+    // if applicable, open Class C until the next Class A window
+    if(step % 2 == 0) {
+      if(this->lwClass != RADIOLIB_LORAWAN_CLASS_C && this->multicast != RADIOLIB_LORAWAN_CLASS_C) {
+        continue;
+      }
+
+      RadioLibTime_t timeoutClassC = this->tUplinkEnd + this->rxDelays[window] - \
+                                     mod->hal->millis() - 5*this->scanGuard;
+      state = this->stageClassC(timeoutClassC);
+      RADIOLIB_ASSERT(state);
+      state = this->launchWindow();
+      RADIOLIB_ASSERT(state);
+
+      this->asyncState = RADIOLIB_LORAWAN_ASYNC_RX;
+      this->asyncDeadline = this->rxOpen + this->rxTimeout + 1;
+      this->asyncIrq = true;
+      return(RADIOLIB_LORAWAN_PENDING);
+    }
+
+    state = this->stageClassA(RADIOLIB_LORAWAN_DOWNLINK, &this->channels[window], window, this->rxDelays[window]);
+    RADIOLIB_ASSERT(state);
+
+    // calculate time at which the window should open
+    RadioLibTime_t tWindow = this->getWindowTime(this->tUplinkEnd, this->rxDelays[window]);
+    RadioLibTime_t tNow = mod->hal->millis();
+    if(tNow > tWindow) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Window too late by %d ms", tNow - tWindow);
+      return(RADIOLIB_ERR_NO_RX_WINDOW);
+    }
+
+    this->asyncState = RADIOLIB_LORAWAN_ASYNC_RX_WAIT;
+    this->asyncDeadline = tWindow;
+    this->asyncIrq = false;
+    return(RADIOLIB_LORAWAN_PENDING);
+  }
+
+  // no downlink after this transmission, so if applicable, keep RxC open
+  state = this->receiveClassC();
+  RADIOLIB_ASSERT(state);
+  this->asyncTrans++;
+
+  // When an end-device has requested an ACK from the Network but has not yet received it, 
+  // it SHALL wait RETRANSMIT_TIMEOUT seconds after RECEIVE_DELAY2 seconds have elapsed 
+  // after the end of the previous uplink transmission before sending a new uplink (repetition or new frame). 
+  // The RETRANSMIT_TIMEOUT delay is not required between unconfirmed uplinks, 
+  // or after the ACK has been successfully demodulated by the end-device.
+  this->asyncDeadline = mod->hal->millis();
+  if(this->asyncConfirmed) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Retransmit timeout");
+    int min = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MIN_MS;
+    int max = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MAX_MS;
+    this->asyncDeadline += min + this->prng() % (max - min);
+  }
+  this->asyncState = RADIOLIB_LORAWAN_ASYNC_RETRANSMIT;
+  this->asyncIrq = false;
+  return(RADIOLIB_LORAWAN_PENDING);
+}
+
+int16_t LoRaWANNode::asyncFinishWindow(RadioLibTime_t tNow) {
+  // same as the wait at the start of finishWindow, but spread over calls to poll()
+  if((this->rxWindow != RADIOLIB_LORAWAN_RX_BC) &&
+     !this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT) && !this->phyLayer->checkIrq(RADIOLIB_IRQ_RX_DONE)) {
+    if(this->asyncState != RADIOLIB_LORAWAN_ASYNC_RX_FINISH) {
+      this->asyncState = RADIOLIB_LORAWAN_ASYNC_RX_FINISH;
+      this->asyncDeadline = tNow + RADIOLIB_LORAWAN_RX_FINISH_TIMEOUT_MS;
+
+      // the flags are polled rather than waited for, so do not sleep until the deadline
+      this->asyncIrq = true;
+      return(RADIOLIB_LORAWAN_PENDING);
     }
-    // if no downlink was received, go on
 
-    // When an end-device has requested an ACK from the Network but has not yet received it, 
-    // it SHALL wait RETRANSMIT_TIMEOUT seconds after RECEIVE_DELAY2 seconds have elapsed 
-    // after the end of the previous uplink transmission before sending a new uplink (repetition or new frame). 
-    // The RETRANSMIT_TIMEOUT delay is not required between unconfirmed uplinks, 
-    // or after the ACK has been successfully demodulated by the end-device.
-    if(isConfirmed) {
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Retransmit timeout");
-      int min = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MIN_MS;
-      int max = RADIOLIB_LORAWAN_RETRANSMIT_TIMEOUT_MAX_MS;
-      this->sleepDelay(min + rand() % (max - min));
+    if(!LoRaWANNodeDeadlineReached(tNow, this->asyncDeadline)) {
+      return(RADIOLIB_LORAWAN_PENDING);
     }
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Timeout without IRQ!");
+  }
 
-  } // end of transmission & reception
+  int16_t state = this->finishWindow(false);
+  if(state == 0) {
+    state = this->asyncNextWindow();
+  }
+  return(state);
+}
+
+int16_t LoRaWANNode::asyncFinish(int16_t result, uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown) {
+  this->asyncState = RADIOLIB_LORAWAN_ASYNC_IDLE;
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] this->asyncMsg;
+  this->asyncMsg = NULL;
+  #endif
 
   // note: if an error occurred, it may still be the case that a transmission occurred
   // therefore, we act as if a transmission occurred before throwing the actual error
@@ -217,28 +576,25 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
   // pass the uplink info if requested
   if(eventUp) {
     eventUp->dir = RADIOLIB_LORAWAN_UPLINK;
-    eventUp->confirmed = isConfirmed;
+    eventUp->confirmed = this->asyncConfirmed;
     eventUp->confirming = (this->confFCntDown != RADIOLIB_LORAWAN_FCNT_NONE);
     eventUp->datarate = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
     eventUp->freq = this->channels[RADIOLIB_LORAWAN_UPLINK].freq / 10000.0;
     eventUp->power = this->txPowerMax - this->txPowerSteps * 2;
     eventUp->fCnt = this->fCntUp;
-    eventUp->fPort = fPort;
-    eventUp->nbTrans = trans;
+    eventUp->fPort = this->asyncPort;
+    eventUp->nbTrans = this->asyncTrans;
     eventUp->multicast = false;
+    eventUp->windowOffset[0] = this->rxOffsets[0];
+    eventUp->windowOffset[1] = this->rxOffsets[1];
   }
 
-  #if !RADIOLIB_STATIC_ONLY
-    delete[] uplinkMsg;
-    delete[] frmPayload;
-  #endif
-
   // if a hardware error occurred, return
-  if(state < RADIOLIB_ERR_NONE) {
-    return(state);
+  if(result < RADIOLIB_ERR_NONE) {
+    return(result);
   }
 
-  uint8_t rxWindow = state;
+  uint8_t rxWindow = result;
 
   // if no downlink was received, do an early exit
   if(rxWindow == 0) {
@@ -251,7 +607,7 @@ int16_t LoRaWANNode::sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fP
     return(rxWindow);
   }
   
-  state = this->parseDownlink(dataDown, lenDown, rxWindow, eventDown);
+  int16_t state = this->parseDownlink(dataDown, lenDown, rxWindow, eventDown);
   RADIOLIB_ASSERT(state);
 
   // if in Class C, open up RxC window
@@ -325,6 +681,7 @@ int16_t LoRaWANNode::setBufferNonces(const uint8_t* persistentBuffer) {
 
 void LoRaWANNode::clearSession() {
   memset(this->bufferSession, 0, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  this->crypto->invalidate();
   memset(this->fOptsUp, 0, RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN);
   memset(this->fOptsDown, 0, RADIOLIB_LORAWAN_FHDR_FOPTS_MAX_LEN);
 
@@ -363,8 +720,8 @@ void LoRaWANNode::clearSession() {
 }
 
 void LoRaWANNode::createSession() {  
-  // set a seed for the pseudo-rng using a truly random value from radio noise
-  srand(this->phyLayer->random(INT32_MAX));
+  // restart the pseudo-rng, unless fixed by the user it will be seeded from radio noise on first use
+  this->prngState = this->prngSeed;
 
   // setup default channels
   if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
@@ -513,6 +870,9 @@ int16_t LoRaWANNode::setBufferSession(const uint8_t* persistentBuffer) {
   int16_t state = LoRaWANNode::checkBufferCommon(persistentBuffer, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
   RADIOLIB_ASSERT(state);
 
+  // the backend may have been used by another session, or the radio may have been reset since
+  this->crypto->invalidate();
+
   // the Nonces buffer holds a checksum signature - compare this to the signature that is in the session buffer
   uint16_t signatureNonces = LoRaWANNode::ntoh<uint16_t>(&this->bufferNonces[RADIOLIB_LORAWAN_NONCES_SIGNATURE]);
   uint16_t signatureInSession = LoRaWANNode::ntoh<uint16_t>(&persistentBuffer[RADIOLIB_LORAWAN_SESSION_NONCES_SIGNATURE]);
@@ -693,7 +1053,7 @@ int16_t LoRaWANNode::beginABP(uint32_t addr, const uint8_t* fNwkSIntKey, const u
   return(RADIOLIB_ERR_NONE);
 }
 
-void LoRaWANNode::composeJoinRequest(uint8_t* out) {
+int16_t LoRaWANNode::composeJoinRequest(uint8_t* out) {
   // copy devNonce currently in use
   uint16_t devNonceUsed = this->devNonce;
   
@@ -705,12 +1065,11 @@ void LoRaWANNode::composeJoinRequest(uint8_t* out) {
 
   // add the authentication code
   uint32_t mic = 0;
-  if(this->rev == 1) {
-    mic =this->generateMIC(out, RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t), this->nwkKey);
-  } else {
-    mic =this->generateMIC(out, RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t), this->appKey);
-  }
+  int16_t state = this->generateMIC(out, RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t),
+                                    (this->rev == 1) ? this->nwkKey : this->appKey, &mic);
+  RADIOLIB_ASSERT(state);
   LoRaWANNode::hton<uint32_t>(&out[RADIOLIB_LORAWAN_JOIN_REQUEST_LEN - sizeof(uint32_t)], mic);
+  return(state);
 }
 
 int16_t LoRaWANNode::processJoinAccept(LoRaWANJoinEvent_t *joinEvent) {
@@ -747,12 +1106,8 @@ int16_t LoRaWANNode::processJoinAccept(LoRaWANJoinEvent_t *joinEvent) {
   // the first byte is the MAC header which is not encrypted
   uint8_t joinAcceptMsg[RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN];
   joinAcceptMsg[0] = joinAcceptMsgEnc[0];
-  if(this->rev == 1) {
-    RadioLibAES128Instance.init(this->nwkKey);
-  } else {
-    RadioLibAES128Instance.init(this->appKey);
-  }
-  RadioLibAES128Instance.encryptECB(&joinAcceptMsgEnc[1], RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN - 1, &joinAcceptMsg[1]);
+  state = this->encryptECB((this->rev == 1) ? this->nwkKey : this->appKey, &joinAcceptMsgEnc[1], RADIOLIB_LORAWAN_JOIN_ACCEPT_MAX_LEN - 1, &joinAcceptMsg[1]);
+  RADIOLIB_ASSERT(state);
 
   // get current joinNonce from downlink
   uint32_t joinNonceNew = LoRaWANNode::ntoh<uint32_t>(&joinAcceptMsg[RADIOLIB_LORAWAN_JOIN_ACCEPT_JOIN_NONCE_POS], 3);
@@ -787,8 +1142,8 @@ int16_t LoRaWANNode::processJoinAccept(LoRaWANJoinEvent_t *joinEvent) {
     uint8_t keyDerivationBuff[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_JS_INT_KEY;
     LoRaWANNode::hton<uint64_t>(&keyDerivationBuff[1], this->devEUI);
-    RadioLibAES128Instance.init(this->nwkKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->jSIntKey);
+    state = this->encryptECB(this->nwkKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->jSIntKey);
+    RADIOLIB_ASSERT(state);
 
     // prepare the buffer for MIC calculation
     uint8_t micBuff[3*RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
@@ -797,15 +1152,13 @@ int16_t LoRaWANNode::processJoinAccept(LoRaWANJoinEvent_t *joinEvent) {
     LoRaWANNode::hton<uint16_t>(&micBuff[9], this->devNonce - 1);
     memcpy(&micBuff[11], joinAcceptMsg, lenRx);
     
-    if(!verifyMIC(micBuff, lenRx + 11, this->jSIntKey)) {
-      return(RADIOLIB_ERR_MIC_MISMATCH);
-    }
+    state = this->verifyMIC(micBuff, lenRx + 11, this->jSIntKey);
+    RADIOLIB_ASSERT(state);
   
   } else {
     // 1.0 version
-    if(!verifyMIC(joinAcceptMsg, lenRx, this->appKey)) {
-      return(RADIOLIB_ERR_MIC_MISMATCH);
-    }
+    state = this->verifyMIC(joinAcceptMsg, lenRx, this->appKey);
+    RADIOLIB_ASSERT(state);
 
   }
 
@@ -838,32 +1191,32 @@ int16_t LoRaWANNode::processJoinAccept(LoRaWANJoinEvent_t *joinEvent) {
     LoRaWANNode::hton<uint16_t>(&keyDerivationBuff[RADIOLIB_LORAWAN_JOIN_ACCEPT_AES_DEV_NONCE_POS], this->devNonce - 1);
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_APP_S_KEY;
 
-    RadioLibAES128Instance.init(this->appKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->appSKey);
+    state = this->encryptECB(this->appKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->appSKey);
+    RADIOLIB_ASSERT(state);
 
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_F_NWK_S_INT_KEY;
-    RadioLibAES128Instance.init(this->nwkKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->fNwkSIntKey);
+    state = this->encryptECB(this->nwkKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->fNwkSIntKey);
+    RADIOLIB_ASSERT(state);
 
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_S_NWK_S_INT_KEY;
-    RadioLibAES128Instance.init(this->nwkKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->sNwkSIntKey);
+    state = this->encryptECB(this->nwkKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->sNwkSIntKey);
+    RADIOLIB_ASSERT(state);
 
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_NWK_S_ENC_KEY;
-    RadioLibAES128Instance.init(this->nwkKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->nwkSEncKey);
+    state = this->encryptECB(this->nwkKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->nwkSEncKey);
+    RADIOLIB_ASSERT(state);
 
   } else {
     // 1.0 version, just derive the keys
     LoRaWANNode::hton<uint32_t>(&keyDerivationBuff[RADIOLIB_LORAWAN_JOIN_ACCEPT_HOME_NET_ID_POS], this->homeNetId, 3);
     LoRaWANNode::hton<uint16_t>(&keyDerivationBuff[RADIOLIB_LORAWAN_JOIN_ACCEPT_DEV_ADDR_POS], this->devNonce - 1);
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_APP_S_KEY;
-    RadioLibAES128Instance.init(this->appKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->appSKey);
+    state = this->encryptECB(this->appKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->appSKey);
+    RADIOLIB_ASSERT(state);
 
     keyDerivationBuff[0] = RADIOLIB_LORAWAN_JOIN_ACCEPT_F_NWK_S_INT_KEY;
-    RadioLibAES128Instance.init(this->appKey);
-    RadioLibAES128Instance.encryptECB(keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->fNwkSIntKey);
+    state = this->encryptECB(this->appKey, keyDerivationBuff, RADIOLIB_AES128_BLOCK_SIZE, this->fNwkSIntKey);
+    RADIOLIB_ASSERT(state);
 
     memcpy(this->sNwkSIntKey, this->fNwkSIntKey, RADIOLIB_AES128_KEY_SIZE);
     memcpy(this->nwkSEncKey, this->fNwkSIntKey, RADIOLIB_AES128_KEY_SIZE);
@@ -948,10 +1301,11 @@ int16_t LoRaWANNode::activateOTAA(LoRaWANJoinEvent_t *joinEvent) {
 
   // build the JoinRequest message
   uint8_t joinRequestMsg[RADIOLIB_LORAWAN_JOIN_REQUEST_LEN];
-  this->composeJoinRequest(joinRequestMsg);
+  int16_t state = this->composeJoinRequest(joinRequestMsg);
+  RADIOLIB_ASSERT(state);
 
   // select a random pair of Tx/Rx channels
-  int16_t state = this->selectChannels();
+  state = this->selectChannels();
   RADIOLIB_ASSERT(state);
   
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("JoinRequest (DevNonce = %d):", this->devNonce);
@@ -1324,7 +1678,7 @@ void LoRaWANNode::adrBackoff() {
   return;
 }
 
-void LoRaWANNode::composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out, uint8_t fPort, bool isConfirmed) {
+int16_t LoRaWANNode::composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out, uint8_t fPort, bool isConfirmed) {
   // set the packet fields
   if(isConfirmed) {
     out[RADIOLIB_LORAWAN_FHDR_LEN_START_OFFS] = RADIOLIB_LORAWAN_MHDR_MTYPE_CONF_DATA_UP;
@@ -1373,7 +1727,8 @@ void LoRaWANNode::composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out,
 
     if(this->rev == 1) {
       // in LoRaWAN v1.1, the FOpts are encrypted using the NwkSEncKey
-      processAES(this->fOptsUp, this->fOptsUpLen, this->nwkSEncKey, &out[RADIOLIB_LORAWAN_FHDR_FOPTS_POS], this->devAddr, this->fCntUp, RADIOLIB_LORAWAN_UPLINK, 0x01, true);
+      int16_t state = this->processAES(this->fOptsUp, this->fOptsUpLen, this->nwkSEncKey, &out[RADIOLIB_LORAWAN_FHDR_FOPTS_POS], this->devAddr, this->fCntUp, RADIOLIB_LORAWAN_UPLINK, 0x01, true);
+      RADIOLIB_ASSERT(state);
     } else {
       // in LoRaWAN v1.0, the FOpts are unencrypted
       memcpy(&out[RADIOLIB_LORAWAN_FHDR_FOPTS_POS], this->fOptsUp, this->fOptsUpLen);
@@ -1394,10 +1749,10 @@ void LoRaWANNode::composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out,
   }
 
   // encrypt the frame payload
-  processAES(in, lenIn, encKey, &out[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(this->fOptsUpLen)], this->devAddr, this->fCntUp, RADIOLIB_LORAWAN_UPLINK, 0x00, true);
+  return(this->processAES(in, lenIn, encKey, &out[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(this->fOptsUpLen)], this->devAddr, this->fCntUp, RADIOLIB_LORAWAN_UPLINK, 0x00, true));
 }
 
-void LoRaWANNode::micUplink(uint8_t* inOut, size_t lenInOut) {
+int16_t LoRaWANNode::micUplink(uint8_t* inOut, size_t lenInOut) {
   // create blocks for MIC calculation
   uint8_t block0[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
   block0[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_MIC_BLOCK_MAGIC;
@@ -1418,10 +1773,15 @@ void LoRaWANNode::micUplink(uint8_t* inOut, size_t lenInOut) {
   RADIOLIB_DEBUG_PROTOCOL_HEXDUMP(inOut, lenInOut);
 
   // calculate authentication codes
-  memcpy(inOut, block1, RADIOLIB_AES128_BLOCK_SIZE);
-  uint32_t micS = this->generateMIC(inOut, lenInOut - sizeof(uint32_t), this->sNwkSIntKey);
-  memcpy(inOut, block0, RADIOLIB_AES128_BLOCK_SIZE);
-  uint32_t micF = this->generateMIC(inOut, lenInOut - sizeof(uint32_t), this->fNwkSIntKey);
+  // the blocks are passed separately, so the frame does not need to be copied
+  const uint8_t* frame = &inOut[RADIOLIB_AES128_BLOCK_SIZE];
+  size_t frameLen = lenInOut - RADIOLIB_AES128_BLOCK_SIZE - sizeof(uint32_t);
+  uint32_t micS = 0;
+  uint32_t micF = 0;
+  int16_t state = this->generateMIC(block1, frame, frameLen, this->sNwkSIntKey, &micS);
+  RADIOLIB_ASSERT(state);
+  state = this->generateMIC(block0, frame, frameLen, this->fNwkSIntKey, &micF);
+  RADIOLIB_ASSERT(state);
 
   // check LoRaWAN revision
   if(this->rev == 1) {
@@ -1430,12 +1790,48 @@ void LoRaWANNode::micUplink(uint8_t* inOut, size_t lenInOut) {
   } else {
     LoRaWANNode::hton<uint32_t>(&inOut[lenInOut - sizeof(uint32_t)], micF);
   }
+  return(state);
 }
 
 int16_t LoRaWANNode::transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len) {
-  int16_t state = RADIOLIB_ERR_UNKNOWN;
   Module* mod = this->phyLayer->getMod();
 
+  int16_t state = this->stageUplink(chnl, in, len);
+  RADIOLIB_ASSERT(state);
+  
+  // if requested, wait until transmitting uplink
+  RadioLibTime_t tNow = mod->hal->millis();
+  if(this->tUplink > tNow + this->launchDuration) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Delaying transmission by %lu ms", (unsigned long)(this->tUplink - tNow - this->launchDuration));
+    tNow = mod->hal->millis();
+    if(this->tUplink > tNow + this->launchDuration) {
+      this->sleepDelay(this->tUplink - tNow - this->launchDuration);
+    }
+  }
+
+  state = this->launchUplink();
+  RADIOLIB_ASSERT(state);
+
+  // sleep for the duration of the transmission
+  this->sleepDelay(this->txToa, false);
+  RadioLibTime_t txEnd = mod->hal->millis();
+
+  // wait for an additional transmission duration as Tx timeout period
+  while(!mod->hal->digitalRead(mod->getIrq())) {
+    // yield for multi-threaded platforms
+    mod->hal->yield();
+
+    if(mod->hal->millis() > txEnd + this->scanGuard) {
+      return(RADIOLIB_ERR_TX_TIMEOUT);
+    }
+  }
+
+  return(this->finishUplink());
+}
+
+int16_t LoRaWANNode::stageUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len) {
+  int16_t state = RADIOLIB_ERR_UNKNOWN;
+
   const uint8_t currentDr = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
   const ModemType_t modem = this->band->dataRates[currentDr].modem;
   const DataRate_t* dr = &this->band->dataRates[currentDr].dr;
@@ -1461,79 +1857,160 @@ int16_t LoRaWANNode::transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, u
   modeCfg.transmit.addr = 0;
   state = this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_TX, &modeCfg);
   RADIOLIB_ASSERT(state);
-  
-  // if requested, wait until transmitting uplink
-  RadioLibTime_t tNow = mod->hal->millis();
-  if(this->tUplink > tNow + this->launchDuration) {
-    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Delaying transmission by %lu ms", (unsigned long)(this->tUplink - tNow - this->launchDuration));
-    tNow = mod->hal->millis();
-    if(this->tUplink > tNow + this->launchDuration) {
-      this->sleepDelay(this->tUplink - tNow - this->launchDuration);
-    }
-  }
+
+  this->txToa = toa;
+  return(state);
+}
+
+int16_t LoRaWANNode::launchUplink() {
+  Module* mod = this->phyLayer->getMod();
 
   if(this->ledPins[0] != RADIOLIB_NC) {
     mod->hal->digitalWrite(this->ledPins[0], mod->hal->GpioLevelHigh);
   }
 
+  // setup interrupt, the IRQ pin is checked directly but the interrupt timestamps the end of transmission
+  radioActionHal = mod->hal;
+  radioActionCb = this->eventAction;
+  radioAction = false;
+  this->phyLayer->setPacketSentAction(LoRaWANNodeOnRadioAction);
+
   // start transmission, and time the duration of launchMode() to offset window timing
   RadioLibTime_t spiStart = mod->hal->millis();
-  state = this->phyLayer->launchMode();
+  RadioLibTime_t spiStartUs = mod->hal->micros();
+  int16_t state = this->phyLayer->launchMode();
+  this->launchDurationUs = mod->hal->micros() - spiStartUs;
   RadioLibTime_t spiEnd = mod->hal->millis();
   this->launchDuration = spiEnd - spiStart;
-  RADIOLIB_ASSERT(state);
-
-  // sleep for the duration of the transmission
-  this->sleepDelay(toa, false);
-  RadioLibTime_t txEnd = mod->hal->millis();
+  return(state);
+}
 
-  // wait for an additional transmission duration as Tx timeout period
-  while(!mod->hal->digitalRead(mod->getIrq())) {
-    // yield for multi-threaded platforms
-    mod->hal->yield();
+int16_t LoRaWANNode::finishUplink() {
+  Module* mod = this->phyLayer->getMod();
 
-    if(mod->hal->millis() > txEnd + this->scanGuard) {
-      return(RADIOLIB_ERR_TX_TIMEOUT);
-    }
-  }
-  state = this->phyLayer->finishTransmit();
+  this->phyLayer->clearPacketSentAction();
+  int16_t state = this->phyLayer->finishTransmit();
 
   // set the timestamp so that we can measure when to start receiving
+  RadioLibTime_t tNowUs = mod->hal->micros();
   this->tUplinkEnd = mod->hal->millis();
 
+  // if the interrupt was timestamped, use that instead, as it does not include the time it took to service it
+  this->tUplinkEndIrq = radioAction;
+  this->tUplinkEndUs = tNowUs;
+  if(this->tUplinkEndIrq) {
+    RadioLibTime_t latencyUs = tNowUs - radioActionUs;
+    this->tUplinkEndUs = radioActionUs;
+    this->tUplinkEnd -= latencyUs / 1000;
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Tx done serviced after %lu us", (unsigned long)latencyUs);
+  }
+  this->rxOffsets[0] = 0;
+  this->rxOffsets[1] = 0;
+
   if(this->ledPins[0] != RADIOLIB_NC) {
     mod->hal->digitalWrite(this->ledPins[0], mod->hal->GpioLevelLow);
   }
 
-  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Uplink sent (ToA = %d ms)", toa);
+  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Uplink sent (ToA = %d ms)", this->txToa);
 
   // increase Time on Air of the uplink sequence
-  this->lastToA += toa;
+  this->lastToA += this->txToa;
 
   return(state);
 }
 
-// flag to indicate whether there was some action during Rx mode (timeout or downlink)
-static volatile bool downlinkAction = false;
+int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChannel, uint8_t window, const RadioLibTime_t dlDelay, RadioLibTime_t tReference) {
+  Module* mod = this->phyLayer->getMod();
 
-// interrupt service routine to handle downlinks automatically
-#if defined(ESP8266) || defined(ESP32)
-  IRAM_ATTR
-#endif
-static void LoRaWANNodeOnDownlinkAction(void) {
-  downlinkAction = true;
+  // either both must be set or none
+  if((dlDelay == 0 && tReference > 0) || (dlDelay > 0 && tReference == 0)) {
+    return(RADIOLIB_ERR_NO_RX_WINDOW);
+  }
+
+  int16_t state = this->stageClassA(dir, dlChannel, window, dlDelay);
+  RADIOLIB_ASSERT(state);
+
+  // if the Rx window must be awaited, do so
+  RadioLibTime_t tNow = mod->hal->millis();
+  if(dlDelay > 0 && tReference > 0) {
+    // calculate time at which the window should open
+    RadioLibTime_t tWindow = this->getWindowTime(tReference, dlDelay);
+    if(tNow > tWindow) {
+      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Window too late by %d ms", tNow - tWindow);
+      return(RADIOLIB_ERR_NO_RX_WINDOW);
+    }
+    this->sleepDelay(tWindow - tNow);
+  }
+
+  // open Rx window by starting receive with specified timeout
+  state = this->launchWindow();
+  RADIOLIB_ASSERT(state);
+  
+  // sleep for the duration of the padded Rx window
+  this->sleepDelay(this->rxTimeout, false);
+  
+  // wait for the DIO interrupt to fire (RxDone or RxTimeout)
+  // use a small additional delay in case the RxTimeout interrupt is slow to fire
+  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window closing", window);
+  while(!radioAction && mod->hal->millis() - this->rxOpen <= this->rxTimeout + this->scanGuard) {
+    mod->hal->yield();
+  }
+
+  // check IRQ bit for RxTimeout
+  state = this->checkWindowTimeout();
+  if(state < RADIOLIB_ERR_NONE) {
+    return(state);
+  } else if(state > 0) {
+    return(0);  // no downlink
+  }
+  
+  // if the IRQ bit for RxTimeout is not set, something is being received, 
+  // so keep listening for maximum ToA waiting for the DIO to fire
+  while(!radioAction && mod->hal->millis() - this->rxOpen < this->rxToaMax + this->scanGuard) {
+    mod->hal->yield();
+  }
+
+  return(this->finishWindow());
 }
 
-int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChannel, uint8_t window, const RadioLibTime_t dlDelay, RadioLibTime_t tReference) {
-  Module* mod = this->phyLayer->getMod();
+int16_t LoRaWANNode::receiveClassC(RadioLibTime_t timeout) {
+  // only open RxC if the device is Unicast-C or Multicast-C, otherwise ignore without error
+  if(this->lwClass != RADIOLIB_LORAWAN_CLASS_C && this->multicast != RADIOLIB_LORAWAN_CLASS_C) {
+    return(RADIOLIB_ERR_NONE);
+  }
+  Module* mod = this->phyLayer->getMod();
+
+  int16_t state = this->stageClassC(timeout);
+  RADIOLIB_ASSERT(state);
+
+  // open RxC window by starting receive with specified timeout
+  state = this->launchWindow();
+  RADIOLIB_ASSERT(state);
+
+  if(timeout) {
+    // wait for the DIO interrupt to fire (RxDone or RxTimeout)
+    while(!radioAction && mod->hal->millis() - this->rxOpen <= this->rxTimeout) {
+      mod->hal->yield();
+    }
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Closed RxC window");
+
+    // check IRQ bit for RxTimeout
+    state = this->checkWindowTimeout();
+    if(state < RADIOLIB_ERR_NONE) {
+      return(state);
+    } else if(state > 0) {
+      return(0);  // no downlink
+    }
+
+    return(this->finishWindow());
+  }
+
+  return(state);
+}
 
+int16_t LoRaWANNode::stageClassA(uint8_t dir, const LoRaWANChannel_t* dlChannel, uint8_t window, RadioLibTime_t dlDelay) {
   int16_t state = RADIOLIB_ERR_UNKNOWN;
 
-  // either both must be set or none
-  if((dlDelay == 0 && tReference > 0) || (dlDelay > 0 && tReference == 0)) {
-    return(RADIOLIB_ERR_NO_RX_WINDOW);
-  }
-
   const uint8_t currentDr = dlChannel->dr;
   const ModemType_t modem = this->band->dataRates[currentDr].modem;
   const DataRate_t* dr = &this->band->dataRates[currentDr].dr;
@@ -1554,6 +2031,15 @@ int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChanne
   // calculate the timeout of an empty packet plus scanGuard
   RadioLibTime_t timeoutUs = toaMinUs + this->scanGuard*1000;
 
+  // if the end of uplink was timestamped in the interrupt, the window can be timed precisely,
+  // so it is only padded by the timing error on either side
+  this->rxPrecise = (dlDelay > 0) && this->tUplinkEndIrq;
+  this->rxTargetUs = dlDelay*1000 - this->scanGuard*500;
+  if(this->rxPrecise) {
+    timeoutUs = toaMinUs + 2*this->rxErrorUs;
+    this->rxTargetUs = dlDelay*1000 - this->rxErrorUs;
+  }
+
   // set the radio Rx parameters
   RadioModeConfig_t modeCfg;
   modeCfg.receive.irqFlags = RADIOLIB_IRQ_RX_DEFAULT_FLAGS;
@@ -1565,113 +2051,29 @@ int16_t LoRaWANNode::receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChanne
   RADIOLIB_ASSERT(state);
 
   // setup interrupt
-  this->phyLayer->setPacketReceivedAction(LoRaWANNodeOnDownlinkAction);
-  downlinkAction = false;
-
-  // if the Rx window must be awaited, do so
-  RadioLibTime_t tNow = mod->hal->millis();
-  if(dlDelay > 0 && tReference > 0) {
-    // calculate time at which the window should open
-    // - the launch of Rx window takes a few milliseconds, so shorten the waitLen a bit (launchDuration)
-    // - the Rx window is padded using scanGuard, so shorten the waitLen a bit (scanGuard / 2)
-    RadioLibTime_t tWindow = tReference + dlDelay - this->launchDuration - this->scanGuard / 2;
-    if(tNow > tWindow) {
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Window too late by %d ms", tNow - tWindow);
-      return(RADIOLIB_ERR_NO_RX_WINDOW);
-    }
-    this->sleepDelay(tWindow - tNow);
-  }
-
-  if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
-    mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelHigh);
-  }
-
-  // open Rx window by starting receive with specified timeout
-  state = this->phyLayer->launchMode();
-  RadioLibTime_t tOpen = mod->hal->millis();
-  RADIOLIB_ASSERT(state);
-  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window open (%lu + %lu ms)", window, timeoutUs / 1000UL, this->scanGuard);
-  
-  // sleep for the duration of the padded Rx window
-  this->sleepDelay(timeoutUs / 1000, false);
-  
-  // wait for the DIO interrupt to fire (RxDone or RxTimeout)
-  // use a small additional delay in case the RxTimeout interrupt is slow to fire
-  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window closing", window);
-  while(!downlinkAction && mod->hal->millis() - tOpen <= timeoutUs / 1000 + this->scanGuard) {
-    mod->hal->yield();
-  }
-
-  // check IRQ bit for RxTimeout
-  int16_t timedOut = this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT);
-  if(timedOut == RADIOLIB_ERR_UNSUPPORTED) {
-    return(timedOut);
-  }
-
-  // if the IRQ bit for RxTimeout is set, put chip in standby and return
-  if(timedOut) {
-    this->phyLayer->clearPacketReceivedAction();
-    this->phyLayer->clearIrq(1UL << RADIOLIB_IRQ_TIMEOUT);
-    this->phyLayer->standby();
-    if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
-      mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelLow);
-    }
-    return(0);  // no downlink
-  }
-  
-  // if the IRQ bit for RxTimeout is not set, something is being received, 
-  // so keep listening for maximum ToA waiting for the DIO to fire
-  while(!downlinkAction && mod->hal->millis() - tOpen < toaMaxMs + this->scanGuard) {
-    mod->hal->yield();
-  }
-  
-  // sometimes we can get to a state when reception is still ongoing, but has not finished yet
-  // this has been observed on LR2021 - wait until either timeout, or Rx done is raised
-  // it should never take more than 300 ms
-  RadioLibTime_t start = mod->hal->millis();
-  while(!this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT) && !this->phyLayer->checkIrq(RADIOLIB_IRQ_RX_DONE)) {
-    mod->hal->yield();
-    if(mod->hal->millis() - start >= 300) {
-      RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Timeout without IRQ!");
-      break;
-    }
-  }
-
-  // update time of downlink reception
-  if(downlinkAction) {
-    this->tDownlink = mod->hal->millis();
-  }
-
-  // we have a message, clear actions, go to standby
-  this->phyLayer->clearPacketReceivedAction();
-  this->phyLayer->standby();
-  if(window < 4 && this->ledPins[window] != RADIOLIB_NC) {
-    mod->hal->digitalWrite(this->ledPins[window], mod->hal->GpioLevelLow);
-  }
-
-  // if all windows passed without receiving anything, return 0 for no window
-  if(!downlinkAction) {
-    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink missing!");
-    return(0);
-  }
-  downlinkAction = false;
+  radioActionCb = this->eventAction;
+  this->phyLayer->setPacketReceivedAction(LoRaWANNodeOnRadioAction);
+  radioAction = false;
+
+  this->rxWindow = window;
+  this->rxTimeout = timeoutUs / 1000;
+  this->rxToaMax = toaMaxMs;
+  this->rxLenMax = maxPayLen + 13;  // mandatory FHDR is 12/13 bytes
+  return(state);
+}
 
-  // Any frame received by an end-device containing a MACPayload greater than 
-  // the specified maximum length M over the data rate used to receive the frame 
-  // SHALL be silently discarded.
-  if(this->phyLayer->getPacketLength() > (size_t)(maxPayLen + 13)) {  // mandatory FHDR is 12/13 bytes
-    return(0);  // act as if no downlink was received
+RadioLibTime_t LoRaWANNode::getWindowTime(RadioLibTime_t tReference, RadioLibTime_t dlDelay) {
+  // with a timestamped end of uplink, wake up a bit early and let launchWindow() wait for the exact time
+  if(this->rxPrecise) {
+    return(tReference + (this->rxTargetUs - this->launchDurationUs) / 1000 - 1);
   }
 
-  // return downlink window number (1/2)
-  return(window);
+  // - the launch of Rx window takes a few milliseconds, so shorten the waitLen a bit (launchDuration)
+  // - the Rx window is padded using scanGuard, so shorten the waitLen a bit (scanGuard / 2)
+  return(tReference + dlDelay - this->launchDuration - this->scanGuard / 2);
 }
 
-int16_t LoRaWANNode::receiveClassC(RadioLibTime_t timeout) {
-  // only open RxC if the device is Unicast-C or Multicast-C, otherwise ignore without error
-  if(this->lwClass != RADIOLIB_LORAWAN_CLASS_C && this->multicast != RADIOLIB_LORAWAN_CLASS_C) {
-    return(RADIOLIB_ERR_NONE);
-  }
+int16_t LoRaWANNode::stageClassC(RadioLibTime_t timeout) {
   Module* mod = this->phyLayer->getMod();
   
   RadioLibTime_t tStart = mod->hal->millis();
@@ -1681,8 +2083,9 @@ int16_t LoRaWANNode::receiveClassC(RadioLibTime_t timeout) {
   RADIOLIB_ASSERT(state);
 
   // setup interrupt
-  this->phyLayer->setPacketReceivedAction(LoRaWANNodeOnDownlinkAction);
-  downlinkAction = false;
+  radioActionCb = this->eventAction;
+  this->phyLayer->setPacketReceivedAction(LoRaWANNodeOnRadioAction);
+  radioAction = false;
   
   // configure radio
   RadioModeConfig_t modeCfg;
@@ -1699,74 +2102,124 @@ int16_t LoRaWANNode::receiveClassC(RadioLibTime_t timeout) {
   state = this->phyLayer->stageMode(RADIOLIB_RADIO_MODE_RX, &modeCfg);
   RADIOLIB_ASSERT(state);
 
-  if(this->ledPins[RADIOLIB_LORAWAN_RX_BC] != RADIOLIB_NC) {
-    mod->hal->digitalWrite(this->ledPins[RADIOLIB_LORAWAN_RX_BC], mod->hal->GpioLevelHigh);
+  uint8_t maxPayLen = this->band->payloadLenMax[this->channels[RADIOLIB_LORAWAN_RX_BC].dr];
+  if(this->packages[RADIOLIB_LORAWAN_PACKAGE_TS011].enabled) {
+    maxPayLen = RADIOLIB_MIN(maxPayLen, 222); // payload length is limited to 222 if under repeater
   }
 
-  // open RxC window by starting receive with specified timeout
-  state = this->phyLayer->launchMode();
-  RadioLibTime_t tOpen = mod->hal->millis();
-  RADIOLIB_ASSERT(state);
-  RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Opened RxC window");
+  this->rxWindow = RADIOLIB_LORAWAN_RX_BC;
+  this->rxPrecise = false;
+  this->rxTimeout = timeout;
+  this->rxToaMax = 0;
+  this->rxLenMax = maxPayLen + 13;  // mandatory FHDR is 12/13 bytes
+  return(state);
+}
 
-  if(timeout) {
-    // wait for the DIO interrupt to fire (RxDone or RxTimeout)
-    while(!downlinkAction && mod->hal->millis() - tOpen <= timeout) {
-      mod->hal->yield();
-    }
-    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Closed RxC window");
+int16_t LoRaWANNode::launchWindow() {
+  Module* mod = this->phyLayer->getMod();
 
-    // check IRQ bit for RxTimeout
-    int16_t timedOut = this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT);
-    if(timedOut == RADIOLIB_ERR_UNSUPPORTED) {
-      return(timedOut);
-    }
+  if(this->rxWindow < 4 && this->ledPins[this->rxWindow] != RADIOLIB_NC) {
+    mod->hal->digitalWrite(this->ledPins[this->rxWindow], mod->hal->GpioLevelHigh);
+  }
 
-    // if the IRQ bit for RxTimeout is set, put chip in standby and return
-    if(timedOut) {
-      this->phyLayer->clearPacketReceivedAction();
-      this->phyLayer->clearIrq(1UL << RADIOLIB_IRQ_TIMEOUT);
-      this->phyLayer->standby();
-      if(this->ledPins[RADIOLIB_LORAWAN_RX_BC] != RADIOLIB_NC) {
-        mod->hal->digitalWrite(this->ledPins[RADIOLIB_LORAWAN_RX_BC], mod->hal->GpioLevelLow);
-      }
-      return(0);  // no downlink
+  // with a timestamped end of uplink, the window is opened on the exact microsecond
+  // this is only the last bit of the delay, most of it was already spent waiting for getWindowTime()
+  if(this->rxPrecise) {
+    RadioLibTime_t offsetUs = this->rxTargetUs - this->launchDurationUs;
+    RadioLibTime_t elapsedUs = mod->hal->micros() - this->tUplinkEndUs;
+    if(elapsedUs < offsetUs) {
+      mod->waitForMicroseconds(mod->hal->micros(), offsetUs - elapsedUs);
     }
+  }
 
-    // update time of downlink reception
-    if(downlinkAction) {
-      this->tDownlink = mod->hal->millis();
-    }
+  // open Rx window by starting receive with specified timeout
+  int16_t state = this->phyLayer->launchMode();
+  RadioLibTime_t tOpenUs = mod->hal->micros();
+  this->rxOpen = mod->hal->millis();
+  RADIOLIB_ASSERT(state);
+
+  // keep track of the timing error of Class A windows
+  if(this->rxWindow == RADIOLIB_LORAWAN_RX1 || this->rxWindow == RADIOLIB_LORAWAN_RX2) {
+    int32_t offset = (int32_t)(tOpenUs - this->tUplinkEndUs - this->rxTargetUs);
+    this->rxOffsets[this->rxWindow - 1] = offset;
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window offset %ld us", this->rxWindow, (long)offset);
+  }
+  if(this->rxWindow == RADIOLIB_LORAWAN_RX_BC) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Opened RxC window");
+  } else {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Rx%d window open (%lu + %lu ms)", this->rxWindow, (unsigned long)this->rxTimeout, (unsigned long)this->scanGuard);
+  }
+  return(state);
+}
+
+int16_t LoRaWANNode::checkWindowTimeout() {
+  Module* mod = this->phyLayer->getMod();
+
+  // check IRQ bit for RxTimeout
+  int16_t timedOut = this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT);
+  if(timedOut == RADIOLIB_ERR_UNSUPPORTED) {
+    return(timedOut);
+  }
 
-    // we have a message, clear actions, go to standby
+  // if the IRQ bit for RxTimeout is set, put chip in standby
+  if(timedOut) {
     this->phyLayer->clearPacketReceivedAction();
+    this->phyLayer->clearIrq(1UL << RADIOLIB_IRQ_TIMEOUT);
     this->phyLayer->standby();
-    if(this->ledPins[RADIOLIB_LORAWAN_RX_BC] != RADIOLIB_NC) {
-      mod->hal->digitalWrite(this->ledPins[RADIOLIB_LORAWAN_RX_BC], mod->hal->GpioLevelLow);
+    if(this->rxWindow < 4 && this->ledPins[this->rxWindow] != RADIOLIB_NC) {
+      mod->hal->digitalWrite(this->ledPins[this->rxWindow], mod->hal->GpioLevelLow);
     }
+    return(1);
+  }
 
-    // if all windows passed without receiving anything, return 0 for no window
-    if(!downlinkAction) {
-      return(0);
-    }
-    downlinkAction = false;
+  return(0);
+}
 
-    // Any frame received by an end-device containing a MACPayload greater than 
-    // the specified maximum length M over the data rate used to receive the frame 
-    // SHALL be silently discarded.
-    uint8_t maxPayLen = this->band->payloadLenMax[this->channels[RADIOLIB_LORAWAN_RX_BC].dr];
-    if(this->packages[RADIOLIB_LORAWAN_PACKAGE_TS011].enabled) {
-      maxPayLen = RADIOLIB_MIN(maxPayLen, 222); // payload length is limited to 222 if under repeater
-    }
-    if(this->phyLayer->getPacketLength() > (size_t)(maxPayLen + 13)) {  // mandatory FHDR is 12/13 bytes
-      return(0);  // act as if no downlink was received
+int16_t LoRaWANNode::finishWindow(bool wait) {
+  Module* mod = this->phyLayer->getMod();
+
+  // sometimes we can get to a state when reception is still ongoing, but has not finished yet
+  // this has been observed on LR2021 - wait until either timeout, or Rx done is raised
+  // it should never take more than 300 ms
+  if(wait && (this->rxWindow != RADIOLIB_LORAWAN_RX_BC)) {
+    RadioLibTime_t start = mod->hal->millis();
+    while(!this->phyLayer->checkIrq(RADIOLIB_IRQ_TIMEOUT) && !this->phyLayer->checkIrq(RADIOLIB_IRQ_RX_DONE)) {
+      mod->hal->yield();
+      if(mod->hal->millis() - start >= RADIOLIB_LORAWAN_RX_FINISH_TIMEOUT_MS) {
+        RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Timeout without IRQ!");
+        break;
+      }
     }
+  }
 
-    // return downlink window number (3 = RxC)
-    return(RADIOLIB_LORAWAN_RX_BC);
+  // update time of downlink reception
+  if(radioAction) {
+    this->tDownlink = mod->hal->millis();
   }
 
-  return(state);
+  // we have a message, clear actions, go to standby
+  this->phyLayer->clearPacketReceivedAction();
+  this->phyLayer->standby();
+  if(this->rxWindow < 4 && this->ledPins[this->rxWindow] != RADIOLIB_NC) {
+    mod->hal->digitalWrite(this->ledPins[this->rxWindow], mod->hal->GpioLevelLow);
+  }
+
+  // if all windows passed without receiving anything, return 0 for no window
+  if(!radioAction) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink missing!");
+    return(0);
+  }
+  radioAction = false;
+
+  // Any frame received by an end-device containing a MACPayload greater than 
+  // the specified maximum length M over the data rate used to receive the frame 
+  // SHALL be silently discarded.
+  if(this->phyLayer->getPacketLength() > this->rxLenMax) {
+    return(0);  // act as if no downlink was received
+  }
+
+  // return downlink window number (1/2, or 3 = RxC)
+  return(this->rxWindow);
 }
 
 int16_t LoRaWANNode::receiveDownlink() {
@@ -2008,11 +2461,12 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
   if(this->multicast && window == RADIOLIB_LORAWAN_RX_BC) {
     micKey = this->mcNwkSKey;
   }
-  if(!verifyMIC(downlinkMsg, RADIOLIB_AES128_BLOCK_SIZE + downlinkMsgLen, micKey)) {
+  state = this->verifyMIC(downlinkMsg, RADIOLIB_AES128_BLOCK_SIZE + downlinkMsgLen, micKey);
+  if(state != RADIOLIB_ERR_NONE) {
     #if !RADIOLIB_STATIC_ONLY
       delete[] downlinkMsg;
     #endif
-    return(RADIOLIB_ERR_MIC_MISMATCH);
+    return(state);
   }
 
   // all checks passed, so start processing
@@ -2057,13 +2511,19 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
     // in LoRaWAN v1.1, the piggy-backed FOpts are encrypted using the NwkSEncKey
     if(this->rev == 1) {
       uint8_t ctrId = 0x01 + isAppDownlink; // see LoRaWAN v1.1 errata
-      processAES(fOptsPtr, (size_t)fOptsLen, this->nwkSEncKey, fOptsPtr, this->devAddr, devFCnt32, RADIOLIB_LORAWAN_DOWNLINK, ctrId, true);
+      state = this->processAES(fOptsPtr, (size_t)fOptsLen, this->nwkSEncKey, fOptsPtr, this->devAddr, devFCnt32, RADIOLIB_LORAWAN_DOWNLINK, ctrId, true);
     }
     
   // decrypt any FOpts in the payload (in-place)
   } else if(fOptsLen > 0) {
     fOptsPtr = &downlinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(0)];
-    processAES(fOptsPtr, (size_t)fOptsLen, this->nwkSEncKey, fOptsPtr, this->devAddr, devFCnt32, RADIOLIB_LORAWAN_DOWNLINK, 0x00, true);
+    state = this->processAES(fOptsPtr, (size_t)fOptsLen, this->nwkSEncKey, fOptsPtr, this->devAddr, devFCnt32, RADIOLIB_LORAWAN_DOWNLINK, 0x00, true);
+  }
+  if(state != RADIOLIB_ERR_NONE) {
+    #if !RADIOLIB_STATIC_ONLY
+      delete[] downlinkMsg;
+    #endif
+    return(state);
   }
 
   // figure out which key to use to decrypt the application payload
@@ -2080,7 +2540,13 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
 
   // decrypt the frame payload (in-place to allow a fully decrypted hex-dump next)
   uint8_t* payloadPtr = &downlinkMsg[RADIOLIB_LORAWAN_FRAME_PAYLOAD_POS(fOptsLen)];
-  processAES(payloadPtr, payLen, encKey, payloadPtr, addr, devFCnt32, RADIOLIB_LORAWAN_DOWNLINK, 0x00, true);
+  state = this->processAES(payloadPtr, payLen, encKey, payloadPtr, addr, devFCnt32, RADIOLIB_LORAWAN_DOWNLINK, 0x00, true);
+  if(state != RADIOLIB_ERR_NONE) {
+    #if !RADIOLIB_STATIC_ONLY
+      delete[] downlinkMsg;
+    #endif
+    return(state);
+  }
   memcpy(data, payloadPtr, payLen);
 
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("Downlink (%sFCntDown = %lu) decoded:", 
@@ -2254,6 +2720,8 @@ int16_t LoRaWANNode::parseDownlink(uint8_t* data, size_t* len, uint8_t window, L
     event->fCnt = devFCnt32;
     event->fPort = fPort;
     event->multicast = (bool)this->multicast;
+    event->windowOffset[0] = 0;
+    event->windowOffset[1] = 0;
   }
 
   #if !RADIOLIB_STATIC_ONLY
@@ -2271,9 +2739,9 @@ int16_t LoRaWANNode::getDownlinkClassC(uint8_t* dataDown, size_t* lenDown, LoRaW
 
   int16_t state = RADIOLIB_ERR_NONE;
 
-  if(downlinkAction) {
+  if(radioAction) {
     state = this->parseDownlink(dataDown, lenDown, RADIOLIB_LORAWAN_RX_BC, eventDown);
-    downlinkAction = false;
+    radioAction = false;
 
     // if downlink parsed successfully, set state to RxC window
     if(state == RADIOLIB_ERR_NONE) {
@@ -2384,7 +2852,7 @@ bool LoRaWANNode::execMacCommand(uint8_t cid, uint8_t* optIn, uint8_t lenIn, uin
         // and check if there are any available Tx channels for this datarate
         if(state == RADIOLIB_ERR_NONE) {
           this->channels[RADIOLIB_LORAWAN_UPLINK].dr = macDrUp;
-          drAck = this->calculateChannelFlags();
+          drAck = this->updateChannelFlags();
 
           if(!drAck) {
             RADIOLIB_DEBUG_PROTOCOL_PRINTLN("ADR: no channels available for datarate %d", macDrUp);
@@ -2608,8 +3076,14 @@ bool LoRaWANNode::execMacCommand(uint8_t cid, uint8_t* optIn, uint8_t lenIn, uin
         this->dynamicChannels[RADIOLIB_LORAWAN_DOWNLINK][macChIndex] = this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][macChIndex];
   
         // add the new channel
+        // only flag it for the current hopping cycle if it can be used at the current datarate
         this->channelMasks[0] |= (0x0001 << macChIndex);
-        this->channelFlags[0] |= (0x0001 << macChIndex);
+        uint8_t drUp = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
+        if(drUp >= macDrMin && drUp <= macDrMax) {
+          this->channelFlags[0] |= (0x0001 << macChIndex);
+        } else {
+          this->channelFlags[0] &= ~(0x0001 << macChIndex);
+        }
       } else {
         this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][macChIndex] = RADIOLIB_LORAWAN_CHANNEL_NONE;
         this->dynamicChannels[RADIOLIB_LORAWAN_DOWNLINK][macChIndex] = RADIOLIB_LORAWAN_CHANNEL_NONE;
@@ -3245,6 +3719,11 @@ void LoRaWANNode::setCSMA(bool csmaEnabled, uint8_t maxChanges, uint8_t backoffM
   }
 }
 
+void LoRaWANNode::setRandomSeed(uint32_t seed) {
+  this->prngSeed = seed;
+  this->prngState = seed;
+}
+
 void LoRaWANNode::setDeviceStatus(uint8_t battLevel) {
   this->battLevel = battLevel;
 }
@@ -3464,23 +3943,41 @@ void LoRaWANNode::enableDefaultChannels(bool addDynamic) {
   }
 }
 
-bool LoRaWANNode::calculateChannelFlags() {
-  // clear all flags
-  memset(this->channelFlags, 0, sizeof(this->channelFlags));
+uint32_t LoRaWANNode::prng() {
+  // set a seed for the pseudo-rng using a truly random value from radio noise
+  // xorshift gets stuck at zero, so that is never used as the state
+  if(this->prngState == 0) {
+    this->prngState = (uint32_t)this->phyLayer->random(INT32_MAX);
+    if(this->prngState == 0) {
+      this->prngState = 1;
+    }
+  }
+
+  // xorshift32, see G. Marsaglia, "Xorshift RNGs"
+  uint32_t x = this->prngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  this->prngState = x;
+  return(x);
+}
+
+bool LoRaWANNode::getEligibleChannels(uint16_t* eligible) {
+  memset(eligible, 0, sizeof(this->channelFlags));
   bool any = false;
 
   uint8_t drUp = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
 
   if(this->band->bandType == RADIOLIB_LORAWAN_BAND_DYNAMIC) {
-    for(size_t i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_DYNAMIC_CHANNELS; i++) {
-      // skip channel if not available
-      if((this->channelMasks[0] & (0x0001 << i)) == 0) {
-        continue;
-      }
+    // only walk the enabled channels
+    uint16_t mask = this->channelMasks[0];
+    while(mask) {
+      uint8_t i = rlb_ctz(mask);
+      mask &= mask - 1;
       // check if datarate is allowed for this channel
       if(drUp >= this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][i].drMin \
           && drUp <= this->dynamicChannels[RADIOLIB_LORAWAN_UPLINK][i].drMax) {
-        this->channelFlags[0] |= (0x0001 << i);
+        eligible[0] |= (0x0001 << i);
         any = true;
       }
     }
@@ -3489,7 +3986,7 @@ bool LoRaWANNode::calculateChannelFlags() {
     // during activation of fixed bands, flag all available channels
     // the datarate will be determined from there
     if(!this->isActivated()) {
-      memcpy(this->channelFlags, this->channelMasks, sizeof(this->channelMasks));
+      memcpy(eligible, this->channelMasks, sizeof(this->channelMasks));
       return(true);
     }
 
@@ -3497,7 +3994,7 @@ bool LoRaWANNode::calculateChannelFlags() {
     if(drUp >= this->band->txSpans[0].drMin && drUp <= this->band->txSpans[0].drMax) {
       // if the datarate is OK, all channel in this span can be used
       for(int i = 0; i < this->band->txSpans[0].numChannels / 16; i++) {
-        this->channelFlags[i] = this->channelMasks[i];
+        eligible[i] = this->channelMasks[i];
         if(this->channelMasks[i]) {
           any = true;
         }
@@ -3506,7 +4003,7 @@ bool LoRaWANNode::calculateChannelFlags() {
 
     // check second frequency span to see if the datarate is allowed and any channel is available
     if(drUp >= this->band->txSpans[1].drMin && drUp <= this->band->txSpans[1].drMax) {
-      this->channelFlags[4] = this->channelMasks[4];
+      eligible[4] = this->channelMasks[4];
       if(this->channelMasks[4]) {
         any = true;
       }
@@ -3515,6 +4012,30 @@ bool LoRaWANNode::calculateChannelFlags() {
   return(any);
 }
 
+bool LoRaWANNode::calculateChannelFlags() {
+  return(this->getEligibleChannels(this->channelFlags));
+}
+
+bool LoRaWANNode::updateChannelFlags() {
+  uint16_t eligible[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16];
+  bool any = this->getEligibleChannels(eligible);
+
+  // drop the channels that can no longer be used
+  bool flag = false;
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16; i++) {
+    this->channelFlags[i] &= eligible[i];
+    if(this->channelFlags[i]) {
+      flag = true;
+    }
+  }
+
+  // if that exhausted the current cycle, start a new one
+  if(!flag) {
+    memcpy(this->channelFlags, eligible, sizeof(this->channelFlags));
+  }
+  return(any);
+}
+
 int16_t LoRaWANNode::selectChannels() {
   // save the current uplink datarate
   uint8_t uplinkDr = this->channels[RADIOLIB_LORAWAN_UPLINK].dr;
@@ -3564,16 +4085,44 @@ int16_t LoRaWANNode::selectChannels() {
     }
   }
 
-  // select a random channel index using reservoir sampling
+  // restrict the flagged channels to the selected range and count them
+  uint16_t range[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { 0 };
+  uint8_t num = 0;
+  for(int i = start / 16; i < (end + 15) / 16; i++) {
+    uint32_t lo = (start > 16*i) ? start - 16*i : 0;
+    uint32_t hi = (end < 16*(i + 1)) ? end - 16*i : 16;
+    range[i] = this->channelFlags[i] & (((1UL << hi) - 1) & ~((1UL << lo) - 1));
+    num += rlb_popcount(range[i]);
+  }
+
+  // if the range was already exhausted in this cycle, pick any enabled channel from it
+  if(num == 0) {
+    for(int i = start / 16; i < (end + 15) / 16; i++) {
+      uint32_t lo = (start > 16*i) ? start - 16*i : 0;
+      uint32_t hi = (end < 16*(i + 1)) ? end - 16*i : 16;
+      range[i] = this->channelMasks[i] & (((1UL << hi) - 1) & ~((1UL << lo) - 1));
+      num += rlb_popcount(range[i]);
+    }
+    if(num == 0) {
+      return(RADIOLIB_ERR_NO_CHANNEL_AVAILABLE);
+    }
+  }
+
+  // select a uniformly random channel index: skip whole words, then clear the lowest bits
   uint8_t idx = 0;
-  uint8_t seen = 0;
-  for(int i = start; i < end; i++) {
-    if(this->channelFlags[i/16] & (0x0001 << (i % 16))) {
-      seen++;
-      if(rand() % seen == 0) {
-        idx = i;
-      }
+  uint8_t n = this->prng() % num;
+  for(int i = start / 16; i < (end + 15) / 16; i++) {
+    uint8_t cnt = rlb_popcount(range[i]);
+    if(n >= cnt) {
+      n -= cnt;
+      continue;
     }
+    uint16_t word = range[i];
+    for(; n > 0; n--) {
+      word &= word - 1;
+    }
+    idx = 16*i + rlb_ctz(word);
+    break;
   }
 
   // remove the channel from the available channels
@@ -3631,34 +4180,88 @@ int16_t LoRaWANNode::selectChannels() {
   return(RADIOLIB_ERR_NONE);
 }
 
-uint32_t LoRaWANNode::generateMIC(const uint8_t* msg, size_t len, uint8_t* key) {
+int16_t LoRaWANNode::getKeyId(const uint8_t* key, uint8_t* keyId) {
+  if(key == this->nwkKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_NWK;
+  } else if(key == this->appKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_APP;
+  } else if(key == this->jSIntKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_J_S_INT;
+  } else if(key == this->appSKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_APP_S;
+  } else if(key == this->fNwkSIntKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_F_NWK_S_INT;
+  } else if(key == this->sNwkSIntKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_S_NWK_S_INT;
+  } else if(key == this->nwkSEncKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_NWK_S_ENC;
+  } else if(key == this->mcAppSKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_MC_APP_S;
+  } else if(key == this->mcNwkSKey) {
+    *keyId = RADIOLIB_LORAWAN_KEY_MC_NWK_S;
+  } else {
+    *keyId = RADIOLIB_LORAWAN_KEY_NONE;
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  // keys may change at any time (join, session restore, multicast setup),
+  // the backend is responsible for skipping the upload if the contents are the same
+  return(this->crypto->setKey(*keyId, key));
+}
+
+int16_t LoRaWANNode::encryptECB(const uint8_t* key, const uint8_t* in, size_t len, uint8_t* out) {
+  uint8_t keyId = RADIOLIB_LORAWAN_KEY_NONE;
+  int16_t state = this->getKeyId(key, &keyId);
+  RADIOLIB_ASSERT(state);
+  return(this->crypto->encryptECB(keyId, in, len, out));
+}
+
+int16_t LoRaWANNode::generateMIC(const uint8_t* msg, size_t len, uint8_t* key, uint32_t* mic) {
   if((msg == NULL) || (len == 0)) {
-    return(0);
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+
+  return(this->generateMIC(NULL, msg, len, key, mic));
+}
+
+int16_t LoRaWANNode::generateMIC(const uint8_t* prefix, const uint8_t* msg, size_t len, uint8_t* key, uint32_t* mic) {
+  if((msg == NULL) && (len != 0)) {
+    return(RADIOLIB_ERR_NULL_POINTER);
   }
 
-  RadioLibAES128Instance.init(key);
-  uint8_t cmac[RADIOLIB_AES128_BLOCK_SIZE];
-  RadioLibAES128Instance.generateCMAC(msg, len, cmac);
-  return(((uint32_t)cmac[0]) | ((uint32_t)cmac[1] << 8) | ((uint32_t)cmac[2] << 16) | ((uint32_t)cmac[3]) << 24);
+  uint8_t keyId = RADIOLIB_LORAWAN_KEY_NONE;
+  int16_t state = this->getKeyId(key, &keyId);
+  RADIOLIB_ASSERT(state);
+
+  uint8_t buff[RADIOLIB_LORAWAN_MIC_SIZE] = { 0 };
+  state = this->crypto->generateMIC(keyId, prefix, msg, len, buff);
+  if(state != RADIOLIB_ERR_NONE) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("MIC calculation failed, code %d", state);
+    return(state);
+  }
+  *mic = ((uint32_t)buff[0]) | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) | ((uint32_t)buff[3]) << 24;
+  return(RADIOLIB_ERR_NONE);
 }
 
-bool LoRaWANNode::verifyMIC(uint8_t* msg, size_t len, uint8_t* key) {
+int16_t LoRaWANNode::verifyMIC(uint8_t* msg, size_t len, uint8_t* key) {
   if((msg == NULL) || (len < sizeof(uint32_t))) {
-    return(0);
+    return(RADIOLIB_ERR_MIC_MISMATCH);
   }
 
   // extract MIC from the message
   uint32_t micReceived = LoRaWANNode::ntoh<uint32_t>(&msg[len - sizeof(uint32_t)]);
 
   // calculate the expected value and compare
-  uint32_t micCalculated = generateMIC(msg, len - sizeof(uint32_t), key);
+  uint32_t micCalculated = 0;
+  int16_t state = this->generateMIC(msg, len - sizeof(uint32_t), key, &micCalculated);
+  RADIOLIB_ASSERT(state);
   if(micCalculated != micReceived) {
     RADIOLIB_DEBUG_PROTOCOL_PRINTLN("MIC mismatch, expected %08lx, got %08lx", 
                                     (unsigned long)micCalculated, (unsigned long)micReceived);
-    return(false);
+    return(RADIOLIB_ERR_MIC_MISMATCH);
   }
 
-  return(true);
+  return(RADIOLIB_ERR_NONE);
 }
 
 // given an airtime in milliseconds, calculate the minimum uplink interval
@@ -3725,6 +4328,15 @@ void LoRaWANNode::setSleepFunction(SleepCb_t cb) {
   this->sleepCb = cb;
 }
 
+void LoRaWANNode::setCryptoBackend(LoRaWANCryptoBackend* backend) {
+  if(backend == NULL) {
+    this->crypto = &this->cryptoSoftware;
+  } else {
+    this->crypto = backend;
+  }
+  this->crypto->invalidate();
+}
+
 int16_t LoRaWANNode::addAppPackage(uint8_t packageId, PackageCb_t callback) {
   if(packageId >= RADIOLIB_LORAWAN_NUM_SUPPORTED_PACKAGES) {
     return(RADIOLIB_ERR_INVALID_MODE);
@@ -3773,19 +4385,12 @@ void LoRaWANNode::removePackage(uint8_t packageId) {
   return;
 }
 
-void LoRaWANNode::processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t addr, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter) {
+int16_t LoRaWANNode::processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t addr, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter) {
   if(len == 0) {
-    return;
-  }
-  
-  // figure out how many encryption blocks are there
-  size_t numBlocks = len/RADIOLIB_AES128_BLOCK_SIZE;
-  if(len % RADIOLIB_AES128_BLOCK_SIZE) {
-    numBlocks++;
+    return(RADIOLIB_ERR_NONE);
   }
 
   // generate the encryption blocks
-  uint8_t encBuffer[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
   uint8_t encBlock[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
   encBlock[RADIOLIB_LORAWAN_BLOCK_MAGIC_POS] = RADIOLIB_LORAWAN_ENC_BLOCK_MAGIC;
   encBlock[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_ID_POS] = ctrId;
@@ -3795,27 +4400,23 @@ void LoRaWANNode::processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_
 
   // now encrypt the input
   // on downlink frames, this has a decryption effect because server actually "decrypts" the plaintext
-  size_t remLen = len;
-  for(size_t i = 0; i < numBlocks; i++) {
-
-    if(counter) {
-      encBlock[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_POS] = i + 1;
-    }
-
-    // encrypt the buffer
-    RadioLibAES128Instance.init(key);
-    RadioLibAES128Instance.encryptECB(encBlock, RADIOLIB_AES128_BLOCK_SIZE, encBuffer);
+  uint8_t keyId = RADIOLIB_LORAWAN_KEY_NONE;
+  int16_t state = this->getKeyId(key, &keyId);
+  RADIOLIB_ASSERT(state);
+  if(counter) {
+    // the block counter starts at 1, at most 16 blocks so it never overflows into the rest of the block
+    encBlock[RADIOLIB_LORAWAN_ENC_BLOCK_COUNTER_POS] = 1;
+    return(this->crypto->encryptCTR(keyId, encBlock, in, len, out));
+  }
 
-    // now xor the buffer with the input
-    size_t xorLen = remLen;
-    if(xorLen > RADIOLIB_AES128_BLOCK_SIZE) {
-      xorLen = RADIOLIB_AES128_BLOCK_SIZE;
-    }
-    for(uint8_t j = 0; j < xorLen; j++) {
-      out[i*RADIOLIB_AES128_BLOCK_SIZE + j] = in[i*RADIOLIB_AES128_BLOCK_SIZE + j] ^ encBuffer[j];
-    }
-    remLen -= xorLen;
+  // without counter, the same keystream block is used for all the input
+  uint8_t encBuffer[RADIOLIB_AES128_BLOCK_SIZE] = { 0 };
+  state = this->crypto->encryptECB(keyId, encBlock, RADIOLIB_AES128_BLOCK_SIZE, encBuffer);
+  RADIOLIB_ASSERT(state);
+  for(size_t i = 0; i < len; i++) {
+    out[i] = in[i] ^ encBuffer[i % RADIOLIB_AES128_BLOCK_SIZE];
   }
+  return(RADIOLIB_ERR_NONE);
 }
 
 void LoRaWANNode::sleepDelay(RadioLibTime_t ms, bool radioOff) {
@@ -4,6 +4,7 @@
 #include "../../TypeDef.h"
 #include "../PhysicalLayer/PhysicalLayer.h"
 #include "../../utils/Cryptography.h"
+#include "LoRaWANCrypto.h"
 
 // activation mode
 #define RADIOLIB_LORAWAN_MODE_OTAA                              (0x07AA)
@@ -218,6 +219,19 @@
 // threshold at which sleeping via user callback enabled, in ms
 #define RADIOLIB_LORAWAN_DELAY_SLEEP_THRESHOLD                  (50)
 
+// states of the asynchronous uplink/downlink exchange
+#define RADIOLIB_LORAWAN_ASYNC_IDLE                             (0x00)  // no exchange in progress
+#define RADIOLIB_LORAWAN_ASYNC_TX_WAIT                          (0x01)  // uplink staged, waiting for the scheduled time
+#define RADIOLIB_LORAWAN_ASYNC_TX                               (0x02)  // uplink on air
+#define RADIOLIB_LORAWAN_ASYNC_RX_WAIT                          (0x03)  // Rx window staged, waiting for it to open
+#define RADIOLIB_LORAWAN_ASYNC_RX                               (0x04)  // Rx window open
+#define RADIOLIB_LORAWAN_ASYNC_RX_EXTEND                        (0x05)  // downlink being received after the window closed
+#define RADIOLIB_LORAWAN_ASYNC_RETRANSMIT                       (0x06)  // waiting for RETRANSMIT_TIMEOUT
+#define RADIOLIB_LORAWAN_ASYNC_RX_FINISH                        (0x07)  // waiting for the radio to report end of reception
+
+// maximum time the radio may take to raise RxDone or RxTimeout once reception has finished
+#define RADIOLIB_LORAWAN_RX_FINISH_TIMEOUT_MS                   (300)
+
 /*!
   \struct LoRaWANMacCommand_t
   \brief MAC command specification structure.
@@ -568,6 +582,10 @@ struct LoRaWANEvent_t {
 
   /*! \brief Multicast or unicast */
   bool multicast;
+
+  /*! \brief Uplink only: measured minus planned opening time of the Rx1 and Rx2 windows in microseconds,
+  relative to the end of the last transmission. 0 if the window was not opened, always 0 for downlinks. */
+  int32_t windowOffset[2];
 };
 
 /*!
@@ -749,6 +767,52 @@ class LoRaWANNode {
     */
     virtual int16_t sendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort, uint8_t* dataDown, size_t* lenDown, bool isConfirmed = false, LoRaWANEvent_t* eventUp = NULL, LoRaWANEvent_t* eventDown = NULL);
 
+    /*!
+      \brief Start sending a message to the server without blocking. The exchange (uplink, Rx1 and Rx2 windows
+      and any retransmissions) is then driven by calling poll() at the time returned by getNextDeadline(),
+      or when the radio interrupt fires (see setEventAction).
+      \param dataUp Data to send.
+      \param lenUp Length of the data.
+      \param fPort Port number to send the message to.
+      \param isConfirmed Whether to send a confirmed uplink or not.
+      \returns \ref status_codes
+    */
+    int16_t startSendReceive(const uint8_t* dataUp, size_t lenUp, uint8_t fPort = 1, bool isConfirmed = false);
+
+    /*!
+      \brief Advance the exchange started by startSendReceive. Waiting for the uplink time, the end of transmission,
+      Rx windows and the radio to report end of reception is all done across calls, not inside poll().
+      A single call may still take a while in two cases: opening an Rx window waits up to about 2 ms
+      for its exact start time, and with CSMA enabled, the channel is sensed when each (re)transmission
+      is started, which blocks for the DIFS and any backoff CAD slots.
+      \param dataDown Buffer to save received data into.
+      \param lenDown Pointer to variable that will be used to save the number of received bytes.
+      \param eventUp Pointer to a structure to store extra information about the uplink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \param eventDown Pointer to a structure to store extra information about the downlink event
+      (fPort, frame counter, etc.). If set to NULL, no extra information will be passed to the user.
+      \returns RADIOLIB_LORAWAN_PENDING while the exchange is in progress. Once it is done,
+      window number > 0 if downlink was received, 0 is no downlink was received, otherwise \ref status_codes
+    */
+    int16_t poll(uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventUp = NULL, LoRaWANEvent_t* eventDown = NULL);
+
+    /*!
+      \brief Get the time at which poll() must be called at the latest, so that the application
+      can sleep until then. poll() must also be called once the radio interrupt fires.
+      \returns Time in milliseconds, based on internal clock; 0 if no exchange is in progress.
+    */
+    RadioLibTime_t getNextDeadline();
+
+    /*!
+      \brief Set a function to be called from interrupt context when the radio raises an interrupt
+      during an asynchronous exchange, e.g. to wake up the task that calls poll().
+      The function is kept per node, but the radio interrupt is shared by all nodes. Only one node
+      may have an exchange in progress at a time, the function of the node that last started
+      a radio operation is the one that is called.
+      \param func Function to call, NULL to disable.
+    */
+    void setEventAction(void (*func)(void));
+
     /*!
       \brief Check if there is an RxC downlink and parse it if available.
       \param dataDown Buffer to save received data into.
@@ -841,6 +905,14 @@ class LoRaWANNode {
     */
     void setCSMA(bool csmaEnabled, uint8_t maxChanges = 4, uint8_t backoffMax = 0, uint8_t difsSlots = 2);
 
+    /*!
+      \brief Set seed of the pseudo-random generator used for channel selection and backoff.
+      By default, the generator is seeded from radio noise at the start of each session.
+      A fixed seed makes the channel sequence reproducible, e.g. for host testing.
+      \param seed Seed to use, 0 to seed from radio noise (default).
+    */
+    void setRandomSeed(uint32_t seed);
+
     /*!
       \brief Set device status.
       \param battLevel Battery level to set. 0 for external power source, 1 for lowest battery,
@@ -942,6 +1014,13 @@ class LoRaWANNode {
     */
     void setSleepFunction(SleepCb_t cb); 
 
+    /*!
+      \brief Set backend that performs the cryptographic operations (MIC, payload encryption and key derivation).
+      By default, these run in software on the host microcontroller.
+      \param backend Pointer to the backend, e.g. LoRaWANCryptoLR11x0. NULL restores the software backend.
+    */
+    void setCryptoBackend(LoRaWANCryptoBackend* backend);
+
     /*!
       \brief Add a LoRaWAN Application Package as defined in one of the TSxxx documents.
       Any downlinks that occur on the corresponding FPort will be redirected to 
@@ -988,6 +1067,14 @@ class LoRaWANNode {
     */
     RadioLibTime_t scanGuard = 10;
 
+    /*!
+      \brief Timing error of Class A Rx windows in microseconds. If the end of the uplink is timestamped
+      in the radio interrupt, the windows are opened this much early and kept open this much longer
+      than the time needed to detect a downlink, instead of being padded by scanGuard.
+      It must cover the clock drift over the Rx delay and the jitter of starting the receiver.
+    */
+    RadioLibTime_t rxErrorUs = 1000;
+
 #if !RADIOLIB_GODMODE
   protected:
 #endif
@@ -1023,6 +1110,10 @@ class LoRaWANNode {
     uint8_t nwkSEncKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
     uint8_t jSIntKey[RADIOLIB_AES128_KEY_SIZE] = { 0 };
 
+    // cryptographic backend, the software one is used unless the user sets a different one
+    LoRaWANCryptoSoftware cryptoSoftware;
+    LoRaWANCryptoBackend* crypto = &cryptoSoftware;
+
     uint16_t keyCheckSum = 0;
     
     // device-specific parameters, persistent through sessions
@@ -1089,6 +1180,12 @@ class LoRaWANNode {
     uint16_t channelMasks[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { 0 };
     uint16_t channelFlags[RADIOLIB_LORAWAN_MAX_NUM_FIXED_CHANNELS / 16] = { 0 };
 
+    // xorshift pseudo-random generator state, 0 means it will be seeded on the next use
+    uint32_t prngState = 0;
+
+    // user-provided seed, 0 to seed from radio noise
+    uint32_t prngSeed = 0;
+
     // currently configured channels for Tx, Rx1, Rx2, RxBC
     LoRaWANChannel_t channels[4] = { RADIOLIB_LORAWAN_CHANNEL_NONE, RADIOLIB_LORAWAN_CHANNEL_NONE,
                                      RADIOLIB_LORAWAN_CHANNEL_NONE, RADIOLIB_LORAWAN_CHANNEL_NONE };
@@ -1114,8 +1211,13 @@ class LoRaWANNode {
     // timestamp to measure the Rx1/2 delay (from uplink end)
     RadioLibTime_t tUplinkEnd = 0;
 
+    // end of uplink in microseconds, and whether it was timestamped in the interrupt
+    RadioLibTime_t tUplinkEndUs = 0;
+    bool tUplinkEndIrq = false;
+
     // duration of SPI transaction for phyLayer->launchMode()
     RadioLibTime_t launchDuration = 0;
+    RadioLibTime_t launchDurationUs = 0;
 
     // device status - battery level
     uint8_t battLevel = 0xFF;
@@ -1129,6 +1231,37 @@ class LoRaWANNode {
     // user-provided sleep callback
     SleepCb_t sleepCb = nullptr;
 
+    // asynchronous uplink/downlink exchange
+    uint8_t asyncState = RADIOLIB_LORAWAN_ASYNC_IDLE;
+
+    // user function called on radio interrupts, see setEventAction
+    void (*eventAction)(void) = NULL;
+    uint8_t asyncStep = 0;              // index in the window sequence RxC, Rx1, RxC, Rx2
+    uint8_t asyncTrans = 0;             // transmission number (ADR nbTrans)
+    bool asyncConfirmed = false;
+    uint8_t asyncPort = 0;
+    RadioLibTime_t asyncDeadline = 0;   // time at which poll() must be called at the latest
+    bool asyncIrq = false;              // whether the expected time has passed and only the IRQ is awaited
+    size_t asyncMsgLen = 0;
+    #if RADIOLIB_STATIC_ONLY
+    uint8_t asyncMsg[RADIOLIB_STATIC_ARRAY_SIZE];
+    #else
+    uint8_t* asyncMsg = NULL;
+    #endif
+
+    // Time-on-Air of the uplink being transmitted
+    RadioLibTime_t txToa = 0;
+
+    // currently staged or open receive window
+    uint8_t rxWindow = 0;
+    RadioLibTime_t rxOpen = 0;          // time at which the window was opened
+    RadioLibTime_t rxTimeout = 0;       // duration of the window, 0 for continuous
+    RadioLibTime_t rxToaMax = 0;        // maximum Time-on-Air of a downlink in this window
+    size_t rxLenMax = 0;                // maximum length of a downlink in this window
+    bool rxPrecise = false;             // whether the window is timed from the interrupt timestamp
+    RadioLibTime_t rxTargetUs = 0;      // planned opening of the window, relative to tUplinkEndUs
+    int32_t rxOffsets[2] = { 0, 0 };    // measured minus planned opening of Rx1 and Rx2
+
     // this will reset the device credentials, so the device starts completely new
     void clearNonces();
 
@@ -1136,7 +1269,7 @@ class LoRaWANNode {
     void createSession();
 
     // setup Join-Request payload
-    void composeJoinRequest(uint8_t* joinRequestMsg);
+    int16_t composeJoinRequest(uint8_t* joinRequestMsg);
 
     // extract Join-Accept payload and start a new session
     int16_t processJoinAccept(LoRaWANJoinEvent_t *joinEvent);
@@ -1151,23 +1284,65 @@ class LoRaWANNode {
     void adrBackoff();
 
     // create an encrypted uplink buffer, composing metadata, user data and MAC data
-    void composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out, uint8_t fPort, bool isConfirmed);
+    int16_t composeUplink(const uint8_t* in, uint8_t lenIn, uint8_t* out, uint8_t fPort, bool isConfirmed);
 
     // generate and set the MIC of an uplink buffer (depends on selected channels)
-    void micUplink(uint8_t* inOut, size_t lenInOut);
+    int16_t micUplink(uint8_t* inOut, size_t lenInOut);
 
     // transmit uplink buffer on a specified channel
     int16_t transmitUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len);
 
+    // configure the radio for uplink, the Time-on-Air in ms is saved into txToa
+    int16_t stageUplink(const LoRaWANChannel_t* chnl, uint8_t* in, uint8_t len);
+
+    // start the staged uplink transmission
+    int16_t launchUplink();
+
+    // clean up after the uplink was sent
+    int16_t finishUplink();
+
     // handle one of the Class A receive windows with a given channel and certain timestamps
     int16_t receiveClassA(uint8_t dir, const LoRaWANChannel_t* dlChannel, uint8_t window, const RadioLibTime_t dlDelay, RadioLibTime_t tReference);
 
     // handle a Class C receive window with timeout (between Class A windows) or without (between uplinks)
     int16_t receiveClassC(RadioLibTime_t timeout = 0);
 
+    // configure the radio for one of the Class A receive windows, opening dlDelay after the uplink
+    int16_t stageClassA(uint8_t dir, const LoRaWANChannel_t* dlChannel, uint8_t window, RadioLibTime_t dlDelay);
+
+    // get the time (internal clock) at which to start opening the staged Class A window
+    RadioLibTime_t getWindowTime(RadioLibTime_t tReference, RadioLibTime_t dlDelay);
+
+    // configure the radio for a Class C receive window, timeout of 0 means continuous
+    int16_t stageClassC(RadioLibTime_t timeout);
+
+    // open the staged receive window
+    int16_t launchWindow();
+
+    // check whether the receive window timed out, closing it if so
+    // returns 1 if timed out, 0 if something is being received, otherwise status code
+    int16_t checkWindowTimeout();
+
+    // close the receive window after reception
+    // returns window number > 0 if a downlink was received, 0 otherwise
+    // if wait is false, the caller has already waited for the radio to raise RxDone or RxTimeout
+    int16_t finishWindow(bool wait = true);
+
     // open a series of Class A (and C) downlinks
     virtual int16_t receiveDownlink();
 
+    // prepare the uplink of the ongoing exchange for (re)transmission
+    int16_t asyncTransmit();
+
+    // stage the next receive window of the ongoing exchange, or finish the uplink if none is left
+    int16_t asyncNextWindow();
+
+    // wait for the radio to report end of reception without blocking, then close the window
+    int16_t asyncFinishWindow(RadioLibTime_t tNow);
+
+    // conclude the ongoing exchange
+    int16_t asyncFinish(int16_t result, uint8_t* dataDown, size_t* lenDown, LoRaWANEvent_t* eventUp, LoRaWANEvent_t* eventDown);
+
     // extract downlink payload and process MAC commands
     int16_t parseDownlink(uint8_t* data, size_t* len, uint8_t window, LoRaWANEvent_t* event = NULL);
 
@@ -1228,22 +1403,43 @@ class LoRaWANNode {
     // enable all default channels on top of the current channels
     void enableDefaultChannels(bool addDynamic = false);
 
+    // get the pseudo-random number, seeding the generator first if needed
+    uint32_t prng();
+
+    // calculate which of the enabled channels may be used at the current datarate
+    // returns true if there is any such channel, false otherwise
+    bool getEligibleChannels(uint16_t* eligible);
+
     // calculate which channels are available given the current datarate
     // returns true if there is any such channel, false otherwise
     bool calculateChannelFlags();
 
+    // remove the channels that are no longer eligible from the flags, keeping the hopping cycle
+    // the flags are only refilled once no flagged channel remains
+    // returns true if there is any eligible channel, false otherwise
+    bool updateChannelFlags();
+
     // select a set of random TX/RX channels for up- and downlink
     int16_t selectChannels();
 
+    // get backend slot for a given key, with the key contents already passed to the backend
+    int16_t getKeyId(const uint8_t* key, uint8_t* keyId);
+
+    // encrypt blocks with a given key using the crypto backend
+    int16_t encryptECB(const uint8_t* key, const uint8_t* in, size_t len, uint8_t* out);
+
     // method to generate message integrity code
-    uint32_t generateMIC(const uint8_t* msg, size_t len, uint8_t* key);
+    int16_t generateMIC(const uint8_t* msg, size_t len, uint8_t* key, uint32_t* mic);
+
+    // method to generate message integrity code of a message prefixed by a B0/B1 block
+    int16_t generateMIC(const uint8_t* prefix, const uint8_t* msg, size_t len, uint8_t* key, uint32_t* mic);
 
     // method to verify message integrity code
     // it assumes that the MIC is the last 4 bytes of the message
-    bool verifyMIC(uint8_t* msg, size_t len, uint8_t* key);
+    int16_t verifyMIC(uint8_t* msg, size_t len, uint8_t* key);
 
     // function to encrypt and decrypt payloads (regular uplink/downlink)
-    void processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t addr, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter);
+    int16_t processAES(const uint8_t* in, size_t len, uint8_t* key, uint8_t* out, uint32_t addr, uint32_t fCnt, uint8_t dir, uint8_t ctrId, bool counter);
 
     // function that allows sleeping via user-provided callback
     void sleepDelay(RadioLibTime_t ms, bool radioOff = true);
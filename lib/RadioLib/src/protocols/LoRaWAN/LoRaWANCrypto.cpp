@@ -0,0 +1,250 @@
+#include "LoRaWANCrypto.h"
+#include <string.h>
+
+#if !RADIOLIB_EXCLUDE_LORAWAN
+
+int16_t LoRaWANCryptoBackend::encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) {
+  uint8_t keystream[RADIOLIB_AES128_BLOCK_SIZE];
+  for(size_t pos = 0; pos < len; pos += RADIOLIB_AES128_BLOCK_SIZE) {
+    int16_t state = this->encryptECB(keyId, ctr, RADIOLIB_AES128_BLOCK_SIZE, keystream);
+    RADIOLIB_ASSERT(state);
+
+    size_t chunk = len - pos;
+    if(chunk > RADIOLIB_AES128_BLOCK_SIZE) {
+      chunk = RADIOLIB_AES128_BLOCK_SIZE;
+    }
+    for(size_t i = 0; i < chunk; i++) {
+      out[pos + i] = in[pos + i] ^ keystream[i];
+    }
+
+    // big-endian increment of the whole block
+    for(int i = RADIOLIB_AES128_BLOCK_SIZE - 1; i >= 0; i--) {
+      if(++ctr[i] != 0) {
+        break;
+      }
+    }
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANCryptoSoftware::setKey(uint8_t keyId, const uint8_t* key) {
+  RADIOLIB_ASSERT_PTR(key);
+  if(keyId >= RADIOLIB_LORAWAN_NUM_KEYS) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  // the key schedule itself is only expanded on first use
+  memcpy(this->keys[keyId], key, RADIOLIB_AES128_KEY_SIZE);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANCryptoSoftware::encryptECB(uint8_t keyId, const uint8_t* in, size_t len, uint8_t* out) {
+  RadioLibAES128* aes = this->getAES(keyId);
+  if(aes == NULL) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  aes->encryptECB(in, len, out);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANCryptoSoftware::encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) {
+  RadioLibAES128* aes = this->getAES(keyId);
+  if(aes == NULL) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+  aes->encryptCTR(ctr, in, len, out);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANCryptoSoftware::generateMIC(uint8_t keyId, const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* mic) {
+  RadioLibAES128* aes = this->getAES(keyId);
+  if(aes == NULL) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  uint8_t cmac[RADIOLIB_AES128_BLOCK_SIZE];
+  if(prefix) {
+    aes->generateCMAC(prefix, in, len, cmac);
+  } else {
+    aes->generateCMAC(in, len, cmac);
+  }
+  memcpy(mic, cmac, RADIOLIB_LORAWAN_MIC_SIZE);
+  return(RADIOLIB_ERR_NONE);
+}
+
+RadioLibAES128* LoRaWANCryptoSoftware::getAES(uint8_t keyId) {
+  // session keys have their own contexts, anything else goes through the global instance
+  RadioLibAES128* aes = &RadioLibAES128Instance;
+  switch(keyId) {
+    case(RADIOLIB_LORAWAN_KEY_APP_S):
+      aes = &this->aesAppS;
+      break;
+    case(RADIOLIB_LORAWAN_KEY_NWK_S_ENC):
+      aes = &this->aesNwkSEnc;
+      break;
+    case(RADIOLIB_LORAWAN_KEY_S_NWK_S_INT):
+      aes = &this->aesSNwkSInt;
+      break;
+    case(RADIOLIB_LORAWAN_KEY_F_NWK_S_INT):
+      aes = &this->aesFNwkSInt;
+      break;
+    default:
+      if(keyId >= RADIOLIB_LORAWAN_NUM_KEYS) {
+        return(NULL);
+      }
+  }
+
+  // this only expands the key if it changed since the last time
+  aes->init(this->keys[keyId]);
+  return(aes);
+}
+
+#if !RADIOLIB_EXCLUDE_LR11X0
+
+// LR11x0 key store indexes for each of the LoRaWAN key slots,
+// multicast keys are placed in the general purpose slots
+static const uint8_t lr11x0KeyIds[RADIOLIB_LORAWAN_NUM_KEYS] RADIOLIB_NONVOLATILE = {
+  2,  // NwkKey
+  3,  // AppKey
+  5,  // JSIntKey
+  12, // AppSKey
+  13, // FNwkSIntKey
+  14, // SNwkSIntKey
+  15, // NwkSEncKey
+  26, // McAppSKey (GP0)
+  27, // McNwkSKey (GP1)
+};
+
+// maximum amount of data that fits into a single crypto engine command
+#define RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN                  (RADIOLIB_LR11X0_SPI_MAX_READ_WRITE_LEN - sizeof(uint8_t))
+
+static uint8_t lr11x0KeyId(uint8_t keyId) {
+  uint8_t* ptr = const_cast<uint8_t*>(&lr11x0KeyIds[keyId]);
+  return(RADIOLIB_NONVOLATILE_READ_BYTE(ptr));
+}
+
+LoRaWANCryptoLR11x0::LoRaWANCryptoLR11x0(LR11x0* radio) {
+  this->radio = radio;
+}
+
+int16_t LoRaWANCryptoLR11x0::setKey(uint8_t keyId, const uint8_t* key) {
+  RADIOLIB_ASSERT_PTR(key);
+  if(keyId >= RADIOLIB_LORAWAN_NUM_KEYS) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  // a reset of the radio clears its key store
+  if(this->resetCount != this->radio->resetCount) {
+    this->invalidate();
+  }
+
+  // only go to the radio if the key actually changed
+  if((this->keysLoaded & (1UL << keyId)) && (memcmp(this->keys[keyId], key, RADIOLIB_AES128_KEY_SIZE) == 0)) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  int16_t state = this->radio->cryptoSetKey(lr11x0KeyId(keyId), key);
+  if(state != RADIOLIB_ERR_NONE) {
+    this->keysLoaded &= ~(1UL << keyId);
+    return(state);
+  }
+  memcpy(this->keys[keyId], key, RADIOLIB_AES128_KEY_SIZE);
+  this->keysLoaded |= (1UL << keyId);
+  return(state);
+}
+
+void LoRaWANCryptoLR11x0::invalidate() {
+  this->keysLoaded = 0;
+  this->resetCount = this->radio->resetCount;
+}
+
+int16_t LoRaWANCryptoLR11x0::encryptECB(uint8_t keyId, const uint8_t* in, size_t len, uint8_t* out) {
+  if(keyId >= RADIOLIB_LORAWAN_NUM_KEYS) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  // split into as many whole blocks as the command can take
+  const size_t maxLen = RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN - (RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN % RADIOLIB_AES128_BLOCK_SIZE);
+  for(size_t pos = 0; pos < len; pos += maxLen) {
+    size_t chunk = len - pos;
+    if(chunk > maxLen) {
+      chunk = maxLen;
+    }
+    int16_t state = this->radio->cryptoAesEncrypt(lr11x0KeyId(keyId), &in[pos], chunk, &out[pos]);
+    RADIOLIB_ASSERT(state);
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANCryptoLR11x0::encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) {
+  // generate keystream for as many blocks as possible in a single command
+  uint8_t blocks[RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN - (RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN % RADIOLIB_AES128_BLOCK_SIZE)];
+  size_t pos = 0;
+  while(pos < len) {
+    size_t numBlocks = 0;
+    while(((pos + numBlocks*RADIOLIB_AES128_BLOCK_SIZE) < len) && (((numBlocks + 1)*RADIOLIB_AES128_BLOCK_SIZE) <= sizeof(blocks))) {
+      memcpy(&blocks[numBlocks*RADIOLIB_AES128_BLOCK_SIZE], ctr, RADIOLIB_AES128_BLOCK_SIZE);
+      for(int i = RADIOLIB_AES128_BLOCK_SIZE - 1; i >= 0; i--) {
+        if(++ctr[i] != 0) {
+          break;
+        }
+      }
+      numBlocks++;
+    }
+
+    size_t streamLen = numBlocks*RADIOLIB_AES128_BLOCK_SIZE;
+    int16_t state = this->encryptECB(keyId, blocks, streamLen, blocks);
+    RADIOLIB_ASSERT(state);
+
+    for(size_t i = 0; (i < streamLen) && (pos < len); i++, pos++) {
+      out[pos] = in[pos] ^ blocks[i];
+    }
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANCryptoLR11x0::generateMIC(uint8_t keyId, const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* mic) {
+  if(keyId >= RADIOLIB_LORAWAN_NUM_KEYS) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  size_t prefixLen = prefix ? RADIOLIB_AES128_BLOCK_SIZE : 0;
+  if((prefixLen + len) > RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN) {
+    // the longest frames do not fit into a single command together with the B0 block,
+    // these are handled in software using the shadow copy of the key
+    RadioLibAES128Instance.init(this->keys[keyId]);
+    uint8_t cmac[RADIOLIB_AES128_BLOCK_SIZE];
+    if(prefix) {
+      RadioLibAES128Instance.generateCMAC(prefix, in, len, cmac);
+    } else {
+      RadioLibAES128Instance.generateCMAC(in, len, cmac);
+    }
+    memcpy(mic, cmac, RADIOLIB_LORAWAN_MIC_SIZE);
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // the prefix has to be sent in the same command as the message
+  uint8_t buff[RADIOLIB_LORAWAN_LR11X0_CRYPTO_MAX_LEN];
+  if(prefix) {
+    memcpy(buff, prefix, prefixLen);
+  }
+  memcpy(&buff[prefixLen], in, len);
+
+  uint32_t micVal = 0;
+  int16_t state = this->radio->cryptoComputeAesCmac(lr11x0KeyId(keyId), buff, prefixLen + len, &micVal);
+  RADIOLIB_ASSERT(state);
+
+  // the radio returns first 4 bytes of the CMAC in a big-endian word
+  mic[0] = (uint8_t)((micVal >> 24) & 0xFF);
+  mic[1] = (uint8_t)((micVal >> 16) & 0xFF);
+  mic[2] = (uint8_t)((micVal >> 8) & 0xFF);
+  mic[3] = (uint8_t)(micVal & 0xFF);
+  return(state);
+}
+
+#endif
+
+#endif
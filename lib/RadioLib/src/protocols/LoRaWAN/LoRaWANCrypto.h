@@ -0,0 +1,153 @@
+#if !defined(_RADIOLIB_LORAWAN_CRYPTO_H)
+#define _RADIOLIB_LORAWAN_CRYPTO_H
+
+#include "../../TypeDef.h"
+#include "../../utils/Cryptography.h"
+
+#if !RADIOLIB_EXCLUDE_LR11X0
+#include "../../modules/LR11x0/LR11x0.h"
+#endif
+
+// key slots used by LoRaWANNode
+#define RADIOLIB_LORAWAN_KEY_NWK                                (0)
+#define RADIOLIB_LORAWAN_KEY_APP                                (1)
+#define RADIOLIB_LORAWAN_KEY_J_S_INT                            (2)
+#define RADIOLIB_LORAWAN_KEY_APP_S                              (3)
+#define RADIOLIB_LORAWAN_KEY_F_NWK_S_INT                        (4)
+#define RADIOLIB_LORAWAN_KEY_S_NWK_S_INT                        (5)
+#define RADIOLIB_LORAWAN_KEY_NWK_S_ENC                          (6)
+#define RADIOLIB_LORAWAN_KEY_MC_APP_S                           (7)
+#define RADIOLIB_LORAWAN_KEY_MC_NWK_S                           (8)
+#define RADIOLIB_LORAWAN_NUM_KEYS                               (9)
+#define RADIOLIB_LORAWAN_KEY_NONE                               (0xFF)
+
+// number of bytes of the CMAC that are used as the LoRaWAN MIC
+#define RADIOLIB_LORAWAN_MIC_SIZE                               (4)
+
+/*!
+  \class LoRaWANCryptoBackend
+  \brief Interface of the cryptographic operations needed by LoRaWANNode.
+  Keys are referenced by slot (RADIOLIB_LORAWAN_KEY_*), so that a backend may keep the key material
+  outside of the MCU, e.g. in the secure element of a radio. LoRaWANNode pushes key contents through setKey
+  before every operation, a backend is expected to skip the upload when the key did not change.
+*/
+class LoRaWANCryptoBackend {
+  public:
+    /*!
+      \brief Default destructor.
+    */
+    virtual ~LoRaWANCryptoBackend() {}
+
+    /*!
+      \brief Load key into a slot.
+      \param keyId Key slot, one of RADIOLIB_LORAWAN_KEY_*.
+      \param key 16-byte key.
+      \returns \ref status_codes
+    */
+    virtual int16_t setKey(uint8_t keyId, const uint8_t* key) = 0;
+
+    /*!
+      \brief Encrypt data in AES-128 ECB mode.
+      \param keyId Key slot, one of RADIOLIB_LORAWAN_KEY_*.
+      \param in Input data, length must be a multiple of 16 bytes.
+      \param len Length of the input data.
+      \param out Output buffer, at least len bytes long.
+      \returns \ref status_codes
+    */
+    virtual int16_t encryptECB(uint8_t keyId, const uint8_t* in, size_t len, uint8_t* out) = 0;
+
+    /*!
+      \brief Encrypt data in AES-128 CTR mode. The default implementation encrypts
+      the counter blocks one by one through encryptECB.
+      \param keyId Key slot, one of RADIOLIB_LORAWAN_KEY_*.
+      \param ctr 16-byte initial counter block, updated to the next unused counter on return.
+      \param in Input data of arbitrary length.
+      \param len Length of the input data.
+      \param out Output buffer, at least len bytes long. May be the same as in.
+      \returns \ref status_codes
+    */
+    virtual int16_t encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out);
+
+    /*!
+      \brief Calculate LoRaWAN MIC (first 4 bytes of AES-CMAC).
+      \param keyId Key slot, one of RADIOLIB_LORAWAN_KEY_*.
+      \param prefix Optional 16-byte block that is prepended to the message (B0/B1), may be NULL.
+      \param in Message to authenticate.
+      \param len Length of the message.
+      \param mic Buffer to save the MIC into, at least 4 bytes long.
+      \returns \ref status_codes
+    */
+    virtual int16_t generateMIC(uint8_t keyId, const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* mic) = 0;
+
+    /*!
+      \brief Forget any key that was loaded before, so that the next setKey of each slot is not skipped.
+      Called by LoRaWANNode when a session is started or restored. The default implementation does nothing.
+    */
+    virtual void invalidate() {}
+};
+
+/*!
+  \class LoRaWANCryptoSoftware
+  \brief Default backend, runs RadioLibAES128 on the MCU.
+*/
+class LoRaWANCryptoSoftware : public LoRaWANCryptoBackend {
+  public:
+    int16_t setKey(uint8_t keyId, const uint8_t* key) override;
+    int16_t encryptECB(uint8_t keyId, const uint8_t* in, size_t len, uint8_t* out) override;
+    int16_t encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) override;
+    int16_t generateMIC(uint8_t keyId, const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* mic) override;
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    uint8_t keys[RADIOLIB_LORAWAN_NUM_KEYS][RADIOLIB_AES128_KEY_SIZE] = { { 0 } };
+
+    // AES contexts for the frequently used session keys, so that the key schedules
+    // are kept across uplinks and downlinks instead of being expanded for every block
+    RadioLibAES128 aesAppS;
+    RadioLibAES128 aesNwkSEnc;
+    RadioLibAES128 aesSNwkSInt;
+    RadioLibAES128 aesFNwkSInt;
+
+    // get AES context for a given key slot, with the key already expanded
+    RadioLibAES128* getAES(uint8_t keyId);
+};
+
+#if !RADIOLIB_EXCLUDE_LR11X0
+
+/*!
+  \class LoRaWANCryptoLR11x0
+  \brief Backend that uses the crypto engine of LR11x0 radios.
+  Keys are uploaded into the radio key store once and only uploaded again after they change,
+  MIC and payload encryption are then performed by the radio.
+*/
+class LoRaWANCryptoLR11x0 : public LoRaWANCryptoBackend {
+  public:
+    /*!
+      \brief Default constructor.
+      \param radio Pointer to the LR11x0 radio, typically the same one that is used by LoRaWANNode.
+    */
+    explicit LoRaWANCryptoLR11x0(LR11x0* radio);
+
+    int16_t setKey(uint8_t keyId, const uint8_t* key) override;
+    int16_t encryptECB(uint8_t keyId, const uint8_t* in, size_t len, uint8_t* out) override;
+    int16_t encryptCTR(uint8_t keyId, uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) override;
+    int16_t generateMIC(uint8_t keyId, const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* mic) override;
+    void invalidate() override;
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    LR11x0* radio;
+
+    // copy of the keys currently held by the radio, the key store itself cannot be read back
+    uint8_t keys[RADIOLIB_LORAWAN_NUM_KEYS][RADIOLIB_AES128_KEY_SIZE] = { { 0 } };
+    uint16_t keysLoaded = 0;
+
+    // radio reset count at the time the keys were loaded, the key store is cleared by a reset
+    uint16_t resetCount = 0;
+};
+
+#endif
+
+#endif
@@ -547,7 +547,13 @@ uint32_t PagerClient::read() {
   }
 
   RADIOLIB_DEBUG_PROTOCOL_PRINTLN("R\t%lX", (long unsigned int)codeWord);
-  // TODO BCH error correction here
+
+  // correct bit errors, so that sync/idle code words and addresses can be matched exactly
+  // uncorrectable code words are passed as-is
+  int8_t numErrors = RadioLibBCHInstance.decode(&codeWord);
+  if(numErrors != 0) {
+    RADIOLIB_DEBUG_PROTOCOL_PRINTLN("BCH\t%d\t%lX", numErrors, (long unsigned int)codeWord);
+  }
   return(codeWord);
 }
 #endif
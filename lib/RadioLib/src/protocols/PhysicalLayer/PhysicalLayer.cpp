@@ -314,6 +314,10 @@ float PhysicalLayer::getSNR() {
   return(RADIOLIB_ERR_UNSUPPORTED);
 }
 
+float PhysicalLayer::getFrequencyError() {
+  return(0);
+}
+
 RadioLibTime_t PhysicalLayer::calculateTimeOnAir(ModemType_t modem, DataRate_t dr, PacketConfig_t pc, size_t len) {
   (void)modem;
   (void)dr;
@@ -522,6 +526,129 @@ void PhysicalLayer::readBit(uint32_t pin) {
 
 #endif
 
+int16_t PhysicalLayer::setRxQueue(RxQueuePacket_t* buff, size_t depth) {
+  if((buff == NULL) || (depth == 0)) {
+    this->rxQueue = NULL;
+    this->rxQueueDepth = 0;
+  } else {
+    this->rxQueue = buff;
+    this->rxQueueDepth = depth;
+  }
+  this->rxQueueHead = 0;
+  this->rxQueueTail = 0;
+  this->resetRxQueueStats();
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PhysicalLayer::rxQueueHandler() {
+  RADIOLIB_ASSERT_PTR(this->rxQueue);
+  RadioLibTime_t timestamp = this->getMod()->hal->micros();
+  int16_t state;
+
+  // drop the packet if the application did not drain the queue in time
+  size_t count = this->rxQueueCount();
+  if(count >= this->rxQueueDepth) {
+    this->rxQueueOverflows++;
+    state = this->finishReceive();
+    RADIOLIB_ASSERT(state);
+    return(this->startReceive());
+  }
+
+  // read the packet and start listening again as soon as possible
+  RxQueuePacket_t* pkt = &this->rxQueue[this->rxQueueHead % this->rxQueueDepth];
+  size_t len = this->getPacketLength();
+  if(len > RADIOLIB_RX_QUEUE_PACKET_LEN) {
+    len = RADIOLIB_RX_QUEUE_PACKET_LEN;
+  }
+  pkt->len = len;
+  pkt->timestamp = timestamp;
+  pkt->state = this->readData(pkt->data, len);
+  state = this->startReceive();
+
+  // packet status is kept by the radio until the next packet is received
+  pkt->rssi = this->getRSSI();
+  pkt->snr = this->getSNR();
+  pkt->freqError = this->getFrequencyError();
+
+  // only now the entry is handed over to the consumer
+  // the release store makes sure the packet contents are visible before the new head
+  RADIOLIB_ATOMIC_STORE_RELEASE(&this->rxQueueHead, (this->rxQueueHead + 1) % (2*this->rxQueueDepth));
+  this->rxQueueReceived++;
+  if(count + 1 > this->rxQueueHighWater) {
+    this->rxQueueHighWater = count + 1;
+  }
+  return(state);
+}
+
+size_t PhysicalLayer::rxQueueAvailable() {
+  if(!this->rxQueue) {
+    return(0);
+  }
+  return(this->rxQueueCount());
+}
+
+const RxQueuePacket_t* PhysicalLayer::rxQueuePeek() {
+  if(this->rxQueueAvailable() == 0) {
+    return(NULL);
+  }
+  return(&this->rxQueue[this->rxQueueTail % this->rxQueueDepth]);
+}
+
+void PhysicalLayer::rxQueueRelease() {
+  const RxQueuePacket_t* pkt = this->rxQueuePeek();
+  if(!pkt) {
+    return;
+  }
+
+  RadioLibTime_t latency = this->getMod()->hal->micros() - pkt->timestamp;
+  this->rxQueueLastLatency = latency;
+  if(latency > this->rxQueueMaxLatency) {
+    this->rxQueueMaxLatency = latency;
+  }
+  // the entry may be overwritten by the producer once the new tail is visible
+  RADIOLIB_ATOMIC_STORE_RELEASE(&this->rxQueueTail, (this->rxQueueTail + 1) % (2*this->rxQueueDepth));
+}
+
+int16_t PhysicalLayer::rxQueuePop(RxQueuePacket_t* pkt) {
+  RADIOLIB_ASSERT_PTR(pkt);
+  const RxQueuePacket_t* head = this->rxQueuePeek();
+  if(!head) {
+    return(RADIOLIB_ERR_RX_TIMEOUT);
+  }
+  memcpy(pkt, head, sizeof(RxQueuePacket_t));
+  this->rxQueueRelease();
+  return(RADIOLIB_ERR_NONE);
+}
+
+RxQueueStats_t PhysicalLayer::getRxQueueStats() {
+  RxQueueStats_t stats = {
+    .depth = this->rxQueueDepth,
+    .count = this->rxQueueAvailable(),
+    .highWater = this->rxQueueHighWater,
+    .received = this->rxQueueReceived,
+    .overflows = this->rxQueueOverflows,
+    .lastLatency = this->rxQueueLastLatency,
+    .maxLatency = this->rxQueueMaxLatency,
+  };
+  return(stats);
+}
+
+void PhysicalLayer::resetRxQueueStats() {
+  this->rxQueueHighWater = 0;
+  this->rxQueueReceived = 0;
+  this->rxQueueOverflows = 0;
+  this->rxQueueLastLatency = 0;
+  this->rxQueueMaxLatency = 0;
+}
+
+size_t PhysicalLayer::rxQueueCount() {
+  // each side reads the index published by the other one with acquire semantics,
+  // so that the entries covered by it are not accessed before they are handed over
+  size_t head = RADIOLIB_ATOMIC_LOAD_ACQUIRE(&this->rxQueueHead);
+  size_t tail = RADIOLIB_ATOMIC_LOAD_ACQUIRE(&this->rxQueueTail);
+  return((head + 2*this->rxQueueDepth - tail) % (2*this->rxQueueDepth));
+}
+
 void PhysicalLayer::setPacketReceivedAction(void (*func)(void)) {
   (void)func;
 }
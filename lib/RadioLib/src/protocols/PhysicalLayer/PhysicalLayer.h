@@ -246,6 +246,60 @@ enum RadioModeType_t {
   RADIOLIB_RADIO_MODE_SLEEP,
 };
 
+/*!
+  \struct RxQueuePacket_t
+  \brief Received packet together with its metadata, as stored in the receive queue.
+*/
+struct RxQueuePacket_t {
+  /*! \brief Packet payload, truncated to RADIOLIB_RX_QUEUE_PACKET_LEN bytes. */
+  uint8_t data[RADIOLIB_RX_QUEUE_PACKET_LEN];
+
+  /*! \brief Number of valid bytes in data. */
+  size_t len;
+
+  /*! \brief Result of reading the packet, e.g. RADIOLIB_ERR_CRC_MISMATCH. */
+  int16_t state;
+
+  /*! \brief RSSI of the packet in dBm. */
+  float rssi;
+
+  /*! \brief SNR of the packet in dB, 0 for modems that do not report it. */
+  float snr;
+
+  /*! \brief Frequency error in Hz, 0 for modules that do not report it. */
+  float freqError;
+
+  /*! \brief Time when the packet was handled, in microseconds. */
+  RadioLibTime_t timestamp;
+};
+
+/*!
+  \struct RxQueueStats_t
+  \brief Receive queue statistics.
+*/
+struct RxQueueStats_t {
+  /*! \brief Number of entries the queue can hold. */
+  size_t depth;
+
+  /*! \brief Number of packets currently waiting in the queue. */
+  size_t count;
+
+  /*! \brief Highest number of packets that were waiting in the queue at the same time. */
+  size_t highWater;
+
+  /*! \brief Number of packets that were put into the queue. */
+  uint32_t received;
+
+  /*! \brief Number of packets that were dropped because the queue was full. */
+  uint32_t overflows;
+
+  /*! \brief Time between handling and draining of the last packet, in microseconds. */
+  RadioLibTime_t lastLatency;
+
+  /*! \brief Longest time between handling and draining of a packet, in microseconds. */
+  RadioLibTime_t maxLatency;
+};
+
 /*!
   \class PhysicalLayer
 
@@ -557,6 +611,12 @@ class PhysicalLayer {
       \returns SNR of the last received packet in dB.
     */
     virtual float getSNR();
+
+    /*!
+      \brief Gets frequency error of the last received packet.
+      \returns Frequency error in Hz.
+    */
+    virtual float getFrequencyError();
     
     /*!
       \brief Calculate the expected time-on-air for a given modem, data rate, packet configuration and payload size.
@@ -779,6 +839,61 @@ class PhysicalLayer {
     */
     virtual void clearChannelScanAction();
 
+    /*!
+      \brief Set up receive queue. Packets are then read by rxQueueHandler and can be drained
+      by the application in batches, while the radio is already listening for the next one.
+      The queue is single-producer/single-consumer: rxQueueHandler must only be called from one context
+      (e.g. a task woken up by the packet received interrupt), and the queue must only be drained from one other context.
+      \param buff Storage for the queue entries, must remain valid while the queue is in use. Set to NULL to disable the queue.
+      \param depth Number of entries in buff.
+      \returns \ref status_codes
+    */
+    int16_t setRxQueue(RxQueuePacket_t* buff, size_t depth);
+
+    /*!
+      \brief Deferred packet received handler. Reads the packet into the queue, re-arms reception
+      and then reads the packet metadata. This performs SPI transactions, so it must not be called from the ISR itself.
+      If the queue is full, the packet is dropped and counted as overflow.
+      \returns \ref status_codes
+    */
+    int16_t rxQueueHandler();
+
+    /*!
+      \brief Get the number of packets waiting in the receive queue.
+      \returns Number of queued packets.
+    */
+    size_t rxQueueAvailable();
+
+    /*!
+      \brief Get the oldest packet in the receive queue without copying it.
+      The entry remains valid until rxQueueRelease is called.
+      \returns Pointer to the oldest packet, or NULL if the queue is empty.
+    */
+    const RxQueuePacket_t* rxQueuePeek();
+
+    /*!
+      \brief Release the oldest packet in the receive queue, after it was processed using rxQueuePeek.
+    */
+    void rxQueueRelease();
+
+    /*!
+      \brief Copy the oldest packet out of the receive queue and release it.
+      \param pkt Pointer to a structure to save the packet into.
+      \returns \ref status_codes, RADIOLIB_ERR_RX_TIMEOUT if the queue is empty.
+    */
+    int16_t rxQueuePop(RxQueuePacket_t* pkt);
+
+    /*!
+      \brief Get receive queue statistics.
+      \returns Statistics structure.
+    */
+    RxQueueStats_t getRxQueueStats();
+
+    /*!
+      \brief Reset receive queue counters and latency statistics.
+    */
+    void resetRxQueueStats();
+
     /*!
       \brief Set modem for the radio to use. Will perform full reset and reconfigure the radio
       using its default parameters.
@@ -851,6 +966,20 @@ class PhysicalLayer {
     bool gotSync = false;
     #endif
 
+    // receive queue, head is only written by rxQueueHandler and tail only by the consumer
+    // both indexes run over twice the depth, so that a full queue can be told apart from an empty one
+    RxQueuePacket_t* rxQueue = NULL;
+    size_t rxQueueDepth = 0;
+    volatile size_t rxQueueHead = 0;
+    volatile size_t rxQueueTail = 0;
+    size_t rxQueueHighWater = 0;
+    uint32_t rxQueueReceived = 0;
+    uint32_t rxQueueOverflows = 0;
+    RadioLibTime_t rxQueueLastLatency = 0;
+    RadioLibTime_t rxQueueMaxLatency = 0;
+
+    size_t rxQueueCount();
+
     virtual Module* getMod() = 0;
 
     // allow specific classes access the private getMod method
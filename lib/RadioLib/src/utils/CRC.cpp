@@ -32,4 +32,180 @@ uint32_t RadioLibCRC::checksum(const uint8_t* buff, size_t len) {
   return(crc);
 }
 
+// read a single entry from the preset lookup table
+static uint16_t readTableEntry(const RadioLibCRCPreset_t& preset, uint8_t index) {
+  if(preset.size == 8) {
+    uint8_t* ptr = const_cast<uint8_t*>(&preset.table[index]);
+    return(RADIOLIB_NONVOLATILE_READ_BYTE(ptr));
+  }
+  uint8_t* ptr = const_cast<uint8_t*>(&preset.table[2*index]);
+  return(((uint16_t)RADIOLIB_NONVOLATILE_READ_BYTE(ptr) << 8) | RADIOLIB_NONVOLATILE_READ_BYTE(ptr + 1));
+}
+
+uint32_t RadioLibCRC::checksum(const RadioLibCRCPreset_t& preset, const uint8_t* buff, size_t len) {
+  uint32_t crc = preset.init;
+  if(preset.size == 8) {
+    // 8-bit CRC is the same for both normal and reflected variant, the only difference is in the table
+    for(size_t i = 0; i < len; i++) {
+      crc = readTableEntry(preset, crc ^ buff[i]);
+    }
+
+  } else if(preset.reflected) {
+    for(size_t i = 0; i < len; i++) {
+      crc = (crc >> 8) ^ readTableEntry(preset, crc ^ buff[i]);
+    }
+
+  } else {
+    for(size_t i = 0; i < len; i++) {
+      crc = ((crc << 8) ^ readTableEntry(preset, (crc >> 8) ^ buff[i])) & 0xFFFF;
+    }
+
+  }
+
+  crc ^= preset.out;
+  return(crc);
+}
+
 RadioLibCRC RadioLibCRCInstance;
+
+// lookup tables for the CRC presets, one entry per input byte
+// 16-bit tables are stored as big-endian byte pairs
+static const uint8_t CRCTableCCITT[512] RADIOLIB_NONVOLATILE = {
+  0x00, 0x00, 0x10, 0x21, 0x20, 0x42, 0x30, 0x63, 0x40, 0x84, 0x50, 0xA5, 0x60, 0xC6, 0x70, 0xE7,
+  0x81, 0x08, 0x91, 0x29, 0xA1, 0x4A, 0xB1, 0x6B, 0xC1, 0x8C, 0xD1, 0xAD, 0xE1, 0xCE, 0xF1, 0xEF,
+  0x12, 0x31, 0x02, 0x10, 0x32, 0x73, 0x22, 0x52, 0x52, 0xB5, 0x42, 0x94, 0x72, 0xF7, 0x62, 0xD6,
+  0x93, 0x39, 0x83, 0x18, 0xB3, 0x7B, 0xA3, 0x5A, 0xD3, 0xBD, 0xC3, 0x9C, 0xF3, 0xFF, 0xE3, 0xDE,
+  0x24, 0x62, 0x34, 0x43, 0x04, 0x20, 0x14, 0x01, 0x64, 0xE6, 0x74, 0xC7, 0x44, 0xA4, 0x54, 0x85,
+  0xA5, 0x6A, 0xB5, 0x4B, 0x85, 0x28, 0x95, 0x09, 0xE5, 0xEE, 0xF5, 0xCF, 0xC5, 0xAC, 0xD5, 0x8D,
+  0x36, 0x53, 0x26, 0x72, 0x16, 0x11, 0x06, 0x30, 0x76, 0xD7, 0x66, 0xF6, 0x56, 0x95, 0x46, 0xB4,
+  0xB7, 0x5B, 0xA7, 0x7A, 0x97, 0x19, 0x87, 0x38, 0xF7, 0xDF, 0xE7, 0xFE, 0xD7, 0x9D, 0xC7, 0xBC,
+  0x48, 0xC4, 0x58, 0xE5, 0x68, 0x86, 0x78, 0xA7, 0x08, 0x40, 0x18, 0x61, 0x28, 0x02, 0x38, 0x23,
+  0xC9, 0xCC, 0xD9, 0xED, 0xE9, 0x8E, 0xF9, 0xAF, 0x89, 0x48, 0x99, 0x69, 0xA9, 0x0A, 0xB9, 0x2B,
+  0x5A, 0xF5, 0x4A, 0xD4, 0x7A, 0xB7, 0x6A, 0x96, 0x1A, 0x71, 0x0A, 0x50, 0x3A, 0x33, 0x2A, 0x12,
+  0xDB, 0xFD, 0xCB, 0xDC, 0xFB, 0xBF, 0xEB, 0x9E, 0x9B, 0x79, 0x8B, 0x58, 0xBB, 0x3B, 0xAB, 0x1A,
+  0x6C, 0xA6, 0x7C, 0x87, 0x4C, 0xE4, 0x5C, 0xC5, 0x2C, 0x22, 0x3C, 0x03, 0x0C, 0x60, 0x1C, 0x41,
+  0xED, 0xAE, 0xFD, 0x8F, 0xCD, 0xEC, 0xDD, 0xCD, 0xAD, 0x2A, 0xBD, 0x0B, 0x8D, 0x68, 0x9D, 0x49,
+  0x7E, 0x97, 0x6E, 0xB6, 0x5E, 0xD5, 0x4E, 0xF4, 0x3E, 0x13, 0x2E, 0x32, 0x1E, 0x51, 0x0E, 0x70,
+  0xFF, 0x9F, 0xEF, 0xBE, 0xDF, 0xDD, 0xCF, 0xFC, 0xBF, 0x1B, 0xAF, 0x3A, 0x9F, 0x59, 0x8F, 0x78,
+  0x91, 0x88, 0x81, 0xA9, 0xB1, 0xCA, 0xA1, 0xEB, 0xD1, 0x0C, 0xC1, 0x2D, 0xF1, 0x4E, 0xE1, 0x6F,
+  0x10, 0x80, 0x00, 0xA1, 0x30, 0xC2, 0x20, 0xE3, 0x50, 0x04, 0x40, 0x25, 0x70, 0x46, 0x60, 0x67,
+  0x83, 0xB9, 0x93, 0x98, 0xA3, 0xFB, 0xB3, 0xDA, 0xC3, 0x3D, 0xD3, 0x1C, 0xE3, 0x7F, 0xF3, 0x5E,
+  0x02, 0xB1, 0x12, 0x90, 0x22, 0xF3, 0x32, 0xD2, 0x42, 0x35, 0x52, 0x14, 0x62, 0x77, 0x72, 0x56,
+  0xB5, 0xEA, 0xA5, 0xCB, 0x95, 0xA8, 0x85, 0x89, 0xF5, 0x6E, 0xE5, 0x4F, 0xD5, 0x2C, 0xC5, 0x0D,
+  0x34, 0xE2, 0x24, 0xC3, 0x14, 0xA0, 0x04, 0x81, 0x74, 0x66, 0x64, 0x47, 0x54, 0x24, 0x44, 0x05,
+  0xA7, 0xDB, 0xB7, 0xFA, 0x87, 0x99, 0x97, 0xB8, 0xE7, 0x5F, 0xF7, 0x7E, 0xC7, 0x1D, 0xD7, 0x3C,
+  0x26, 0xD3, 0x36, 0xF2, 0x06, 0x91, 0x16, 0xB0, 0x66, 0x57, 0x76, 0x76, 0x46, 0x15, 0x56, 0x34,
+  0xD9, 0x4C, 0xC9, 0x6D, 0xF9, 0x0E, 0xE9, 0x2F, 0x99, 0xC8, 0x89, 0xE9, 0xB9, 0x8A, 0xA9, 0xAB,
+  0x58, 0x44, 0x48, 0x65, 0x78, 0x06, 0x68, 0x27, 0x18, 0xC0, 0x08, 0xE1, 0x38, 0x82, 0x28, 0xA3,
+  0xCB, 0x7D, 0xDB, 0x5C, 0xEB, 0x3F, 0xFB, 0x1E, 0x8B, 0xF9, 0x9B, 0xD8, 0xAB, 0xBB, 0xBB, 0x9A,
+  0x4A, 0x75, 0x5A, 0x54, 0x6A, 0x37, 0x7A, 0x16, 0x0A, 0xF1, 0x1A, 0xD0, 0x2A, 0xB3, 0x3A, 0x92,
+  0xFD, 0x2E, 0xED, 0x0F, 0xDD, 0x6C, 0xCD, 0x4D, 0xBD, 0xAA, 0xAD, 0x8B, 0x9D, 0xE8, 0x8D, 0xC9,
+  0x7C, 0x26, 0x6C, 0x07, 0x5C, 0x64, 0x4C, 0x45, 0x3C, 0xA2, 0x2C, 0x83, 0x1C, 0xE0, 0x0C, 0xC1,
+  0xEF, 0x1F, 0xFF, 0x3E, 0xCF, 0x5D, 0xDF, 0x7C, 0xAF, 0x9B, 0xBF, 0xBA, 0x8F, 0xD9, 0x9F, 0xF8,
+  0x6E, 0x17, 0x7E, 0x36, 0x4E, 0x55, 0x5E, 0x74, 0x2E, 0x93, 0x3E, 0xB2, 0x0E, 0xD1, 0x1E, 0xF0,
+};
+
+static const uint8_t CRCTableLRFHSSPayload[512] RADIOLIB_NONVOLATILE = {
+  0x00, 0x00, 0x75, 0x5B, 0xEA, 0xB6, 0x9F, 0xED, 0xA0, 0x37, 0xD5, 0x6C, 0x4A, 0x81, 0x3F, 0xDA,
+  0x35, 0x35, 0x40, 0x6E, 0xDF, 0x83, 0xAA, 0xD8, 0x95, 0x02, 0xE0, 0x59, 0x7F, 0xB4, 0x0A, 0xEF,
+  0x6A, 0x6A, 0x1F, 0x31, 0x80, 0xDC, 0xF5, 0x87, 0xCA, 0x5D, 0xBF, 0x06, 0x20, 0xEB, 0x55, 0xB0,
+  0x5F, 0x5F, 0x2A, 0x04, 0xB5, 0xE9, 0xC0, 0xB2, 0xFF, 0x68, 0x8A, 0x33, 0x15, 0xDE, 0x60, 0x85,
+  0xD4, 0xD4, 0xA1, 0x8F, 0x3E, 0x62, 0x4B, 0x39, 0x74, 0xE3, 0x01, 0xB8, 0x9E, 0x55, 0xEB, 0x0E,
+  0xE1, 0xE1, 0x94, 0xBA, 0x0B, 0x57, 0x7E, 0x0C, 0x41, 0xD6, 0x34, 0x8D, 0xAB, 0x60, 0xDE, 0x3B,
+  0xBE, 0xBE, 0xCB, 0xE5, 0x54, 0x08, 0x21, 0x53, 0x1E, 0x89, 0x6B, 0xD2, 0xF4, 0x3F, 0x81, 0x64,
+  0x8B, 0x8B, 0xFE, 0xD0, 0x61, 0x3D, 0x14, 0x66, 0x2B, 0xBC, 0x5E, 0xE7, 0xC1, 0x0A, 0xB4, 0x51,
+  0xDC, 0xF3, 0xA9, 0xA8, 0x36, 0x45, 0x43, 0x1E, 0x7C, 0xC4, 0x09, 0x9F, 0x96, 0x72, 0xE3, 0x29,
+  0xE9, 0xC6, 0x9C, 0x9D, 0x03, 0x70, 0x76, 0x2B, 0x49, 0xF1, 0x3C, 0xAA, 0xA3, 0x47, 0xD6, 0x1C,
+  0xB6, 0x99, 0xC3, 0xC2, 0x5C, 0x2F, 0x29, 0x74, 0x16, 0xAE, 0x63, 0xF5, 0xFC, 0x18, 0x89, 0x43,
+  0x83, 0xAC, 0xF6, 0xF7, 0x69, 0x1A, 0x1C, 0x41, 0x23, 0x9B, 0x56, 0xC0, 0xC9, 0x2D, 0xBC, 0x76,
+  0x08, 0x27, 0x7D, 0x7C, 0xE2, 0x91, 0x97, 0xCA, 0xA8, 0x10, 0xDD, 0x4B, 0x42, 0xA6, 0x37, 0xFD,
+  0x3D, 0x12, 0x48, 0x49, 0xD7, 0xA4, 0xA2, 0xFF, 0x9D, 0x25, 0xE8, 0x7E, 0x77, 0x93, 0x02, 0xC8,
+  0x62, 0x4D, 0x17, 0x16, 0x88, 0xFB, 0xFD, 0xA0, 0xC2, 0x7A, 0xB7, 0x21, 0x28, 0xCC, 0x5D, 0x97,
+  0x57, 0x78, 0x22, 0x23, 0xBD, 0xCE, 0xC8, 0x95, 0xF7, 0x4F, 0x82, 0x14, 0x1D, 0xF9, 0x68, 0xA2,
+  0xCC, 0xBD, 0xB9, 0xE6, 0x26, 0x0B, 0x53, 0x50, 0x6C, 0x8A, 0x19, 0xD1, 0x86, 0x3C, 0xF3, 0x67,
+  0xF9, 0x88, 0x8C, 0xD3, 0x13, 0x3E, 0x66, 0x65, 0x59, 0xBF, 0x2C, 0xE4, 0xB3, 0x09, 0xC6, 0x52,
+  0xA6, 0xD7, 0xD3, 0x8C, 0x4C, 0x61, 0x39, 0x3A, 0x06, 0xE0, 0x73, 0xBB, 0xEC, 0x56, 0x99, 0x0D,
+  0x93, 0xE2, 0xE6, 0xB9, 0x79, 0x54, 0x0C, 0x0F, 0x33, 0xD5, 0x46, 0x8E, 0xD9, 0x63, 0xAC, 0x38,
+  0x18, 0x69, 0x6D, 0x32, 0xF2, 0xDF, 0x87, 0x84, 0xB8, 0x5E, 0xCD, 0x05, 0x52, 0xE8, 0x27, 0xB3,
+  0x2D, 0x5C, 0x58, 0x07, 0xC7, 0xEA, 0xB2, 0xB1, 0x8D, 0x6B, 0xF8, 0x30, 0x67, 0xDD, 0x12, 0x86,
+  0x72, 0x03, 0x07, 0x58, 0x98, 0xB5, 0xED, 0xEE, 0xD2, 0x34, 0xA7, 0x6F, 0x38, 0x82, 0x4D, 0xD9,
+  0x47, 0x36, 0x32, 0x6D, 0xAD, 0x80, 0xD8, 0xDB, 0xE7, 0x01, 0x92, 0x5A, 0x0D, 0xB7, 0x78, 0xEC,
+  0x10, 0x4E, 0x65, 0x15, 0xFA, 0xF8, 0x8F, 0xA3, 0xB0, 0x79, 0xC5, 0x22, 0x5A, 0xCF, 0x2F, 0x94,
+  0x25, 0x7B, 0x50, 0x20, 0xCF, 0xCD, 0xBA, 0x96, 0x85, 0x4C, 0xF0, 0x17, 0x6F, 0xFA, 0x1A, 0xA1,
+  0x7A, 0x24, 0x0F, 0x7F, 0x90, 0x92, 0xE5, 0xC9, 0xDA, 0x13, 0xAF, 0x48, 0x30, 0xA5, 0x45, 0xFE,
+  0x4F, 0x11, 0x3A, 0x4A, 0xA5, 0xA7, 0xD0, 0xFC, 0xEF, 0x26, 0x9A, 0x7D, 0x05, 0x90, 0x70, 0xCB,
+  0xC4, 0x9A, 0xB1, 0xC1, 0x2E, 0x2C, 0x5B, 0x77, 0x64, 0xAD, 0x11, 0xF6, 0x8E, 0x1B, 0xFB, 0x40,
+  0xF1, 0xAF, 0x84, 0xF4, 0x1B, 0x19, 0x6E, 0x42, 0x51, 0x98, 0x24, 0xC3, 0xBB, 0x2E, 0xCE, 0x75,
+  0xAE, 0xF0, 0xDB, 0xAB, 0x44, 0x46, 0x31, 0x1D, 0x0E, 0xC7, 0x7B, 0x9C, 0xE4, 0x71, 0x91, 0x2A,
+  0x9B, 0xC5, 0xEE, 0x9E, 0x71, 0x73, 0x04, 0x28, 0x3B, 0xF2, 0x4E, 0xA9, 0xD1, 0x44, 0xA4, 0x1F,
+};
+
+static const uint8_t CRCTableLRFHSSHeader[256] RADIOLIB_NONVOLATILE = {
+  0x00, 0x2F, 0x5E, 0x71, 0xBC, 0x93, 0xE2, 0xCD, 0x57, 0x78, 0x09, 0x26, 0xEB, 0xC4, 0xB5, 0x9A,
+  0xAE, 0x81, 0xF0, 0xDF, 0x12, 0x3D, 0x4C, 0x63, 0xF9, 0xD6, 0xA7, 0x88, 0x45, 0x6A, 0x1B, 0x34,
+  0x73, 0x5C, 0x2D, 0x02, 0xCF, 0xE0, 0x91, 0xBE, 0x24, 0x0B, 0x7A, 0x55, 0x98, 0xB7, 0xC6, 0xE9,
+  0xDD, 0xF2, 0x83, 0xAC, 0x61, 0x4E, 0x3F, 0x10, 0x8A, 0xA5, 0xD4, 0xFB, 0x36, 0x19, 0x68, 0x47,
+  0xE6, 0xC9, 0xB8, 0x97, 0x5A, 0x75, 0x04, 0x2B, 0xB1, 0x9E, 0xEF, 0xC0, 0x0D, 0x22, 0x53, 0x7C,
+  0x48, 0x67, 0x16, 0x39, 0xF4, 0xDB, 0xAA, 0x85, 0x1F, 0x30, 0x41, 0x6E, 0xA3, 0x8C, 0xFD, 0xD2,
+  0x95, 0xBA, 0xCB, 0xE4, 0x29, 0x06, 0x77, 0x58, 0xC2, 0xED, 0x9C, 0xB3, 0x7E, 0x51, 0x20, 0x0F,
+  0x3B, 0x14, 0x65, 0x4A, 0x87, 0xA8, 0xD9, 0xF6, 0x6C, 0x43, 0x32, 0x1D, 0xD0, 0xFF, 0x8E, 0xA1,
+  0xE3, 0xCC, 0xBD, 0x92, 0x5F, 0x70, 0x01, 0x2E, 0xB4, 0x9B, 0xEA, 0xC5, 0x08, 0x27, 0x56, 0x79,
+  0x4D, 0x62, 0x13, 0x3C, 0xF1, 0xDE, 0xAF, 0x80, 0x1A, 0x35, 0x44, 0x6B, 0xA6, 0x89, 0xF8, 0xD7,
+  0x90, 0xBF, 0xCE, 0xE1, 0x2C, 0x03, 0x72, 0x5D, 0xC7, 0xE8, 0x99, 0xB6, 0x7B, 0x54, 0x25, 0x0A,
+  0x3E, 0x11, 0x60, 0x4F, 0x82, 0xAD, 0xDC, 0xF3, 0x69, 0x46, 0x37, 0x18, 0xD5, 0xFA, 0x8B, 0xA4,
+  0x05, 0x2A, 0x5B, 0x74, 0xB9, 0x96, 0xE7, 0xC8, 0x52, 0x7D, 0x0C, 0x23, 0xEE, 0xC1, 0xB0, 0x9F,
+  0xAB, 0x84, 0xF5, 0xDA, 0x17, 0x38, 0x49, 0x66, 0xFC, 0xD3, 0xA2, 0x8D, 0x40, 0x6F, 0x1E, 0x31,
+  0x76, 0x59, 0x28, 0x07, 0xCA, 0xE5, 0x94, 0xBB, 0x21, 0x0E, 0x7F, 0x50, 0x9D, 0xB2, 0xC3, 0xEC,
+  0xD8, 0xF7, 0x86, 0xA9, 0x64, 0x4B, 0x3A, 0x15, 0x8F, 0xA0, 0xD1, 0xFE, 0x33, 0x1C, 0x6D, 0x42,
+};
+
+static const uint8_t CRCTableLR11x0[256] RADIOLIB_NONVOLATILE = {
+  0x00, 0xEF, 0x93, 0x7C, 0x6B, 0x84, 0xF8, 0x17, 0xD6, 0x39, 0x45, 0xAA, 0xBD, 0x52, 0x2E, 0xC1,
+  0xE1, 0x0E, 0x72, 0x9D, 0x8A, 0x65, 0x19, 0xF6, 0x37, 0xD8, 0xA4, 0x4B, 0x5C, 0xB3, 0xCF, 0x20,
+  0x8F, 0x60, 0x1C, 0xF3, 0xE4, 0x0B, 0x77, 0x98, 0x59, 0xB6, 0xCA, 0x25, 0x32, 0xDD, 0xA1, 0x4E,
+  0x6E, 0x81, 0xFD, 0x12, 0x05, 0xEA, 0x96, 0x79, 0xB8, 0x57, 0x2B, 0xC4, 0xD3, 0x3C, 0x40, 0xAF,
+  0x53, 0xBC, 0xC0, 0x2F, 0x38, 0xD7, 0xAB, 0x44, 0x85, 0x6A, 0x16, 0xF9, 0xEE, 0x01, 0x7D, 0x92,
+  0xB2, 0x5D, 0x21, 0xCE, 0xD9, 0x36, 0x4A, 0xA5, 0x64, 0x8B, 0xF7, 0x18, 0x0F, 0xE0, 0x9C, 0x73,
+  0xDC, 0x33, 0x4F, 0xA0, 0xB7, 0x58, 0x24, 0xCB, 0x0A, 0xE5, 0x99, 0x76, 0x61, 0x8E, 0xF2, 0x1D,
+  0x3D, 0xD2, 0xAE, 0x41, 0x56, 0xB9, 0xC5, 0x2A, 0xEB, 0x04, 0x78, 0x97, 0x80, 0x6F, 0x13, 0xFC,
+  0xA6, 0x49, 0x35, 0xDA, 0xCD, 0x22, 0x5E, 0xB1, 0x70, 0x9F, 0xE3, 0x0C, 0x1B, 0xF4, 0x88, 0x67,
+  0x47, 0xA8, 0xD4, 0x3B, 0x2C, 0xC3, 0xBF, 0x50, 0x91, 0x7E, 0x02, 0xED, 0xFA, 0x15, 0x69, 0x86,
+  0x29, 0xC6, 0xBA, 0x55, 0x42, 0xAD, 0xD1, 0x3E, 0xFF, 0x10, 0x6C, 0x83, 0x94, 0x7B, 0x07, 0xE8,
+  0xC8, 0x27, 0x5B, 0xB4, 0xA3, 0x4C, 0x30, 0xDF, 0x1E, 0xF1, 0x8D, 0x62, 0x75, 0x9A, 0xE6, 0x09,
+  0xF5, 0x1A, 0x66, 0x89, 0x9E, 0x71, 0x0D, 0xE2, 0x23, 0xCC, 0xB0, 0x5F, 0x48, 0xA7, 0xDB, 0x34,
+  0x14, 0xFB, 0x87, 0x68, 0x7F, 0x90, 0xEC, 0x03, 0xC2, 0x2D, 0x51, 0xBE, 0xA9, 0x46, 0x3A, 0xD5,
+  0x7A, 0x95, 0xE9, 0x06, 0x11, 0xFE, 0x82, 0x6D, 0xAC, 0x43, 0x3F, 0xD0, 0xC7, 0x28, 0x54, 0xBB,
+  0x9B, 0x74, 0x08, 0xE7, 0xF0, 0x1F, 0x63, 0x8C, 0x4D, 0xA2, 0xDE, 0x31, 0x26, 0xC9, 0xB5, 0x5A,
+};
+
+const RadioLibCRCPreset_t RadioLibCRCPresetCCITT = {
+  .size = 16,
+  .init = RADIOLIB_CRC_CCITT_INIT,
+  .out = RADIOLIB_CRC_CCITT_OUT,
+  .reflected = false,
+  .table = CRCTableCCITT,
+};
+
+const RadioLibCRCPreset_t RadioLibCRCPresetLRFHSSPayload = {
+  .size = 16,
+  .init = 0xFFFF,
+  .out = 0x0000,
+  .reflected = false,
+  .table = CRCTableLRFHSSPayload,
+};
+
+const RadioLibCRCPreset_t RadioLibCRCPresetLRFHSSHeader = {
+  .size = 8,
+  .init = 0xFF,
+  .out = 0x00,
+  .reflected = false,
+  .table = CRCTableLRFHSSHeader,
+};
+
+const RadioLibCRCPreset_t RadioLibCRCPresetLR11x0 = {
+  .size = 8,
+  .init = 0xFF,
+  .out = 0x00,
+  .reflected = true,
+  .table = CRCTableLR11x0,
+};
@@ -9,6 +9,34 @@
 #define RADIOLIB_CRC_CCITT_INIT                                 (0xFFFF)
 #define RADIOLIB_CRC_CCITT_OUT                                  (0xFFFF)
 
+/*!
+  \struct RadioLibCRCPreset_t
+  \brief Immutable description of a table-driven CRC. Since presets are never modified,
+  they can be shared by multiple users at the same time, as opposed to the \ref RadioLibCRCInstance.
+*/
+struct RadioLibCRCPreset_t {
+  /*! \brief CRC size in bits, 8 or 16. */
+  uint8_t size;
+
+  /*! \brief Initial value. */
+  uint16_t init;
+
+  /*! \brief Final XOR value. */
+  uint16_t out;
+
+  /*!
+    \brief Whether both input and result are reflected. If set, the table
+    has to be generated for the reflected polynomial.
+  */
+  bool reflected;
+
+  /*!
+    \brief Lookup table with 256 entries stored in non-volatile memory.
+    16-bit entries are stored as big-endian byte pairs.
+  */
+  const uint8_t* table;
+};
+
 /*!
   \class RadioLibCRC
   \brief Class to calculate CRCs of varying formats.
@@ -57,9 +85,32 @@ class RadioLibCRC {
       \returns The resulting checksum.
     */
     uint32_t checksum(const uint8_t* buff, size_t len);
+
+    /*!
+      \brief Calculate checksum of a buffer using a table-driven preset, processing one byte per iteration.
+      This method does not use any instance members, so it is safe to call concurrently.
+      \param preset CRC preset to use.
+      \param buff Buffer to calculate the checksum over.
+      \param len Size of the buffer in bytes.
+      \returns The resulting checksum.
+    */
+    static uint32_t checksum(const RadioLibCRCPreset_t& preset, const uint8_t* buff, size_t len);
 };
 
 // the global singleton
 extern RadioLibCRC RadioLibCRCInstance;
 
+// CRC presets
+/*! \brief CCITT CRC-16 (used by AX.25). */
+extern const RadioLibCRCPreset_t RadioLibCRCPresetCCITT;
+
+/*! \brief LR-FHSS payload CRC-16, polynomial 0x755B. */
+extern const RadioLibCRCPreset_t RadioLibCRCPresetLRFHSSPayload;
+
+/*! \brief LR-FHSS header CRC-8, polynomial 0x2F without final XOR. */
+extern const RadioLibCRCPreset_t RadioLibCRCPresetLRFHSSHeader;
+
+/*! \brief LR11x0 SPI CRC-8, polynomial 0x65 with reflected input and output. */
+extern const RadioLibCRCPreset_t RadioLibCRCPresetLR11x0;
+
 #endif
@@ -8,7 +8,14 @@ RadioLibAES128::RadioLibAES128() {
 
 void RadioLibAES128::init(uint8_t* key) {
   this->keyPtr = key;
+
+  // the first round key is the key itself, so it can be used to check whether the key changed
+  if(this->keyExpanded && (memcmp(this->roundKey, key, RADIOLIB_AES128_KEY_SIZE) == 0)) {
+    return;
+  }
   this->keyExpansion(this->roundKey, key);
+  this->keyExpanded = true;
+  this->subkeysGenerated = false;
 }
 
 size_t RadioLibAES128::encryptECB(const uint8_t* in, size_t len, uint8_t* out) {
@@ -43,6 +50,33 @@ size_t RadioLibAES128::decryptECB(const uint8_t* in, size_t len, uint8_t* out) {
   return(num_blocks*RADIOLIB_AES128_BLOCK_SIZE);
 }
 
+void RadioLibAES128::encryptCTR(uint8_t* ctr, const uint8_t* in, size_t len, uint8_t* out) {
+  uint8_t keystream[RADIOLIB_AES128_BLOCK_SIZE];
+  size_t offset = 0;
+  while(offset < len) {
+    // encrypt the counter to get the keystream
+    memcpy(keystream, ctr, RADIOLIB_AES128_BLOCK_SIZE);
+    this->cipher((state_t*)keystream, this->roundKey);
+
+    // XOR the keystream with the input
+    size_t xorLen = len - offset;
+    if(xorLen > RADIOLIB_AES128_BLOCK_SIZE) {
+      xorLen = RADIOLIB_AES128_BLOCK_SIZE;
+    }
+    for(size_t i = 0; i < xorLen; i++) {
+      out[offset + i] = in[offset + i] ^ keystream[i];
+    }
+    offset += xorLen;
+
+    // increment the counter
+    for(int8_t i = RADIOLIB_AES128_BLOCK_SIZE - 1; i >= 0; i--) {
+      if(++ctr[i] != 0) {
+        break;
+      }
+    }
+  }
+}
+
 /*
  * CMAC streaming API
  *
@@ -62,7 +96,6 @@ void RadioLibAES128::initCMAC(RadioLibCmacState* st) {
   memset(st->X, 0x00, RADIOLIB_AES128_BLOCK_SIZE);
   memset(st->buffer, 0x00, RADIOLIB_AES128_BLOCK_SIZE);
   st->buffer_len = 0;
-  st->subkeys_generated = false;
 }
 
 void RadioLibAES128::updateCMAC(RadioLibCmacState* st, const uint8_t* data, size_t len) {
@@ -70,15 +103,7 @@ void RadioLibAES128::updateCMAC(RadioLibCmacState* st, const uint8_t* data, size
     return;
   }
 
-  // ensure subkeys are present
-  if(!st->subkeys_generated) {
-    this->generateSubkeys(st->k1, st->k2);
-    st->subkeys_generated = true;
-  }
-
-  uint8_t tmp[RADIOLIB_AES128_BLOCK_SIZE];
   size_t offset = 0;
-
   while(len > 0) {
 
     // fill buffer up to one full block
@@ -87,6 +112,15 @@ void RadioLibAES128::updateCMAC(RadioLibCmacState* st, const uint8_t* data, size
       to_copy = len;
     }
 
+    // full blocks that are not the last one can be processed directly from the input
+    if((st->buffer_len == 0) && (len > RADIOLIB_AES128_BLOCK_SIZE)) {
+      this->blockXor(st->X, &data[offset], st->X);
+      this->cipher((state_t*)st->X, this->roundKey);
+      offset += RADIOLIB_AES128_BLOCK_SIZE;
+      len -= RADIOLIB_AES128_BLOCK_SIZE;
+      continue;
+    }
+
     // copy the data into the buffer
     memcpy(&st->buffer[st->buffer_len], &data[offset], to_copy);
     st->buffer_len += to_copy;
@@ -96,8 +130,8 @@ void RadioLibAES128::updateCMAC(RadioLibCmacState* st, const uint8_t* data, size
     // if we now have a full block AND there is still more input remaining,
     // this block is NOT the final one, so process it.
     if(st->buffer_len == RADIOLIB_AES128_BLOCK_SIZE && len > 0) {
-      this->blockXor(tmp, st->buffer, st->X);
-      this->encryptECB(tmp, RADIOLIB_AES128_BLOCK_SIZE, st->X);
+      this->blockXor(st->X, st->buffer, st->X);
+      this->cipher((state_t*)st->X, this->roundKey);
       st->buffer_len = 0;
     }
   }
@@ -108,28 +142,26 @@ void RadioLibAES128::finishCMAC(RadioLibCmacState* st, uint8_t* out) {
     return;
   }
 
-  // ensure subkeys are present
-  if(!st->subkeys_generated) {
-    this->generateSubkeys(st->k1, st->k2);
-    st->subkeys_generated = true;
+  // subkeys only depend on the key, so they are generated only once per key
+  if(!this->subkeysGenerated) {
+    this->generateSubkeys(this->k1, this->k2);
+    this->subkeysGenerated = true;
   }
 
   uint8_t last[RADIOLIB_AES128_BLOCK_SIZE];
-  uint8_t Y[RADIOLIB_AES128_BLOCK_SIZE];
-
   if(st->buffer_len == RADIOLIB_AES128_BLOCK_SIZE) {
-    this->blockXor(last, st->buffer, st->k1);
+    this->blockXor(last, st->buffer, this->k1);
   } else {
     memset(last, 0x00, RADIOLIB_AES128_BLOCK_SIZE);
     if(st->buffer_len > 0) {
       memcpy(last, st->buffer, st->buffer_len);
     }
     last[st->buffer_len] = 0x80;
-    this->blockXor(last, last, st->k2);
+    this->blockXor(last, last, this->k2);
   }
 
-  this->blockXor(Y, last, st->X);
-  this->encryptECB(Y, RADIOLIB_AES128_BLOCK_SIZE, out);
+  this->blockXor(out, last, st->X);
+  this->cipher((state_t*)out, this->roundKey);
 }
 
 void RadioLibAES128::generateCMAC(const uint8_t* in, size_t len, uint8_t* cmac) {
@@ -139,15 +171,24 @@ void RadioLibAES128::generateCMAC(const uint8_t* in, size_t len, uint8_t* cmac)
   this->finishCMAC(&st, cmac);
 }
 
+void RadioLibAES128::generateCMAC(const uint8_t* prefix, const uint8_t* in, size_t len, uint8_t* cmac) {
+  RadioLibCmacState st;
+  this->initCMAC(&st);
+  this->updateCMAC(&st, prefix, RADIOLIB_AES128_BLOCK_SIZE);
+  this->updateCMAC(&st, in, len);
+  this->finishCMAC(&st, cmac);
+}
+
 bool RadioLibAES128::verifyCMAC(const uint8_t* in, size_t len, const uint8_t* cmac) {
   uint8_t cmacReal[RADIOLIB_AES128_BLOCK_SIZE];
   this->generateCMAC(in, len, cmacReal);
+
+  // accumulate the differences to not leak the position of the first mismatch
+  uint8_t diff = 0;
   for(size_t i = 0; i < RADIOLIB_AES128_BLOCK_SIZE; i++) {
-    if((cmacReal[i] != cmac[i])) {
-      return(false);
-    }
+    diff |= cmacReal[i] ^ cmac[i];
   }
-  return(true);
+  return(diff == 0);
 }
 
 void RadioLibAES128::keyExpansion(uint8_t* roundKey, const uint8_t* key) {
@@ -182,6 +223,11 @@ void RadioLibAES128::keyExpansion(uint8_t* roundKey, const uint8_t* key) {
 }
 
 void RadioLibAES128::cipher(state_t* state, uint8_t* roundKey) {
+  #if RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_TTABLE
+  this->cipherTable(state, roundKey);
+  return;
+  #endif
+
   this->addRoundKey(0, state, roundKey);
   for(uint8_t round = 1; round < RADIOLIB_AES128_N_R; round++) {
     this->subBytes(state, aesSbox);
@@ -211,6 +257,12 @@ void RadioLibAES128::decipher(state_t* state, uint8_t* roundKey) {
 }
 
 void RadioLibAES128::subWord(uint8_t* word) {
+  #if RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_BITSLICED
+  // key expansion must not leak the key either
+  this->subBytesBitsliced(word, 4, false);
+  return;
+  #endif
+
   for(size_t i = 0; i < 4; i++) {
     uint8_t* ptr = const_cast<uint8_t*>(&aesSbox[word[i]]);
     word[i] = RADIOLIB_NONVOLATILE_READ_BYTE(ptr);
@@ -264,7 +316,8 @@ void RadioLibAES128::generateSubkeys(uint8_t* key1, uint8_t* key2) {
   };
 
   uint8_t L[RADIOLIB_AES128_BLOCK_SIZE];
-  this->encryptECB(const_Zero, RADIOLIB_AES128_BLOCK_SIZE, L);
+  memcpy(L, const_Zero, RADIOLIB_AES128_BLOCK_SIZE);
+  this->cipher((state_t*)L, this->roundKey);
   this->blockLeftshift(key1, L);
   if(L[0] & 0x80) {
     this->blockXor(key1, key1, const_Rb);
@@ -277,6 +330,11 @@ void RadioLibAES128::generateSubkeys(uint8_t* key1, uint8_t* key2) {
 }
 
 void RadioLibAES128::subBytes(state_t* state, const uint8_t* box) {
+  #if RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_BITSLICED
+  this->subBytesBitsliced(reinterpret_cast<uint8_t*>(state), RADIOLIB_AES128_BLOCK_SIZE, box == aesSboxInv);
+  return;
+  #endif
+
   for(size_t row = 0; row < 4; row++) {
     for(size_t col = 0; col < 4; col++) {
       uint8_t* ptr = const_cast<uint8_t*>(&box[(*state)[col][row]]);
@@ -337,10 +395,8 @@ uint8_t RadioLibAES128::mul(uint8_t a, uint8_t b) {
   uint8_t out = 0;
   sb[0] = b;
   for(size_t i = 1; i < 4; i++) {
-    sb[i] = sb[i - 1] << 1;
-    if (sb[i - 1] & 0x80) {
-      sb[i] ^= 0x1b;
-    }
+    // reduction without branching on the (secret) value
+    sb[i] = (sb[i - 1] << 1) ^ (0x1b & (uint8_t)(0 - (sb[i - 1] >> 7)));
   }
   for(size_t i = 0; i < 4; i++) {
     if(a >> i & 0x01) {
@@ -350,4 +406,232 @@ uint8_t RadioLibAES128::mul(uint8_t a, uint8_t b) {
   return(out);
 }
 
+#if RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_TTABLE
+static inline uint32_t aesTeRead(uint8_t x) {
+  uint32_t* ptr = const_cast<uint32_t*>(&aesTe0[x]);
+  return(RADIOLIB_NONVOLATILE_READ_DWORD(ptr));
+}
+
+static inline uint32_t aesRotr(uint32_t x, uint8_t n) {
+  return((x >> n) | (x << (32 - n)));
+}
+
+static inline uint32_t aesLoadWord(const uint8_t* buff) {
+  return(((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) | ((uint32_t)buff[2] << 8) | (uint32_t)buff[3]);
+}
+
+void RadioLibAES128::cipherTable(state_t* state, const uint8_t* roundKey) {
+  // each word holds one column, first row in the most significant byte
+  uint8_t* buff = reinterpret_cast<uint8_t*>(state);
+  uint32_t w[4];
+  uint32_t t[4];
+  for(size_t c = 0; c < 4; c++) {
+    w[c] = aesLoadWord(&buff[4*c]) ^ aesLoadWord(&roundKey[4*c]);
+  }
+
+  // SubBytes, ShiftRows and MixColumns are all merged in the table lookups
+  for(uint8_t round = 1; round < RADIOLIB_AES128_N_R; round++) {
+    for(size_t c = 0; c < 4; c++) {
+      t[c] = aesTeRead(w[c] >> 24) ^
+             aesRotr(aesTeRead((w[(c + 1) % 4] >> 16) & 0xFF), 8) ^
+             aesRotr(aesTeRead((w[(c + 2) % 4] >> 8) & 0xFF), 16) ^
+             aesRotr(aesTeRead(w[(c + 3) % 4] & 0xFF), 24) ^
+             aesLoadWord(&roundKey[(round * RADIOLIB_AES128_BLOCK_SIZE) + 4*c]);
+    }
+    memcpy(w, t, sizeof(w));
+  }
+
+  // the last round has no MixColumns, plain S-box is the second byte of the table entry
+  for(size_t c = 0; c < 4; c++) {
+    t[c] = (aesTeRead(w[c] >> 24) & 0x00FF0000UL) << 8 |
+           (aesTeRead((w[(c + 1) % 4] >> 16) & 0xFF) & 0x00FF0000UL) |
+           (aesTeRead((w[(c + 2) % 4] >> 8) & 0xFF) & 0x00FF0000UL) >> 8 |
+           (aesTeRead(w[(c + 3) % 4] & 0xFF) & 0x00FF0000UL) >> 16;
+    t[c] ^= aesLoadWord(&roundKey[(RADIOLIB_AES128_N_R * RADIOLIB_AES128_BLOCK_SIZE) + 4*c]);
+    for(size_t r = 0; r < 4; r++) {
+      buff[4*c + r] = (t[c] >> (24 - 8*r)) & 0xFF;
+    }
+  }
+}
+
+#elif RADIOLIB_AES_CORE == RADIOLIB_AES_CORE_BITSLICED
+// inverse of the S-box affine transformation
+static inline uint8_t aesInvAffine(uint8_t x) {
+  uint8_t r1 = (x << 1) | (x >> 7);
+  uint8_t r3 = (x << 3) | (x >> 5);
+  uint8_t r6 = (x << 6) | (x >> 2);
+  return(r1 ^ r3 ^ r6 ^ 0x05);
+}
+
+/*
+  S-box circuit by Boyar and Peralta, "A depth-16 circuit for the AES S-box",
+  evaluated on bit planes - bit n of each plane belongs to the n-th input byte,
+  so all bytes are substituted at once without any lookups or branches.
+*/
+static void aesSboxCircuit(uint16_t* q) {
+  uint16_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4];
+  uint16_t x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+  // top linear transformation
+  uint16_t y14 = x3 ^ x5;
+  uint16_t y13 = x0 ^ x6;
+  uint16_t y9 = x0 ^ x3;
+  uint16_t y8 = x0 ^ x5;
+  uint16_t t0 = x1 ^ x2;
+  uint16_t y1 = t0 ^ x7;
+  uint16_t y4 = y1 ^ x3;
+  uint16_t y12 = y13 ^ y14;
+  uint16_t y2 = y1 ^ x0;
+  uint16_t y5 = y1 ^ x6;
+  uint16_t y3 = y5 ^ y8;
+  uint16_t t1 = x4 ^ y12;
+  uint16_t y15 = t1 ^ x5;
+  uint16_t y20 = t1 ^ x1;
+  uint16_t y6 = y15 ^ x7;
+  uint16_t y10 = y15 ^ t0;
+  uint16_t y11 = y20 ^ y9;
+  uint16_t y7 = x7 ^ y11;
+  uint16_t y17 = y10 ^ y11;
+  uint16_t y19 = y10 ^ y8;
+  uint16_t y16 = t0 ^ y11;
+  uint16_t y21 = y13 ^ y16;
+  uint16_t y18 = x0 ^ y16;
+
+  // non-linear section
+  uint16_t t2 = y12 & y15;
+  uint16_t t3 = y3 & y6;
+  uint16_t t4 = t3 ^ t2;
+  uint16_t t5 = y4 & x7;
+  uint16_t t6 = t5 ^ t2;
+  uint16_t t7 = y13 & y16;
+  uint16_t t8 = y5 & y1;
+  uint16_t t9 = t8 ^ t7;
+  uint16_t t10 = y2 & y7;
+  uint16_t t11 = t10 ^ t7;
+  uint16_t t12 = y9 & y11;
+  uint16_t t13 = y14 & y17;
+  uint16_t t14 = t13 ^ t12;
+  uint16_t t15 = y8 & y10;
+  uint16_t t16 = t15 ^ t12;
+  uint16_t t17 = t4 ^ t14;
+  uint16_t t18 = t6 ^ t16;
+  uint16_t t19 = t9 ^ t14;
+  uint16_t t20 = t11 ^ t16;
+  uint16_t t21 = t17 ^ y20;
+  uint16_t t22 = t18 ^ y19;
+  uint16_t t23 = t19 ^ y21;
+  uint16_t t24 = t20 ^ y18;
+
+  uint16_t t25 = t21 ^ t22;
+  uint16_t t26 = t21 & t23;
+  uint16_t t27 = t24 ^ t26;
+  uint16_t t28 = t25 & t27;
+  uint16_t t29 = t28 ^ t22;
+  uint16_t t30 = t23 ^ t24;
+  uint16_t t31 = t22 ^ t26;
+  uint16_t t32 = t31 & t30;
+  uint16_t t33 = t32 ^ t24;
+  uint16_t t34 = t23 ^ t33;
+  uint16_t t35 = t27 ^ t33;
+  uint16_t t36 = t24 & t35;
+  uint16_t t37 = t36 ^ t34;
+  uint16_t t38 = t27 ^ t36;
+  uint16_t t39 = t29 & t38;
+  uint16_t t40 = t25 ^ t39;
+
+  uint16_t t41 = t40 ^ t37;
+  uint16_t t42 = t29 ^ t33;
+  uint16_t t43 = t29 ^ t40;
+  uint16_t t44 = t33 ^ t37;
+  uint16_t t45 = t42 ^ t41;
+  uint16_t z0 = t44 & y15;
+  uint16_t z1 = t37 & y6;
+  uint16_t z2 = t33 & x7;
+  uint16_t z3 = t43 & y16;
+  uint16_t z4 = t40 & y1;
+  uint16_t z5 = t29 & y7;
+  uint16_t z6 = t42 & y11;
+  uint16_t z7 = t45 & y17;
+  uint16_t z8 = t41 & y10;
+  uint16_t z9 = t44 & y12;
+  uint16_t z10 = t37 & y3;
+  uint16_t z11 = t33 & y4;
+  uint16_t z12 = t43 & y13;
+  uint16_t z13 = t40 & y5;
+  uint16_t z14 = t29 & y2;
+  uint16_t z15 = t42 & y9;
+  uint16_t z16 = t45 & y14;
+  uint16_t z17 = t41 & y8;
+
+  // bottom linear transformation
+  uint16_t t46 = z15 ^ z16;
+  uint16_t t47 = z10 ^ z11;
+  uint16_t t48 = z5 ^ z13;
+  uint16_t t49 = z9 ^ z10;
+  uint16_t t50 = z2 ^ z12;
+  uint16_t t51 = z2 ^ z5;
+  uint16_t t52 = z7 ^ z8;
+  uint16_t t53 = z0 ^ z3;
+  uint16_t t54 = z6 ^ z7;
+  uint16_t t55 = z16 ^ z17;
+  uint16_t t56 = z12 ^ t48;
+  uint16_t t57 = t50 ^ t53;
+  uint16_t t58 = z4 ^ t46;
+  uint16_t t59 = z3 ^ t54;
+  uint16_t t60 = t46 ^ t57;
+  uint16_t t61 = z14 ^ t57;
+  uint16_t t62 = t52 ^ t58;
+  uint16_t t63 = t49 ^ t58;
+  uint16_t t64 = z4 ^ t59;
+  uint16_t t65 = t61 ^ t62;
+  uint16_t t66 = z1 ^ t63;
+  uint16_t s0 = t59 ^ t63;
+  uint16_t s6 = t56 ^ ~t62;
+  uint16_t s7 = t48 ^ ~t60;
+  uint16_t t67 = t64 ^ t65;
+  uint16_t s3 = t53 ^ t66;
+  uint16_t s4 = t51 ^ t66;
+  uint16_t s5 = t47 ^ t65;
+  uint16_t s1 = t64 ^ ~s3;
+  uint16_t s2 = t55 ^ ~t67;
+
+  q[7] = s0;
+  q[6] = s1;
+  q[5] = s2;
+  q[4] = s3;
+  q[3] = s4;
+  q[2] = s5;
+  q[1] = s6;
+  q[0] = s7;
+}
+
+void RadioLibAES128::subBytesBitsliced(uint8_t* bytes, size_t len, bool inv) {
+  // inverse S-box is the forward one wrapped in inverse affine transformations
+  if(inv) {
+    for(size_t i = 0; i < len; i++) {
+      bytes[i] = aesInvAffine(bytes[i]);
+    }
+  }
+
+  // transpose the bytes into bit planes
+  uint16_t q[8] = { 0 };
+  for(size_t i = 0; i < len; i++) {
+    for(uint8_t b = 0; b < 8; b++) {
+      q[b] |= (uint16_t)((bytes[i] >> b) & 0x01) << i;
+    }
+  }
+
+  aesSboxCircuit(q);
+
+  // and transpose back
+  for(size_t i = 0; i < len; i++) {
+    uint8_t val = 0;
+    for(uint8_t b = 0; b < 8; b++) {
+      val |= ((q[b] >> i) & 0x01) << b;
+    }
+    bytes[i] = inv ? aesInvAffine(val) : val;
+  }
+}
+#endif
+
 RadioLibAES128 RadioLibAES128Instance;
\ No newline at end of file
@@ -10,6 +10,8 @@ RadioLibBCH::~RadioLibBCH() {
     delete[] this->alphaTo;
     delete[] this->indexOf;
     delete[] this->generator;
+    delete[] this->syndromeTable;
+    delete[] this->syndromes;
   #endif
 }
 
@@ -190,6 +192,8 @@ void RadioLibBCH::begin(uint8_t n, uint8_t k, uint32_t poly) {
   #if !RADIOLIB_STATIC_ONLY
   delete[] zeros;
   #endif
+
+  this->buildSyndromeTable();
 }
 
 /*
@@ -306,6 +310,112 @@ uint32_t RadioLibBCH::encode(uint32_t dataword) {
 	return(res);
 }
 
+int8_t RadioLibBCH::decode(uint32_t* codeword) {
+  if(!codeword || !this->syndromeTableValid) {
+    return(-1);
+  }
+
+  // the BCH part of the code word sits above the overall parity bit
+  uint32_t cw = *codeword;
+  uint32_t word = cw >> 1;
+  uint32_t synd = this->syndrome(word);
+  int8_t numErrors = 0;
+  if(synd != 0) {
+    // the table holds the lowest error position, the remaining syndrome must then be a single error
+    uint8_t pos = this->syndromeTable[synd];
+    if(pos == 0) {
+      return(-1);
+    }
+    word ^= (uint32_t)1 << (pos - 1);
+    synd ^= this->syndromes[pos - 1];
+    numErrors++;
+
+    if(synd != 0) {
+      pos = this->syndromeTable[synd];
+      if((pos == 0) || (this->syndromes[pos - 1] != synd)) {
+        return(-1);
+      }
+      word ^= (uint32_t)1 << (pos - 1);
+      numErrors++;
+    }
+  }
+
+  // regenerate the even parity bit
+  uint32_t parity = word;
+  parity ^= parity >> 16;
+  parity ^= parity >> 8;
+  parity ^= parity >> 4;
+  parity ^= parity >> 2;
+  parity ^= parity >> 1;
+  parity &= 0x01;
+
+  // odd number of errors in total after fixing two means there is a third one
+  if(parity != (cw & 0x01)) {
+    if(numErrors == 2) {
+      return(-1);
+    }
+    numErrors++;
+  }
+
+  *codeword = (word << 1) | parity;
+  return(numErrors);
+}
+
+uint32_t RadioLibBCH::syndrome(uint32_t word) {
+  // polynomial division by the generator, without branching on the data
+  uint8_t r = this->n - this->k;
+  for(int8_t i = this->n - 1; i >= r; i--) {
+    uint32_t mask = (uint32_t)0 - ((word >> i) & 0x01);
+    word ^= (this->genPoly << (i - r)) & mask;
+  }
+  return(word & (((uint32_t)1 << r) - 1));
+}
+
+void RadioLibBCH::buildSyndromeTable() {
+  // the table is only built for codes with few enough check bits
+  uint8_t r = this->n - this->k;
+  this->syndromeTableValid = false;
+  this->genPoly = 0;
+  for(uint8_t i = 0; i <= r; i++) {
+    if(this->generator[i]) {
+      this->genPoly |= (uint32_t)1 << i;
+    }
+  }
+
+  #if !RADIOLIB_STATIC_ONLY
+  delete[] this->syndromeTable;
+  delete[] this->syndromes;
+  this->syndromeTable = nullptr;
+  this->syndromes = nullptr;
+  #endif
+  if((r > RADIOLIB_BCH_MAX_SYNDROME_BITS) || (this->n > 32)) {
+    return;
+  }
+
+  #if !RADIOLIB_STATIC_ONLY
+  this->syndromeTable = new uint8_t[(size_t)1 << r];
+  this->syndromes = new uint16_t[this->n];
+  #endif
+  memset(this->syndromeTable, 0, (size_t)1 << r);
+
+  for(uint8_t i = 0; i < this->n; i++) {
+    this->syndromes[i] = this->syndrome((uint32_t)1 << i);
+  }
+
+  // all pairs, indexed by the lower position
+  for(uint8_t i = 0; i < this->n; i++) {
+    for(uint8_t j = i + 1; j < this->n; j++) {
+      this->syndromeTable[this->syndromes[i] ^ this->syndromes[j]] = i + 1;
+    }
+  }
+
+  // single errors last, so that they take precedence for codes with smaller distance
+  for(uint8_t i = 0; i < this->n; i++) {
+    this->syndromeTable[this->syndromes[i]] = i + 1;
+  }
+  this->syndromeTableValid = true;
+}
+
 RadioLibBCH RadioLibBCHInstance;
 
 RadioLibConvCode::RadioLibConvCode() {
@@ -362,4 +472,120 @@ int16_t RadioLibConvCode::encode(const uint8_t* in, size_t in_bits, uint8_t* out
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t RadioLibConvCode::decode(const uint8_t* in, size_t in_bits, uint8_t* out, size_t* out_bits, bool terminated) {
+  return(this->viterbi(in, false, in_bits, out, out_bits, terminated));
+}
+
+int16_t RadioLibConvCode::decodeSoft(const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_bits, bool terminated) {
+  return(this->viterbi(in, true, in_len, out, out_bits, terminated));
+}
+
+int16_t RadioLibConvCode::viterbi(const uint8_t* in, bool soft, size_t in_len, uint8_t* out, size_t* out_bits, bool terminated) {
+  if(!in || !out || ((this->rate != 2) && (this->rate != 3))) {
+    return(RADIOLIB_ERR_UNKNOWN);
+  }
+
+  // the encoder state is the last 4 (rate 1/2) or 6 (rate 1/3) input bits
+  const uint32_t* lut_ptr = (this->rate == 2) ? ConvCodeTable1_2 : ConvCodeTable1_3;
+  const uint8_t mem = (this->rate == 2) ? 4 : 6;
+  const uint8_t numStates = 1 << mem;
+  const size_t steps = in_len / this->rate;
+
+  // path metrics, the unknown states start with a large penalty
+  uint16_t metric[64];
+  uint16_t next[64];
+  for(uint8_t s = 0; s < numStates; s++) {
+    metric[s] = (s == this->enc_state) ? 0 : 0x3FFF;
+  }
+
+  // survivor decisions, one bit per state for each step in the traceback window
+  uint64_t decisions[RADIOLIB_CONV_CODE_TRACEBACK];
+
+  for(size_t t = 0; t < steps; t++) {
+    // cost of every possible output symbol in this step
+    uint16_t cost[8] = { 0 };
+    for(uint8_t i = 0; i < this->rate; i++) {
+      size_t pos = t*this->rate + i;
+      uint16_t one = 0;
+      if(soft) {
+        one = 255 - in[pos];
+      } else {
+        one = GET_BIT_IN_ARRAY_LSB(in, pos) ? 0 : 255;
+      }
+      uint16_t zero = 255 - one;
+      for(uint8_t sym = 0; sym < (1 << this->rate); sym++) {
+        cost[sym] += (sym & (1 << (this->rate - 1 - i))) ? one : zero;
+      }
+    }
+
+    // add-compare-select, each state has two predecessors that differ in the oldest bit
+    uint64_t dec = 0;
+    uint16_t best = 0xFFFF;
+    for(uint8_t s = 0; s < numStates; s++) {
+      uint8_t bit = s & 0x01;
+      uint8_t p0 = s >> 1;
+      uint8_t p1 = p0 | (numStates >> 1);
+      uint8_t g0 = (lut_ptr[p0 / 4] >> ((3 - (p0 % 4)) * 8 + (1 - bit) * 4)) & 0x0F;
+      uint8_t g1 = (lut_ptr[p1 / 4] >> ((3 - (p1 % 4)) * 8 + (1 - bit) * 4)) & 0x0F;
+      uint16_t m0 = metric[p0] + cost[g0];
+      uint16_t m1 = metric[p1] + cost[g1];
+      if(m1 < m0) {
+        next[s] = m1;
+        dec |= (uint64_t)1 << s;
+      } else {
+        next[s] = m0;
+      }
+      if(next[s] < best) {
+        best = next[s];
+      }
+    }
+    decisions[t % RADIOLIB_CONV_CODE_TRACEBACK] = dec;
+
+    // renormalize to keep the metrics from overflowing
+    uint8_t bestState = 0;
+    for(uint8_t s = 0; s < numStates; s++) {
+      metric[s] = next[s] - best;
+      if(metric[s] == 0) {
+        bestState = s;
+      }
+    }
+
+    // once the window is full, trace back from the best state and release the oldest bit
+    if(t + 1 >= RADIOLIB_CONV_CODE_TRACEBACK) {
+      uint8_t s = bestState;
+      for(size_t i = t; i > t + 1 - RADIOLIB_CONV_CODE_TRACEBACK; i--) {
+        s = (s >> 1) | (((decisions[i % RADIOLIB_CONV_CODE_TRACEBACK] >> s) & 0x01) << (mem - 1));
+      }
+      size_t outPos = t + 1 - RADIOLIB_CONV_CODE_TRACEBACK;
+      if(s & 0x01) {
+        SET_BIT_IN_ARRAY_LSB(out, outPos);
+      } else {
+        CLEAR_BIT_IN_ARRAY_LSB(out, outPos);
+      }
+    }
+  }
+
+  // flush the rest of the window from the final state - known if the encoder was flushed, best one otherwise
+  uint8_t s = 0;
+  for(uint8_t i = 0; (i < numStates) && !terminated; i++) {
+    if(metric[i] == 0) {
+      s = i;
+      break;
+    }
+  }
+  size_t first = (steps >= RADIOLIB_CONV_CODE_TRACEBACK) ? (steps + 1 - RADIOLIB_CONV_CODE_TRACEBACK) : 0;
+  for(size_t i = steps; i > first; i--) {
+    if(s & 0x01) {
+      SET_BIT_IN_ARRAY_LSB(out, i - 1);
+    } else {
+      CLEAR_BIT_IN_ARRAY_LSB(out, i - 1);
+    }
+    s = (s >> 1) | (((decisions[(i - 1) % RADIOLIB_CONV_CODE_TRACEBACK] >> s) & 0x01) << (mem - 1));
+  }
+
+  if(out_bits) { *out_bits = steps; }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
 RadioLibConvCode RadioLibConvCodeInstance;
@@ -9,6 +9,9 @@
 #define RADIOLIB_PAGER_BCH_K                                    (21)
 #define RADIOLIB_PAGER_BCH_PRIMITIVE_POLY                       (0x25)
 
+// maximum number of check bits for which the syndrome decoding table is built (1 kB for 10 bits)
+#define RADIOLIB_BCH_MAX_SYNDROME_BITS                          (10)
+
 #if RADIOLIB_STATIC_ONLY
 #define RADIOLIB_BCH_MAX_N                                      (63)
 #define RADIOLIB_BCH_MAX_K                                      (31)
@@ -48,21 +51,41 @@ class RadioLibBCH {
     */
     uint32_t encode(uint32_t dataword);
 
+    /*!
+      \brief Decoding method - corrects up to 2 bit errors in a code word using a syndrome lookup table.
+      The overall parity bit (LSB) is regenerated and used to reject code words with 3 errors.
+      \param codeword Pointer to the code word, in the same format as produced by encode. Corrected in place,
+      left unchanged if it could not be corrected.
+      \returns Number of corrected bit errors, or -1 if the code word was not correctable.
+    */
+    int8_t decode(uint32_t* codeword);
+
   private:
     uint8_t n = 0;
     uint8_t k = 0;
     uint32_t poly = 0;
     uint8_t m = 0;
+
+    // generator polynomial as a bit mask, bit i is the coefficient of x^i
+    uint32_t genPoly = 0;
+    bool syndromeTableValid = false;
     
     #if RADIOLIB_STATIC_ONLY
       int32_t alphaTo[RADIOLIB_BCH_MAX_N + 1] = { 0 };
       int32_t indexOf[RADIOLIB_BCH_MAX_N + 1] = { 0 };
       int32_t generator[RADIOLIB_BCH_MAX_N - RADIOLIB_BCH_MAX_K + 1] = { 0 };
+      uint8_t syndromeTable[1UL << RADIOLIB_BCH_MAX_SYNDROME_BITS] = { 0 };
+      uint16_t syndromes[RADIOLIB_BCH_MAX_N] = { 0 };
     #else
       int32_t* alphaTo = nullptr;
       int32_t* indexOf = nullptr;
       int32_t* generator = nullptr;
+      uint8_t* syndromeTable = nullptr;
+      uint16_t* syndromes = nullptr;
     #endif
+
+    uint32_t syndrome(uint32_t word);
+    void buildSyndromeTable();
 };
 
 // the global singleton
@@ -132,11 +155,47 @@ class RadioLibConvCode {
     */
     int16_t encode(const uint8_t* in, size_t in_bits, uint8_t* out, size_t* out_bits = NULL);
 
+    /*!
+      \brief Hard-decision decoding method (Viterbi algorithm with fixed traceback window).
+      Decoding starts from the same state the encoder would start from, i.e. after calling begin,
+      this is the all-zero state.
+      \param in Input buffer with the coded bits, in the same format as produced by encode.
+      \param in_bits Input length in bits.
+      \param out Output buffer (a byte array). It is up to the caller
+      to ensure the buffer is large enough to fit the decoded data!
+      \param out_bits Pointer to a variable to save the number of decoded bits.
+      Ignored if set to NULL.
+      \param terminated Whether the encoder was flushed back to the all-zero state at the end of the input.
+      If not, the final state is the most likely one.
+      \returns \ref status_codes 
+    */
+    int16_t decode(const uint8_t* in, size_t in_bits, uint8_t* out, size_t* out_bits = NULL, bool terminated = false);
+
+    /*!
+      \brief Soft-decision decoding method (Viterbi algorithm with fixed traceback window).
+      \param in Input buffer, one byte per coded bit: 0 is a certain 0, 255 a certain 1
+      and 128 an erasure (e.g. a punctured bit).
+      \param in_len Number of coded bits (bytes) in the input buffer.
+      \param out Output buffer (a byte array). It is up to the caller
+      to ensure the buffer is large enough to fit the decoded data!
+      \param out_bits Pointer to a variable to save the number of decoded bits.
+      Ignored if set to NULL.
+      \param terminated Whether the encoder was flushed back to the all-zero state at the end of the input.
+      If not, the final state is the most likely one.
+      \returns \ref status_codes 
+    */
+    int16_t decodeSoft(const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_bits = NULL, bool terminated = false);
+
   private:
     uint8_t enc_state = 0;
     uint8_t rate = 0;
+
+    int16_t viterbi(const uint8_t* in, bool soft, size_t in_len, uint8_t* out, size_t* out_bits, bool terminated);
 };
 
+// number of trellis steps kept for Viterbi traceback, ~10x the constraint length for the 1/3 code
+#define RADIOLIB_CONV_CODE_TRACEBACK                            (64)
+
 // each 32-bit word stores 8 values, one per each nibble
 static const uint32_t ConvCodeTable1_3[16] = {
   0x07347043, 0x61521625, 0x16256152, 0x70430734,
@@ -0,0 +1,108 @@
+#include "Trace.h"
+#include "../Hal.h"
+
+#if RADIOLIB_TRACE
+
+#include <stdio.h>
+
+static_assert((RADIOLIB_TRACE_SIZE & (RADIOLIB_TRACE_SIZE - 1)) == 0, "RADIOLIB_TRACE_SIZE must be a power of 2");
+
+// single-producer, single-consumer ring buffer
+// head is only written by the producer, tail only by the consumer, so no locking is needed
+// each side publishes its index with a release store and reads the other one with an acquire load
+// events come from all modules and possibly from interrupts, so producers are serialized by the busy flag:
+// a producer that interrupts another one (ISR, preempting task on the same core) drops its event,
+// so that it never writes the slot the interrupted producer is filling
+static RadioLibTraceEvent_t rlb_trace_buff[RADIOLIB_TRACE_SIZE];
+static volatile size_t rlb_trace_head = 0;
+static volatile size_t rlb_trace_tail = 0;
+static volatile bool rlb_trace_busy = false;
+static volatile uint32_t rlb_trace_lost = 0;
+static uint32_t rlb_trace_reported = 0;
+
+void rlb_trace(uint8_t type, uint16_t code, size_t len, uint32_t value) {
+  // a nested producer always finishes before the interrupted one continues,
+  // so the flag only has to be set before head is read and cleared after it is published
+  if(rlb_trace_busy) {
+    rlb_trace_lost = rlb_trace_lost + 1;
+    return;
+  }
+  rlb_trace_busy = true;
+
+  size_t head = rlb_trace_head;
+  if(head - RADIOLIB_ATOMIC_LOAD_ACQUIRE(&rlb_trace_tail) >= RADIOLIB_TRACE_SIZE) {
+    rlb_trace_lost = rlb_trace_lost + 1;
+    rlb_trace_busy = false;
+    return;
+  }
+
+  RadioLibTraceEvent_t* ev = &rlb_trace_buff[head & (RADIOLIB_TRACE_SIZE - 1)];
+  ev->time = (uint32_t)rlb_time_us();
+  ev->code = code;
+  ev->type = type;
+  ev->len = len > 0xFF ? 0xFF : (uint8_t)len;
+  ev->value = value;
+  RADIOLIB_ATOMIC_STORE_RELEASE(&rlb_trace_head, head + 1);
+  rlb_trace_busy = false;
+}
+
+void rlb_trace_data(uint8_t type, uint16_t code, const uint8_t* data, size_t len) {
+  uint32_t value = 0;
+  for(size_t i = 0; (data != NULL) && (i < len) && (i < sizeof(value)); i++) {
+    value |= (uint32_t)data[i] << (24 - 8*i);
+  }
+  rlb_trace(type, code, len, value);
+}
+
+size_t rlb_trace_read(RadioLibTraceEvent_t* events, size_t num) {
+  size_t tail = rlb_trace_tail;
+  size_t head = RADIOLIB_ATOMIC_LOAD_ACQUIRE(&rlb_trace_head);
+  size_t n = 0;
+  while((n < num) && (tail != head)) {
+    events[n++] = rlb_trace_buff[tail & (RADIOLIB_TRACE_SIZE - 1)];
+    tail++;
+  }
+  RADIOLIB_ATOMIC_STORE_RELEASE(&rlb_trace_tail, tail);
+  return(n);
+}
+
+uint32_t rlb_trace_dropped() {
+  // lost counter is only incremented by producers, the consumer keeps track of what was already reported
+  uint32_t lost = rlb_trace_lost;
+  uint32_t diff = lost - rlb_trace_reported;
+  rlb_trace_reported = lost;
+  return(diff);
+}
+
+static void rlb_trace_write(const RadioLibTraceEvent_t* ev) {
+  uint8_t frame[14] = {
+    RADIOLIB_TRACE_SYNC_0, RADIOLIB_TRACE_SYNC_1,
+    (uint8_t)ev->time, (uint8_t)(ev->time >> 8), (uint8_t)(ev->time >> 16), (uint8_t)(ev->time >> 24),
+    (uint8_t)ev->code, (uint8_t)(ev->code >> 8), ev->type, ev->len,
+    (uint8_t)ev->value, (uint8_t)(ev->value >> 8), (uint8_t)(ev->value >> 16), (uint8_t)(ev->value >> 24),
+  };
+  #if defined(RADIOLIB_BUILD_ARDUINO)
+  RADIOLIB_DEBUG_PORT.write(frame, sizeof(frame));
+  #else
+  fwrite(frame, sizeof(frame[0]), sizeof(frame), RADIOLIB_DEBUG_PORT);
+  #endif
+}
+
+size_t rlb_trace_dump(size_t num) {
+  // report lost events first, so that the decoder knows the timeline has a gap
+  uint32_t lost = rlb_trace_dropped();
+  if(lost) {
+    RadioLibTraceEvent_t ev = { (uint32_t)rlb_time_us(), 0, RADIOLIB_TRACE_OVERFLOW, 0, lost };
+    rlb_trace_write(&ev);
+  }
+
+  RadioLibTraceEvent_t ev;
+  size_t n = 0;
+  while(((num == 0) || (n < num)) && rlb_trace_read(&ev, 1)) {
+    rlb_trace_write(&ev);
+    n++;
+  }
+  return(n);
+}
+
+#endif
@@ -0,0 +1,99 @@
+#if !defined(_RADIOLIB_TRACE_H)
+#define _RADIOLIB_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../BuildOpt.h"
+
+// trace event types
+#define RADIOLIB_TRACE_SPI_CMD_WRITE                            (0x01)  // code = command, value = first data bytes
+#define RADIOLIB_TRACE_SPI_CMD_READ                             (0x02)  // code = command, value = first data bytes
+#define RADIOLIB_TRACE_SPI_REG_WRITE                            (0x03)  // code = register address (lower 16 bits), value = first data bytes
+#define RADIOLIB_TRACE_SPI_REG_READ                             (0x04)  // code = register address (lower 16 bits), value = first data bytes
+#define RADIOLIB_TRACE_SPI_CHAIN_WRITE                          (0x05)  // as SPI_CMD_WRITE, but part of a transaction chain
+#define RADIOLIB_TRACE_SPI_CHAIN_READ                           (0x06)  // as SPI_CMD_READ, but part of a transaction chain
+#define RADIOLIB_TRACE_GPIO_WAIT                                (0x07)  // code = 0 before/1 after transfer, len = 1 on timeout, value = wait in us
+#define RADIOLIB_TRACE_MODE                                     (0x08)  // code = Module::OpMode_t
+#define RADIOLIB_TRACE_IRQ                                      (0x09)  // value = IRQ flags as read from the module
+#define RADIOLIB_TRACE_USER                                     (0x0A)  // user event, all fields are free to use
+#define RADIOLIB_TRACE_OVERFLOW                                 (0x0F)  // value = number of events lost since the last drain
+
+// synchronization bytes preceding each event in rlb_trace_dump output
+#define RADIOLIB_TRACE_SYNC_0                                   (0xA5)
+#define RADIOLIB_TRACE_SYNC_1                                   (0x5A)
+
+/*!
+  \struct RadioLibTraceEvent_t
+  \brief Single trace event, 12 bytes.
+*/
+struct RadioLibTraceEvent_t {
+  /*! \brief Timestamp in microseconds, truncated to 32 bits. */
+  uint32_t time;
+
+  /*! \brief Event-specific code, e.g. SPI command or register address. */
+  uint16_t code;
+
+  /*! \brief Event type, one of RADIOLIB_TRACE_* macros. */
+  uint8_t type;
+
+  /*! \brief Event-specific length, e.g. number of transferred bytes (saturated at 255). */
+  uint8_t len;
+
+  /*! \brief Event-specific value, e.g. up to 4 first transferred bytes, first byte in the MSB. */
+  uint32_t value;
+};
+
+#if RADIOLIB_TRACE
+
+/*!
+  \brief Record a single event into the trace buffer. If the buffer is full, the event is dropped.
+  Events may be recorded from any module and from interrupts. An event recorded while another one
+  is being recorded (e.g. from an interrupt) is dropped and counted as lost. Recording from two CPU cores
+  at the same time is not supported. Draining may be done from a different context than recording.
+  \param type Event type, one of RADIOLIB_TRACE_* macros.
+  \param code Event-specific code.
+  \param len Event-specific length.
+  \param value Event-specific value.
+*/
+void rlb_trace(uint8_t type, uint16_t code, size_t len, uint32_t value);
+
+/*!
+  \brief Record an event with data bytes, only up to first 4 bytes are kept in the event value.
+  \param type Event type, one of RADIOLIB_TRACE_* macros.
+  \param code Event-specific code.
+  \param data Transferred data, may be NULL.
+  \param len Number of transferred bytes.
+*/
+void rlb_trace_data(uint8_t type, uint16_t code, const uint8_t* data, size_t len);
+
+/*!
+  \brief Move events out of the trace buffer.
+  \param events Buffer to save the events into.
+  \param num Maximum number of events to read.
+  \returns Number of events that were read.
+*/
+size_t rlb_trace_read(RadioLibTraceEvent_t* events, size_t num);
+
+/*!
+  \brief Write events from the trace buffer to debug port in binary form, for decoding by TraceDecoder.py.
+  Each event is preceded by two synchronization bytes and sent as little endian.
+  \param num Maximum number of events to write, 0 to write all available.
+  \returns Number of events that were written.
+*/
+size_t rlb_trace_dump(size_t num = 0);
+
+/*!
+  \brief Get the number of events lost due to full buffer since the last call.
+  \returns Number of lost events.
+*/
+uint32_t rlb_trace_dropped();
+
+#define RADIOLIB_TRACE_EVENT(...)   rlb_trace(__VA_ARGS__)
+#define RADIOLIB_TRACE_DATA(...)    rlb_trace_data(__VA_ARGS__)
+#else
+#define RADIOLIB_TRACE_EVENT(...) {}
+#define RADIOLIB_TRACE_DATA(...) {}
+#endif
+
+#endif
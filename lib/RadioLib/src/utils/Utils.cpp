@@ -15,16 +15,33 @@ uint32_t rlb_reflect(uint32_t in, uint8_t bits) {
   return(res);
 }
 
-// fast-ish popcount function for use in calculating LFSR feedback value
-// without relying on __builtin_popcount() which may or may not be available
-// from https://stackoverflow.com/a/51388846
-static uint8_t rlb_popcount(uint32_t in) {
+// use the compiler intrinsics when available, these map to single instructions on most cores
+// otherwise fall back to fast-ish portable versions
+// the long variants are used, as int is only 16 bits wide on some platforms (e.g. AVR)
+uint8_t rlb_popcount(uint32_t in) {
+  #if defined(__GNUC__)
+  return(__builtin_popcountl(in));
+  #else
+  // from https://stackoverflow.com/a/51388846
   in = (in & 0x55555555UL) + ((in >> 1) & 0x55555555UL);
   in = (in & 0x33333333UL) + ((in >> 2) & 0x33333333UL);
   in = (in & 0x0F0F0F0FUL) + ((in >> 4) & 0x0F0F0F0FUL);
   in = (in & 0x00FF00FFUL) + ((in >> 8) & 0x00FF00FFUL);
   in = (in & 0x0000FFFFUL) + ((in >>16) & 0x0000FFFFUL);
   return(in);
+  #endif
+}
+
+uint8_t rlb_ctz(uint32_t in) {
+  if(!in) {
+    return(32);
+  }
+  #if defined(__GNUC__)
+  return(__builtin_ctzl(in));
+  #else
+  // isolate the lowest set bit and count the bits below it
+  return(rlb_popcount((in & (~in + 1)) - 1));
+  #endif
 }
 
 void rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_t init, bool scramble) {
@@ -129,7 +146,7 @@ void rlb_hexdump(const char* level, const uint8_t* data, size_t len, uint32_t of
   #endif
 }
 
-#if RADIOLIB_DEBUG
+#if RADIOLIB_DEBUG || RADIOLIB_SPI_STATS
 // https://github.com/esp8266/Arduino/blob/65579d29081cb8501e4d7f786747bf12e7b37da2/cores/esp8266/Print.cpp#L50
 size_t rlb_printf(bool ts, const char* format, ...) {
   va_list arg;
@@ -29,6 +29,20 @@
 */
 uint32_t rlb_reflect(uint32_t in, uint8_t bits);
 
+/*!
+  \brief Function to count the number of set bits.
+  \param in The input value.
+  \return Number of bits set in the input.
+*/
+uint8_t rlb_popcount(uint32_t in);
+
+/*!
+  \brief Function to count the number of trailing zero bits, i.e. get the index of the lowest set bit.
+  \param in The input value.
+  \return Number of trailing zeros, 32 if the input is zero.
+*/
+uint8_t rlb_ctz(uint32_t in);
+
 /*!
   \brief Function to scramble or descramble input using a linear feedback shift register (LFSR).
   \param data The input data to (de)scramble.
@@ -50,7 +64,7 @@ void rlb_scrambler(uint8_t* data, size_t len, const uint32_t poly, const uint32_
 */
 void rlb_hexdump(const char* level, const uint8_t* data, size_t len, uint32_t offset = 0, uint8_t width = 1, bool be = false);
 
-#if RADIOLIB_DEBUG
+#if RADIOLIB_DEBUG || RADIOLIB_SPI_STATS
 size_t rlb_printf(bool ts, const char* format, ...);
 #endif
 